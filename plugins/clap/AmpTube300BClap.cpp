@@ -0,0 +1,325 @@
+/**
+ * AmpTube300BClap - CLAP plugin wrapper around the 300B DSP core
+ *
+ * Lets a host run the tube model inside its own processing graph instead
+ * of routing system audio through VB-CABLE and AudioEngine. Exposes one
+ * stereo input/output pair declared as an in-place pair, so hosts that
+ * share the buffers get no copies at all; otherwise the input is copied to
+ * the output once. The only parameter is a host bypass, applied sample-
+ * accurately by splitting the block at event times.
+ *
+ * Built as a shared library named AmpTube300B.clap from this file plus the
+ * Qt-free core (src/capi, src/dsp, src/utils/Logger).
+ */
+
+#include <clap/clap.h>
+#include "../../src/capi/tubeamp.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t kChannels = 2;
+constexpr clap_id kBypassParamId = 0;
+constexpr uint8_t kStateVersion = 1;
+
+const char* const kFeatures[] = {
+    CLAP_PLUGIN_FEATURE_AUDIO_EFFECT,
+    CLAP_PLUGIN_FEATURE_DISTORTION,
+    CLAP_PLUGIN_FEATURE_STEREO,
+    nullptr
+};
+
+const clap_plugin_descriptor_t kDescriptor = {
+    CLAP_VERSION_INIT,
+    "com.tunwen.amptube300b",
+    "AmpTube300B",
+    "Tunwen",
+    "https://github.com/Tunwen0/300B-TubeAmp-SoundEffect-for-Windows",
+    "",
+    "",
+    "1.0.0",
+    "300B single-ended tube amplifier coloration",
+    kFeatures
+};
+
+struct Plugin {
+    clap_plugin_t clap;
+    const clap_host_t* host = nullptr;
+    tubeamp_processor* dsp = nullptr;
+    std::atomic<bool> bypass{false};  // written on the audio thread, read by the host's main thread
+};
+
+Plugin* self(const clap_plugin_t* plugin) {
+    return static_cast<Plugin*>(plugin->plugin_data);
+}
+
+void setBypass(Plugin* plugin, bool bypass) {
+    plugin->bypass.store(bypass, std::memory_order_relaxed);
+    tubeamp_set_bypass(plugin->dsp, bypass ? 1 : 0);
+}
+
+void applyEvent(Plugin* plugin, const clap_event_header_t* header) {
+    if (header->space_id != CLAP_CORE_EVENT_SPACE_ID || header->type != CLAP_EVENT_PARAM_VALUE) {
+        return;
+    }
+    const auto* event = reinterpret_cast<const clap_event_param_value_t*>(header);
+    if (event->param_id == kBypassParamId) {
+        setBypass(plugin, event->value >= 0.5);
+    }
+}
+
+// --- clap_plugin ----------------------------------------------------------
+
+bool pluginInit(const clap_plugin_t* plugin) {
+    self(plugin)->dsp = tubeamp_create();
+    return self(plugin)->dsp != nullptr;
+}
+
+void pluginDestroy(const clap_plugin_t* plugin) {
+    Plugin* p = self(plugin);
+    tubeamp_destroy(p->dsp);
+    delete p;
+}
+
+bool pluginActivate(const clap_plugin_t* plugin, double sampleRate, uint32_t, uint32_t) {
+    Plugin* p = self(plugin);
+    if (tubeamp_prepare(p->dsp, static_cast<uint32_t>(std::lround(sampleRate)), kChannels) != TUBEAMP_OK) {
+        return false;
+    }
+    tubeamp_set_bypass(p->dsp, p->bypass.load(std::memory_order_relaxed) ? 1 : 0);
+    return true;
+}
+
+void pluginDeactivate(const clap_plugin_t*) {
+}
+
+bool pluginStartProcessing(const clap_plugin_t*) {
+    return true;
+}
+
+void pluginStopProcessing(const clap_plugin_t*) {
+}
+
+void pluginReset(const clap_plugin_t* plugin) {
+    tubeamp_reset(self(plugin)->dsp);
+}
+
+clap_process_status pluginProcess(const clap_plugin_t* plugin, const clap_process_t* process) {
+    Plugin* p = self(plugin);
+    if (process->audio_inputs_count < 1 || process->audio_outputs_count < 1) {
+        return CLAP_PROCESS_ERROR;
+    }
+    const clap_audio_buffer_t& input = process->audio_inputs[0];
+    const clap_audio_buffer_t& output = process->audio_outputs[0];
+    if (!input.data32 || !output.data32 || input.channel_count < kChannels || output.channel_count < kChannels) {
+        return CLAP_PROCESS_ERROR;
+    }
+
+    const uint32_t frames = process->frames_count;
+    const uint32_t eventCount = process->in_events ? process->in_events->size(process->in_events) : 0;
+    uint32_t eventIndex = 0;
+    uint32_t start = 0;
+
+    // Run up to each event's time, apply it, continue; in place when the host shares buffers
+    while (start < frames) {
+        uint32_t end = frames;
+        while (eventIndex < eventCount) {
+            const clap_event_header_t* header = process->in_events->get(process->in_events, eventIndex);
+            if (header->time > start) {
+                end = std::min(header->time, frames);
+                break;
+            }
+            applyEvent(p, header);
+            ++eventIndex;
+        }
+
+        const float* in[kChannels];
+        float* out[kChannels];
+        for (uint32_t ch = 0; ch < kChannels; ++ch) {
+            in[ch] = input.data32[ch] + start;
+            out[ch] = output.data32[ch] + start;
+        }
+        tubeamp_process_planar(p->dsp, in, out, end - start);
+        start = end;
+    }
+
+    // Events stamped at or past the end of the block still take effect
+    for (; eventIndex < eventCount; ++eventIndex) {
+        applyEvent(p, process->in_events->get(process->in_events, eventIndex));
+    }
+    return CLAP_PROCESS_CONTINUE;
+}
+
+// --- clap.audio-ports -----------------------------------------------------
+
+uint32_t audioPortsCount(const clap_plugin_t*, bool) {
+    return 1;
+}
+
+bool audioPortsGet(const clap_plugin_t*, uint32_t index, bool isInput, clap_audio_port_info_t* info) {
+    if (index != 0) {
+        return false;
+    }
+    info->id = 0;
+    std::snprintf(info->name, sizeof(info->name), "%s", isInput ? "Input" : "Output");
+    info->flags = CLAP_AUDIO_PORT_IS_MAIN;
+    info->channel_count = kChannels;
+    info->port_type = CLAP_PORT_STEREO;
+    info->in_place_pair = 0;  // output 0 may alias input 0
+    return true;
+}
+
+const clap_plugin_audio_ports_t kAudioPorts = {audioPortsCount, audioPortsGet};
+
+// --- clap.latency ---------------------------------------------------------
+
+uint32_t latencyGet(const clap_plugin_t*) {
+    return 0;  // IIR processed sample by sample, no lookahead or block delay
+}
+
+const clap_plugin_latency_t kLatency = {latencyGet};
+
+// --- clap.params ----------------------------------------------------------
+
+uint32_t paramsCount(const clap_plugin_t*) {
+    return 1;
+}
+
+bool paramsGetInfo(const clap_plugin_t*, uint32_t index, clap_param_info_t* info) {
+    if (index != 0) {
+        return false;
+    }
+    std::memset(info, 0, sizeof(*info));
+    info->id = kBypassParamId;
+    info->flags = CLAP_PARAM_IS_STEPPED | CLAP_PARAM_IS_AUTOMATABLE | CLAP_PARAM_IS_BYPASS;
+    std::snprintf(info->name, sizeof(info->name), "Bypass");
+    info->min_value = 0.0;
+    info->max_value = 1.0;
+    info->default_value = 0.0;
+    return true;
+}
+
+bool paramsGetValue(const clap_plugin_t* plugin, clap_id id, double* value) {
+    if (id != kBypassParamId) {
+        return false;
+    }
+    *value = self(plugin)->bypass.load(std::memory_order_relaxed) ? 1.0 : 0.0;
+    return true;
+}
+
+bool paramsValueToText(const clap_plugin_t*, clap_id id, double value, char* buffer, uint32_t capacity) {
+    if (id != kBypassParamId || capacity == 0) {
+        return false;
+    }
+    std::snprintf(buffer, capacity, "%s", value >= 0.5 ? "On" : "Off");
+    return true;
+}
+
+bool paramsTextToValue(const clap_plugin_t*, clap_id id, const char* text, double* value) {
+    if (id != kBypassParamId) {
+        return false;
+    }
+    *value = (std::strcmp(text, "On") == 0 || std::strcmp(text, "1") == 0) ? 1.0 : 0.0;
+    return true;
+}
+
+void paramsFlush(const clap_plugin_t* plugin, const clap_input_events_t* in, const clap_output_events_t*) {
+    const uint32_t count = in->size(in);
+    for (uint32_t i = 0; i < count; ++i) {
+        applyEvent(self(plugin), in->get(in, i));
+    }
+}
+
+const clap_plugin_params_t kParams = {
+    paramsCount, paramsGetInfo, paramsGetValue, paramsValueToText, paramsTextToValue, paramsFlush
+};
+
+// --- clap.state -----------------------------------------------------------
+
+bool stateSave(const clap_plugin_t* plugin, const clap_ostream_t* stream) {
+    const uint8_t data[2] = {kStateVersion, static_cast<uint8_t>(self(plugin)->bypass.load() ? 1 : 0)};
+    return stream->write(stream, data, sizeof(data)) == static_cast<int64_t>(sizeof(data));
+}
+
+bool stateLoad(const clap_plugin_t* plugin, const clap_istream_t* stream) {
+    uint8_t data[2] = {0, 0};
+    if (stream->read(stream, data, sizeof(data)) != static_cast<int64_t>(sizeof(data)) || data[0] != kStateVersion) {
+        return false;
+    }
+    setBypass(self(plugin), data[1] != 0);
+    return true;
+}
+
+const clap_plugin_state_t kState = {stateSave, stateLoad};
+
+const void* pluginGetExtension(const clap_plugin_t*, const char* id) {
+    if (std::strcmp(id, CLAP_EXT_AUDIO_PORTS) == 0) return &kAudioPorts;
+    if (std::strcmp(id, CLAP_EXT_LATENCY) == 0) return &kLatency;
+    if (std::strcmp(id, CLAP_EXT_PARAMS) == 0) return &kParams;
+    if (std::strcmp(id, CLAP_EXT_STATE) == 0) return &kState;
+    return nullptr;
+}
+
+void pluginOnMainThread(const clap_plugin_t*) {
+}
+
+// --- factory and entry ----------------------------------------------------
+
+uint32_t factoryGetPluginCount(const clap_plugin_factory_t*) {
+    return 1;
+}
+
+const clap_plugin_descriptor_t* factoryGetPluginDescriptor(const clap_plugin_factory_t*, uint32_t index) {
+    return index == 0 ? &kDescriptor : nullptr;
+}
+
+const clap_plugin_t* factoryCreatePlugin(const clap_plugin_factory_t*, const clap_host_t* host, const char* pluginId) {
+    if (!clap_version_is_compatible(host->clap_version) || std::strcmp(pluginId, kDescriptor.id) != 0) {
+        return nullptr;
+    }
+
+    Plugin* plugin = new Plugin();
+    plugin->host = host;
+    plugin->clap.desc = &kDescriptor;
+    plugin->clap.plugin_data = plugin;
+    plugin->clap.init = pluginInit;
+    plugin->clap.destroy = pluginDestroy;
+    plugin->clap.activate = pluginActivate;
+    plugin->clap.deactivate = pluginDeactivate;
+    plugin->clap.start_processing = pluginStartProcessing;
+    plugin->clap.stop_processing = pluginStopProcessing;
+    plugin->clap.reset = pluginReset;
+    plugin->clap.process = pluginProcess;
+    plugin->clap.get_extension = pluginGetExtension;
+    plugin->clap.on_main_thread = pluginOnMainThread;
+    return &plugin->clap;
+}
+
+const clap_plugin_factory_t kFactory = {
+    factoryGetPluginCount, factoryGetPluginDescriptor, factoryCreatePlugin
+};
+
+bool entryInit(const char*) {
+    tubeamp_set_logging(0);  // nothing on the host's stderr
+    return true;
+}
+
+void entryDeinit() {
+}
+
+const void* entryGetFactory(const char* factoryId) {
+    return std::strcmp(factoryId, CLAP_PLUGIN_FACTORY_ID) == 0 ? &kFactory : nullptr;
+}
+
+} // namespace
+
+extern "C" CLAP_EXPORT const clap_plugin_entry_t clap_entry = {
+    CLAP_VERSION_INIT,
+    entryInit,
+    entryDeinit,
+    entryGetFactory
+};
@@ -0,0 +1,121 @@
+#define TUBEAMP_BUILDING
+#include "tubeamp.h"
+#include "../dsp/DSPProcessor.h"
+#include "../dsp/TubeEmulator.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+struct tubeamp_processor {
+    DSPProcessor dsp;
+    uint32_t channels = 0;  // 0 until prepared
+};
+
+namespace {
+// Interleaved blocks are processed in slices that fit DSPProcessor's stack buffers
+constexpr uint32_t kSliceFrames = 1024;
+}
+
+extern "C" {
+
+uint32_t tubeamp_api_version(void) {
+    return TUBEAMP_API_VERSION;
+}
+
+tubeamp_processor* tubeamp_create(void) {
+    return new (std::nothrow) tubeamp_processor();
+}
+
+void tubeamp_destroy(tubeamp_processor* processor) {
+    delete processor;
+}
+
+tubeamp_status tubeamp_prepare(tubeamp_processor* processor, uint32_t sample_rate, uint32_t channels) {
+    if (!processor || sample_rate == 0) {
+        return TUBEAMP_ERROR_INVALID_ARGUMENT;
+    }
+    if (channels != 1 && channels != 2) {
+        return TUBEAMP_ERROR_UNSUPPORTED_CHANNELS;
+    }
+
+    processor->dsp.setSampleRate(static_cast<int>(sample_rate));
+    processor->dsp.reset();
+    processor->channels = channels;
+    return TUBEAMP_OK;
+}
+
+int tubeamp_is_rate_supported(uint32_t sample_rate) {
+    return TubeEmulator::isRateSupported(static_cast<int>(sample_rate)) ? 1 : 0;
+}
+
+tubeamp_status tubeamp_process_interleaved(tubeamp_processor* processor,
+                                           const float* input, float* output, uint32_t frames) {
+    if (!processor || (frames > 0 && (!input || !output))) {
+        return TUBEAMP_ERROR_INVALID_ARGUMENT;
+    }
+    if (processor->channels == 0) {
+        return TUBEAMP_ERROR_NOT_PREPARED;
+    }
+
+    const uint32_t channels = processor->channels;
+    for (uint32_t offset = 0; offset < frames; offset += kSliceFrames) {
+        const uint32_t slice = std::min(kSliceFrames, frames - offset);
+        float* out = output + static_cast<size_t>(offset) * channels;
+        if (input != output) {
+            std::memcpy(out, input + static_cast<size_t>(offset) * channels,
+                        static_cast<size_t>(slice) * channels * sizeof(float));
+        }
+        processor->dsp.process(out, static_cast<int>(slice), static_cast<int>(channels));
+    }
+    return TUBEAMP_OK;
+}
+
+tubeamp_status tubeamp_process_planar(tubeamp_processor* processor,
+                                      const float* const* input, float* const* output, uint32_t frames) {
+    if (!processor || !input || !output) {
+        return TUBEAMP_ERROR_INVALID_ARGUMENT;
+    }
+    if (processor->channels == 0) {
+        return TUBEAMP_ERROR_NOT_PREPARED;
+    }
+
+    for (uint32_t ch = 0; ch < processor->channels; ++ch) {
+        if (frames > 0 && (!input[ch] || !output[ch])) {
+            return TUBEAMP_ERROR_INVALID_ARGUMENT;
+        }
+        if (input[ch] != output[ch]) {
+            std::memcpy(output[ch], input[ch], static_cast<size_t>(frames) * sizeof(float));
+        }
+    }
+    processor->dsp.processPlanar(output, static_cast<int>(frames), static_cast<int>(processor->channels));
+    return TUBEAMP_OK;
+}
+
+void tubeamp_set_bypass(tubeamp_processor* processor, int bypass) {
+    if (processor) {
+        processor->dsp.setBypass(bypass != 0);
+    }
+}
+
+void tubeamp_reset(tubeamp_processor* processor) {
+    if (processor) {
+        processor->dsp.reset();
+    }
+}
+
+void tubeamp_set_logging(int enabled) {
+    Logger::enableConsoleOutput(enabled != 0);
+}
+
+const char* tubeamp_status_string(tubeamp_status status) {
+    switch (status) {
+    case TUBEAMP_OK: return "ok";
+    case TUBEAMP_ERROR_INVALID_ARGUMENT: return "invalid argument";
+    case TUBEAMP_ERROR_UNSUPPORTED_CHANNELS: return "unsupported channel count";
+    case TUBEAMP_ERROR_NOT_PREPARED: return "processor not prepared";
+    default: return "unknown error";
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,77 @@
+#ifndef TUBEAMP_H
+#define TUBEAMP_H
+
+/**
+ * tubeamp - C interface to the 300B tube DSP core
+ *
+ * Plain C so the processor can be embedded in services, plugins and other
+ * languages without Qt or a C++ ABI. A processor is not thread-safe: call
+ * prepare/reset and process from one thread at a time. tubeamp_process_*
+ * never allocates or logs, so it is safe on a real-time audio thread.
+ */
+
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(TUBEAMP_SHARED)
+#  ifdef TUBEAMP_BUILDING
+#    define TUBEAMP_API __declspec(dllexport)
+#  else
+#    define TUBEAMP_API __declspec(dllimport)
+#  endif
+#elif defined(TUBEAMP_SHARED) && defined(TUBEAMP_BUILDING)
+#  define TUBEAMP_API __attribute__((visibility("default")))
+#else
+#  define TUBEAMP_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change to this header */
+#define TUBEAMP_API_VERSION 1
+
+typedef struct tubeamp_processor tubeamp_processor;
+
+typedef enum tubeamp_status {
+    TUBEAMP_OK = 0,
+    TUBEAMP_ERROR_INVALID_ARGUMENT = -1,
+    TUBEAMP_ERROR_UNSUPPORTED_CHANNELS = -2,
+    TUBEAMP_ERROR_NOT_PREPARED = -3
+} tubeamp_status;
+
+TUBEAMP_API uint32_t tubeamp_api_version(void);
+
+/* Returns NULL on allocation failure */
+TUBEAMP_API tubeamp_processor* tubeamp_create(void);
+TUBEAMP_API void tubeamp_destroy(tubeamp_processor* processor);
+
+/*
+ * Sets the stream format and clears the filter state. channels is 1 or 2.
+ * Rates without measured coefficients use the nearest supported rate;
+ * see tubeamp_is_rate_supported().
+ */
+TUBEAMP_API tubeamp_status tubeamp_prepare(tubeamp_processor* processor, uint32_t sample_rate, uint32_t channels);
+TUBEAMP_API int tubeamp_is_rate_supported(uint32_t sample_rate);
+
+/* Interleaved frames; input may equal output for in-place processing */
+TUBEAMP_API tubeamp_status tubeamp_process_interleaved(tubeamp_processor* processor,
+                                                       const float* input, float* output, uint32_t frames);
+
+/* One buffer per channel; input[ch] may equal output[ch] */
+TUBEAMP_API tubeamp_status tubeamp_process_planar(tubeamp_processor* processor,
+                                                  const float* const* input, float* const* output, uint32_t frames);
+
+TUBEAMP_API void tubeamp_set_bypass(tubeamp_processor* processor, int bypass);
+TUBEAMP_API void tubeamp_reset(tubeamp_processor* processor);
+
+/* Console logging from the core (on by default); affects all processors */
+TUBEAMP_API void tubeamp_set_logging(int enabled);
+
+TUBEAMP_API const char* tubeamp_status_string(tubeamp_status status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TUBEAMP_H */
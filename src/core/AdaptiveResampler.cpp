@@ -0,0 +1,121 @@
+#include "AdaptiveResampler.h"
+#include "AudioBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+// 4-point, 3rd-order Hermite interpolation between x0 and x1
+inline float hermite(float xm1, float x0, float x1, float x2, float t) {
+    const float c1 = 0.5f * (x1 - xm1);
+    const float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+    const float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+    return ((c3 * t + c2) * t + c1) * t + x0;
+}
+} // namespace
+
+AdaptiveResampler::AdaptiveResampler() {
+}
+
+void AdaptiveResampler::prepare(int channels, size_t maxFrames, size_t targetFill) {
+    m_channels = std::max(1, channels);
+    m_targetFill = targetFill;
+
+    // Worst case: every output frame consumes (1 + kMaxCorrection) input frames,
+    // plus the interpolator taps carried over between blocks
+    size_t maxHistory = static_cast<size_t>(std::ceil(maxFrames * (1.0 + kMaxCorrection))) + 8;
+    m_history.assign(maxHistory * m_channels, 0.0f);
+
+    reset();
+}
+
+void AdaptiveResampler::reset() {
+    m_integral = 0.0;
+    m_clockRatio.store(1.0, std::memory_order_relaxed);
+    restartPlayback();
+}
+
+void AdaptiveResampler::restartPlayback() {
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    m_historyFrames = 2;  // x[-1] and x[0] start out silent
+    m_position = 1.0;
+    m_primed.store(false, std::memory_order_release);
+    m_filteredFill = static_cast<double>(m_targetFill);
+
+    // The integrator holds the clock drift, which an underrun does not change;
+    // starting again from the learned ratio avoids drifting into the next one
+    m_ratio = 1.0 + m_integral;
+}
+
+bool AdaptiveResampler::process(AudioBuffer& source, float* output, size_t frames) {
+    const int ch = m_channels;
+    const size_t availableFrames = source.availableRead() / ch;
+
+    // Wait for the ring to reach its target before starting playback
+    if (!m_primed.load(std::memory_order_relaxed)) {
+        std::memset(output, 0, frames * ch * sizeof(float));
+        if (availableFrames >= m_targetFill) {
+            m_primed.store(true, std::memory_order_release);
+        }
+        return true;
+    }
+
+    const double step = m_ratio;
+    const double lastPosition = m_position + static_cast<double>(frames - 1) * step;
+    const size_t neededFrames = static_cast<size_t>(lastPosition) + 3;
+    const size_t toRead = neededFrames > m_historyFrames ? neededFrames - m_historyFrames : 0;
+
+    if (toRead > 0) {
+        if (toRead > availableFrames ||
+            (m_historyFrames + toRead) * ch > m_history.size() ||
+            !source.read(m_history.data() + m_historyFrames * ch, toRead, ch)) {
+            std::memset(output, 0, frames * ch * sizeof(float));
+            m_underruns.fetch_add(1, std::memory_order_relaxed);
+            restartPlayback();
+            return false;
+        }
+        m_historyFrames += toRead;
+    }
+
+    for (size_t i = 0; i < frames; ++i) {
+        const double pos = m_position + static_cast<double>(i) * step;
+        const size_t idx = static_cast<size_t>(pos);
+        const float t = static_cast<float>(pos - static_cast<double>(idx));
+        const float* x = m_history.data() + (idx - 1) * ch;
+        float* out = output + i * ch;
+
+        for (int c = 0; c < ch; ++c) {
+            out[c] = hermite(x[c], x[ch + c], x[2 * ch + c], x[3 * ch + c], t);
+        }
+    }
+
+    // Drop consumed frames, keeping the x[-1] tap for the next block
+    m_position += static_cast<double>(frames) * step;
+    const size_t discard = static_cast<size_t>(m_position) - 1;
+    if (discard > 0) {
+        std::memmove(m_history.data(), m_history.data() + discard * ch,
+                     (m_historyFrames - discard) * ch * sizeof(float));
+        m_historyFrames -= discard;
+        m_position -= static_cast<double>(discard);
+    }
+
+    // Frames still pending = ring contents + unread history ahead of the read head
+    const double pendingFrames = static_cast<double>(source.availableRead() / ch) +
+                                 (static_cast<double>(m_historyFrames) - m_position);
+    updateController(pendingFrames);
+    return true;
+}
+
+void AdaptiveResampler::updateController(double fillFrames) {
+    // Block-granular writes make the raw fill level jumpy; smooth it first
+    m_filteredFill += kFillSmoothing * (fillFrames - m_filteredFill);
+    const double error = m_filteredFill - static_cast<double>(m_targetFill);
+
+    m_integral = std::clamp(m_integral + kIntegralGain * error, -kMaxCorrection, kMaxCorrection);
+    const double correction = std::clamp(kProportionalGain * error + m_integral,
+                                         -kMaxCorrection, kMaxCorrection);
+
+    // Ring filling up means the input clock is faster: consume more per output frame
+    m_ratio = 1.0 + correction;
+    m_clockRatio.store(1.0 + m_integral, std::memory_order_relaxed);
+}
@@ -0,0 +1,68 @@
+#ifndef ADAPTIVERESAMPLER_H
+#define ADAPTIVERESAMPLER_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class AudioBuffer;
+
+/**
+ * AdaptiveResampler - Drift-compensating bridge between two audio clocks
+ *
+ * Pulls interleaved frames out of an AudioBuffer filled by a stream running
+ * on another device clock and resamples them by a ratio very close to 1.0.
+ * A PI controller steers the ratio so the ring fill level stays at its
+ * target, which absorbs the slow drift between capture and playback clocks.
+ *
+ * process() is real-time safe; prepare() allocates and must be called
+ * before the streams start.
+ */
+class AdaptiveResampler {
+public:
+    AdaptiveResampler();
+
+    // Configuration (not real-time safe)
+    void prepare(int channels, size_t maxFrames, size_t targetFill);
+    void reset();
+
+    // Fill 'frames' output frames from the ring (called from the playback thread).
+    // Returns false on underrun; the output is silenced and the resampler re-primes,
+    // keeping the learned clock drift.
+    bool process(AudioBuffer& source, float* output, size_t frames);
+
+    // Estimated input/output clock ratio (1.0 = clocks in sync)
+    double getClockRatio() const { return m_clockRatio.load(std::memory_order_relaxed); }
+    size_t getTargetFill() const { return m_targetFill; }
+    bool isPrimed() const { return m_primed.load(std::memory_order_acquire); }
+    uint64_t getUnderrunCount() const { return m_underruns.load(std::memory_order_relaxed); }
+
+private:
+    void restartPlayback();
+    void updateController(double fillFrames);
+
+    int m_channels = 2;
+    size_t m_targetFill = 0;
+
+    // Interleaved input history; frame 0 is the x[-1] tap of the interpolator
+    std::vector<float> m_history;
+    size_t m_historyFrames = 0;
+    double m_position = 1.0;
+
+    // PI controller state
+    std::atomic<bool> m_primed{false};
+    double m_filteredFill = 0.0;
+    double m_integral = 0.0;
+    double m_ratio = 1.0;
+
+    std::atomic<double> m_clockRatio{1.0};
+    std::atomic<uint64_t> m_underruns{0};
+
+    static constexpr double kFillSmoothing = 0.01;
+    static constexpr double kProportionalGain = 2.0e-6;
+    static constexpr double kIntegralGain = 5.0e-10;
+    static constexpr double kMaxCorrection = 0.005;  // +/- 5000 ppm
+};
+
+#endif // ADAPTIVERESAMPLER_H
@@ -2,68 +2,125 @@
 #include <algorithm>
 #include <cstring>
 
-AudioBuffer::AudioBuffer(size_t capacity)
-    : m_capacity(capacity)
-    , m_buffer(capacity, 0.0f)
-{
+namespace {
+size_t nextPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
 }
+} // namespace
 
-bool AudioBuffer::write(const float* data, size_t frames, int channels) {
-    size_t samplesToWrite = frames * channels;
+AudioBuffer::AudioBuffer(size_t capacity) {
+    resize(capacity);
+}
 
-    if (availableWrite() < samplesToWrite) {
-        return false;
+bool AudioBuffer::write(const float* data, size_t frames, int channels) {
+    const size_t samplesToWrite = frames * channels;
+    const size_t writePos = m_writePos.load(std::memory_order_relaxed);
+
+    if (m_capacity - (writePos - m_cachedReadPos) < samplesToWrite) {
+        m_cachedReadPos = m_readPos.load(std::memory_order_acquire);
+        if (m_capacity - (writePos - m_cachedReadPos) < samplesToWrite) {
+            return false;
+        }
     }
 
-    size_t writePos = m_writePos.load(std::memory_order_relaxed);
-
-    for (size_t i = 0; i < samplesToWrite; ++i) {
-        m_buffer[(writePos + i) % m_capacity] = data[i];
-    }
+    const size_t offset = writePos & m_mask;
+    const size_t first = std::min(samplesToWrite, m_capacity - offset);
+    std::memcpy(m_buffer.data() + offset, data, first * sizeof(float));
+    std::memcpy(m_buffer.data(), data + first, (samplesToWrite - first) * sizeof(float));
 
-    m_writePos.store((writePos + samplesToWrite) % m_capacity, std::memory_order_release);
+    m_writePos.store(writePos + samplesToWrite, std::memory_order_release);
     return true;
 }
 
 bool AudioBuffer::read(float* data, size_t frames, int channels) {
-    size_t samplesToRead = frames * channels;
-
-    if (availableRead() < samplesToRead) {
-        return false;
+    const size_t samplesToRead = frames * channels;
+    const size_t readPos = m_readPos.load(std::memory_order_relaxed);
+
+    if (m_cachedWritePos - readPos < samplesToRead) {
+        m_cachedWritePos = m_writePos.load(std::memory_order_acquire);
+        if (m_cachedWritePos - readPos < samplesToRead) {
+            return false;
+        }
     }
 
-    size_t readPos = m_readPos.load(std::memory_order_relaxed);
+    const size_t offset = readPos & m_mask;
+    const size_t first = std::min(samplesToRead, m_capacity - offset);
+    std::memcpy(data, m_buffer.data() + offset, first * sizeof(float));
+    std::memcpy(data + first, m_buffer.data(), (samplesToRead - first) * sizeof(float));
 
-    for (size_t i = 0; i < samplesToRead; ++i) {
-        data[i] = m_buffer[(readPos + i) % m_capacity];
+    m_readPos.store(readPos + samplesToRead, std::memory_order_release);
+    return true;
+}
+
+AudioBuffer::WriteRegion AudioBuffer::acquireWrite(size_t maxSamples) {
+    const size_t writePos = m_writePos.load(std::memory_order_relaxed);
+    if (m_capacity - (writePos - m_cachedReadPos) < maxSamples) {
+        m_cachedReadPos = m_readPos.load(std::memory_order_acquire);
     }
 
-    m_readPos.store((readPos + samplesToRead) % m_capacity, std::memory_order_release);
-    return true;
+    const size_t samples = std::min(maxSamples, m_capacity - (writePos - m_cachedReadPos));
+    const size_t offset = writePos & m_mask;
+
+    WriteRegion region;
+    region.first = m_buffer.data() + offset;
+    region.firstSize = std::min(samples, m_capacity - offset);
+    region.second = m_buffer.data();
+    region.secondSize = samples - region.firstSize;
+    return region;
 }
 
-size_t AudioBuffer::availableRead() const {
-    size_t writePos = m_writePos.load(std::memory_order_acquire);
-    size_t readPos = m_readPos.load(std::memory_order_relaxed);
+void AudioBuffer::commitWrite(size_t samples) {
+    // Must not exceed the last acquired region
+    const size_t writePos = m_writePos.load(std::memory_order_relaxed);
+    m_writePos.store(writePos + samples, std::memory_order_release);
+}
 
-    if (writePos >= readPos) {
-        return writePos - readPos;
-    } else {
-        return m_capacity - readPos + writePos;
+AudioBuffer::ReadRegion AudioBuffer::acquireRead(size_t maxSamples) {
+    const size_t readPos = m_readPos.load(std::memory_order_relaxed);
+    if (m_cachedWritePos - readPos < maxSamples) {
+        m_cachedWritePos = m_writePos.load(std::memory_order_acquire);
     }
+
+    const size_t samples = std::min(maxSamples, m_cachedWritePos - readPos);
+    const size_t offset = readPos & m_mask;
+
+    ReadRegion region;
+    region.first = m_buffer.data() + offset;
+    region.firstSize = std::min(samples, m_capacity - offset);
+    region.second = m_buffer.data();
+    region.secondSize = samples - region.firstSize;
+    return region;
+}
+
+void AudioBuffer::commitRead(size_t samples) {
+    const size_t readPos = m_readPos.load(std::memory_order_relaxed);
+    m_readPos.store(readPos + samples, std::memory_order_release);
+}
+
+size_t AudioBuffer::availableRead() const {
+    m_cachedWritePos = m_writePos.load(std::memory_order_acquire);
+    return m_cachedWritePos - m_readPos.load(std::memory_order_relaxed);
 }
 
 size_t AudioBuffer::availableWrite() const {
-    return m_capacity - availableRead() - 1;
+    m_cachedReadPos = m_readPos.load(std::memory_order_acquire);
+    return m_capacity - (m_writePos.load(std::memory_order_relaxed) - m_cachedReadPos);
 }
 
 void AudioBuffer::clear() {
+    m_cachedReadPos = 0;
+    m_cachedWritePos = 0;
     m_readPos.store(0, std::memory_order_relaxed);
     m_writePos.store(0, std::memory_order_release);
 }
 
 void AudioBuffer::resize(size_t newCapacity) {
-    m_buffer.resize(newCapacity, 0.0f);
-    m_capacity = newCapacity;
+    m_capacity = nextPowerOfTwo(std::max<size_t>(newCapacity, 1));
+    m_mask = m_capacity - 1;
+    m_buffer.assign(m_capacity, 0.0f);
     clear();
 }
@@ -5,13 +5,54 @@
 #include <atomic>
 #include <cstddef>
 
+/**
+ * AudioBuffer - Single-producer/single-consumer ring of float samples
+ *
+ * Capacity is rounded up to a power of two, and the read/write positions
+ * are free-running counters that are masked into the buffer, so all of the
+ * capacity is usable. Each side keeps its own index on a separate cache
+ * line, next to a cached copy of the other side's index. The other side's
+ * atomic is only reloaded when the cached copy says there is not enough
+ * room or data. Bulk transfers are at most two memcpy calls.
+ *
+ * The write/acquireWrite/commitWrite/availableWrite calls belong to the
+ * producer thread. The read/acquireRead/commitRead/availableRead calls
+ * belong to the consumer thread. clear() and resize() need both sides idle.
+ */
 class AudioBuffer {
 public:
+    // Up to two contiguous spans, in ring order; the second is empty unless the region wraps
+    struct WriteRegion {
+        float* first = nullptr;
+        size_t firstSize = 0;
+        float* second = nullptr;
+        size_t secondSize = 0;
+
+        size_t size() const { return firstSize + secondSize; }
+    };
+
+    struct ReadRegion {
+        const float* first = nullptr;
+        size_t firstSize = 0;
+        const float* second = nullptr;
+        size_t secondSize = 0;
+
+        size_t size() const { return firstSize + secondSize; }
+    };
+
     explicit AudioBuffer(size_t capacity = 65536);
 
+    // All-or-nothing: false (and nothing transferred) if the whole block does not fit
     bool write(const float* data, size_t frames, int channels = 2);
     bool read(float* data, size_t frames, int channels = 2);
 
+    // Zero-copy access: the region covers up to maxSamples samples, fewer if
+    // the ring is fuller/emptier than that. Commit what was actually used.
+    WriteRegion acquireWrite(size_t maxSamples);
+    void commitWrite(size_t samples);
+    ReadRegion acquireRead(size_t maxSamples);
+    void commitRead(size_t samples);
+
     size_t availableRead() const;
     size_t availableWrite() const;
     size_t capacity() const { return m_capacity; }
@@ -20,10 +61,19 @@ public:
     void resize(size_t newCapacity);
 
 private:
+    static constexpr size_t kCacheLine = 64;
+
     std::vector<float> m_buffer;
-    size_t m_capacity;
-    std::atomic<size_t> m_readPos{0};
-    std::atomic<size_t> m_writePos{0};
+    size_t m_capacity = 0;
+    size_t m_mask = 0;
+
+    // Producer line
+    alignas(kCacheLine) std::atomic<size_t> m_writePos{0};
+    mutable size_t m_cachedReadPos = 0;
+
+    // Consumer line
+    alignas(kCacheLine) std::atomic<size_t> m_readPos{0};
+    mutable size_t m_cachedWritePos = 0;
 };
 
 #endif // AUDIOBUFFER_H
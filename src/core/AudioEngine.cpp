@@ -19,7 +19,13 @@ static int getWasapiHostApiIndex() {
 
 AudioEngine::AudioEngine(QObject* parent)
     : QObject(parent)
+    , m_switchTimer(new QTimer(this))
+    , m_latencyTimer(new QTimer(this))
 {
+    m_switchTimer->setInterval(10);
+    connect(m_switchTimer, &QTimer::timeout, this, &AudioEngine::advanceOutputSwitch);
+    m_latencyTimer->setInterval(kLatencyPollMs);
+    connect(m_latencyTimer, &QTimer::timeout, this, &AudioEngine::pollLatencyMeasurement);
 }
 
 AudioEngine::~AudioEngine() {
@@ -230,8 +236,10 @@ bool AudioEngine::setInputDevice(int index) {
 }
 
 bool AudioEngine::setOutputDevice(int index) {
-    if (m_running) {
-        LOG_WARNING("Cannot change output device while stream is running");
+    // JACK routes through its own ports and the null device plays nowhere,
+    // so there is no running output to swap; the index applies to PortAudio starts
+    if (m_running && m_backend != Backend::PortAudio) {
+        LOG_WARNING("Output device switching needs the PortAudio backend");
         return false;
     }
 
@@ -241,12 +249,60 @@ bool AudioEngine::setOutputDevice(int index) {
         return false;
     }
 
+    if (m_running && index != m_outputDeviceIndex) {
+        if (!m_outputPaths.empty()) {
+            return beginOutputSwitch(index);
+        }
+
+        // Full duplex: one stream spans both devices, so it has to be reopened.
+        // The DSP state is not reset by stop()/start().
+        LOG_INFO("Full-duplex stream: restarting to switch output device");
+        stop();
+        m_outputDeviceIndex = index;
+        if (!start()) {
+            LOG_ERROR(QString("Restart on output device [%1] %2 failed").arg(index).arg(info->name));
+            return false;
+        }
+        return true;
+    }
+
     m_outputDeviceIndex = index;
     LOG_INFO(QString("Output device set to [%1]: %2 (%3 channels)")
         .arg(index).arg(info->name).arg(info->maxOutputChannels));
     return true;
 }
 
+bool AudioEngine::addOutputDevice(int index) {
+    if (m_running) {
+        LOG_WARNING("Cannot add output device while stream is running");
+        return false;
+    }
+
+    const PaDeviceInfo* info = Pa_GetDeviceInfo(index);
+    if (!info || info->maxOutputChannels < 1) {
+        LOG_ERROR(QString("Invalid output device index: %1").arg(index));
+        return false;
+    }
+
+    if (index == m_outputDeviceIndex || m_additionalOutputDevices.contains(index)) {
+        return true;
+    }
+
+    m_additionalOutputDevices.append(index);
+    LOG_INFO(QString("Additional output device [%1]: %2 (%3 channels)")
+        .arg(index).arg(info->name).arg(info->maxOutputChannels));
+    return true;
+}
+
+bool AudioEngine::removeOutputDevice(int index) {
+    if (m_running) {
+        LOG_WARNING("Cannot remove output device while stream is running");
+        return false;
+    }
+
+    return m_additionalOutputDevices.removeAll(index) > 0;
+}
+
 int AudioEngine::findVBCableDevice() const {
     if (!m_initialized) {
         return -1;
@@ -289,11 +345,44 @@ bool AudioEngine::start() {
         return true;
     }
 
+    m_latencyProbe.setSampleRate(m_sampleRate);
+    m_levelMeter.prepare(m_sampleRate);
+    m_loudnessMeter.prepare(m_sampleRate);
+    m_spectrumAnalyzer.prepare(m_sampleRate);
+
+    // The virtual device needs no host API
+    if (m_backend == Backend::Null) {
+        if (!startNullDevice()) {
+            return false;
+        }
+        m_running = true;
+        if (isVisualizationEnabled()) {
+            m_spectrumAnalyzer.start();
+        }
+        LOG_INFO(QString("Null device STARTED. Sample rate: %1, Buffer: %2, %3")
+                 .arg(m_sampleRate).arg(m_bufferSize)
+                 .arg(m_nullOptions.paced ? "paced" : "unpaced"));
+        return true;
+    }
+
     if (!m_initialized) {
         LOG_ERROR("AudioEngine not initialized");
         return false;
     }
 
+    if (m_backend == Backend::Jack) {
+        if (!startJack()) {
+            return false;
+        }
+        m_running = true;
+        if (isVisualizationEnabled()) {
+            m_spectrumAnalyzer.start();
+        }
+        LOG_INFO(QString("JACK client STARTED. Sample rate: %1, Period: %2")
+                 .arg(m_sampleRate).arg(m_bufferSize));
+        return true;
+    }
+
     if (m_inputDeviceIndex < 0 || m_outputDeviceIndex < 0) {
         LOG_ERROR("Input or output device not set");
         return false;
@@ -322,12 +411,13 @@ bool AudioEngine::start() {
 
     LOG_INFO(QString("Using %1 input channels, %2 output channels")
         .arg(m_actualInputChannels).arg(m_actualOutputChannels));
+    prepareChannelMatrix();
 
     // Configure input parameters
     PaStreamParameters inputParams;
     inputParams.device = m_inputDeviceIndex;
     inputParams.channelCount = m_actualInputChannels;
-    inputParams.sampleFormat = paFloat32;
+    inputParams.sampleFormat = toPaFormat(m_streamFormat);
     inputParams.suggestedLatency = inputInfo->defaultLowInputLatency;
     inputParams.hostApiSpecificStreamInfo = nullptr;
 
@@ -335,10 +425,18 @@ bool AudioEngine::start() {
     PaStreamParameters outputParams;
     outputParams.device = m_outputDeviceIndex;
     outputParams.channelCount = m_actualOutputChannels;
-    outputParams.sampleFormat = paFloat32;
+    outputParams.sampleFormat = toPaFormat(m_streamFormat);
     outputParams.suggestedLatency = outputInfo->defaultLowOutputLatency;
     outputParams.hostApiSpecificStreamInfo = nullptr;
 
+    if (m_streamFormat != SampleConverter::Format::Float32) {
+        m_nativeInput.assign(static_cast<size_t>(m_bufferSize) * m_actualInputChannels, 0.0f);
+        m_nativeOutput.assign(static_cast<size_t>(m_bufferSize) * m_actualOutputChannels, 0.0f);
+        m_outputDither.reset(static_cast<uint32_t>(m_outputDeviceIndex + 1));
+        LOG_INFO(QString("Streams use %1-bit integer samples, converted in the callback")
+            .arg(SampleConverter::bytesPerSample(m_streamFormat) * 8));
+    }
+
     // Check if format is supported
     PaError err = Pa_IsFormatSupported(&inputParams, &outputParams, m_sampleRate);
     if (err != paFormatIsSupported) {
@@ -346,8 +444,34 @@ bool AudioEngine::start() {
             .arg(Pa_GetErrorText(err)));
     }
 
+    // Fan-out needs the capture side decoupled from every output clock
+    bool separate = (m_streamMode == StreamMode::SeparateStreams) || !m_additionalOutputDevices.isEmpty();
+    if (separate && m_streamMode == StreamMode::FullDuplex) {
+        LOG_INFO("Additional outputs configured, using separate streams");
+    }
+
+    bool opened = separate
+        ? openSeparateStreams(inputParams, outputParams)
+        : openDuplexStream(inputParams, outputParams);
+    if (!opened) {
+        return false;
+    }
+
+    m_running = true;
+    if (isVisualizationEnabled()) {
+        m_spectrumAnalyzer.start();
+    }
+    LOG_INFO(QString("Audio stream STARTED successfully! Sample rate: %1, Buffer: %2, Mode: %3")
+             .arg(m_sampleRate).arg(m_bufferSize)
+             .arg(separate ? "separate streams" : "full duplex"));
+
+    return true;
+}
+
+bool AudioEngine::openDuplexStream(const PaStreamParameters& inputParams,
+                                   const PaStreamParameters& outputParams) {
     // Open stream
-    err = Pa_OpenStream(
+    PaError err = Pa_OpenStream(
         &m_stream,
         &inputParams,
         &outputParams,
@@ -386,31 +510,465 @@ bool AudioEngine::start() {
         return false;
     }
 
-    m_running = true;
-    LOG_INFO(QString("Audio stream STARTED successfully! Sample rate: %1, Buffer: %2")
-             .arg(m_sampleRate).arg(m_bufferSize));
+    return true;
+}
+
+bool AudioEngine::openSeparateStreams(const PaStreamParameters& inputParams,
+                                      const PaStreamParameters& outputParams) {
+    // Capture output is DSP-processed once, at the primary playback channel count
+    m_captureScratch.assign(static_cast<size_t>(m_bufferSize) * m_actualOutputChannels, 0.0f);
+
+    PaError err = Pa_OpenStream(&m_captureStream, &inputParams, nullptr, m_sampleRate,
+                                m_bufferSize, paClipOff | paDitherOff, captureCallback, this);
+    if (err != paNoError) {
+        LOG_ERROR(QString("Failed to open capture stream: %1").arg(Pa_GetErrorText(err)));
+        emit errorOccurred(QString("Failed to open audio stream: %1").arg(Pa_GetErrorText(err)));
+        m_captureStream = nullptr;
+        return false;
+    }
+
+    const PaStreamInfo* captureInfo = Pa_GetStreamInfo(m_captureStream);
+    m_inputLatency = captureInfo ? captureInfo->inputLatency : 0.0;
+
+    // Primary output must open; additional outputs are best effort
+    auto primary = openOutputPath(outputParams.device, outputParams.channelCount,
+                                  outputParams.suggestedLatency);
+    if (!primary) {
+        emit errorOccurred(QString("Failed to open audio stream on output device %1").arg(outputParams.device));
+        closeOutputPaths();
+        Pa_CloseStream(m_captureStream);
+        m_captureStream = nullptr;
+        return false;
+    }
+    m_outputLatency = primary->latency;
+    publishOutputPath(primary.get());
+    m_outputPaths.push_back(std::move(primary));
+
+    for (int deviceIndex : m_additionalOutputDevices) {
+        const PaDeviceInfo* info = Pa_GetDeviceInfo(deviceIndex);
+        if (!info || deviceIndex == outputParams.device) continue;
+
+        int channels = std::max(1, std::min(m_channels, info->maxOutputChannels));
+        auto path = openOutputPath(deviceIndex, channels, info->defaultLowOutputLatency);
+        if (path && publishOutputPath(path.get())) {
+            m_outputPaths.push_back(std::move(path));
+        } else {
+            if (path) {
+                Pa_CloseStream(path->stream);
+            }
+            LOG_WARNING(QString("Skipping additional output [%1] %2").arg(deviceIndex).arg(info->name));
+        }
+    }
+
+    LOG_INFO(QString("Separate streams opened. Input latency: %1ms, Output latency: %2ms, %3 output(s)")
+        .arg(m_inputLatency * 1000.0, 0, 'f', 1)
+        .arg(m_outputLatency * 1000.0, 0, 'f', 1)
+        .arg(m_outputPaths.size()));
+    emit latencyChanged(m_inputLatency * 1000.0, m_outputLatency * 1000.0);
+
+    // Outputs prime on silence until the capture side has filled their rings
+    for (const auto& path : m_outputPaths) {
+        err = Pa_StartStream(path->stream);
+        if (err != paNoError) break;
+    }
+    if (err == paNoError) {
+        err = Pa_StartStream(m_captureStream);
+    }
+    if (err != paNoError) {
+        LOG_ERROR(QString("Failed to start stream: %1").arg(Pa_GetErrorText(err)));
+        closeOutputPaths();
+        Pa_CloseStream(m_captureStream);  // never started: outputs start first
+        m_captureStream = nullptr;
+        emit errorOccurred(QString("Failed to start audio stream: %1").arg(Pa_GetErrorText(err)));
+        return false;
+    }
 
     return true;
 }
 
-void AudioEngine::stop() {
-    if (!m_running || !m_stream) {
-        return;
+bool AudioEngine::startJack() {
+    m_jackClient = std::make_unique<JackClient>();
+    if (!m_jackClient->open("AmpTube300B", m_channels, &AudioEngine::jackProcessCallback,
+                            &AudioEngine::jackNotifyCallback, this)) {
+        LOG_ERROR(QString("Failed to open JACK client: %1").arg(m_jackClient->getError()));
+        emit errorOccurred(QString("Failed to open JACK client: %1").arg(m_jackClient->getError()));
+        m_jackClient.reset();
+        return false;
     }
 
-    LOG_INFO("Stopping audio stream...");
+    // The server owns the clock: follow its rate and period instead of ours
+    m_actualInputChannels = m_jackClient->getChannels();
+    m_actualOutputChannels = m_jackClient->getChannels();
+    m_bufferSize = static_cast<int>(m_jackClient->getBufferSize());
+    if (m_jackClient->getSampleRate() != m_sampleRate) {
+        LOG_INFO(QString("Following JACK sample rate: %1 Hz").arg(m_jackClient->getSampleRate()));
+        m_sampleRate = m_jackClient->getSampleRate();
+    }
+    if (m_dspProcessor) {
+        m_dspProcessor->setSampleRate(m_sampleRate);
+    }
+
+    if (!m_additionalOutputDevices.isEmpty()) {
+        LOG_WARNING("Additional output devices are ignored with JACK; route them in the JACK graph");
+    }
+
+    if (!m_jackClient->activate(true)) {
+        LOG_ERROR(QString("Failed to start JACK client: %1").arg(m_jackClient->getError()));
+        emit errorOccurred(QString("Failed to start JACK client: %1").arg(m_jackClient->getError()));
+        m_jackClient.reset();
+        return false;
+    }
+
+    m_inputLatency = m_jackClient->getInputLatency();
+    m_outputLatency = m_jackClient->getOutputLatency();
+    LOG_INFO(QString("JACK port latency - Input: %1 ms, Output: %2 ms")
+             .arg(m_inputLatency * 1000.0, 0, 'f', 2)
+             .arg(m_outputLatency * 1000.0, 0, 'f', 2));
+    emit latencyChanged(getInputLatency(), getOutputLatency());
+    return true;
+}
+
+bool AudioEngine::startNullDevice() {
+    m_actualInputChannels = m_channels;
+    m_actualOutputChannels = m_channels;
+    prepareChannelMatrix();
+
+    NullDeviceOptions options = m_nullOptions;
+    if (options.blockFrames <= 0) {
+        options.blockFrames = m_bufferSize;
+    }
+
+    m_nullDevice = std::make_unique<NullAudioDevice>();
+    if (!m_nullDevice->open(options, m_sampleRate, m_actualInputChannels, m_actualOutputChannels,
+                            &AudioEngine::audioCallback, this)) {
+        const QString error = QString::fromStdString(m_nullDevice->getError());
+        LOG_ERROR(QString("Failed to open null device: %1").arg(error));
+        emit errorOccurred(QString("Failed to open null device: %1").arg(error));
+        m_nullDevice.reset();
+        return false;
+    }
+
+    // A finished run leaves the engine stopped, as if stop() had been called
+    NullAudioDevice* device = m_nullDevice.get();
+    m_nullDevice->setFinishedHandler([this, device]() {
+        QMetaObject::invokeMethod(this, [this, device]() {
+            if (m_nullDevice.get() != device) {
+                return;  // restarted since; this run was already stopped
+            }
+            stop();
+            emit streamFinished();
+        }, Qt::QueuedConnection);
+    });
+
+    // Nominal figures: one block in, one block out
+    m_inputLatency = double(options.blockFrames) / m_sampleRate;
+    m_outputLatency = double(options.blockFrames) / m_sampleRate;
+    emit latencyChanged(getInputLatency(), getOutputLatency());
+
+    return m_nullDevice->start();
+}
+
+void AudioEngine::handleJackEvent(JackClient::Event event) {
+    if (m_backend != Backend::Jack || !m_jackClient) {
+        return;  // queued from a client that has since been closed
+    }
+
+    switch (event) {
+    case JackClient::Event::BufferSizeChanged:
+        m_bufferSize = static_cast<int>(m_jackClient->getBufferSize());
+        LOG_INFO(QString("JACK period changed: %1 frames").arg(m_bufferSize));
+        break;
+
+    case JackClient::Event::LatencyChanged:
+        m_inputLatency = m_jackClient->getInputLatency();
+        m_outputLatency = m_jackClient->getOutputLatency();
+        emit latencyChanged(getInputLatency(), getOutputLatency());
+        break;
+
+    case JackClient::Event::SampleRateChanged:
+        // Filter coefficients depend on the rate; restart rather than swap them under the process thread
+        LOG_INFO(QString("JACK sample rate changed to %1 Hz, restarting").arg(m_jackClient->getSampleRate()));
+        stop();
+        start();
+        break;
+
+    case JackClient::Event::Shutdown:
+        LOG_ERROR("JACK server shut down");
+        stop();
+        emit errorOccurred("JACK server shut down");
+        break;
+    }
+}
+
+std::unique_ptr<AudioEngine::OutputPath> AudioEngine::openOutputPath(int deviceIndex, int channels,
+                                                                     double suggestedLatency) {
+    const size_t targetFill = static_cast<size_t>(m_bufferSize) * 2;
+
+    auto path = std::make_unique<OutputPath>();
+    path->engine = this;
+    path->deviceIndex = deviceIndex;
+    path->channels = channels;
+    path->ring.resize((targetFill * 4 + m_bufferSize * 4) * m_actualOutputChannels);
+    path->resampler.prepare(m_actualOutputChannels, m_bufferSize, targetFill);
+    path->scratch.assign(static_cast<size_t>(m_bufferSize) * m_actualOutputChannels, 0.0f);
+    if (m_streamFormat != SampleConverter::Format::Float32) {
+        path->native.assign(static_cast<size_t>(m_bufferSize) * channels, 0.0f);
+        path->dither.reset(static_cast<uint32_t>(deviceIndex + 1));
+    }
+
+    PaStreamParameters params;
+    params.device = deviceIndex;
+    params.channelCount = channels;
+    params.sampleFormat = toPaFormat(m_streamFormat);
+    params.suggestedLatency = suggestedLatency;
+    params.hostApiSpecificStreamInfo = nullptr;
 
-    PaError err = Pa_StopStream(m_stream);
+    PaError err = Pa_OpenStream(&path->stream, nullptr, &params, m_sampleRate,
+                                m_bufferSize, paClipOff | paDitherOff, playbackCallback, path.get());
+    if (err != paNoError) {
+        LOG_ERROR(QString("Failed to open playback stream on device %1: %2")
+            .arg(deviceIndex).arg(Pa_GetErrorText(err)));
+        return nullptr;
+    }
+
+    // The resampler ring adds its target fill on top of the device latency
+    const PaStreamInfo* info = Pa_GetStreamInfo(path->stream);
+    path->latency = (info ? info->outputLatency : 0.0) +
+                    static_cast<double>(targetFill) / m_sampleRate;
+
+    LOG_INFO(QString("Output [%1] opened: %2ch, latency %3ms (ring target %4 frames)")
+        .arg(deviceIndex).arg(channels)
+        .arg(path->latency * 1000.0, 0, 'f', 1)
+        .arg(targetFill));
+    return path;
+}
+
+void AudioEngine::closeOutputPaths() {
+    m_switchTimer->stop();
+    m_incomingPath = nullptr;
+    m_outgoingPath = nullptr;
+    m_outgoingUnpublished = false;
+
+    // Capture is already stopped here, so the slots can be cleared directly
+    for (auto& slot : m_activePaths) {
+        slot.store(nullptr, std::memory_order_release);
+    }
+
+    for (const auto& path : m_outputPaths) {
+        closeOutputStream(*path);
+    }
+    m_outputPaths.clear();
+    m_retiredPaths.clear();
+}
+
+void AudioEngine::closeOutputStream(OutputPath& path) {
+    if (!path.stream) {
+        return;
+    }
+
+    PaError err = Pa_StopStream(path.stream);
     if (err != paNoError) {
         LOG_WARNING(QString("Error stopping stream: %1").arg(Pa_GetErrorText(err)));
     }
 
-    err = Pa_CloseStream(m_stream);
+    err = Pa_CloseStream(path.stream);
     if (err != paNoError) {
         LOG_WARNING(QString("Error closing stream: %1").arg(Pa_GetErrorText(err)));
     }
+    path.stream = nullptr;
+
+    double ratio = path.resampler.getClockRatio();
+    LOG_INFO(QString("Output [%1] drift compensation: clock ratio %2 (%3 ppm), %4 underruns, %5 overruns")
+        .arg(path.deviceIndex)
+        .arg(ratio, 0, 'f', 6)
+        .arg((ratio - 1.0) * 1.0e6, 0, 'f', 1)
+        .arg(path.resampler.getUnderrunCount())
+        .arg(path.overruns));
+}
+
+bool AudioEngine::publishOutputPath(OutputPath* path) {
+    for (auto& slot : m_activePaths) {
+        if (!slot.load(std::memory_order_relaxed)) {
+            slot.store(path, std::memory_order_release);
+            return true;
+        }
+    }
+    LOG_WARNING(QString("Too many outputs, at most %1 are supported").arg(kMaxOutputPaths));
+    return false;
+}
+
+quint64 AudioEngine::unpublishOutputPath(OutputPath* path) {
+    for (auto& slot : m_activePaths) {
+        if (slot.load(std::memory_order_relaxed) == path) {
+            slot.store(nullptr, std::memory_order_release);
+        }
+    }
+
+    // A capture callback that loaded the pointer before the store is done once the generation moves
+    return m_captureGeneration.load(std::memory_order_acquire);
+}
+
+bool AudioEngine::beginOutputSwitch(int index) {
+    if (m_incomingPath) {
+        LOG_WARNING("Output switch already in progress");
+        return false;
+    }
+
+    const PaDeviceInfo* info = Pa_GetDeviceInfo(index);
+    int channels = std::max(1, std::min(m_channels, info->maxOutputChannels));
+
+    // Failures leave the current output playing, so they are returned, not emitted as errors
+    auto path = openOutputPath(index, channels, info->defaultLowOutputLatency);
+    if (!path) {
+        return false;
+    }
+
+    // Pre-roll silently; the crossfade starts once the new ring has primed
+    path->gain = 0.0f;
+    path->targetGain.store(0.0f, std::memory_order_relaxed);
+
+    // Start before publishing: the stream plays silence until the capture side
+    // feeds it, and a failure here needs no handshake with the capture callback
+    PaError err = Pa_StartStream(path->stream);
+    if (err != paNoError) {
+        LOG_ERROR(QString("Failed to start stream: %1").arg(Pa_GetErrorText(err)));
+        Pa_CloseStream(path->stream);
+        return false;
+    }
+    if (!publishOutputPath(path.get())) {
+        closeOutputStream(*path);
+        return false;
+    }
+
+    m_incomingPath = path.get();
+    m_outgoingPath = m_outputPaths.empty() ? nullptr : m_outputPaths.front().get();
+    m_outputPaths.push_back(std::move(path));
+    m_switchClock.start();
+    m_switchTimer->start();
+
+    LOG_INFO(QString("Switching output to [%1] %2, pre-rolling").arg(index).arg(info->name));
+    return true;
+}
+
+void AudioEngine::advanceOutputSwitch() {
+    if (!m_incomingPath) {
+        m_switchTimer->stop();
+        return;
+    }
+
+    // Every stage waits on a callback: priming and the generation on capture,
+    // silence on the outgoing playback. When one of them stalls (capture
+    // device gone, old output unplugged) the switch is finished in one go
+    const bool forced = m_switchClock.hasExpired(kSwitchTimeoutMs);
+    if (forced) {
+        LOG_WARNING(QString("Output switch stalled for %1 ms, completing it without crossfade")
+                    .arg(m_switchClock.elapsed()));
+    }
+
+    // Stage 1: pre-roll until the incoming resampler has primed, then crossfade
+    if (m_incomingPath->targetGain.load(std::memory_order_relaxed) == 0.0f) {
+        if (!m_incomingPath->resampler.isPrimed() && !forced) {
+            return;
+        }
+        m_incomingPath->targetGain.store(1.0f, std::memory_order_relaxed);
+        if (m_outgoingPath) {
+            m_outgoingPath->targetGain.store(0.0f, std::memory_order_relaxed);
+        }
+        if (!forced) {
+            LOG_INFO("Output pre-rolled, crossfading");
+            return;
+        }
+    }
+
+    // Stage 2: wait for the outgoing output to fade to silence, then unpublish it
+    if (m_outgoingPath) {
+        if (!m_outgoingUnpublished) {
+            if (!m_outgoingPath->silent.load(std::memory_order_acquire) && !forced) {
+                return;
+            }
+            m_outgoingGeneration = unpublishOutputPath(m_outgoingPath);
+            m_outgoingUnpublished = true;
+            if (!forced) {
+                return;
+            }
+        }
+
+        // Stage 3: free it once a capture callback has run past the unpublish.
+        // A forced switch cannot tell a stalled callback from an idle one, so
+        // the path is closed but kept allocated until stop()
+        const bool released = m_captureGeneration.load(std::memory_order_acquire) != m_outgoingGeneration;
+        if (!released && !forced) {
+            return;
+        }
+        closeOutputStream(*m_outgoingPath);
+        auto outgoing = std::find_if(m_outputPaths.begin(), m_outputPaths.end(),
+                                     [this](const auto& path) { return path.get() == m_outgoingPath; });
+        if (!released) {
+            m_retiredPaths.push_back(std::move(*outgoing));
+        }
+        m_outputPaths.erase(outgoing);
+    }
+
+    // The incoming output becomes the primary one
+    auto it = std::find_if(m_outputPaths.begin(), m_outputPaths.end(),
+                           [this](const auto& path) { return path.get() == m_incomingPath; });
+    std::rotate(m_outputPaths.begin(), it, it + 1);
+
+    m_outputDeviceIndex = m_incomingPath->deviceIndex;
+    m_outputLatency = m_incomingPath->latency;
+    m_incomingPath = nullptr;
+    m_outgoingPath = nullptr;
+    m_outgoingUnpublished = false;
+    m_switchTimer->stop();
+
+    LOG_INFO(QString("Output switched to device %1").arg(m_outputDeviceIndex));
+    emit latencyChanged(m_inputLatency * 1000.0, m_outputLatency * 1000.0);
+}
+
+void AudioEngine::stop() {
+    if (!m_running) {
+        return;
+    }
+
+    LOG_INFO("Stopping audio stream...");
+    cancelLatencyMeasurement();
+
+    if (m_jackClient) {
+        m_jackClient->close();
+        m_jackClient.reset();
+    }
+    if (m_nullDevice) {
+        m_nullDevice->stop();
+    }
+
+    // Stop capture before playback so the rings are not refilled behind us
+    for (PaStream** stream : {&m_stream, &m_captureStream}) {
+        if (!*stream) continue;
+
+        PaError err = Pa_StopStream(*stream);
+        if (err != paNoError) {
+            LOG_WARNING(QString("Error stopping stream: %1").arg(Pa_GetErrorText(err)));
+        }
+
+        err = Pa_CloseStream(*stream);
+        if (err != paNoError) {
+            LOG_WARNING(QString("Error closing stream: %1").arg(Pa_GetErrorText(err)));
+        }
+
+        *stream = nullptr;
+    }
+
+    closeOutputPaths();
+    m_spectrumAnalyzer.stop();
+
+    const LoudnessReading loudness = m_loudnessMeter.read();
+    if (std::isfinite(loudness.integrated)) {
+        LOG_INFO(QString("Session loudness: %1 LUFS integrated, LRA %2 LU, max short-term %3 LUFS")
+                 .arg(loudness.integrated, 0, 'f', 1)
+                 .arg(loudness.range, 0, 'f', 1)
+                 .arg(loudness.maxShortTerm, 0, 'f', 1));
+    }
 
-    m_stream = nullptr;
     m_running = false;
     LOG_INFO("Audio stream stopped");
 }
@@ -445,6 +1003,92 @@ void AudioEngine::setChannels(int channels) {
     m_channels = std::clamp(channels, 1, 2);
 }
 
+void AudioEngine::setStreamMode(StreamMode mode) {
+    if (m_running) {
+        LOG_WARNING("Cannot change stream mode while stream is running");
+        return;
+    }
+    m_streamMode = mode;
+    LOG_INFO(QString("Stream mode set to: %1")
+        .arg(mode == StreamMode::SeparateStreams ? "separate streams" : "full duplex"));
+}
+
+void AudioEngine::setStreamFormat(SampleConverter::Format format) {
+    if (m_running) {
+        LOG_WARNING("Cannot change stream sample format while stream is running");
+        return;
+    }
+    m_streamFormat = format;
+    LOG_INFO(QString("Stream sample format set to: %1")
+        .arg(format == SampleConverter::Format::Float32
+             ? QString("float32") : QString("int%1").arg(SampleConverter::bytesPerSample(format) * 8)));
+}
+
+void AudioEngine::setChannelMatrix(const ChannelMatrix& matrix) {
+    if (m_running) {
+        LOG_WARNING("Cannot change channel matrix while stream is running");
+        return;
+    }
+    m_userMatrix = matrix;
+    m_hasUserMatrix = true;
+    LOG_INFO(QString("Channel matrix set: %1 in, %2 out")
+        .arg(matrix.getInputChannels()).arg(matrix.getOutputChannels()));
+}
+
+void AudioEngine::resetChannelMatrix() {
+    if (m_running) {
+        LOG_WARNING("Cannot change channel matrix while stream is running");
+        return;
+    }
+    m_hasUserMatrix = false;
+    LOG_INFO("Channel matrix reset to the default mix");
+}
+
+void AudioEngine::prepareChannelMatrix() {
+    if (m_hasUserMatrix &&
+        m_userMatrix.getInputChannels() == m_actualInputChannels &&
+        m_userMatrix.getOutputChannels() == m_actualOutputChannels) {
+        m_channelMatrix = m_userMatrix;
+        return;
+    }
+    if (m_hasUserMatrix) {
+        LOG_WARNING(QString("Channel matrix is %1 in, %2 out but the streams have %3 and %4; using the default mix")
+            .arg(m_userMatrix.getInputChannels()).arg(m_userMatrix.getOutputChannels())
+            .arg(m_actualInputChannels).arg(m_actualOutputChannels));
+    }
+    m_channelMatrix.setDefault(m_actualInputChannels, m_actualOutputChannels);
+}
+
+void AudioEngine::setBackend(Backend backend) {
+    if (m_running) {
+        LOG_WARNING("Cannot change audio backend while stream is running");
+        return;
+    }
+    if (!isBackendAvailable(backend)) {
+        LOG_WARNING("JACK backend requested but this build has no JACK support");
+        return;
+    }
+    m_backend = backend;
+    LOG_INFO(QString("Audio backend set to: %1")
+        .arg(backend == Backend::Jack ? "JACK" : backend == Backend::Null ? "null device" : "PortAudio"));
+}
+
+bool AudioEngine::isBackendAvailable(Backend backend) {
+    return backend != Backend::Jack || JackClient::isAvailable();
+}
+
+void AudioEngine::setNullDeviceOptions(const NullDeviceOptions& options) {
+    if (m_running) {
+        LOG_WARNING("Cannot change null device options while stream is running");
+        return;
+    }
+    m_nullOptions = options;
+}
+
+NullDeviceStats AudioEngine::getNullDeviceStats() const {
+    return m_nullDevice ? m_nullDevice->getStats() : NullDeviceStats();
+}
+
 void AudioEngine::setDSPProcessor(DSPProcessor* processor) {
     m_dspProcessor = processor;
     if (m_dspProcessor) {
@@ -464,12 +1108,113 @@ double AudioEngine::getTotalLatency() const {
     return (m_inputLatency + m_outputLatency) * 1000.0;
 }
 
+bool AudioEngine::startLatencyMeasurement(const LatencyProbeOptions& options) {
+    if (!m_running) {
+        LOG_WARNING("Latency measurement needs a running stream");
+        return false;
+    }
+    if (m_latencyProbe.isActive()) {
+        return false;
+    }
+    if (!m_latencyProbe.start(options)) {
+        return false;
+    }
+
+    // Bursts plus their search windows, then two seconds of slack for a stalled stream
+    const double captureSeconds = options.repetitions * (double((1 << options.mlsOrder) - 1) / m_sampleRate
+                                                         + options.maxLatencySeconds);
+    m_latencyPollsLeft = static_cast<int>((captureSeconds + 2.0) * 1000.0 / kLatencyPollMs);
+    m_latencyTimer->start();
+
+    LOG_INFO(QString("Latency measurement started: %1 MLS bursts of %2 frames")
+             .arg(options.repetitions).arg((1 << options.mlsOrder) - 1));
+    return true;
+}
+
+void AudioEngine::cancelLatencyMeasurement() {
+    m_latencyTimer->stop();
+    m_latencyProbe.cancel();
+}
+
+void AudioEngine::pollLatencyMeasurement() {
+    if (m_latencyProbe.getState() == LatencyProbe::Running) {
+        if (--m_latencyPollsLeft > 0) {
+            return;
+        }
+        cancelLatencyMeasurement();
+        m_lastLatencyMeasurement = LatencyMeasurement();
+        m_lastLatencyMeasurement.error = "Latency measurement timed out (stream stalled?)";
+        LOG_WARNING(QString::fromStdString(m_lastLatencyMeasurement.error));
+        emit latencyMeasured(m_lastLatencyMeasurement);
+        return;
+    }
+    m_latencyTimer->stop();
+
+    // Run the bursts through a fresh DSP to split its delay from the device loop
+    const bool dspInLoop = m_dspProcessor && !m_dspProcessor->isBypassed();
+    DSPProcessor dsp;
+    dsp.setSampleRate(m_sampleRate);
+    std::function<void(float*, int)> processor;
+    if (dspInLoop) {
+        processor = [&dsp](float* buffer, int frames) { dsp.process(buffer, frames, 1); };
+    }
+
+    m_lastLatencyMeasurement = m_latencyProbe.analyze(processor);
+    m_latencyProbe.cancel();
+
+    const LatencyMeasurement& result = m_lastLatencyMeasurement;
+    if (result.valid) {
+        LOG_INFO(QString("Measured round trip %1 ms (range %2-%3, DSP %4 ms, %5 dB); driver reports %6 ms")
+                 .arg(result.roundTripMs, 0, 'f', 2)
+                 .arg(result.minRoundTripMs, 0, 'f', 2)
+                 .arg(result.maxRoundTripMs, 0, 'f', 2)
+                 .arg(result.dspLatencyMs, 0, 'f', 3)
+                 .arg(result.peakToNoiseDb, 0, 'f', 1)
+                 .arg(getTotalLatency(), 0, 'f', 2));
+    } else {
+        LOG_WARNING(QString("Latency measurement failed: %1").arg(QString::fromStdString(result.error)));
+    }
+    emit latencyMeasured(result);
+}
+
+double AudioEngine::getClockRatio() const {
+    if (m_outputPaths.empty()) {
+        return 1.0;
+    }
+    return m_outputPaths.front()->resampler.getClockRatio();
+}
+
+QVector<OutputStreamStatus> AudioEngine::getOutputStatus() const {
+    QVector<OutputStreamStatus> status;
+    for (const auto& path : m_outputPaths) {
+        OutputStreamStatus entry;
+        entry.deviceIndex = path->deviceIndex;
+        entry.channels = path->channels;
+        entry.latencyMs = (m_inputLatency + path->latency) * 1000.0;
+        entry.clockRatio = path->resampler.getClockRatio();
+        entry.underruns = path->resampler.getUnderrunCount();
+        entry.overruns = path->overruns;
+        status.append(entry);
+    }
+    return status;
+}
+
 int AudioEngine::audioCallback(const void* inputBuffer, void* outputBuffer,
                                unsigned long framesPerBuffer,
                                const PaStreamCallbackTimeInfo* timeInfo,
                                PaStreamCallbackFlags statusFlags,
                                void* userData) {
     AudioEngine* engine = static_cast<AudioEngine*>(userData);
+    if (timeInfo) {
+        engine->m_latencyProbe.recordTiming(timeInfo->currentTime, timeInfo->inputBufferAdcTime,
+                                            timeInfo->outputBufferDacTime, framesPerBuffer);
+    }
+    // The null device shares this callback but always delivers float; only a
+    // PortAudio stream was opened in m_streamFormat with native buffers sized
+    if (engine->m_backend == Backend::PortAudio &&
+        engine->m_streamFormat != SampleConverter::Format::Float32) {
+        return engine->processNativeDuplex(inputBuffer, outputBuffer, framesPerBuffer, timeInfo, statusFlags);
+    }
     return engine->processAudio(
         static_cast<const float*>(inputBuffer),
         static_cast<float*>(outputBuffer),
@@ -479,6 +1224,207 @@ int AudioEngine::audioCallback(const void* inputBuffer, void* outputBuffer,
     );
 }
 
+int AudioEngine::captureCallback(const void* inputBuffer, void* outputBuffer,
+                                 unsigned long framesPerBuffer,
+                                 const PaStreamCallbackTimeInfo* timeInfo,
+                                 PaStreamCallbackFlags statusFlags,
+                                 void* userData) {
+    (void)outputBuffer;
+    AudioEngine* engine = static_cast<AudioEngine*>(userData);
+    if (timeInfo) {
+        // Input-only stream: no DAC time, so only arrival jitter is tracked
+        engine->m_latencyProbe.recordTiming(timeInfo->currentTime, timeInfo->inputBufferAdcTime,
+                                            timeInfo->outputBufferDacTime, framesPerBuffer);
+    }
+    if (engine->m_streamFormat != SampleConverter::Format::Float32) {
+        return engine->processNativeCapture(inputBuffer, framesPerBuffer, timeInfo, statusFlags);
+    }
+    return engine->processCapture(
+        static_cast<const float*>(inputBuffer),
+        framesPerBuffer,
+        timeInfo,
+        statusFlags
+    );
+}
+
+int AudioEngine::playbackCallback(const void* inputBuffer, void* outputBuffer,
+                                  unsigned long framesPerBuffer,
+                                  const PaStreamCallbackTimeInfo* timeInfo,
+                                  PaStreamCallbackFlags statusFlags,
+                                  void* userData) {
+    (void)inputBuffer;
+    (void)timeInfo;
+    (void)statusFlags;
+    OutputPath* path = static_cast<OutputPath*>(userData);
+    if (path->engine->m_streamFormat != SampleConverter::Format::Float32) {
+        return path->engine->processNativePlayback(*path, outputBuffer, framesPerBuffer);
+    }
+    return path->engine->processPlayback(*path, static_cast<float*>(outputBuffer), framesPerBuffer);
+}
+
+void AudioEngine::jackProcessCallback(const float* const* inputs, float* const* outputs,
+                                      uint32_t frames, bool xrun, void* userData) {
+    AudioEngine* engine = static_cast<AudioEngine*>(userData);
+    engine->processPlanar(inputs, outputs, frames, xrun);
+}
+
+void AudioEngine::jackNotifyCallback(JackClient::Event event, void* userData) {
+    // Called on a JACK thread; handle it on the engine's thread
+    AudioEngine* engine = static_cast<AudioEngine*>(userData);
+    QMetaObject::invokeMethod(engine, [engine, event]() {
+        engine->handleJackEvent(event);
+    }, Qt::QueuedConnection);
+}
+
+int AudioEngine::processCapture(const float* input, unsigned long frames,
+                                const PaStreamCallbackTimeInfo* timeInfo,
+                                PaStreamCallbackFlags statusFlags) {
+    if (!fitsCallbackBuffer(frames, m_captureScratch.size() / m_actualOutputChannels)) {
+        return paContinue;  // the output rings run dry and the playback side recovers
+    }
+
+    processAudio(input, m_captureScratch.data(), frames, timeInfo, statusFlags);
+
+    // Fan the processed block out to every output ring
+    for (auto& slot : m_activePaths) {
+        OutputPath* path = slot.load(std::memory_order_acquire);
+        if (path && !path->ring.write(m_captureScratch.data(), frames, m_actualOutputChannels)) {
+            ++path->overruns;
+        }
+    }
+
+    m_captureGeneration.fetch_add(1, std::memory_order_release);
+    return paContinue;
+}
+
+int AudioEngine::processPlayback(OutputPath& path, float* output, unsigned long frames) {
+    if (!output) {
+        return paContinue;
+    }
+
+    // Same layout as the capture side: resample straight into the device buffer
+    if (path.channels == m_actualOutputChannels) {
+        if (!path.resampler.process(path.ring, output, frames)) {
+            LOG_DEBUG("Playback ring underrun");
+        }
+        applyOutputGain(path, output, frames);
+        return paContinue;
+    }
+
+    if (!fitsCallbackBuffer(frames, path.scratch.size() / m_actualOutputChannels)) {
+        std::memset(output, 0, frames * path.channels * sizeof(float));
+        return paContinue;
+    }
+    if (!path.resampler.process(path.ring, path.scratch.data(), frames)) {
+        LOG_DEBUG("Playback ring underrun");
+    }
+    convertChannels(path.scratch.data(), m_actualOutputChannels, output, path.channels, frames);
+
+    applyOutputGain(path, output, frames);
+    return paContinue;
+}
+
+int AudioEngine::processNativeDuplex(const void* input, void* output, unsigned long frames,
+                                     const PaStreamCallbackTimeInfo* timeInfo,
+                                     PaStreamCallbackFlags statusFlags) {
+    const size_t bytes = SampleConverter::bytesPerSample(m_streamFormat);
+    if (!fitsCallbackBuffer(frames, m_nativeOutput.size() / m_actualOutputChannels)) {
+        if (output) {
+            std::memset(output, 0, frames * m_actualOutputChannels * bytes);
+        }
+        return paContinue;
+    }
+
+    // Through an identity matrix the input converts straight into the output scratch
+    float* staged = m_channelMatrix.isIdentity() ? m_nativeOutput.data() : m_nativeInput.data();
+    if (input) {
+        SampleConverter::toFloat(static_cast<const uint8_t*>(input), m_streamFormat,
+                                 staged, frames * m_actualInputChannels);
+    }
+
+    processAudio(input ? staged : nullptr, m_nativeOutput.data(), frames, timeInfo, statusFlags);
+
+    if (output) {
+        SampleConverter::fromFloat(m_nativeOutput.data(), static_cast<uint8_t*>(output), m_streamFormat,
+                                   frames * m_actualOutputChannels, &m_outputDither);
+    }
+    return paContinue;
+}
+
+int AudioEngine::processNativeCapture(const void* input, unsigned long frames,
+                                      const PaStreamCallbackTimeInfo* timeInfo,
+                                      PaStreamCallbackFlags statusFlags) {
+    if (!input) {
+        return processCapture(nullptr, frames, timeInfo, statusFlags);
+    }
+    if (!fitsCallbackBuffer(frames, m_nativeInput.size() / m_actualInputChannels)) {
+        return paContinue;
+    }
+
+    SampleConverter::toFloat(static_cast<const uint8_t*>(input), m_streamFormat,
+                             m_nativeInput.data(), frames * m_actualInputChannels);
+    return processCapture(m_nativeInput.data(), frames, timeInfo, statusFlags);
+}
+
+int AudioEngine::processNativePlayback(OutputPath& path, void* output, unsigned long frames) {
+    if (!output) {
+        return paContinue;
+    }
+
+    const size_t bytes = SampleConverter::bytesPerSample(m_streamFormat);
+    if (!fitsCallbackBuffer(frames, path.native.size() / path.channels)) {
+        std::memset(output, 0, frames * path.channels * bytes);
+        return paContinue;
+    }
+
+    processPlayback(path, path.native.data(), frames);
+    SampleConverter::fromFloat(path.native.data(), static_cast<uint8_t*>(output), m_streamFormat,
+                               frames * path.channels, &path.dither);
+    return paContinue;
+}
+
+bool AudioEngine::fitsCallbackBuffer(unsigned long frames, size_t capacityFrames) {
+    // Streams open with framesPerBuffer = m_bufferSize, which PortAudio always
+    // delivers, and the callback buffers hold that many frames
+    if (frames <= capacityFrames) {
+        return true;
+    }
+    LOG_DEBUG("Callback larger than the stream buffer size; block dropped");
+    return false;
+}
+
+PaSampleFormat AudioEngine::toPaFormat(SampleConverter::Format format) {
+    switch (format) {
+    case SampleConverter::Format::Int16: return paInt16;
+    case SampleConverter::Format::Int24: return paInt24;
+    case SampleConverter::Format::Int32: return paInt32;
+    case SampleConverter::Format::Float32:
+    default: return paFloat32;
+    }
+}
+
+void AudioEngine::applyOutputGain(OutputPath& path, float* output, unsigned long frames) {
+    const float target = path.targetGain.load(std::memory_order_relaxed);
+    if (path.gain == target) {
+        if (target == 0.0f) {
+            std::memset(output, 0, frames * path.channels * sizeof(float));
+            path.silent.store(true, std::memory_order_release);
+        }
+        return;
+    }
+
+    // Linear ramp toward the target over kCrossfadeSeconds
+    const float step = 1.0f / static_cast<float>(kCrossfadeSeconds * m_sampleRate);
+    float gain = path.gain;
+    for (unsigned long i = 0; i < frames; ++i) {
+        gain = (target > gain) ? std::min(target, gain + step) : std::max(target, gain - step);
+        for (int ch = 0; ch < path.channels; ++ch) {
+            output[i * path.channels + ch] *= gain;
+        }
+    }
+    path.gain = gain;
+}
+
 int AudioEngine::processAudio(const float* input, float* output, unsigned long frames,
                              const PaStreamCallbackTimeInfo* timeInfo,
                              PaStreamCallbackFlags statusFlags) {
@@ -509,48 +1455,21 @@ int AudioEngine::processAudio(const float* input, float* output, unsigned long f
         return paContinue;
     }
 
-    // Copy input to output, handling channel count differences
-    if (m_actualInputChannels == m_actualOutputChannels) {
-        // Same channel count - direct copy
-        std::memcpy(output, input, frames * m_actualOutputChannels * sizeof(float));
-    } else if (m_actualInputChannels == 1 && m_actualOutputChannels == 2) {
-        // Mono to stereo
-        for (unsigned long i = 0; i < frames; ++i) {
-            output[i * 2] = input[i];
-            output[i * 2 + 1] = input[i];
-        }
-    } else if (m_actualInputChannels == 2 && m_actualOutputChannels == 1) {
-        // Stereo to mono
-        for (unsigned long i = 0; i < frames; ++i) {
-            output[i] = (input[i * 2] + input[i * 2 + 1]) * 0.5f;
-        }
-    } else {
-        // Fallback: just copy what we can
-        int minChannels = std::min(m_actualInputChannels, m_actualOutputChannels);
-        for (unsigned long i = 0; i < frames; ++i) {
-            for (int ch = 0; ch < minChannels; ++ch) {
-                output[i * m_actualOutputChannels + ch] = input[i * m_actualInputChannels + ch];
-            }
-            // Zero any extra output channels
-            for (int ch = minChannels; ch < m_actualOutputChannels; ++ch) {
-                output[i * m_actualOutputChannels + ch] = 0.0f;
-            }
-        }
+    // Copy input to output through the channel matrix
+    m_channelMatrix.process(input, output, frames);
+
+    // Measurement bursts replace the input ahead of the DSP
+    if (m_latencyProbe.isActive()) {
+        m_latencyProbe.processBlock(output, m_actualOutputChannels, frames);
     }
 
-    // Capture dry (pre-DSP) signal for spectrum visualization
-    bool shouldCaptureSpectrum = (m_visualizationCounter + 1 >= VISUALIZATION_INTERVAL);
+    // Capture dry (pre-DSP) signal for the analyzer and the waveform view
+    const float* left = output;
+    const float* right = output + (m_actualOutputChannels >= 2 ? 1 : 0);
+    m_spectrumAnalyzer.captureDry(left, right, m_actualOutputChannels, frames);
     QVector<float> dryCapture;
-    if (shouldCaptureSpectrum) {
-        dryCapture.resize(frames);
-        for (unsigned long i = 0; i < frames; ++i) {
-            if (m_actualOutputChannels >= 2) {
-                dryCapture[i] = (output[i * m_actualOutputChannels] +
-                                output[i * m_actualOutputChannels + 1]) * 0.5f;
-            } else {
-                dryCapture[i] = output[i];
-            }
-        }
+    if (isVisualizationEnabled() && m_visualizationCounter + 1 >= VISUALIZATION_INTERVAL) {
+        mixDown(left, right, m_actualOutputChannels, frames, dryCapture);
     }
 
     // Process through DSP (using output channel count)
@@ -558,24 +1477,68 @@ int AudioEngine::processAudio(const float* input, float* output, unsigned long f
         m_dspProcessor->process(output, frames, m_actualOutputChannels);
     }
 
-    // Level metering
-    ++m_levelUpdateCounter;
-    if (m_levelUpdateCounter >= LEVEL_UPDATE_INTERVAL) {
-        m_levelUpdateCounter = 0;
+    publishAnalysis(left, right, m_actualOutputChannels, frames, dryCapture);
 
-        if (m_actualOutputChannels >= 2) {
-            m_levelL = calculateRMS(output, frames, 0, m_actualOutputChannels);
-            m_levelR = calculateRMS(output, frames, 1, m_actualOutputChannels);
-        } else {
-            m_levelL = m_levelR = calculateRMS(output, frames, 0, m_actualOutputChannels);
+    return paContinue;
+}
+
+void AudioEngine::processPlanar(const float* const* input, float* const* output, unsigned long frames, bool xrun) {
+    if (xrun) {
+        LOG_DEBUG("JACK xrun");
+    }
+
+    // JACK registers matching input/output ports, so each channel is a straight copy
+    const int channels = m_actualOutputChannels;
+    for (int ch = 0; ch < channels; ++ch) {
+        if (output[ch] != input[ch]) {
+            std::memcpy(output[ch], input[ch], frames * sizeof(float));
         }
+    }
 
-        QMetaObject::invokeMethod(this, [this]() {
-            emit levelChanged(m_levelL, m_levelR);
-        }, Qt::QueuedConnection);
+    if (m_latencyProbe.isActive()) {
+        m_latencyProbe.processBlock(output, channels, frames);
     }
 
-    // Visualization data
+    const float* left = output[0];
+    const float* right = output[channels >= 2 ? 1 : 0];
+    m_spectrumAnalyzer.captureDry(left, right, 1, frames);
+    QVector<float> dryCapture;
+    if (isVisualizationEnabled() && m_visualizationCounter + 1 >= VISUALIZATION_INTERVAL) {
+        mixDown(left, right, 1, frames, dryCapture);
+    }
+
+    if (m_dspProcessor && !m_dspProcessor->isBypassed()) {
+        m_dspProcessor->processPlanar(output, static_cast<int>(frames), channels);
+    }
+
+    publishAnalysis(left, right, 1, frames, dryCapture);
+}
+
+void AudioEngine::setVisualizationEnabled(bool enabled) {
+    if (m_visualizationEnabled.exchange(enabled, std::memory_order_relaxed) == enabled) {
+        return;
+    }
+    if (!enabled) {
+        m_spectrumAnalyzer.stop();
+    } else if (m_running) {
+        m_spectrumAnalyzer.start();
+    }
+    LOG_DEBUG(QString("Visualization %1").arg(enabled ? "enabled" : "disabled"));
+}
+
+void AudioEngine::publishAnalysis(const float* left, const float* right, int stride, unsigned long frames,
+                                  const QVector<float>& dryCapture) {
+    // Level and loudness metering; the UI polls getLevels() and getLoudness()
+    const float* meterChannels[2] = {left, right};
+    const int meterChannelCount = right == left ? 1 : 2;
+    m_levelMeter.process(meterChannels, meterChannelCount, frames, stride);
+    m_loudnessMeter.process(meterChannels, meterChannelCount, frames, stride);
+    m_spectrumAnalyzer.captureWet(left, right, stride, frames);
+
+    // Visualization data; nothing is posted to the GUI thread while nothing shows it
+    if (!isVisualizationEnabled()) {
+        return;
+    }
     ++m_visualizationCounter;
     if (m_visualizationCounter >= VISUALIZATION_INTERVAL) {
         m_visualizationCounter = 0;
@@ -583,15 +1546,7 @@ int AudioEngine::processAudio(const float* input, float* output, unsigned long f
         QMutexLocker locker(&m_visualizationMutex);
 
         // Capture wet (post-DSP) signal
-        m_wetVisualizationBuffer.resize(frames);
-        for (unsigned long i = 0; i < frames; ++i) {
-            if (m_actualOutputChannels >= 2) {
-                m_wetVisualizationBuffer[i] = (output[i * m_actualOutputChannels] +
-                                               output[i * m_actualOutputChannels + 1]) * 0.5f;
-            } else {
-                m_wetVisualizationBuffer[i] = output[i];
-            }
-        }
+        mixDown(left, right, stride, frames, m_wetVisualizationBuffer);
 
         // Store the dry signal captured earlier
         m_dryVisualizationBuffer = dryCapture;
@@ -605,15 +1560,23 @@ int AudioEngine::processAudio(const float* input, float* output, unsigned long f
             emit spectrumDataReady(m_dryVisualizationBuffer, m_wetVisualizationBuffer);
         }, Qt::QueuedConnection);
     }
-
-    return paContinue;
 }
 
-float AudioEngine::calculateRMS(const float* buffer, int frames, int channel, int totalChannels) {
-    float sum = 0.0f;
-    for (int i = 0; i < frames; ++i) {
-        float sample = buffer[i * totalChannels + channel];
-        sum += sample * sample;
+void AudioEngine::mixDown(const float* left, const float* right, int stride, unsigned long frames,
+                          QVector<float>& output) {
+    output.resize(frames);
+    if (left == right) {
+        for (unsigned long i = 0; i < frames; ++i) {
+            output[i] = left[i * stride];
+        }
+    } else {
+        for (unsigned long i = 0; i < frames; ++i) {
+            output[i] = (left[i * stride] + right[i * stride]) * 0.5f;
+        }
     }
-    return std::sqrt(sum / frames);
+}
+
+void AudioEngine::convertChannels(const float* input, int inputChannels,
+                                  float* output, int outputChannels, unsigned long frames) {
+    ChannelMatrix::mixDefault(input, inputChannels, output, outputChannels, frames);
 }
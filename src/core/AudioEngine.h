@@ -6,7 +6,23 @@
 #include <QStringList>
 #include <QVector>
 #include <QMutex>
+#include <QTimer>
+#include <QElapsedTimer>
 #include <portaudio.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include "AudioBuffer.h"
+#include "AdaptiveResampler.h"
+#include "ChannelMatrix.h"
+#include "JackClient.h"
+#include "LatencyProbe.h"
+#include "LevelMeter.h"
+#include "LoudnessMeter.h"
+#include "NullAudioDevice.h"
+#include "SampleConverter.h"
+#include "SpectrumAnalyzer.h"
 
 class DSPProcessor;
 
@@ -21,10 +37,39 @@ struct AudioDeviceInfo {
     QString hostApi;
 };
 
+// Per-device playback status in SeparateStreams mode
+struct OutputStreamStatus {
+    int deviceIndex;
+    int channels;
+    double latencyMs;
+    double clockRatio;
+    quint64 underruns;
+    quint64 overruns;
+};
+
 class AudioEngine : public QObject {
     Q_OBJECT
 
 public:
+    // FullDuplex: one stream across both devices (lowest latency, shared clock assumed)
+    // SeparateStreams: independent capture/playback streams bridged by a
+    // drift-compensating resampler (for long sessions on unsynchronized devices)
+    enum class StreamMode {
+        FullDuplex,
+        SeparateStreams
+    };
+
+    // PortAudio: device streams chosen from the lists below (WASAPI preferred)
+    // Jack: a JACK/PipeWire client; the server sets rate and period and the
+    // DSP runs directly on the non-interleaved port buffers
+    // Null: virtual device with generated or file input, for profiling and
+    // headless tests; needs neither initialize() nor any sound hardware
+    enum class Backend {
+        PortAudio,
+        Jack,
+        Null
+    };
+
     explicit AudioEngine(QObject* parent = nullptr);
     ~AudioEngine();
 
@@ -37,10 +82,25 @@ public:
     QVector<AudioDeviceInfo> getInputDevices() const;
     QVector<AudioDeviceInfo> getOutputDevices() const;
     bool setInputDevice(int index);
+    // While running with separate streams the new output is opened and
+    // pre-rolled in the background, then crossfaded in without a dropout;
+    // DSP state is kept. A full-duplex stream spans both devices and is
+    // restarted instead. A switch that stalls (capture stops feeding the new
+    // output, or the old device stops playing) is completed without the
+    // crossfade after kSwitchTimeoutMs. Returns false if the device cannot
+    // be used or a switch is already pending (the old output keeps playing),
+    // if a full-duplex restart failed (the engine is then stopped), or while
+    // running on JACK or the null device, which have no PortAudio outputs to
+    // switch.
     bool setOutputDevice(int index);
     int getInputDeviceIndex() const { return m_inputDeviceIndex; }
     int getOutputDeviceIndex() const { return m_outputDeviceIndex; }
 
+    // Additional outputs fed from the same DSP pass (uses separate streams)
+    bool addOutputDevice(int index);
+    bool removeOutputDevice(int index);
+    QVector<int> getAdditionalOutputDevices() const { return m_additionalOutputDevices; }
+
     // Find VB-CABLE device
     int findVBCableDevice() const;
 
@@ -56,6 +116,31 @@ public:
     int getSampleRate() const { return m_sampleRate; }
     int getBufferSize() const { return m_bufferSize; }
     int getChannels() const { return m_channels; }
+    void setStreamMode(StreamMode mode);
+    StreamMode getStreamMode() const { return m_streamMode; }
+    void setBackend(Backend backend);
+    Backend getBackend() const { return m_backend; }
+    // Sample format of the PortAudio streams, applied on the next start().
+    // With an integer format PortAudio's converters are bypassed: the
+    // callbacks convert in and out of the float scratch buffers themselves,
+    // with TPDF dither on 16/24-bit output. JACK and the null device are float only.
+    void setStreamFormat(SampleConverter::Format format);
+    SampleConverter::Format getStreamFormat() const { return m_streamFormat; }
+    static bool isBackendAvailable(Backend backend);
+    // Capture-to-playback channel mix, e.g. a mono input panned across the
+    // outputs or input 1 of a stereo interface sent to both speakers. Used
+    // from the next start() when its channel counts match the opened
+    // streams; otherwise, and after resetChannelMatrix(), the default mix
+    // runs. JACK has equal port counts and always passes channels through.
+    void setChannelMatrix(const ChannelMatrix& matrix);
+    void resetChannelMatrix();
+    bool hasChannelMatrix() const { return m_hasUserMatrix; }
+    const ChannelMatrix& getChannelMatrix() const { return m_userMatrix; }
+
+    // Virtual device configuration and timing (Backend::Null only)
+    void setNullDeviceOptions(const NullDeviceOptions& options);
+    const NullDeviceOptions& getNullDeviceOptions() const { return m_nullOptions; }
+    NullDeviceStats getNullDeviceStats() const;
 
     // DSP processor
     void setDSPProcessor(DSPProcessor* processor);
@@ -66,15 +151,52 @@ public:
     double getOutputLatency() const;
     double getTotalLatency() const;
 
+    // Measured round trip over a loopback (an output wired back to the input).
+    // For a moment the input is replaced by MLS bursts; the result arrives
+    // through latencyMeasured(). Needs a running stream.
+    bool startLatencyMeasurement(const LatencyProbeOptions& options = LatencyProbeOptions());
+    void cancelLatencyMeasurement();
+    bool isMeasuringLatency() const { return m_latencyProbe.isActive(); }
+    const LatencyMeasurement& getLastLatencyMeasurement() const { return m_lastLatencyMeasurement; }
+
+    // Callback arrival jitter and host timestamps since the stream started
+    // (PortAudio and null backends; JACK reports no timeInfo)
+    CallbackTiming getCallbackTiming() const { return m_latencyProbe.getTiming(); }
+
+    // Estimated capture/playback clock ratio of the primary output
+    // (SeparateStreams mode only, 1.0 otherwise)
+    double getClockRatio() const;
+
+    // Latency, drift and xrun counters for every open output
+    QVector<OutputStreamStatus> getOutputStatus() const;
+
     // Debug: list all devices
     void logAllDevices() const;
 
+    // Latest post-DSP metering window (RMS, sample peak, true-peak); lock-free, poll from any thread
+    LevelReading getLevels() const { return m_levelMeter.read(); }
+    void resetPeakHold() { m_levelMeter.resetPeakHold(); }
+
+    // EBU R128 loudness of the post-DSP output; lock-free, poll from any thread
+    LoudnessReading getLoudness() const { return m_loudnessMeter.read(); }
+    void resetLoudness() { m_loudnessMeter.resetIntegrated(); }
+
+    // Dry vs. wet spectrum, analyzed on a worker thread while the engine runs
+    const SpectrumAnalyzer& getSpectrumAnalyzer() const { return m_spectrumAnalyzer; }
+
+    // Off while no visualization is on screen: the spectrum worker stops and the
+    // callback posts no waveform data to the GUI thread. Meters keep running
+    void setVisualizationEnabled(bool enabled);
+    bool isVisualizationEnabled() const { return m_visualizationEnabled.load(std::memory_order_relaxed); }
+
 signals:
     void audioDataReady(const QVector<float>& data);
     void spectrumDataReady(const QVector<float>& dryData, const QVector<float>& wetData);
     void errorOccurred(const QString& error);
     void latencyChanged(double inputMs, double outputMs);
-    void levelChanged(float leftLevel, float rightLevel);
+    void latencyMeasured(const LatencyMeasurement& result);
+    // The stream ended on its own (null device reached its duration); the engine is stopped
+    void streamFinished();
 
 private:
     // PortAudio callback
@@ -83,18 +205,146 @@ private:
                             const PaStreamCallbackTimeInfo* timeInfo,
                             PaStreamCallbackFlags statusFlags,
                             void* userData);
+    static int captureCallback(const void* inputBuffer, void* outputBuffer,
+                               unsigned long framesPerBuffer,
+                               const PaStreamCallbackTimeInfo* timeInfo,
+                               PaStreamCallbackFlags statusFlags,
+                               void* userData);
+    static int playbackCallback(const void* inputBuffer, void* outputBuffer,
+                                unsigned long framesPerBuffer,
+                                const PaStreamCallbackTimeInfo* timeInfo,
+                                PaStreamCallbackFlags statusFlags,
+                                void* userData);
+
+    // JACK callbacks (process thread / notification thread)
+    static void jackProcessCallback(const float* const* inputs, float* const* outputs,
+                                    uint32_t frames, bool xrun, void* userData);
+    static void jackNotifyCallback(JackClient::Event event, void* userData);
+
+    // Stream setup for each mode
+    bool openDuplexStream(const PaStreamParameters& inputParams, const PaStreamParameters& outputParams);
+    bool openSeparateStreams(const PaStreamParameters& inputParams, const PaStreamParameters& outputParams);
+    bool startJack();
+    bool startNullDevice();
+    // Picks the callback's channel mix once the stream channel counts are known
+    void prepareChannelMatrix();
+    void handleJackEvent(JackClient::Event event);
+    void pollLatencyMeasurement();
+
+    // One playback device fed from the shared capture/DSP pass. Each output
+    // owns its ring and resampler so it can drift against the capture clock
+    // independently of the others.
+    struct OutputPath {
+        AudioEngine* engine = nullptr;
+        int deviceIndex = -1;
+        int channels = 2;
+        PaStream* stream = nullptr;
+        AudioBuffer ring;
+        AdaptiveResampler resampler;
+        std::vector<float> scratch;  // resampled frames before channel conversion
+        std::vector<float> native;   // float output ahead of integer conversion
+        SampleConverter::Dither dither;
+        double latency = 0.0;
+        quint64 overruns = 0;
+
+        // Crossfade state: the control thread sets the target, playback ramps to it
+        std::atomic<float> targetGain{1.0f};
+        std::atomic<bool> silent{false};
+        float gain = 1.0f;  // playback thread only
+    };
+
+    std::unique_ptr<OutputPath> openOutputPath(int deviceIndex, int channels, double suggestedLatency);
+    void closeOutputPaths();
+    void closeOutputStream(OutputPath& path);
+
+    // Capture-side visibility of output paths (lock-free for the audio thread).
+    // Unpublishing returns the capture generation; the path may be freed once
+    // m_captureGeneration has moved past it
+    bool publishOutputPath(OutputPath* path);
+    quint64 unpublishOutputPath(OutputPath* path);
+
+    // Live output switching
+    bool beginOutputSwitch(int index);
+    void advanceOutputSwitch();
+    void applyOutputGain(OutputPath& path, float* output, unsigned long frames);
+
+    // Separate-stream handlers: capture runs the DSP once, each output drains its ring
+    int processCapture(const float* input, unsigned long frames,
+                       const PaStreamCallbackTimeInfo* timeInfo,
+                       PaStreamCallbackFlags statusFlags);
+    int processPlayback(OutputPath& path, float* output, unsigned long frames);
+
+    // Integer stream formats: convert around the float handlers, one pass per callback
+    int processNativeDuplex(const void* input, void* output, unsigned long frames,
+                            const PaStreamCallbackTimeInfo* timeInfo,
+                            PaStreamCallbackFlags statusFlags);
+    int processNativeCapture(const void* input, unsigned long frames,
+                             const PaStreamCallbackTimeInfo* timeInfo,
+                             PaStreamCallbackFlags statusFlags);
+    int processNativePlayback(OutputPath& path, void* output, unsigned long frames);
+    static PaSampleFormat toPaFormat(SampleConverter::Format format);
+    // False (and logged) for a callback larger than its scratch buffer, which a
+    // stream opened with framesPerBuffer never delivers
+    static bool fitsCallbackBuffer(unsigned long frames, size_t capacityFrames);
+
+    // Interleaved channel count conversion with ChannelMatrix's default matrix
+    // (mono <-> stereo, truncate/zero-pad otherwise); input may equal output
+    // only when the channel counts match
+    static void convertChannels(const float* input, int inputChannels,
+                                float* output, int outputChannels, unsigned long frames);
 
     // Instance callback handler
     int processAudio(const float* input, float* output, unsigned long frames,
                     const PaStreamCallbackTimeInfo* timeInfo,
                     PaStreamCallbackFlags statusFlags);
 
-    // Calculate RMS level
-    float calculateRMS(const float* buffer, int frames, int channel, int totalChannels);
+    // Non-interleaved variant used by the JACK backend; runs on the port buffers
+    void processPlanar(const float* const* input, float* const* output, unsigned long frames, bool xrun);
 
-    // PortAudio stream
+    // Metering and visualization handoff shared by both layouts. Channels are
+    // read as left[i * stride] / right[i * stride] (right == left for mono).
+    void publishAnalysis(const float* left, const float* right, int stride, unsigned long frames,
+                         const QVector<float>& dryCapture);
+    static void mixDown(const float* left, const float* right, int stride, unsigned long frames,
+                        QVector<float>& output);
+
+    // PortAudio stream (full-duplex mode)
     PaStream* m_stream = nullptr;
 
+    // Separate capture stream fanned out to one or more resampled outputs;
+    // m_outputPaths[0] is the primary output device
+    PaStream* m_captureStream = nullptr;
+    std::vector<std::unique_ptr<OutputPath>> m_outputPaths;
+    std::vector<float> m_captureScratch;
+
+    // JACK client (Backend::Jack only)
+    std::unique_ptr<JackClient> m_jackClient;
+
+    // Virtual device (Backend::Null only); kept after stop() for its statistics
+    std::unique_ptr<NullAudioDevice> m_nullDevice;
+    NullDeviceOptions m_nullOptions;
+    QVector<int> m_additionalOutputDevices;
+
+    // Slots read by the capture callback; m_outputPaths owns the paths
+    static constexpr int kMaxOutputPaths = 8;
+    std::array<std::atomic<OutputPath*>, kMaxOutputPaths> m_activePaths{};
+    std::atomic<quint64> m_captureGeneration{0};
+
+    // Pending live switch: the incoming path pre-rolls, then both crossfade.
+    // m_switchTimer drives it, so the GUI thread never waits on the capture callback;
+    // past kSwitchTimeoutMs it stops waiting on the callbacks altogether
+    OutputPath* m_incomingPath = nullptr;
+    OutputPath* m_outgoingPath = nullptr;
+    bool m_outgoingUnpublished = false;
+    quint64 m_outgoingGeneration = 0;
+    QTimer* m_switchTimer = nullptr;
+    QElapsedTimer m_switchClock;
+    static constexpr double kCrossfadeSeconds = 0.05;
+    static constexpr qint64 kSwitchTimeoutMs = 2000;
+
+    // Closed outputs a stalled capture callback may still hold; freed by stop()
+    std::vector<std::unique_ptr<OutputPath>> m_retiredPaths;
+
     // DSP processor (not owned)
     DSPProcessor* m_dspProcessor = nullptr;
 
@@ -104,6 +354,19 @@ private:
     int m_sampleRate = 48000;
     int m_bufferSize = 512;  // Increased default for stability
     int m_channels = 2;
+    StreamMode m_streamMode = StreamMode::FullDuplex;
+    Backend m_backend = Backend::PortAudio;
+    SampleConverter::Format m_streamFormat = SampleConverter::Format::Float32;
+    ChannelMatrix m_userMatrix;
+    bool m_hasUserMatrix = false;
+
+    // Mix run by processAudio; rebuilt by start() only, so callbacks read it unlocked
+    ChannelMatrix m_channelMatrix;
+
+    // Float staging for integer stream formats, one callback long (callback threads only)
+    std::vector<float> m_nativeInput;
+    std::vector<float> m_nativeOutput;
+    SampleConverter::Dither m_outputDither;
 
     // Actual channel counts used in the stream (may differ from m_channels)
     int m_actualInputChannels = 2;
@@ -117,13 +380,20 @@ private:
     double m_inputLatency = 0.0;
     double m_outputLatency = 0.0;
 
-    // Level metering
-    float m_levelL = 0.0f;
-    float m_levelR = 0.0f;
-    int m_levelUpdateCounter = 0;
-    static constexpr int LEVEL_UPDATE_INTERVAL = 4;
+    // Loopback measurement and callback timing; the timer polls for a finished capture
+    LatencyProbe m_latencyProbe;
+    LatencyMeasurement m_lastLatencyMeasurement;
+    QTimer* m_latencyTimer = nullptr;
+    int m_latencyPollsLeft = 0;
+    static constexpr int kLatencyPollMs = 50;
+
+    // Level metering, run on every callback
+    LevelMeter m_levelMeter;
+    LoudnessMeter m_loudnessMeter;
+    SpectrumAnalyzer m_spectrumAnalyzer;
 
     // Visualization buffers (dry = before DSP, wet = after DSP)
+    std::atomic<bool> m_visualizationEnabled{true};
     QVector<float> m_visualizationBuffer;
     QVector<float> m_dryVisualizationBuffer;
     QVector<float> m_wetVisualizationBuffer;
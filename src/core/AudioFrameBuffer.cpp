@@ -0,0 +1,214 @@
+#include "AudioFrameBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+size_t nextPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+size_t runFrames(const AudioFrameBuffer::Region& region, int run) {
+    return run == 0 ? region.firstFrames : region.secondFrames;
+}
+
+// Matching layouts are one memcpy per run (interleaved) or per channel and run (planar)
+void copyIn(const AudioFrameBuffer::Region& region, int channels, const float* interleaved) {
+    const size_t stride = region.stride();
+    size_t offset = 0;
+    for (int run = 0; run < 2; ++run) {
+        const size_t frames = runFrames(region, run);
+        const float* src = interleaved + offset * channels;
+        if (stride == static_cast<size_t>(channels)) {
+            std::memcpy(region.channel(0, run), src, frames * channels * sizeof(float));
+        } else {
+            for (int ch = 0; ch < channels; ++ch) {
+                float* dst = region.channel(ch, run);
+                for (size_t i = 0; i < frames; ++i) {
+                    dst[i] = src[i * channels + ch];
+                }
+            }
+        }
+        offset += frames;
+    }
+}
+
+void copyIn(const AudioFrameBuffer::Region& region, int channels, const float* const* planes) {
+    const size_t stride = region.stride();
+    size_t offset = 0;
+    for (int run = 0; run < 2; ++run) {
+        const size_t frames = runFrames(region, run);
+        for (int ch = 0; ch < channels; ++ch) {
+            float* dst = region.channel(ch, run);
+            const float* src = planes[ch] + offset;
+            if (stride == 1) {
+                std::memcpy(dst, src, frames * sizeof(float));
+            } else {
+                for (size_t i = 0; i < frames; ++i) {
+                    dst[i * stride] = src[i];
+                }
+            }
+        }
+        offset += frames;
+    }
+}
+
+void copyOut(const AudioFrameBuffer::Region& region, int channels, float* interleaved) {
+    const size_t stride = region.stride();
+    size_t offset = 0;
+    for (int run = 0; run < 2; ++run) {
+        const size_t frames = runFrames(region, run);
+        float* dst = interleaved + offset * channels;
+        if (stride == static_cast<size_t>(channels)) {
+            std::memcpy(dst, region.channel(0, run), frames * channels * sizeof(float));
+        } else {
+            for (int ch = 0; ch < channels; ++ch) {
+                const float* src = region.channel(ch, run);
+                for (size_t i = 0; i < frames; ++i) {
+                    dst[i * channels + ch] = src[i];
+                }
+            }
+        }
+        offset += frames;
+    }
+}
+
+void copyOut(const AudioFrameBuffer::Region& region, int channels, float* const* planes) {
+    const size_t stride = region.stride();
+    size_t offset = 0;
+    for (int run = 0; run < 2; ++run) {
+        const size_t frames = runFrames(region, run);
+        for (int ch = 0; ch < channels; ++ch) {
+            const float* src = region.channel(ch, run);
+            float* dst = planes[ch] + offset;
+            if (stride == 1) {
+                std::memcpy(dst, src, frames * sizeof(float));
+            } else {
+                for (size_t i = 0; i < frames; ++i) {
+                    dst[i] = src[i * stride];
+                }
+            }
+        }
+        offset += frames;
+    }
+}
+} // namespace
+
+AudioFrameBuffer::AudioFrameBuffer(int channels, size_t capacityFrames, Layout layout) {
+    configure(channels, capacityFrames, layout);
+}
+
+void AudioFrameBuffer::configure(int channels, size_t capacityFrames, Layout layout) {
+    m_channels = std::max(1, channels);
+    m_layout = layout;
+    m_capacity = nextPowerOfTwo(std::max<size_t>(capacityFrames, 1));
+    m_mask = m_capacity - 1;
+    m_buffer.assign(m_capacity * m_channels, 0.0f);
+    clear();
+}
+
+AudioFrameBuffer::Region AudioFrameBuffer::makeRegion(size_t position, size_t frames) {
+    const size_t offset = position & m_mask;
+
+    Region region;
+    region.firstFrames = std::min(frames, m_capacity - offset);
+    region.secondFrames = frames - region.firstFrames;
+    if (m_layout == Layout::Planar) {
+        region.m_first = m_buffer.data() + offset;
+        region.m_channelStep = m_capacity;
+        region.m_stride = 1;
+    } else {
+        region.m_first = m_buffer.data() + offset * m_channels;
+        region.m_channelStep = 1;
+        region.m_stride = static_cast<size_t>(m_channels);
+    }
+    region.m_second = m_buffer.data();
+    return region;
+}
+
+AudioFrameBuffer::Region AudioFrameBuffer::acquireWrite(size_t maxFrames) {
+    const size_t writePos = m_writePos.load(std::memory_order_relaxed);
+    if (m_capacity - (writePos - m_cachedReadPos) < maxFrames) {
+        m_cachedReadPos = m_readPos.load(std::memory_order_acquire);
+    }
+    return makeRegion(writePos, std::min(maxFrames, m_capacity - (writePos - m_cachedReadPos)));
+}
+
+void AudioFrameBuffer::commitWrite(size_t frames) {
+    // Must not exceed the last acquired region
+    const size_t writePos = m_writePos.load(std::memory_order_relaxed);
+    m_writePos.store(writePos + frames, std::memory_order_release);
+}
+
+AudioFrameBuffer::Region AudioFrameBuffer::acquireRead(size_t maxFrames) {
+    const size_t readPos = m_readPos.load(std::memory_order_relaxed);
+    if (m_cachedWritePos - readPos < maxFrames) {
+        m_cachedWritePos = m_writePos.load(std::memory_order_acquire);
+    }
+    return makeRegion(readPos, std::min(maxFrames, m_cachedWritePos - readPos));
+}
+
+void AudioFrameBuffer::commitRead(size_t frames) {
+    const size_t readPos = m_readPos.load(std::memory_order_relaxed);
+    m_readPos.store(readPos + frames, std::memory_order_release);
+}
+
+bool AudioFrameBuffer::writeInterleaved(const float* data, size_t frames) {
+    const Region region = acquireWrite(frames);
+    if (region.frames() < frames) {
+        return false;
+    }
+    copyIn(region, m_channels, data);
+    commitWrite(frames);
+    return true;
+}
+
+bool AudioFrameBuffer::writePlanar(const float* const* channels, size_t frames) {
+    const Region region = acquireWrite(frames);
+    if (region.frames() < frames) {
+        return false;
+    }
+    copyIn(region, m_channels, channels);
+    commitWrite(frames);
+    return true;
+}
+
+bool AudioFrameBuffer::readInterleaved(float* data, size_t frames) {
+    const Region region = acquireRead(frames);
+    if (region.frames() < frames) {
+        return false;
+    }
+    copyOut(region, m_channels, data);
+    commitRead(frames);
+    return true;
+}
+
+bool AudioFrameBuffer::readPlanar(float* const* channels, size_t frames) {
+    const Region region = acquireRead(frames);
+    if (region.frames() < frames) {
+        return false;
+    }
+    copyOut(region, m_channels, channels);
+    commitRead(frames);
+    return true;
+}
+
+size_t AudioFrameBuffer::availableRead() const {
+    m_cachedWritePos = m_writePos.load(std::memory_order_acquire);
+    return m_cachedWritePos - m_readPos.load(std::memory_order_relaxed);
+}
+
+size_t AudioFrameBuffer::availableWrite() const {
+    m_cachedReadPos = m_readPos.load(std::memory_order_acquire);
+    return m_capacity - (m_writePos.load(std::memory_order_relaxed) - m_cachedReadPos);
+}
+
+void AudioFrameBuffer::clear() {
+    m_cachedReadPos = 0;
+    m_cachedWritePos = 0;
+    m_readPos.store(0, std::memory_order_relaxed);
+    m_writePos.store(0, std::memory_order_release);
+}
@@ -0,0 +1,98 @@
+#ifndef AUDIOFRAMEBUFFER_H
+#define AUDIOFRAMEBUFFER_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * AudioFrameBuffer - Single-producer/single-consumer ring of whole frames
+ *
+ * Like AudioBuffer, but positions count frames of a fixed channel count,
+ * so a transfer can never leave half a frame behind. Samples are stored
+ * planar (one contiguous plane per channel) or interleaved, as chosen at
+ * configure time. Either side may use the other layout: the interleaved
+ * and planar read/write calls convert while copying.
+ *
+ * Regions hand out per-channel spans into the ring itself. A planar
+ * consumer can run its DSP directly on an acquired read region (the frames
+ * belong to the consumer until commitRead) instead of de-interleaving
+ * into a scratch block first.
+ *
+ * Thread ownership and capacity rounding are the same as AudioBuffer.
+ */
+class AudioFrameBuffer {
+public:
+    enum class Layout {
+        Interleaved,
+        Planar
+    };
+
+    // Up to two runs of frames in ring order; the second is empty unless the region wraps
+    class Region {
+    public:
+        size_t firstFrames = 0;
+        size_t secondFrames = 0;
+
+        size_t frames() const { return firstFrames + secondFrames; }
+
+        // Channel `channel` of run 0 or 1; consecutive frames are stride() floats apart
+        float* channel(int channel, int run) const {
+            return (run == 0 ? m_first : m_second) + static_cast<size_t>(channel) * m_channelStep;
+        }
+        size_t stride() const { return m_stride; }
+
+    private:
+        friend class AudioFrameBuffer;
+        float* m_first = nullptr;
+        float* m_second = nullptr;
+        size_t m_channelStep = 0;
+        size_t m_stride = 1;
+    };
+
+    explicit AudioFrameBuffer(int channels = 2, size_t capacityFrames = 8192, Layout layout = Layout::Planar);
+
+    // Not thread-safe; drops anything buffered
+    void configure(int channels, size_t capacityFrames, Layout layout);
+
+    // All-or-nothing: false (and nothing transferred) if the whole block does not fit
+    bool writeInterleaved(const float* data, size_t frames);
+    bool writePlanar(const float* const* channels, size_t frames);
+    bool readInterleaved(float* data, size_t frames);
+    bool readPlanar(float* const* channels, size_t frames);
+
+    // Zero-copy access to up to maxFrames frames; commit what was actually used
+    Region acquireWrite(size_t maxFrames);
+    void commitWrite(size_t frames);
+    Region acquireRead(size_t maxFrames);
+    void commitRead(size_t frames);
+
+    size_t availableRead() const;
+    size_t availableWrite() const;
+    size_t capacity() const { return m_capacity; }
+    int getChannels() const { return m_channels; }
+    Layout getLayout() const { return m_layout; }
+
+    void clear();
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    Region makeRegion(size_t position, size_t frames);
+
+    std::vector<float> m_buffer;
+    int m_channels = 2;
+    Layout m_layout = Layout::Planar;
+    size_t m_capacity = 0;
+    size_t m_mask = 0;
+
+    // Producer line
+    alignas(kCacheLine) std::atomic<size_t> m_writePos{0};
+    mutable size_t m_cachedReadPos = 0;
+
+    // Consumer line
+    alignas(kCacheLine) std::atomic<size_t> m_readPos{0};
+    mutable size_t m_cachedWritePos = 0;
+};
+
+#endif // AUDIOFRAMEBUFFER_H
@@ -0,0 +1,192 @@
+#include "ChannelMatrix.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CHANNELMATRIX_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+void monoToStereo(const float* input, float* output, size_t frames) {
+    size_t i = 0;
+#ifdef CHANNELMATRIX_SSE2
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 v = _mm_loadu_ps(input + i);
+        _mm_storeu_ps(output + 2 * i, _mm_unpacklo_ps(v, v));
+        _mm_storeu_ps(output + 2 * i + 4, _mm_unpackhi_ps(v, v));
+    }
+#endif
+    for (; i < frames; ++i) {
+        output[i * 2] = input[i];
+        output[i * 2 + 1] = input[i];
+    }
+}
+
+void stereoToMono(const float* input, float* output, size_t frames) {
+    size_t i = 0;
+#ifdef CHANNELMATRIX_SSE2
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 a = _mm_loadu_ps(input + 2 * i);
+        const __m128 b = _mm_loadu_ps(input + 2 * i + 4);
+        const __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+    }
+#endif
+    for (; i < frames; ++i) {
+        output[i] = (input[i * 2] + input[i * 2 + 1]) * 0.5f;
+    }
+}
+} // namespace
+
+ChannelMatrix::ChannelMatrix(int inputChannels, int outputChannels) {
+    setDefault(inputChannels, outputChannels);
+}
+
+void ChannelMatrix::setDefault(int inputChannels, int outputChannels) {
+    m_inputs = std::max(1, inputChannels);
+    m_outputs = std::max(1, outputChannels);
+    m_gains.assign(static_cast<size_t>(m_inputs) * m_outputs, 0.0f);
+
+    if (m_inputs == 1 && m_outputs == 2) {
+        m_gains[0] = 1.0f;
+        m_gains[1] = 1.0f;
+    } else if (m_inputs == 2 && m_outputs == 1) {
+        m_gains[0] = 0.5f;
+        m_gains[1] = 0.5f;
+    } else {
+        for (int ch = 0; ch < std::min(m_inputs, m_outputs); ++ch) {
+            m_gains[static_cast<size_t>(ch) * m_inputs + ch] = 1.0f;
+        }
+    }
+    rebuild();
+}
+
+void ChannelMatrix::setGain(int output, int input, float gain) {
+    if (output < 0 || output >= m_outputs || input < 0 || input >= m_inputs) {
+        return;
+    }
+    m_gains[static_cast<size_t>(output) * m_inputs + input] = gain;
+    rebuild();
+}
+
+float ChannelMatrix::getGain(int output, int input) const {
+    if (output < 0 || output >= m_outputs || input < 0 || input >= m_inputs) {
+        return 0.0f;
+    }
+    return m_gains[static_cast<size_t>(output) * m_inputs + input];
+}
+
+void ChannelMatrix::rebuild() {
+    // Transposed and zero-padded, so one vector load fetches the gains of
+    // four outputs for a single input
+    m_paddedOutputs = (m_outputs + 3) & ~3;
+    m_columns.assign(static_cast<size_t>(m_inputs) * m_paddedOutputs, 0.0f);
+    for (int out = 0; out < m_outputs; ++out) {
+        for (int in = 0; in < m_inputs; ++in) {
+            m_columns[static_cast<size_t>(in) * m_paddedOutputs + out] =
+                m_gains[static_cast<size_t>(out) * m_inputs + in];
+        }
+    }
+
+    // Recognize the shapes that have dedicated kernels
+    bool identity = m_inputs == m_outputs;
+    for (int out = 0; out < m_outputs && identity; ++out) {
+        for (int in = 0; in < m_inputs; ++in) {
+            if (m_gains[static_cast<size_t>(out) * m_inputs + in] != (in == out ? 1.0f : 0.0f)) {
+                identity = false;
+                break;
+            }
+        }
+    }
+
+    if (identity) {
+        m_kind = Kind::Identity;
+    } else if (m_inputs == 1 && m_outputs == 2 && m_gains[0] == 1.0f && m_gains[1] == 1.0f) {
+        m_kind = Kind::MonoToStereo;
+    } else if (m_inputs == 2 && m_outputs == 1 && m_gains[0] == 0.5f && m_gains[1] == 0.5f) {
+        m_kind = Kind::StereoToMono;
+    } else {
+        m_kind = Kind::General;
+    }
+}
+
+void ChannelMatrix::process(const float* input, float* output, size_t frames) const {
+    switch (m_kind) {
+    case Kind::Identity:
+        if (input != output) {
+            std::memcpy(output, input, frames * m_outputs * sizeof(float));
+        }
+        return;
+    case Kind::MonoToStereo:
+        monoToStereo(input, output, frames);
+        return;
+    case Kind::StereoToMono:
+        stereoToMono(input, output, frames);
+        return;
+    case Kind::General:
+        processGeneral(input, output, frames);
+        return;
+    }
+}
+
+void ChannelMatrix::processGeneral(const float* input, float* output, size_t frames) const {
+    float* const end = output + frames * m_outputs;
+    for (size_t i = 0; i < frames; ++i) {
+        const float* in = input + i * m_inputs;
+        float* out = output + i * m_outputs;
+        for (int o = 0; o < m_outputs; o += 4) {
+            const float* column = m_columns.data() + o;
+#ifdef CHANNELMATRIX_SSE2
+            __m128 sum = _mm_setzero_ps();
+            for (int c = 0; c < m_inputs; ++c, column += m_paddedOutputs) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(in[c]), _mm_loadu_ps(column)));
+            }
+            // Padding lanes hold zeros and spill into the next frame's
+            // outputs, which are written after them; the last frame stops short
+            if (out + o + 4 <= end) {
+                _mm_storeu_ps(out + o, sum);
+            } else {
+                float lanes[4];
+                _mm_storeu_ps(lanes, sum);
+                std::memcpy(out + o, lanes, static_cast<size_t>(end - (out + o)) * sizeof(float));
+            }
+#else
+            const int lanes = std::min(4, m_outputs - o);
+            for (int lane = 0; lane < lanes; ++lane) {
+                float sum = 0.0f;
+                for (int c = 0; c < m_inputs; ++c) {
+                    sum += in[c] * column[static_cast<size_t>(c) * m_paddedOutputs + lane];
+                }
+                out[o + lane] = sum;
+            }
+#endif
+        }
+    }
+}
+
+void ChannelMatrix::mixDefault(const float* input, int inputChannels,
+                               float* output, int outputChannels, size_t frames) {
+    if (inputChannels == outputChannels) {
+        if (input != output) {
+            std::memcpy(output, input, frames * outputChannels * sizeof(float));
+        }
+    } else if (inputChannels == 1 && outputChannels == 2) {
+        monoToStereo(input, output, frames);
+    } else if (inputChannels == 2 && outputChannels == 1) {
+        stereoToMono(input, output, frames);
+    } else {
+        // Copy what both sides have, zero any extra output channels
+        const int minChannels = std::min(inputChannels, outputChannels);
+        for (size_t i = 0; i < frames; ++i) {
+            for (int ch = 0; ch < minChannels; ++ch) {
+                output[i * outputChannels + ch] = input[i * inputChannels + ch];
+            }
+            for (int ch = minChannels; ch < outputChannels; ++ch) {
+                output[i * outputChannels + ch] = 0.0f;
+            }
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef CHANNELMATRIX_H
+#define CHANNELMATRIX_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * ChannelMatrix - Interleaved channel up/down-mix
+ *
+ * Computes out[o] = sum over i of gain(o, i) * in[i] for every frame. The
+ * default matrix for a pair of channel counts does what the engine has
+ * always done: mono is duplicated to stereo, stereo to mono is averaged,
+ * and any other pair maps channels one to one, leaving extra outputs
+ * silent. Identity, mono-to-stereo and stereo-to-mono use dedicated SSE
+ * kernels. Any other matrix broadcasts each input sample against its
+ * column of gains, four outputs per SSE vector.
+ */
+class ChannelMatrix {
+public:
+    ChannelMatrix(int inputChannels = 2, int outputChannels = 2);
+
+    // Resets to the default matrix for these channel counts
+    void setDefault(int inputChannels, int outputChannels);
+    void setGain(int output, int input, float gain);
+    float getGain(int output, int input) const;
+
+    int getInputChannels() const { return m_inputs; }
+    int getOutputChannels() const { return m_outputs; }
+    bool isIdentity() const { return m_kind == Kind::Identity; }
+
+    // Allocation-free for audio callbacks. Input and output must not overlap
+    // unless the matrix is an identity
+    void process(const float* input, float* output, size_t frames) const;
+
+    // The default matrix without building one
+    static void mixDefault(const float* input, int inputChannels,
+                           float* output, int outputChannels, size_t frames);
+
+private:
+    enum class Kind {
+        Identity,
+        MonoToStereo,
+        StereoToMono,
+        General
+    };
+
+    void rebuild();
+    void processGeneral(const float* input, float* output, size_t frames) const;
+
+    int m_inputs = 2;
+    int m_outputs = 2;
+    std::vector<float> m_gains;    // row per output
+    Kind m_kind = Kind::Identity;
+    int m_paddedOutputs = 4;       // m_outputs rounded up to a whole vector
+    std::vector<float> m_columns;  // column per input, m_paddedOutputs gains each
+};
+
+#endif // CHANNELMATRIX_H
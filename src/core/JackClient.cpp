@@ -0,0 +1,242 @@
+#include "JackClient.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+
+#ifdef HAVE_JACK
+#include <jack/jack.h>
+#endif
+
+JackClient::JackClient() {
+}
+
+JackClient::~JackClient() {
+    close();
+}
+
+double JackClient::getInputLatency() const {
+    int rate = getSampleRate();
+    return rate > 0 ? double(m_inputLatencyFrames.load(std::memory_order_relaxed)) / rate : 0.0;
+}
+
+double JackClient::getOutputLatency() const {
+    int rate = getSampleRate();
+    return rate > 0 ? double(m_outputLatencyFrames.load(std::memory_order_relaxed)) / rate : 0.0;
+}
+
+void JackClient::notify(Event event) {
+    if (m_notify) {
+        m_notify(event, m_userData);
+    }
+}
+
+#ifdef HAVE_JACK
+
+namespace {
+jack_client_t* asClient(void* client) { return static_cast<jack_client_t*>(client); }
+jack_port_t* asPort(void* port) { return static_cast<jack_port_t*>(port); }
+} // namespace
+
+bool JackClient::isAvailable() {
+    return true;
+}
+
+bool JackClient::open(const QString& clientName, int channels,
+                      ProcessCallback process, NotifyCallback notify, void* userData) {
+    close();
+    m_error.clear();
+
+    jack_status_t status;
+    jack_client_t* client = jack_client_open(clientName.toUtf8().constData(), JackNoStartServer, &status);
+    if (!client) {
+        m_error = QString("Cannot connect to JACK server (status 0x%1)").arg(int(status), 0, 16);
+        return false;
+    }
+    m_client = client;
+    m_channels = std::max(1, channels);
+    m_process = process;
+    m_notify = notify;
+    m_userData = userData;
+
+    for (int ch = 0; ch < m_channels; ++ch) {
+        QByteArray inName = QString("in_%1").arg(ch + 1).toUtf8();
+        QByteArray outName = QString("out_%1").arg(ch + 1).toUtf8();
+        jack_port_t* in = jack_port_register(client, inName.constData(), JACK_DEFAULT_AUDIO_TYPE, JackPortIsInput, 0);
+        jack_port_t* out = jack_port_register(client, outName.constData(), JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
+        if (!in || !out) {
+            m_error = "Cannot register JACK ports";
+            close();
+            return false;
+        }
+        m_inputPorts.push_back(in);
+        m_outputPorts.push_back(out);
+    }
+    m_inputBuffers.assign(m_channels, nullptr);
+    m_outputBuffers.assign(m_channels, nullptr);
+
+    m_sampleRate.store(static_cast<int>(jack_get_sample_rate(client)), std::memory_order_relaxed);
+    m_bufferSize.store(jack_get_buffer_size(client), std::memory_order_relaxed);
+
+    // Captureless lambdas keep libjack's types out of the header
+    jack_set_process_callback(client, [](jack_nframes_t frames, void* arg) {
+        static_cast<JackClient*>(arg)->process(frames);
+        return 0;
+    }, this);
+
+    jack_set_buffer_size_callback(client, [](jack_nframes_t frames, void* arg) {
+        auto* self = static_cast<JackClient*>(arg);
+        self->m_bufferSize.store(frames, std::memory_order_relaxed);
+        self->notify(Event::BufferSizeChanged);
+        return 0;
+    }, this);
+
+    jack_set_sample_rate_callback(client, [](jack_nframes_t rate, void* arg) {
+        auto* self = static_cast<JackClient*>(arg);
+        if (static_cast<int>(rate) != self->getSampleRate()) {
+            self->m_sampleRate.store(static_cast<int>(rate), std::memory_order_relaxed);
+            self->notify(Event::SampleRateChanged);
+        }
+        return 0;
+    }, this);
+
+    jack_set_latency_callback(client, [](jack_latency_callback_mode_t, void* arg) {
+        auto* self = static_cast<JackClient*>(arg);
+        self->updateLatency();
+        self->notify(Event::LatencyChanged);
+    }, this);
+
+    jack_set_xrun_callback(client, [](void* arg) {
+        auto* self = static_cast<JackClient*>(arg);
+        self->m_xruns.fetch_add(1, std::memory_order_relaxed);
+        self->m_xrunPending.store(true, std::memory_order_release);
+        return 0;
+    }, this);
+
+    jack_on_shutdown(client, [](void* arg) {
+        static_cast<JackClient*>(arg)->notify(Event::Shutdown);
+    }, this);
+
+    LOG_INFO(QString("JACK client '%1' opened: %2 Hz, period %3 frames, %4 channels")
+        .arg(QString::fromUtf8(jack_get_client_name(client)))
+        .arg(getSampleRate()).arg(getBufferSize()).arg(m_channels));
+    return true;
+}
+
+bool JackClient::activate(bool connectPhysical) {
+    if (!m_client) {
+        return false;
+    }
+    if (jack_activate(asClient(m_client)) != 0) {
+        m_error = "Cannot activate JACK client";
+        return false;
+    }
+    if (connectPhysical) {
+        connectPhysicalPorts();
+    }
+    updateLatency();
+    return true;
+}
+
+void JackClient::close() {
+    if (!m_client) {
+        return;
+    }
+    jack_deactivate(asClient(m_client));
+    jack_client_close(asClient(m_client));
+    m_client = nullptr;
+    m_inputPorts.clear();
+    m_outputPorts.clear();
+    m_inputBuffers.clear();
+    m_outputBuffers.clear();
+    m_xrunPending.store(false, std::memory_order_relaxed);
+}
+
+void JackClient::process(uint32_t frames) {
+    for (int ch = 0; ch < m_channels; ++ch) {
+        m_inputBuffers[ch] = static_cast<const float*>(jack_port_get_buffer(asPort(m_inputPorts[ch]), frames));
+        m_outputBuffers[ch] = static_cast<float*>(jack_port_get_buffer(asPort(m_outputPorts[ch]), frames));
+    }
+    bool xrun = m_xrunPending.exchange(false, std::memory_order_acq_rel);
+    m_process(m_inputBuffers.data(), m_outputBuffers.data(), frames, xrun, m_userData);
+}
+
+void JackClient::connectPhysicalPorts() {
+    jack_client_t* client = asClient(m_client);
+
+    // Physical capture ports are outputs from JACK's point of view, and vice versa
+    if (const char** sources = jack_get_ports(client, nullptr, JACK_DEFAULT_AUDIO_TYPE,
+                                              JackPortIsPhysical | JackPortIsOutput)) {
+        for (int ch = 0; ch < m_channels && sources[ch]; ++ch) {
+            jack_connect(client, sources[ch], jack_port_name(asPort(m_inputPorts[ch])));
+        }
+        jack_free(sources);
+    } else {
+        LOG_WARNING("JACK: no physical capture ports to connect");
+    }
+
+    if (const char** sinks = jack_get_ports(client, nullptr, JACK_DEFAULT_AUDIO_TYPE,
+                                            JackPortIsPhysical | JackPortIsInput)) {
+        // Channels map 1:1; a mono client feeds the first two playback ports
+        const int count = (m_channels == 1) ? 2 : m_channels;
+        for (int ch = 0; ch < count && sinks[ch]; ++ch) {
+            jack_connect(client, jack_port_name(asPort(m_outputPorts[std::min(ch, m_channels - 1)])), sinks[ch]);
+        }
+        jack_free(sinks);
+    } else {
+        LOG_WARNING("JACK: no physical playback ports to connect");
+    }
+}
+
+void JackClient::updateLatency() {
+    // Largest upstream capture latency and downstream playback latency over our ports
+    jack_nframes_t input = 0;
+    jack_nframes_t output = 0;
+    for (void* port : m_inputPorts) {
+        jack_latency_range_t range;
+        jack_port_get_latency_range(asPort(port), JackCaptureLatency, &range);
+        input = std::max(input, range.max);
+    }
+    for (void* port : m_outputPorts) {
+        jack_latency_range_t range;
+        jack_port_get_latency_range(asPort(port), JackPlaybackLatency, &range);
+        output = std::max(output, range.max);
+    }
+    m_inputLatencyFrames.store(input, std::memory_order_relaxed);
+    m_outputLatencyFrames.store(output, std::memory_order_relaxed);
+}
+
+#else
+
+bool JackClient::isAvailable() {
+    return false;
+}
+
+bool JackClient::open(const QString& clientName, int channels,
+                      ProcessCallback process, NotifyCallback notify, void* userData) {
+    (void)clientName;
+    (void)channels;
+    (void)process;
+    (void)notify;
+    (void)userData;
+    m_error = "Built without JACK support (define HAVE_JACK and link libjack)";
+    return false;
+}
+
+bool JackClient::activate(bool connectPhysical) {
+    (void)connectPhysical;
+    return false;
+}
+
+void JackClient::close() {
+}
+
+void JackClient::process(uint32_t frames) {
+    (void)frames;
+}
+
+void JackClient::connectPhysicalPorts() {
+}
+
+void JackClient::updateLatency() {
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef JACKCLIENT_H
+#define JACKCLIENT_H
+
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * JackClient - JACK / PipeWire-JACK client with non-interleaved ports
+ *
+ * Registers one input and one output port per channel and passes the
+ * server's own port buffers to the process callback, so DSP runs on them
+ * directly with no interleave round trip. The server owns the sample rate
+ * and period size; the client adopts both and reports the latency of the
+ * ports it is actually connected to.
+ *
+ * Built against libjack only when HAVE_JACK is defined; without it open()
+ * fails and isAvailable() returns false.
+ */
+class JackClient {
+public:
+    enum class Event {
+        BufferSizeChanged,
+        SampleRateChanged,
+        LatencyChanged,
+        Shutdown
+    };
+
+    // Process thread: planar port buffers, one pointer per channel
+    using ProcessCallback = void (*)(const float* const* inputs, float* const* outputs,
+                                     uint32_t frames, bool xrun, void* userData);
+    // JACK notification thread, never concurrent with a process call
+    using NotifyCallback = void (*)(Event event, void* userData);
+
+    JackClient();
+    ~JackClient();
+
+    static bool isAvailable();
+
+    // Register the client and its ports (not real-time safe)
+    bool open(const QString& clientName, int channels,
+              ProcessCallback process, NotifyCallback notify, void* userData);
+    // Start processing, optionally wiring ports to the physical system ports
+    bool activate(bool connectPhysical);
+    void close();
+    bool isOpen() const { return m_client != nullptr; }
+
+    int getChannels() const { return m_channels; }
+    int getSampleRate() const { return m_sampleRate.load(std::memory_order_relaxed); }
+    uint32_t getBufferSize() const { return m_bufferSize.load(std::memory_order_relaxed); }
+
+    // Worst-case latency of the connected ports in seconds
+    double getInputLatency() const;
+    double getOutputLatency() const;
+
+    uint64_t getXrunCount() const { return m_xruns.load(std::memory_order_relaxed); }
+    const QString& getError() const { return m_error; }
+
+private:
+    void process(uint32_t frames);
+    void connectPhysicalPorts();
+    void updateLatency();
+    void notify(Event event);
+
+    void* m_client = nullptr;  // jack_client_t
+    std::vector<void*> m_inputPorts;
+    std::vector<void*> m_outputPorts;
+    std::vector<const float*> m_inputBuffers;
+    std::vector<float*> m_outputBuffers;
+    int m_channels = 0;
+
+    ProcessCallback m_process = nullptr;
+    NotifyCallback m_notify = nullptr;
+    void* m_userData = nullptr;
+
+    std::atomic<int> m_sampleRate{0};
+    std::atomic<uint32_t> m_bufferSize{0};
+    std::atomic<uint32_t> m_inputLatencyFrames{0};
+    std::atomic<uint32_t> m_outputLatencyFrames{0};
+    std::atomic<bool> m_xrunPending{false};
+    std::atomic<uint64_t> m_xruns{0};
+
+    QString m_error;
+};
+
+#endif // JACKCLIENT_H
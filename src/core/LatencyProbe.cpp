@@ -0,0 +1,353 @@
+#include "LatencyProbe.h"
+#include "../dsp/RealFFT.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+constexpr double kMinPeakToNoiseDb = 15.0;
+
+// Feedback taps (1-based bit positions) of maximal-length Fibonacci LFSRs
+constexpr int kMlsTaps[][2] = {
+    {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0},
+    {5, 3}, {6, 5}, {7, 6}, {8, 6}, {9, 5}, {10, 7},
+    {11, 9}, {12, 11}, {13, 12}, {14, 13}, {15, 14}, {16, 15}
+};
+// Orders 8, 12, 13, 14 and 16 need four taps
+constexpr int kMlsExtraTaps[][2] = {
+    {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0},
+    {0, 0}, {0, 0}, {0, 0}, {5, 4}, {0, 0}, {0, 0},
+    {0, 0}, {10, 4}, {11, 8}, {12, 2}, {0, 0}, {13, 4}
+};
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    const size_t n = values.size();
+    return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+/**
+ * Correlator - Cross-correlation with one reference through the FFT
+ *
+ * The transform covers reference length + maxLag frames, so the circular
+ * correlation never wraps for the lags asked for. The reference spectrum
+ * is computed once; each window then costs one forward and one inverse
+ * FFT instead of (maxLag + 1) * length multiply-adds.
+ */
+class Correlator {
+public:
+    Correlator(const std::vector<float>& reference, size_t maxLag)
+        : m_fft(static_cast<int>(reference.size() + maxLag))
+        , m_maxLag(maxLag)
+    {
+        const int size = m_fft.getSize();
+        const int bins = m_fft.getBinCount();
+        m_padded.assign(size, 0.0f);
+        m_referenceRe.resize(bins);
+        m_referenceIm.resize(bins);
+        m_re.resize(bins);
+        m_im.resize(bins);
+
+        std::copy(reference.begin(), reference.end(), m_padded.begin());
+        m_fft.forward(m_padded.data(), m_referenceRe.data(), m_referenceIm.data());
+        m_windowFrames = reference.size() + maxLag;
+    }
+
+    // |correlation| of the reference with window[lag...] for lags [0, maxLag];
+    // the window holds reference length + maxLag frames
+    void correlate(const float* window, std::vector<double>& correlation) {
+        std::copy(window, window + m_windowFrames, m_padded.begin());
+        std::fill(m_padded.begin() + m_windowFrames, m_padded.end(), 0.0f);
+        m_fft.forward(m_padded.data(), m_re.data(), m_im.data());
+
+        // conj(R) * X
+        for (size_t k = 0; k < m_re.size(); ++k) {
+            const float xr = m_re[k], xi = m_im[k];
+            const float rr = m_referenceRe[k], ri = m_referenceIm[k];
+            m_re[k] = rr * xr + ri * xi;
+            m_im[k] = rr * xi - ri * xr;
+        }
+        m_fft.inverse(m_re.data(), m_im.data(), m_padded.data());
+
+        correlation.resize(m_maxLag + 1);
+        for (size_t lag = 0; lag <= m_maxLag; ++lag) {
+            correlation[lag] = std::fabs(double(m_padded[lag]));
+        }
+    }
+
+private:
+    RealFFT m_fft;
+    size_t m_maxLag;
+    size_t m_windowFrames = 0;
+    std::vector<float> m_padded;
+    std::vector<float> m_referenceRe;
+    std::vector<float> m_referenceIm;
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+};
+}
+
+LatencyProbe::LatencyProbe() {
+}
+
+void LatencyProbe::setSampleRate(int sampleRate) {
+    m_sampleRate = std::max(1, sampleRate);
+    resetTiming();
+}
+
+std::vector<float> LatencyProbe::generateMls(int order) {
+    order = std::clamp(order, 5, 16);
+    const uint32_t length = (1u << order) - 1;
+    const int* taps = kMlsTaps[order];
+    const int* extra = kMlsExtraTaps[order];
+
+    std::vector<float> sequence(length);
+    uint32_t state = 1;
+    for (uint32_t i = 0; i < length; ++i) {
+        sequence[i] = (state & 1u) ? 1.0f : -1.0f;
+        uint32_t bit = ((state >> (order - taps[0])) ^ (state >> (order - taps[1])));
+        if (extra[0] != 0) {
+            bit ^= (state >> (order - extra[0])) ^ (state >> (order - extra[1]));
+        }
+        state = (state >> 1) | ((bit & 1u) << (order - 1));
+    }
+    return sequence;
+}
+
+bool LatencyProbe::start(const LatencyProbeOptions& options) {
+    if (isActive()) {
+        return false;
+    }
+    cancel();  // make sure the audio thread is out of the buffers
+
+    m_options = options;
+    m_options.repetitions = std::max(1, m_options.repetitions);
+    m_mls = generateMls(m_options.mlsOrder);
+
+    const size_t maxLag = static_cast<size_t>(std::max(0.01, m_options.maxLatencySeconds) * m_sampleRate);
+    m_periodFrames = m_mls.size() + maxLag;
+    m_capture.assign(m_periodFrames * m_options.repetitions, 0.0f);
+    m_position = 0;
+
+    m_state.store(Running, std::memory_order_release);
+    return true;
+}
+
+void LatencyProbe::cancel() {
+    m_state.store(Idle);
+    while (m_inBlock.load()) {
+        std::this_thread::yield();
+    }
+}
+
+float LatencyProbe::nextProbeSample(float input) {
+    if (m_position >= m_capture.size()) {
+        return input;
+    }
+
+    m_capture[m_position] = input;
+    const size_t phase = m_position % m_periodFrames;
+    const float output = phase < m_mls.size() ? m_mls[phase] * m_options.amplitude : 0.0f;
+
+    if (++m_position == m_capture.size()) {
+        m_state.store(Complete, std::memory_order_release);
+    }
+    return output;
+}
+
+void LatencyProbe::processBlock(float* interleaved, int channels, unsigned long frames) {
+    // Flag first, then check: cancel() either sees the flag or we see Idle
+    m_inBlock.store(true);
+    if (m_state.load() == Running) {
+        for (unsigned long i = 0; i < frames; ++i) {
+            float* frame = interleaved + i * channels;
+            const float sample = nextProbeSample(frame[0]);
+            for (int ch = 0; ch < channels; ++ch) {
+                frame[ch] = sample;
+            }
+        }
+    }
+    m_inBlock.store(false);
+}
+
+void LatencyProbe::processBlock(float* const* planar, int channels, unsigned long frames) {
+    m_inBlock.store(true);
+    if (m_state.load() == Running) {
+        for (unsigned long i = 0; i < frames; ++i) {
+            const float sample = nextProbeSample(planar[0][i]);
+            for (int ch = 0; ch < channels; ++ch) {
+                planar[ch][i] = sample;
+            }
+        }
+    }
+    m_inBlock.store(false);
+}
+
+double LatencyProbe::findPeak(const std::vector<double>& correlation, double* peakToNoiseDb) {
+    const size_t maxLag = correlation.size() - 1;
+    const size_t peak = static_cast<size_t>(std::max_element(correlation.begin(), correlation.end())
+                                            - correlation.begin());
+
+    // Parabolic interpolation around the peak for the fractional part
+    double offset = 0.0;
+    if (peak > 0 && peak < maxLag) {
+        const double a = correlation[peak - 1];
+        const double b = correlation[peak];
+        const double c = correlation[peak + 1];
+        const double denominator = a - 2.0 * b + c;
+        if (denominator < 0.0) {
+            offset = std::clamp(0.5 * (a - c) / denominator, -0.5, 0.5);
+        }
+    }
+
+    if (peakToNoiseDb) {
+        double noise = 0.0;
+        size_t count = 0;
+        for (size_t lag = 0; lag <= maxLag; ++lag) {
+            if (lag + 2 < peak || lag > peak + 2) {
+                noise += correlation[lag] * correlation[lag];
+                ++count;
+            }
+        }
+        noise = count > 0 ? std::sqrt(noise / count) : 0.0;
+        *peakToNoiseDb = noise > 0.0 ? 20.0 * std::log10(correlation[peak] / noise) : 300.0;
+    }
+    return double(peak) + offset;
+}
+
+LatencyMeasurement LatencyProbe::analyze(const std::function<void(float*, int)>& processor) const {
+    LatencyMeasurement result;
+    result.sampleRate = m_sampleRate;
+    if (getState() != Complete) {
+        result.error = "No completed measurement";
+        return result;
+    }
+
+    const size_t maxLag = m_periodFrames - m_mls.size();
+    const double msPerFrame = 1000.0 / m_sampleRate;
+
+    Correlator correlator(m_mls, maxLag);
+    std::vector<double> correlation;
+
+    result.peakToNoiseDb = 300.0;
+    for (int rep = 0; rep < m_options.repetitions; ++rep) {
+        double peakToNoise = 0.0;
+        correlator.correlate(m_capture.data() + rep * m_periodFrames, correlation);
+        const double lag = findPeak(correlation, &peakToNoise);
+        result.roundTripFrames.push_back(lag);
+        result.peakToNoiseDb = std::min(result.peakToNoiseDb, peakToNoise);
+    }
+
+    if (result.peakToNoiseDb < kMinPeakToNoiseDb) {
+        result.error = "No loopback signal found on the input (peak " +
+                       std::to_string(static_cast<int>(std::lround(result.peakToNoiseDb))) + " dB above noise)";
+        return result;
+    }
+
+    const auto range = std::minmax_element(result.roundTripFrames.begin(), result.roundTripFrames.end());
+    result.roundTripMs = median(result.roundTripFrames) * msPerFrame;
+    result.minRoundTripMs = *range.first * msPerFrame;
+    result.maxRoundTripMs = *range.second * msPerFrame;
+
+    if (processor) {
+        std::vector<float> burst(m_periodFrames, 0.0f);
+        for (size_t i = 0; i < m_mls.size(); ++i) {
+            burst[i] = m_mls[i] * m_options.amplitude;
+        }
+        processor(burst.data(), static_cast<int>(burst.size()));
+        correlator.correlate(burst.data(), correlation);
+        result.dspLatencyMs = findPeak(correlation, nullptr) * msPerFrame;
+    }
+
+    result.valid = true;
+    return result;
+}
+
+void LatencyProbe::recordTiming(double currentTime, double inputAdcTime, double outputDacTime,
+                                unsigned long frames) {
+    if (m_timingResetRequested.exchange(false, std::memory_order_acquire)) {
+        m_timing = TimingAccumulator();
+    }
+
+    TimingAccumulator& t = m_timing;
+    ++t.callbacks;
+
+    // Hosts without timestamps report zeros; input-only streams have no DAC time
+    if (currentTime != 0.0 && inputAdcTime != 0.0) {
+        const double blockSeconds = double(frames) / m_sampleRate;
+
+        if (t.timedCallbacks > 0) {
+            // A callback is due one block after the last; its ADC time moves by the previous block
+            const double interval = currentTime - t.lastCurrentTime;
+            const double adcError = (inputAdcTime - t.lastAdcTime) - t.lastFrames / m_sampleRate;
+            t.intervalSum += interval;
+            t.intervalSquares += (interval - blockSeconds) * (interval - blockSeconds);
+            t.maxIntervalDeviation = std::max(t.maxIntervalDeviation, std::fabs(interval - blockSeconds));
+            t.adcSum += adcError;
+            t.adcSquares += adcError * adcError;
+            t.maxAdcDeviation = std::max(t.maxAdcDeviation, std::fabs(adcError));
+            ++t.steps;
+        }
+
+        const double wakeup = currentTime - (inputAdcTime + blockSeconds);
+        t.wakeupSum += wakeup;
+        t.maxWakeup = t.timedCallbacks > 0 ? std::max(t.maxWakeup, wakeup) : wakeup;
+
+        if (outputDacTime != 0.0) {
+            const double loop = outputDacTime - inputAdcTime;
+            t.loopSum += loop;
+            t.minLoop = t.loopCallbacks > 0 ? std::min(t.minLoop, loop) : loop;
+            t.maxLoop = t.loopCallbacks > 0 ? std::max(t.maxLoop, loop) : loop;
+            ++t.loopCallbacks;
+        }
+
+        t.lastCurrentTime = currentTime;
+        t.lastAdcTime = inputAdcTime;
+        t.lastFrames = double(frames);
+        ++t.timedCallbacks;
+    }
+
+    // Never wait for a reader; the next callback publishes instead
+    std::unique_lock<std::mutex> lock(m_timingMutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+        m_publishedTiming = t;
+    }
+}
+
+CallbackTiming LatencyProbe::getTiming() const {
+    TimingAccumulator t;
+    {
+        std::lock_guard<std::mutex> lock(m_timingMutex);
+        t = m_publishedTiming;
+    }
+
+    CallbackTiming timing;
+    timing.callbacks = t.callbacks;
+    timing.timestampsAvailable = t.timedCallbacks > 0;
+    if (t.steps > 0) {
+        const double n = double(t.steps);
+        const double meanAdc = t.adcSum / n;
+        timing.meanIntervalMs = t.intervalSum / n * 1000.0;
+        timing.intervalJitterMs = std::sqrt(t.intervalSquares / n) * 1000.0;
+        timing.maxIntervalDeviationMs = t.maxIntervalDeviation * 1000.0;
+        timing.adcJitterMs = std::sqrt(std::max(0.0, t.adcSquares / n - meanAdc * meanAdc)) * 1000.0;
+        timing.maxAdcDeviationMs = t.maxAdcDeviation * 1000.0;
+    }
+    if (t.timedCallbacks > 0) {
+        const double n = double(t.timedCallbacks);
+        timing.meanWakeupMs = t.wakeupSum / n * 1000.0;
+        timing.maxWakeupMs = t.maxWakeup * 1000.0;
+    }
+    if (t.loopCallbacks > 0) {
+        timing.meanDeviceLoopMs = t.loopSum / double(t.loopCallbacks) * 1000.0;
+        timing.minDeviceLoopMs = t.minLoop * 1000.0;
+        timing.maxDeviceLoopMs = t.maxLoop * 1000.0;
+    }
+    return timing;
+}
+
+void LatencyProbe::resetTiming() {
+    std::lock_guard<std::mutex> lock(m_timingMutex);
+    m_publishedTiming = TimingAccumulator();
+    m_timingResetRequested.store(true, std::memory_order_release);
+}
@@ -0,0 +1,146 @@
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct LatencyProbeOptions {
+    int mlsOrder = 12;               // sequence length 2^order - 1 (4095 frames)
+    float amplitude = 0.25f;         // -12 dBFS
+    double maxLatencySeconds = 0.5;  // search window after each burst
+    int repetitions = 3;
+};
+
+struct LatencyMeasurement {
+    bool valid = false;
+    std::string error;
+    int sampleRate = 0;
+
+    // Loop through the app: output buffer -> device -> loopback -> input buffer,
+    // including the DSP (the burst is injected ahead of it)
+    std::vector<double> roundTripFrames;  // one per repetition, sub-sample
+    double roundTripMs = 0.0;             // median
+    double minRoundTripMs = 0.0;
+    double maxRoundTripMs = 0.0;
+
+    double dspLatencyMs = 0.0;            // group delay at the DSP's correlation peak
+    double peakToNoiseDb = 0.0;           // weakest repetition; below ~15 dB means no loopback
+
+    double getDeviceRoundTripMs() const { return roundTripMs - dspLatencyMs; }
+};
+
+// Callback arrival statistics from the host timestamps
+struct CallbackTiming {
+    uint64_t callbacks = 0;
+    bool timestampsAvailable = false;    // false when the host reports zeros
+
+    double meanIntervalMs = 0.0;         // currentTime between callbacks
+    double intervalJitterMs = 0.0;       // RMS deviation of that interval from the block length
+    double maxIntervalDeviationMs = 0.0; // worst |interval - frames/rate|
+
+    double adcJitterMs = 0.0;            // standard deviation of ADC time steps vs frames/rate
+    double maxAdcDeviationMs = 0.0;
+
+    double meanWakeupMs = 0.0;           // currentTime - end of the captured block
+    double maxWakeupMs = 0.0;
+
+    double meanDeviceLoopMs = 0.0;       // outputBufferDacTime - inputBufferAdcTime (duplex only)
+    double minDeviceLoopMs = 0.0;
+    double maxDeviceLoopMs = 0.0;
+};
+
+/**
+ * LatencyProbe - Loopback round-trip measurement and callback jitter tracking
+ *
+ * While armed, the audio thread replaces the signal going into the DSP with
+ * maximum-length-sequence bursts (silence in between) and records what comes
+ * back on the input. The control thread then cross-correlates each burst
+ * with its capture window through the FFT; the peak lag is the real round
+ * trip in frames, refined to a fraction of a sample. Needs an output wired back to the
+ * input (cable or virtual loopback) while it runs.
+ *
+ * recordTiming() keeps running statistics of the host's timeInfo on every
+ * callback, so jitter and the driver's own latency view are available
+ * without a measurement.
+ *
+ * start()/analyze() allocate and run on the control thread; processBlock()
+ * and recordTiming() are real-time safe.
+ */
+class LatencyProbe {
+public:
+    enum State {
+        Idle,
+        Running,
+        Complete
+    };
+
+    LatencyProbe();
+
+    // Control thread, before the stream starts; also clears the timing statistics
+    void setSampleRate(int sampleRate);
+    int getSampleRate() const { return m_sampleRate; }
+
+    // Control thread
+    bool start(const LatencyProbeOptions& options);
+    void cancel();
+    State getState() const { return static_cast<State>(m_state.load(std::memory_order_acquire)); }
+    bool isActive() const { return getState() == Running; }
+
+    // Correlates the captured bursts. 'processor' (optional) runs a burst through
+    // a fresh copy of the DSP, in place, to separate its delay from the device loop.
+    LatencyMeasurement analyze(const std::function<void(float*, int)>& processor = nullptr) const;
+
+    CallbackTiming getTiming() const;
+    void resetTiming();
+
+    // Audio thread: record the incoming block, then overwrite it with the probe signal
+    void processBlock(float* interleaved, int channels, unsigned long frames);
+    void processBlock(float* const* planar, int channels, unsigned long frames);
+
+    // Audio thread, once per device callback, with the host's timeInfo fields
+    void recordTiming(double currentTime, double inputAdcTime, double outputDacTime,
+                      unsigned long frames);
+
+    static std::vector<float> generateMls(int order);
+
+private:
+    float nextProbeSample(float input);
+
+    // Sub-sample lag of the largest |correlation|, from lag 0
+    static double findPeak(const std::vector<double>& correlation, double* peakToNoiseDb);
+
+    std::atomic<int> m_state{Idle};
+    std::atomic<bool> m_inBlock{false};  // audio thread is touching the buffers
+    LatencyProbeOptions m_options;
+    int m_sampleRate = 48000;
+
+    std::vector<float> m_mls;        // +/-1
+    std::vector<float> m_capture;    // repetitions * period frames
+    size_t m_periodFrames = 0;
+    size_t m_position = 0;           // audio thread only while running
+
+    // Running timing sums, audio thread only; published with try_lock
+    struct TimingAccumulator {
+        uint64_t callbacks = 0;
+        uint64_t timedCallbacks = 0;
+        double lastCurrentTime = 0.0;
+        double lastAdcTime = 0.0;
+        double lastFrames = 0.0;
+        double intervalSum = 0.0, intervalSquares = 0.0, maxIntervalDeviation = 0.0;
+        double adcSum = 0.0, adcSquares = 0.0, maxAdcDeviation = 0.0;
+        uint64_t steps = 0;
+        double wakeupSum = 0.0, maxWakeup = 0.0;
+        uint64_t loopCallbacks = 0;
+        double loopSum = 0.0, minLoop = 0.0, maxLoop = 0.0;
+    };
+    TimingAccumulator m_timing;
+    TimingAccumulator m_publishedTiming;
+    mutable std::mutex m_timingMutex;
+    std::atomic<bool> m_timingResetRequested{false};
+};
+
+#endif // LATENCYPROBE_H
@@ -0,0 +1,182 @@
+#include "LevelMeter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LEVELMETER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+// ITU-R BS.1770-4 Annex 2 4x interpolator, transposed: row j weights the
+// j-th oldest of the last 12 input samples for each of the four phases
+alignas(16) const float kPhaseCoeffs[12][4] = {
+    {-0.0083007812500f, -0.0189208984375f, -0.0291748046875f, 0.0017089843750f},
+    {0.0148925781250f, 0.0330810546875f, 0.0292968750000f, 0.0109863281250f},
+    {-0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f},
+    {0.0476074218750f, 0.1015625000000f, 0.0891113281250f, 0.0332031250000f},
+    {-0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f},
+    {0.9721679687500f, 0.7797851562500f, 0.4650878906250f, 0.1373291015625f},
+    {0.1373291015625f, 0.4650878906250f, 0.7797851562500f, 0.9721679687500f},
+    {-0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f},
+    {0.0332031250000f, 0.0891113281250f, 0.1015625000000f, 0.0476074218750f},
+    {-0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f},
+    {0.0109863281250f, 0.0292968750000f, 0.0330810546875f, 0.0148925781250f},
+    {0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f},
+};
+
+// Largest |y| over the four interpolated points ending at window[11]
+inline float interpolatedPeak(const float* window) {
+#ifdef LEVELMETER_SSE2
+    // Three independent sums keep the add chain short
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps();
+    for (int j = 0; j < 12; j += 3) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_load_ps(kPhaseCoeffs[j]), _mm_set1_ps(window[j])));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_load_ps(kPhaseCoeffs[j + 1]), _mm_set1_ps(window[j + 1])));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_load_ps(kPhaseCoeffs[j + 2]), _mm_set1_ps(window[j + 2])));
+    }
+    __m128 acc = _mm_add_ps(_mm_add_ps(acc0, acc1), acc2);
+    acc = _mm_andnot_ps(_mm_set1_ps(-0.0f), acc);
+    acc = _mm_max_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_max_ss(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(acc);
+#else
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int j = 0; j < 12; ++j) {
+        for (int p = 0; p < 4; ++p) {
+            acc[p] += kPhaseCoeffs[j][p] * window[j];
+        }
+    }
+    return std::max(std::max(std::fabs(acc[0]), std::fabs(acc[1])),
+                    std::max(std::fabs(acc[2]), std::fabs(acc[3])));
+#endif
+}
+} // namespace
+
+float LevelReading::toDecibels(float level) {
+    return level > 0.0f ? 20.0f * std::log10(level) : -std::numeric_limits<float>::infinity();
+}
+
+LevelMeter::LevelMeter() {
+    for (int ch = 0; ch < kMaxChannels; ++ch) {
+        m_publishedRms[ch].store(0.0f, std::memory_order_relaxed);
+        m_publishedPeak[ch].store(0.0f, std::memory_order_relaxed);
+        m_publishedTruePeak[ch].store(0.0f, std::memory_order_relaxed);
+        m_publishedMaxTruePeak[ch].store(0.0f, std::memory_order_relaxed);
+    }
+    prepare(48000);
+}
+
+void LevelMeter::prepare(int sampleRate) {
+    m_windowFrames = std::max<size_t>(1, static_cast<size_t>(sampleRate * kWindowSeconds));
+    m_windowPosition = 0;
+    m_channels = 0;
+    m_sumSquares.fill(0.0);
+    m_peak.fill(0.0f);
+    m_truePeak.fill(0.0f);
+    m_maxTruePeak.fill(0.0f);
+    m_windows = 0;
+    std::memset(m_history, 0, sizeof(m_history));
+    m_historyPos = 0;
+    m_resetHold.store(false, std::memory_order_relaxed);
+    publish();
+}
+
+void LevelMeter::process(const float* const* channels, int numChannels, size_t frames, size_t stride) {
+    numChannels = std::clamp(numChannels, 0, kMaxChannels);
+    m_channels = numChannels;
+
+    size_t offset = 0;
+    while (offset < frames) {
+        const size_t chunk = std::min(frames - offset, m_windowFrames - m_windowPosition);
+
+        // Block-local accumulators stay in registers; the window totals are updated once per chunk
+        float sumSquares[kMaxChannels] = {};
+        float peak[kMaxChannels] = {};
+        float truePeak[kMaxChannels] = {};
+        int historyPos = m_historyPos;
+
+        for (size_t i = offset; i < offset + chunk; ++i) {
+            for (int ch = 0; ch < numChannels; ++ch) {
+                const float x = channels[ch][i * stride];
+                sumSquares[ch] += x * x;
+                peak[ch] = std::max(peak[ch], std::fabs(x));
+
+                float* history = m_history[ch];
+                history[historyPos] = x;
+                history[historyPos + kTaps] = x;
+                truePeak[ch] = std::max(truePeak[ch], interpolatedPeak(history + historyPos + 1));
+            }
+            historyPos = historyPos + 1 < kTaps ? historyPos + 1 : 0;
+        }
+
+        m_historyPos = historyPos;
+        for (int ch = 0; ch < numChannels; ++ch) {
+            m_sumSquares[ch] += sumSquares[ch];
+            m_peak[ch] = std::max(m_peak[ch], peak[ch]);
+            m_truePeak[ch] = std::max(m_truePeak[ch], truePeak[ch]);
+        }
+
+        offset += chunk;
+        m_windowPosition += chunk;
+        if (m_windowPosition == m_windowFrames) {
+            publish();
+            m_windowPosition = 0;
+            m_sumSquares.fill(0.0);
+            m_peak.fill(0.0f);
+            m_truePeak.fill(0.0f);
+        }
+    }
+}
+
+void LevelMeter::publish() {
+    if (m_resetHold.exchange(false, std::memory_order_relaxed)) {
+        m_maxTruePeak.fill(0.0f);
+    }
+
+    const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const double frames = m_windowPosition > 0 ? static_cast<double>(m_windowPosition) : 1.0;
+    for (int ch = 0; ch < m_channels; ++ch) {
+        m_maxTruePeak[ch] = std::max(m_maxTruePeak[ch], m_truePeak[ch]);
+        m_publishedRms[ch].store(static_cast<float>(std::sqrt(m_sumSquares[ch] / frames)),
+                                 std::memory_order_relaxed);
+        m_publishedPeak[ch].store(m_peak[ch], std::memory_order_relaxed);
+        m_publishedTruePeak[ch].store(m_truePeak[ch], std::memory_order_relaxed);
+        m_publishedMaxTruePeak[ch].store(m_maxTruePeak[ch], std::memory_order_relaxed);
+    }
+    m_publishedChannels.store(m_channels, std::memory_order_relaxed);
+    m_publishedWindows.store(m_windows++, std::memory_order_relaxed);
+
+    m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+LevelReading LevelMeter::read() const {
+    LevelReading reading;
+    for (;;) {
+        const uint32_t before = m_sequence.load(std::memory_order_acquire);
+        if (before & 1u) {
+            continue;  // a publish is a few dozen stores; just retry
+        }
+
+        reading.channels = m_publishedChannels.load(std::memory_order_relaxed);
+        for (int ch = 0; ch < reading.channels; ++ch) {
+            reading.rms[ch] = m_publishedRms[ch].load(std::memory_order_relaxed);
+            reading.peak[ch] = m_publishedPeak[ch].load(std::memory_order_relaxed);
+            reading.truePeak[ch] = m_publishedTruePeak[ch].load(std::memory_order_relaxed);
+            reading.maxTruePeak[ch] = m_publishedMaxTruePeak[ch].load(std::memory_order_relaxed);
+        }
+        reading.windows = m_publishedWindows.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) == before) {
+            return reading;
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef LEVELMETER_H
+#define LEVELMETER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// One metering window; levels are linear (1.0 = full scale)
+struct LevelReading {
+    static constexpr int kMaxChannels = 8;
+
+    int channels = 0;
+    std::array<float, kMaxChannels> rms{};
+    std::array<float, kMaxChannels> peak{};
+    std::array<float, kMaxChannels> truePeak{};     // 4x oversampled, BS.1770 interpolator
+    std::array<float, kMaxChannels> maxTruePeak{};  // held since the last resetPeakHold()
+    uint64_t windows = 0;                           // unchanged between reads means no new data
+
+    // -inf for silence
+    static float toDecibels(float level);
+};
+
+/**
+ * LevelMeter - Per-channel RMS, sample peak and true-peak for the audio thread
+ *
+ * process() makes one pass over a block: per sample it updates the sum of
+ * squares and |x| maximum and runs the 4x polyphase interpolator, whose
+ * four phases are one SSE multiply-add per tap. Every kWindowSeconds the
+ * window is published through a seqlock of relaxed atomics, so read() on
+ * any thread never blocks the writer and never returns a torn window.
+ * Nothing is allocated or locked after prepare(), so it can stay on.
+ */
+class LevelMeter {
+public:
+    static constexpr int kMaxChannels = LevelReading::kMaxChannels;
+    static constexpr double kWindowSeconds = 0.05;
+
+    LevelMeter();
+
+    // Clears all state; not safe while process() may run
+    void prepare(int sampleRate);
+
+    // Audio thread. Frame i of channel c is channels[c][i * stride]; channels past kMaxChannels are ignored
+    void process(const float* const* channels, int numChannels, size_t frames, size_t stride);
+
+    // Any thread
+    LevelReading read() const;
+    void resetPeakHold() { m_resetHold.store(true, std::memory_order_relaxed); }
+
+private:
+    static constexpr int kTaps = 12;  // per phase
+
+    void publish();
+
+    // Audio thread state
+    int m_channels = 0;
+    size_t m_windowFrames = 2400;
+    size_t m_windowPosition = 0;
+    std::array<double, kMaxChannels> m_sumSquares{};
+    std::array<float, kMaxChannels> m_peak{};
+    std::array<float, kMaxChannels> m_truePeak{};
+    std::array<float, kMaxChannels> m_maxTruePeak{};
+    uint64_t m_windows = 0;
+
+    // Interpolator input, stored twice back to back so the last kTaps samples
+    // are always contiguous at m_history[ch][m_historyPos + 1 ..]
+    alignas(16) float m_history[kMaxChannels][2 * kTaps];
+    int m_historyPos = 0;
+
+    std::atomic<bool> m_resetHold{false};
+
+    // Seqlock: odd while a window is being written
+    std::atomic<uint32_t> m_sequence{0};
+    std::atomic<int> m_publishedChannels{0};
+    std::array<std::atomic<float>, kMaxChannels> m_publishedRms;
+    std::array<std::atomic<float>, kMaxChannels> m_publishedPeak;
+    std::array<std::atomic<float>, kMaxChannels> m_publishedTruePeak;
+    std::array<std::atomic<float>, kMaxChannels> m_publishedMaxTruePeak;
+    std::atomic<uint64_t> m_publishedWindows{0};
+};
+
+#endif // LEVELMETER_H
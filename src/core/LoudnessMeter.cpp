@@ -0,0 +1,270 @@
+#include "LoudnessMeter.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+
+double toLoudness(double meanSquare) {
+    return meanSquare > 0.0 ? -0.691 + 10.0 * std::log10(meanSquare)
+                            : -std::numeric_limits<double>::infinity();
+}
+
+// BS.1770 K-weighting (high shelf, then RLB high-pass), derived for any rate
+// so it matches the published 48 kHz coefficients
+std::vector<Parameters::FilterCoeffs> kWeighting(int sampleRate) {
+    std::vector<Parameters::FilterCoeffs> stages(2);
+
+    double f0 = 1681.974450955533;
+    double q = 0.7071752369554196;
+    double k = std::tan(kPi * f0 / sampleRate);
+    const double vh = std::pow(10.0, 3.999843853973347 / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    stages[0].b0 = (vh + vb * k / q + k * k) / a0;
+    stages[0].b1 = 2.0 * (k * k - vh) / a0;
+    stages[0].b2 = (vh - vb * k / q + k * k) / a0;
+    stages[0].a1 = 2.0 * (k * k - 1.0) / a0;
+    stages[0].a2 = (1.0 - k / q + k * k) / a0;
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(kPi * f0 / sampleRate);
+    a0 = 1.0 + k / q + k * k;
+    stages[1].b0 = 1.0;
+    stages[1].b1 = -2.0;
+    stages[1].b2 = 1.0;
+    stages[1].a1 = 2.0 * (k * k - 1.0) / a0;
+    stages[1].a2 = (1.0 - k / q + k * k) / a0;
+
+    return stages;
+}
+} // namespace
+
+void LoudnessMeter::Histogram::clear() {
+    count.fill(0);
+    energy.fill(0.0);
+    gatedCount = 0;
+    gatedEnergy = 0.0;
+    gateBin = 0;
+    aboveCount = 0;
+    aboveEnergy = 0.0;
+}
+
+void LoudnessMeter::Histogram::add(double meanSquare, double relativeGate) {
+    const double loudness = toLoudness(meanSquare);
+    if (!(loudness > kHistogramFloor)) {
+        return;  // absolute gate
+    }
+
+    const int bin = binFor(loudness);
+    ++count[bin];
+    energy[bin] += meanSquare;
+    ++gatedCount;
+    gatedEnergy += meanSquare;
+    if (bin >= gateBin) {
+        ++aboveCount;
+        aboveEnergy += meanSquare;
+    }
+
+    // The gate follows the gated mean, which moves by a bin or two per block at most
+    const int target = binFor(toLoudness(gatedEnergy / gatedCount) + relativeGate);
+    while (gateBin < target) {
+        aboveCount -= count[gateBin];
+        aboveEnergy -= energy[gateBin];
+        ++gateBin;
+    }
+    while (gateBin > target) {
+        --gateBin;
+        aboveCount += count[gateBin];
+        aboveEnergy += energy[gateBin];
+    }
+}
+
+LoudnessMeter::LoudnessMeter() {
+    prepare(48000);
+}
+
+int LoudnessMeter::binFor(double loudness) {
+    const double bin = std::floor((loudness - kHistogramFloor) / kBinWidth);
+    return static_cast<int>(std::clamp(bin, 0.0, static_cast<double>(kBins - 1)));
+}
+
+void LoudnessMeter::prepare(int sampleRate) {
+    m_weighting.setCoefficients(kWeighting(sampleRate));
+    m_channels = 0;
+    m_blockFrames = std::max<size_t>(1, static_cast<size_t>(std::lround(sampleRate * kBlockSeconds)));
+    m_blockPosition = 0;
+    m_blockSum = 0.0;
+
+    m_recent.fill(0.0);
+    m_recentPos = 0;
+    m_blocks = 0;
+
+    m_integrated.clear();
+    m_shortTerm.clear();
+    m_momentary = toLoudness(0.0);
+    m_shortTermValue = toLoudness(0.0);
+    m_maxMomentary = toLoudness(0.0);
+    m_maxShortTerm = toLoudness(0.0);
+    m_range = 0.0;
+    m_resetIntegrated.store(false, std::memory_order_relaxed);
+    publish();
+}
+
+void LoudnessMeter::process(const float* const* channels, int numChannels, size_t frames, size_t stride) {
+    numChannels = std::clamp(numChannels, 0, kMaxChannels);
+    if (numChannels == 0) {
+        return;
+    }
+    m_channels = numChannels;
+
+    size_t offset = 0;
+    while (offset < frames) {
+        const size_t chunk = std::min({frames - offset, static_cast<size_t>(kChunkFrames),
+                                       m_blockFrames - m_blockPosition});
+        const int n = static_cast<int>(chunk);
+
+        for (int ch = 0; ch < numChannels; ++ch) {
+            const float* src = channels[ch] + offset * stride;
+            float* dst = m_scratch[ch];
+            for (int i = 0; i < n; ++i) {
+                dst[i] = src[i * stride];
+            }
+        }
+
+        if (numChannels == 2) {
+            m_weighting.process(m_scratch[0], m_scratch[1], n);
+        } else {
+            m_weighting.processMono(m_scratch[0], n);
+        }
+
+        // Both channels weigh 1.0, so the block energy is the plain sum
+        double sum = 0.0;
+        for (int ch = 0; ch < numChannels; ++ch) {
+            const float* weighted = m_scratch[ch];
+            float partial = 0.0f;
+            for (int i = 0; i < n; ++i) {
+                partial += weighted[i] * weighted[i];
+            }
+            sum += partial;
+        }
+        m_blockSum += sum;
+
+        offset += chunk;
+        m_blockPosition += chunk;
+        if (m_blockPosition == m_blockFrames) {
+            endBlock();
+        }
+    }
+}
+
+void LoudnessMeter::endBlock() {
+    if (m_resetIntegrated.exchange(false, std::memory_order_relaxed)) {
+        m_integrated.clear();
+        m_shortTerm.clear();
+        m_maxMomentary = toLoudness(0.0);
+        m_maxShortTerm = toLoudness(0.0);
+        m_range = 0.0;
+    }
+
+    m_recent[m_recentPos] = m_blockSum / static_cast<double>(m_blockFrames);
+    m_recentPos = m_recentPos + 1 < kShortTermBlocks ? m_recentPos + 1 : 0;
+    ++m_blocks;
+    m_blockSum = 0.0;
+    m_blockPosition = 0;
+
+    // Windows average the newest blocks; until they fill, the missing blocks count as silence
+    double momentary = 0.0;
+    double shortTerm = 0.0;
+    for (int age = 0; age < kShortTermBlocks; ++age) {
+        const double meanSquare = m_recent[(m_recentPos + kShortTermBlocks - 1 - age) % kShortTermBlocks];
+        if (age < kMomentaryBlocks) {
+            momentary += meanSquare;
+        }
+        shortTerm += meanSquare;
+    }
+    momentary /= kMomentaryBlocks;
+    shortTerm /= kShortTermBlocks;
+    m_momentary = toLoudness(momentary);
+    m_shortTermValue = toLoudness(shortTerm);
+
+    if (m_blocks >= kMomentaryBlocks) {
+        m_maxMomentary = std::max(m_maxMomentary, m_momentary);
+        m_integrated.add(momentary, -10.0);
+    }
+    if (m_blocks >= kShortTermBlocks) {
+        m_maxShortTerm = std::max(m_maxShortTerm, m_shortTermValue);
+        m_shortTerm.add(shortTerm, -20.0);
+        computeRange();
+    }
+
+    publish();
+}
+
+void LoudnessMeter::computeRange() {
+    // 10th to 95th percentile of the gated short-term values, walked up from the gate
+    const uint64_t total = m_shortTerm.aboveCount;
+    if (total == 0) {
+        m_range = 0.0;
+        return;
+    }
+    const uint64_t lowRank = std::max<uint64_t>(1, (total * 10 + 99) / 100);
+    const uint64_t highRank = std::max<uint64_t>(1, (total * 95 + 99) / 100);
+
+    uint64_t seen = 0;
+    int lowBin = -1;
+    for (int bin = m_shortTerm.gateBin; bin < kBins; ++bin) {
+        seen += m_shortTerm.count[bin];
+        if (lowBin < 0 && seen >= lowRank) {
+            lowBin = bin;
+        }
+        if (seen >= highRank) {
+            m_range = (bin - lowBin) * kBinWidth;
+            return;
+        }
+    }
+}
+
+void LoudnessMeter::publish() {
+    const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const double integrated = m_integrated.aboveCount > 0
+        ? toLoudness(m_integrated.aboveEnergy / m_integrated.aboveCount)
+        : toLoudness(0.0);
+    m_publishedMomentary.store(static_cast<float>(m_momentary), std::memory_order_relaxed);
+    m_publishedShortTerm.store(static_cast<float>(m_shortTermValue), std::memory_order_relaxed);
+    m_publishedIntegrated.store(static_cast<float>(integrated), std::memory_order_relaxed);
+    m_publishedRange.store(static_cast<float>(m_range), std::memory_order_relaxed);
+    m_publishedMaxMomentary.store(static_cast<float>(m_maxMomentary), std::memory_order_relaxed);
+    m_publishedMaxShortTerm.store(static_cast<float>(m_maxShortTerm), std::memory_order_relaxed);
+    m_publishedBlocks.store(m_blocks, std::memory_order_relaxed);
+
+    m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+LoudnessReading LoudnessMeter::read() const {
+    LoudnessReading reading;
+    for (;;) {
+        const uint32_t before = m_sequence.load(std::memory_order_acquire);
+        if (before & 1u) {
+            continue;
+        }
+
+        reading.momentary = m_publishedMomentary.load(std::memory_order_relaxed);
+        reading.shortTerm = m_publishedShortTerm.load(std::memory_order_relaxed);
+        reading.integrated = m_publishedIntegrated.load(std::memory_order_relaxed);
+        reading.range = m_publishedRange.load(std::memory_order_relaxed);
+        reading.maxMomentary = m_publishedMaxMomentary.load(std::memory_order_relaxed);
+        reading.maxShortTerm = m_publishedMaxShortTerm.load(std::memory_order_relaxed);
+        reading.blocks = m_publishedBlocks.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) == before) {
+            return reading;
+        }
+    }
+}
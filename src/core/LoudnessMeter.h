@@ -0,0 +1,109 @@
+#ifndef LOUDNESSMETER_H
+#define LOUDNESSMETER_H
+
+#include "../dsp/FilterBank.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// EBU R128 values in LUFS (range in LU); -inf until enough audio was measured
+struct LoudnessReading {
+    float momentary = 0.0f;     // 400 ms
+    float shortTerm = 0.0f;     // 3 s
+    float integrated = 0.0f;    // gated, since prepare() or resetIntegrated()
+    float range = 0.0f;         // LRA, EBU Tech 3342
+    float maxMomentary = 0.0f;
+    float maxShortTerm = 0.0f;
+    uint64_t blocks = 0;        // 100 ms blocks measured; unchanged between reads means no new data
+};
+
+/**
+ * LoudnessMeter - Streaming EBU R128 / ITU-R BS.1770-4 loudness
+ *
+ * Audio is K-weighted by a FilterBank in chunks and reduced to the
+ * mean square of each 100 ms block. Momentary and short-term loudness
+ * average the last 4 and 30 blocks. Every 400 ms gating block (75%
+ * overlap) goes into a 0.1 LU histogram that also keeps its energy. The
+ * relative gate is a bin index that moves with the gated mean, so the
+ * integrated value costs O(1) per block however long the session runs.
+ * LRA scans the short-term histogram at most once per block. Results are
+ * published through a seqlock like LevelMeter's.
+ */
+class LoudnessMeter {
+public:
+    static constexpr int kMaxChannels = 2;  // FilterBank is stereo; both channels weigh 1.0
+    static constexpr double kBlockSeconds = 0.1;
+
+    LoudnessMeter();
+
+    // Clears all state and recomputes the K-weighting; allocates, not safe while process() may run
+    void prepare(int sampleRate);
+
+    // Audio thread. Frame i of channel c is channels[c][i * stride]; channels past kMaxChannels are ignored
+    void process(const float* const* channels, int numChannels, size_t frames, size_t stride);
+
+    // Any thread
+    LoudnessReading read() const;
+    void resetIntegrated() { m_resetIntegrated.store(true, std::memory_order_relaxed); }
+
+private:
+    static constexpr int kChunkFrames = 256;
+    static constexpr int kMomentaryBlocks = 4;
+    static constexpr int kShortTermBlocks = 30;
+    static constexpr double kHistogramFloor = -70.0;  // absolute gate, LUFS
+    static constexpr double kBinWidth = 0.1;          // LU
+    static constexpr int kBins = 800;                 // -70 .. +10 LUFS; louder lands in the top bin
+
+    struct Histogram {
+        std::array<uint32_t, kBins> count{};
+        std::array<double, kBins> energy{};
+        uint64_t gatedCount = 0;    // everything above the absolute gate
+        double gatedEnergy = 0.0;
+        int gateBin = 0;            // first bin at or above the relative gate
+        uint64_t aboveCount = 0;    // bins from gateBin up
+        double aboveEnergy = 0.0;
+
+        void clear();
+        void add(double meanSquare, double relativeGate);
+    };
+
+    static int binFor(double loudness);
+    void endBlock();
+    void computeRange();
+    void publish();
+
+    // Audio thread state
+    FilterBank m_weighting;
+    int m_channels = 0;
+    size_t m_blockFrames = 4800;
+    size_t m_blockPosition = 0;
+    double m_blockSum = 0.0;
+    alignas(16) float m_scratch[kMaxChannels][kChunkFrames];
+
+    std::array<double, kShortTermBlocks> m_recent{};  // mean squares of the last blocks, ring
+    int m_recentPos = 0;
+    uint64_t m_blocks = 0;
+
+    Histogram m_integrated;  // 400 ms gating blocks, relative gate -10 LU
+    Histogram m_shortTerm;   // 3 s values for LRA, relative gate -20 LU
+    double m_momentary = 0.0;
+    double m_shortTermValue = 0.0;
+    double m_maxMomentary = 0.0;
+    double m_maxShortTerm = 0.0;
+    double m_range = 0.0;
+
+    std::atomic<bool> m_resetIntegrated{false};
+
+    // Seqlock: odd while a block is being written
+    std::atomic<uint32_t> m_sequence{0};
+    std::atomic<float> m_publishedMomentary{0.0f};
+    std::atomic<float> m_publishedShortTerm{0.0f};
+    std::atomic<float> m_publishedIntegrated{0.0f};
+    std::atomic<float> m_publishedRange{0.0f};
+    std::atomic<float> m_publishedMaxMomentary{0.0f};
+    std::atomic<float> m_publishedMaxShortTerm{0.0f};
+    std::atomic<uint64_t> m_publishedBlocks{0};
+};
+
+#endif // LOUDNESSMETER_H
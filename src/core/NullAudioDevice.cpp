@@ -0,0 +1,275 @@
+#include "NullAudioDevice.h"
+#include "../offline/MappedWavFile.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+constexpr double kTwoPi = 6.283185307179586;
+}
+
+NullAudioDevice::NullAudioDevice() {
+}
+
+NullAudioDevice::~NullAudioDevice() {
+    stop();
+}
+
+bool NullAudioDevice::open(const NullDeviceOptions& options, int sampleRate, int inputChannels, int outputChannels,
+                           PaStreamCallback* callback, void* userData) {
+    stop();
+    m_error.clear();
+
+    m_options = options;
+    m_options.blockFrames = std::max(1, m_options.blockFrames);
+    m_options.blockVariation = std::clamp(m_options.blockVariation, 0, m_options.blockFrames - 1);
+    m_sampleRate = sampleRate;
+    m_inputChannels = std::max(1, inputChannels);
+    m_outputChannels = std::max(1, outputChannels);
+    m_callback = callback;
+    m_userData = userData;
+
+    m_random.seed(m_options.seed);
+    m_phase = 0.0;
+    m_filePosition = 0;
+    m_fileSamples.clear();
+    m_loopback.clear();
+
+    if (m_options.source == NullDeviceOptions::Source::File && !loadFile()) {
+        return false;
+    }
+
+    if (m_options.source == NullDeviceOptions::Source::Loopback) {
+        // A block can only hear output from blocks already delivered
+        const int maxFrames = m_options.blockFrames + m_options.blockVariation;
+        m_loopbackDelay = static_cast<uint64_t>(std::max(m_options.loopbackFrames, maxFrames));
+        m_loopback.assign((m_loopbackDelay + maxFrames) * m_inputChannels, 0.0f);
+    }
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats = NullDeviceStats();
+    m_stats.sampleRate = m_sampleRate;
+    return true;
+}
+
+bool NullAudioDevice::loadFile() {
+    MappedWavReader reader;
+    if (!reader.open(m_options.filePath)) {
+        m_error = reader.getError();
+        return false;
+    }
+
+    const WavFormat& format = reader.getFormat();
+    const size_t frames = static_cast<size_t>(reader.getTotalFrames());
+    if (frames == 0) {
+        m_error = "Source file has no audio: " + m_options.filePath;
+        return false;
+    }
+    if (format.sampleRate != m_sampleRate) {
+        LOG_WARNING("Null device source is " + std::to_string(format.sampleRate) + " Hz, played at "
+                    + std::to_string(m_sampleRate) + " Hz without resampling");
+    }
+
+    std::vector<float> samples(frames * format.channels);
+    reader.read(0, samples.data(), frames);
+
+    // Map onto the device's input channels (mono is duplicated, extras dropped)
+    m_fileSamples.resize(frames * m_inputChannels);
+    for (size_t i = 0; i < frames; ++i) {
+        for (int ch = 0; ch < m_inputChannels; ++ch) {
+            m_fileSamples[i * m_inputChannels + ch] = samples[i * format.channels + std::min(ch, format.channels - 1)];
+        }
+    }
+    return true;
+}
+
+bool NullAudioDevice::start() {
+    if (!m_callback) {
+        m_error = "Null device not opened";
+        return false;
+    }
+    if (isRunning()) {
+        return true;
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();  // previous run finished on its own
+    }
+
+    m_stopRequested.store(false, std::memory_order_relaxed);
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&NullAudioDevice::run, this);
+    return true;
+}
+
+void NullAudioDevice::stop() {
+    m_stopRequested.store(true, std::memory_order_relaxed);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_running.store(false, std::memory_order_release);
+}
+
+NullDeviceStats NullAudioDevice::getStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
+void NullAudioDevice::fillInput(float* input, uint64_t streamFrame, int frames) {
+    const size_t count = static_cast<size_t>(frames) * m_inputChannels;
+
+    switch (m_options.source) {
+    case NullDeviceOptions::Source::Silence:
+        std::fill(input, input + count, 0.0f);
+        break;
+
+    case NullDeviceOptions::Source::Sine: {
+        const double step = kTwoPi * m_options.sineFrequency / m_sampleRate;
+        for (int i = 0; i < frames; ++i) {
+            const float sample = m_options.amplitude * static_cast<float>(std::sin(m_phase));
+            for (int ch = 0; ch < m_inputChannels; ++ch) {
+                input[i * m_inputChannels + ch] = sample;
+            }
+            m_phase = std::fmod(m_phase + step, kTwoPi);
+        }
+        break;
+    }
+
+    case NullDeviceOptions::Source::Noise: {
+        std::uniform_real_distribution<float> noise(-m_options.amplitude, m_options.amplitude);
+        for (size_t i = 0; i < count; ++i) {
+            input[i] = noise(m_random);
+        }
+        break;
+    }
+
+    case NullDeviceOptions::Source::File:
+        for (size_t i = 0; i < count; ++i) {
+            input[i] = m_fileSamples[m_filePosition];
+            m_filePosition = (m_filePosition + 1) % m_fileSamples.size();
+        }
+        break;
+
+    case NullDeviceOptions::Source::Loopback: {
+        const uint64_t ringFrames = m_loopback.size() / m_inputChannels;
+        for (int i = 0; i < frames; ++i) {
+            const uint64_t frame = streamFrame + i;
+            for (int ch = 0; ch < m_inputChannels; ++ch) {
+                input[i * m_inputChannels + ch] = frame >= m_loopbackDelay
+                    ? m_loopback[((frame - m_loopbackDelay) % ringFrames) * m_inputChannels + ch] : 0.0f;
+            }
+        }
+        break;
+    }
+    }
+}
+
+void NullAudioDevice::storeLoopback(const float* output, uint64_t streamFrame, int frames) {
+    if (m_loopback.empty()) {
+        return;
+    }
+
+    // Output channels map onto input channels like a mono/stereo cable; dropped blocks are silent
+    const uint64_t ringFrames = m_loopback.size() / m_inputChannels;
+    for (int i = 0; i < frames; ++i) {
+        float* frame = &m_loopback[((streamFrame + i) % ringFrames) * m_inputChannels];
+        for (int ch = 0; ch < m_inputChannels; ++ch) {
+            frame[ch] = output ? output[i * m_outputChannels + std::min(ch, m_outputChannels - 1)] : 0.0f;
+        }
+    }
+}
+
+void NullAudioDevice::run() {
+    using Clock = std::chrono::steady_clock;
+
+    const int maxFrames = m_options.blockFrames + m_options.blockVariation;
+    std::vector<float> input(static_cast<size_t>(maxFrames) * m_inputChannels);
+    std::vector<float> output(static_cast<size_t>(maxFrames) * m_outputChannels);
+
+    const uint64_t totalFrames = m_options.durationSeconds > 0.0
+        ? static_cast<uint64_t>(std::llround(m_options.durationSeconds * m_sampleRate))
+        : 0;
+
+    std::uniform_int_distribution<int> variation(-m_options.blockVariation, m_options.blockVariation);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    const Clock::time_point begin = Clock::now();
+    uint64_t streamFrames = 0;  // device clock, including dropped blocks
+    PaStreamCallbackFlags pendingFlags = 0;
+
+    while (!m_stopRequested.load(std::memory_order_relaxed)) {
+        if (totalFrames > 0 && streamFrames >= totalFrames) {
+            break;
+        }
+
+        int frames = m_options.blockFrames + (m_options.blockVariation > 0 ? variation(m_random) : 0);
+        if (totalFrames > 0) {
+            frames = static_cast<int>(std::min<uint64_t>(frames, totalFrames - streamFrames));
+        }
+        const double blockSeconds = double(frames) / m_sampleRate;
+        const double streamSeconds = double(streamFrames) / m_sampleRate;
+
+        // A block is delivered once its last input frame has been "captured"
+        Clock::time_point deadline = begin + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(streamSeconds + blockSeconds));
+        if (m_options.paced) {
+            Clock::time_point wake = deadline;
+            if (m_options.jitterMs > 0.0) {
+                wake += std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double, std::milli>(unit(m_random) * m_options.jitterMs));
+            }
+            std::this_thread::sleep_until(wake);
+        }
+
+        const uint64_t blockStart = streamFrames;
+        fillInput(input.data(), blockStart, frames);
+        streamFrames += frames;
+
+        // Injected xrun: the block is lost and the next callback carries the flags
+        if (m_options.xrunProbability > 0.0 && unit(m_random) < m_options.xrunProbability) {
+            storeLoopback(nullptr, blockStart, frames);
+            pendingFlags = paInputOverflow | paOutputUnderflow;
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            ++m_stats.xruns;
+            continue;
+        }
+
+        // Paced runs report the real wake-up time, so injected jitter shows in the timestamps
+        PaStreamCallbackTimeInfo timeInfo;
+        timeInfo.currentTime = m_options.paced ? std::chrono::duration<double>(Clock::now() - begin).count()
+                                               : streamSeconds + blockSeconds;
+        timeInfo.inputBufferAdcTime = streamSeconds;
+        timeInfo.outputBufferDacTime = streamSeconds + 2.0 * blockSeconds;
+
+        const Clock::time_point callStart = Clock::now();
+        int result = m_callback(input.data(), output.data(), static_cast<unsigned long>(frames),
+                                &timeInfo, pendingFlags, m_userData);
+        const Clock::time_point callEnd = Clock::now();
+        pendingFlags = 0;
+        storeLoopback(output.data(), blockStart, frames);
+
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            const double callSeconds = std::chrono::duration<double>(callEnd - callStart).count();
+            ++m_stats.callbacks;
+            m_stats.frames += frames;
+            m_stats.callbackSeconds += callSeconds;
+            m_stats.maxCallbackMs = std::max(m_stats.maxCallbackMs, callSeconds * 1000.0);
+            m_stats.wallSeconds = std::chrono::duration<double>(callEnd - begin).count();
+            // Output for this block is due one block after it was delivered
+            if (m_options.paced && callEnd > deadline + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(blockSeconds))) {
+                ++m_stats.missedDeadlines;
+            }
+        }
+
+        if (result != paContinue) {
+            break;
+        }
+    }
+
+    m_running.store(false, std::memory_order_release);
+    if (!m_stopRequested.load(std::memory_order_relaxed) && m_finishedHandler) {
+        m_finishedHandler();
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef NULLAUDIODEVICE_H
+#define NULLAUDIODEVICE_H
+
+#include <portaudio.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct NullDeviceOptions {
+    enum class Source {
+        Silence,
+        Sine,
+        Noise,
+        File,     // WAV loaded up front and looped
+        Loopback  // the callback's own output, returned loopbackFrames later
+    };
+
+    Source source = Source::Sine;
+    std::string filePath;
+    double sineFrequency = 1000.0;
+    float amplitude = 0.5f;
+    int loopbackFrames = 0;         // Loopback delay; raised to at least one block
+
+    int blockFrames = 0;            // 0 uses the engine buffer size
+    int blockVariation = 0;         // +/- frames per callback, like shared-mode hosts
+    bool paced = false;             // true: real-time schedule, false: as fast as possible
+    double jitterMs = 0.0;          // paced only: random late wake-up of up to this much
+    double xrunProbability = 0.0;   // per block: drop it and flag the next callback
+    double durationSeconds = 0.0;   // 0 runs until stopped
+    uint32_t seed = 1;
+};
+
+struct NullDeviceStats {
+    uint64_t callbacks = 0;
+    uint64_t frames = 0;
+    uint64_t xruns = 0;             // injected
+    uint64_t missedDeadlines = 0;   // paced callbacks that returned after their output was due
+    double wallSeconds = 0.0;
+    double callbackSeconds = 0.0;   // time spent inside the callback
+    double maxCallbackMs = 0.0;
+    int sampleRate = 0;
+
+    double getAudioSeconds() const { return sampleRate > 0 ? double(frames) / sampleRate : 0.0; }
+    double getRealtimeFactor() const { return callbackSeconds > 0.0 ? getAudioSeconds() / callbackSeconds : 0.0; }
+};
+
+/**
+ * NullAudioDevice - Virtual full-duplex device for headless runs
+ *
+ * Drives a PortAudio-style stream callback from its own thread with a
+ * generated or file-backed input, either on a real-time schedule or as
+ * fast as the callback returns. Block sizes, wake-up jitter and xruns are
+ * drawn from a seeded generator, so a run is reproducible. Output is
+ * discarded, or fed back to the input with a known delay in Loopback mode
+ * (for testing latency measurement); only timing statistics are kept.
+ */
+class NullAudioDevice {
+public:
+    NullAudioDevice();
+    ~NullAudioDevice();
+
+    bool open(const NullDeviceOptions& options, int sampleRate, int inputChannels, int outputChannels,
+              PaStreamCallback* callback, void* userData);
+    bool start();
+    void stop();
+
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    // Called on the device thread when the duration elapses or the callback completes
+    void setFinishedHandler(std::function<void()> handler) { m_finishedHandler = std::move(handler); }
+
+    NullDeviceStats getStats() const;
+    const std::string& getError() const { return m_error; }
+
+private:
+    void run();
+    void fillInput(float* input, uint64_t streamFrame, int frames);
+    void storeLoopback(const float* output, uint64_t streamFrame, int frames);
+    bool loadFile();
+
+    NullDeviceOptions m_options;
+    int m_sampleRate = 48000;
+    int m_inputChannels = 2;
+    int m_outputChannels = 2;
+    PaStreamCallback* m_callback = nullptr;
+    void* m_userData = nullptr;
+
+    std::vector<float> m_fileSamples;  // interleaved at m_inputChannels
+    size_t m_filePosition = 0;
+    double m_phase = 0.0;
+    std::vector<float> m_loopback;     // past output by stream frame, interleaved at m_inputChannels
+    uint64_t m_loopbackDelay = 0;
+    std::mt19937 m_random;  // block sizes, jitter, xruns and noise
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stopRequested{false};
+    std::function<void()> m_finishedHandler;
+
+    mutable std::mutex m_statsMutex;
+    NullDeviceStats m_stats;
+
+    std::string m_error;
+};
+
+#endif // NULLAUDIODEVICE_H
@@ -0,0 +1,353 @@
+#include "SampleConverter.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAMPLECONVERTER_SSE2 1
+#include <emmintrin.h>
+#if defined(__SSSE3__) || defined(__AVX__)
+#define SAMPLECONVERTER_SSSE3 1
+#include <tmmintrin.h>
+#endif
+#endif
+
+namespace {
+constexpr float kScale16 = 1.0f / 32768.0f;
+constexpr float kScale24 = 1.0f / 8388608.0f;
+constexpr float kScale32 = 1.0f / 2147483648.0f;
+
+// NaN maps to -1, the same as the SSE min/max sequence below
+inline float clampUnit(float x) {
+    float v = x > -1.0f ? x : -1.0f;
+    return v < 1.0f ? v : 1.0f;
+}
+
+inline int32_t load24(const uint8_t* p) {
+    return static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 8) | (static_cast<uint32_t>(p[1]) << 16) |
+                                (static_cast<uint32_t>(p[2]) << 24)) >> 8;
+}
+
+inline void store24(uint8_t* p, int32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+}
+
+inline int32_t quantize24(float x) {
+    return static_cast<int32_t>(std::lrint(static_cast<double>(clampUnit(x)) * 8388607.0));
+}
+
+inline int32_t quantize32(float x) {
+    return static_cast<int32_t>(std::lrint(static_cast<double>(clampUnit(x)) * 2147483647.0));
+}
+
+inline uint32_t xorshift(uint32_t x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    return x ^ (x << 5);
+}
+
+// Uniform in [1, 2) from the top 23 bits
+inline float unitFloat(uint32_t x) {
+    const uint32_t bits = (x >> 9) | 0x3F800000u;
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// Difference of two uniforms: triangular in (-1, 1) LSB; advances the lane twice
+inline float tpdf(uint32_t& lane) {
+    const uint32_t a = xorshift(lane);
+    lane = xorshift(a);
+    return unitFloat(a) - unitFloat(lane);
+}
+
+inline int16_t quantize16Dithered(float x, float dither) {
+    const long v = std::lrint(clampUnit(x) * 32767.0f + dither);
+    return static_cast<int16_t>(v < -32768 ? -32768 : (v > 32767 ? 32767 : v));
+}
+
+inline int32_t quantize24Dithered(float x, float dither) {
+    double v = static_cast<double>(clampUnit(x)) * 8388607.0 + static_cast<double>(dither);
+    v = v > -8388608.0 ? v : -8388608.0;
+    v = v < 8388607.0 ? v : 8388607.0;
+    return static_cast<int32_t>(std::lrint(v));
+}
+
+#ifdef SAMPLECONVERTER_SSE2
+inline __m128 clampUnit4(__m128 x) {
+    return _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+}
+
+// Four floats to int32 at the given full-scale, rounded in double precision
+inline __m128i quantizeWide4(__m128 x, double scale) {
+    const __m128d s = _mm_set1_pd(scale);
+    x = clampUnit4(x);
+    __m128i lo = _mm_cvtpd_epi32(_mm_mul_pd(_mm_cvtps_pd(x), s));
+    __m128i hi = _mm_cvtpd_epi32(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), s));
+    return _mm_unpacklo_epi64(lo, hi);
+}
+
+inline __m128i xorshift4(__m128i x) {
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    return _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+}
+
+inline __m128 unitFloat4(__m128i x) {
+    return _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(x, 9), _mm_set1_epi32(0x3F800000)));
+}
+
+// Same sequence as tpdf() on each lane
+inline __m128 tpdf4(__m128i& lanes) {
+    const __m128i a = xorshift4(lanes);
+    lanes = xorshift4(a);
+    return _mm_sub_ps(unitFloat4(a), unitFloat4(lanes));
+}
+
+// Dither is added in double and the result clamped to the 24-bit range before rounding
+inline __m128i quantize24Dithered4(__m128 x, __m128 dither) {
+    const __m128d scale = _mm_set1_pd(8388607.0);
+    const __m128d lo = _mm_set1_pd(-8388608.0);
+    const __m128d hi = _mm_set1_pd(8388607.0);
+    x = clampUnit4(x);
+    __m128d a = _mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(x), scale), _mm_cvtps_pd(dither));
+    __m128d b = _mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), scale),
+                           _mm_cvtps_pd(_mm_movehl_ps(dither, dither)));
+    a = _mm_min_pd(_mm_max_pd(a, lo), hi);
+    b = _mm_min_pd(_mm_max_pd(b, lo), hi);
+    return _mm_unpacklo_epi64(_mm_cvtpd_epi32(a), _mm_cvtpd_epi32(b));
+}
+#endif
+} // namespace
+
+void SampleConverter::Dither::reset(uint32_t seed) {
+    // xorshift must never hold zero; spread the seed so the lanes decorrelate
+    for (int k = 0; k < 4; ++k) {
+        uint32_t lane = seed + 0x9E3779B9u * static_cast<uint32_t>(k + 1);
+        lane = xorshift(lane ? lane : 1u);
+        m_state[k] = lane ? lane : 1u;
+    }
+}
+
+void SampleConverter::int16ToFloat(const void* src, float* dst, size_t samples) {
+    const uint8_t* in = static_cast<const uint8_t*>(src);
+    size_t i = 0;
+#ifdef SAMPLECONVERTER_SSE2
+    const __m128 scale = _mm_set1_ps(kScale16);
+    for (; i + 8 <= samples; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i));
+        // Sign-extend by placing each sample in the high half and shifting down
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+#endif
+    for (; i < samples; ++i) {
+        int16_t v;
+        std::memcpy(&v, in + 2 * i, sizeof(v));
+        dst[i] = static_cast<float>(v) * kScale16;
+    }
+}
+
+void SampleConverter::int24ToFloat(const void* src, float* dst, size_t samples) {
+    const uint8_t* in = static_cast<const uint8_t*>(src);
+    size_t i = 0;
+#if defined(SAMPLECONVERTER_SSSE3)
+    // 16-byte loads cover 4 samples plus 4 spare bytes, so stop 6 short of the end
+    const __m128i shuffle = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m128 scale = _mm_set1_ps(kScale24);
+    for (; i + 6 <= samples; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 3 * i));
+        v = _mm_srai_epi32(_mm_shuffle_epi8(v, shuffle), 8);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+#elif defined(SAMPLECONVERTER_SSE2)
+    // 32-bit loads read one spare byte past each sample, so stop 5 short of the end
+    const __m128 scale = _mm_set1_ps(kScale24);
+    for (; i + 5 <= samples; i += 4) {
+        int32_t w[4];
+        std::memcpy(w, in + 3 * i, 4);
+        std::memcpy(w + 1, in + 3 * i + 3, 4);
+        std::memcpy(w + 2, in + 3 * i + 6, 4);
+        std::memcpy(w + 3, in + 3 * i + 9, 4);
+        __m128i v = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w)), 8), 8);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+#endif
+    for (; i < samples; ++i) {
+        dst[i] = static_cast<float>(load24(in + 3 * i)) * kScale24;
+    }
+}
+
+void SampleConverter::int32ToFloat(const void* src, float* dst, size_t samples) {
+    const uint8_t* in = static_cast<const uint8_t*>(src);
+    size_t i = 0;
+#ifdef SAMPLECONVERTER_SSE2
+    const __m128 scale = _mm_set1_ps(kScale32);
+    for (; i + 4 <= samples; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 4 * i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+#endif
+    for (; i < samples; ++i) {
+        int32_t v;
+        std::memcpy(&v, in + 4 * i, sizeof(v));
+        dst[i] = static_cast<float>(v) * kScale32;
+    }
+}
+
+void SampleConverter::floatToInt16(const float* src, void* dst, size_t samples) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    size_t i = 0;
+#ifdef SAMPLECONVERTER_SSE2
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= samples; i += 8) {
+        __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(clampUnit4(_mm_loadu_ps(src + i)), scale));
+        __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(clampUnit4(_mm_loadu_ps(src + i + 4)), scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < samples; ++i) {
+        int16_t v = static_cast<int16_t>(std::lrint(clampUnit(src[i]) * 32767.0f));
+        std::memcpy(out + 2 * i, &v, sizeof(v));
+    }
+}
+
+void SampleConverter::floatToInt24(const float* src, void* dst, size_t samples) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    size_t i = 0;
+#ifdef SAMPLECONVERTER_SSE2
+    for (; i + 4 <= samples; i += 4) {
+        alignas(16) int32_t v[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(v), quantizeWide4(_mm_loadu_ps(src + i), 8388607.0));
+        for (int k = 0; k < 4; ++k) {
+            store24(out + 3 * (i + k), v[k]);
+        }
+    }
+#endif
+    for (; i < samples; ++i) {
+        store24(out + 3 * i, quantize24(src[i]));
+    }
+}
+
+void SampleConverter::floatToInt32(const float* src, void* dst, size_t samples) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    size_t i = 0;
+#ifdef SAMPLECONVERTER_SSE2
+    for (; i + 4 <= samples; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * i), quantizeWide4(_mm_loadu_ps(src + i), 2147483647.0));
+    }
+#endif
+    for (; i < samples; ++i) {
+        int32_t v = quantize32(src[i]);
+        std::memcpy(out + 4 * i, &v, sizeof(v));
+    }
+}
+
+void SampleConverter::floatToInt16(const float* src, void* dst, size_t samples, Dither& dither) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    size_t i = 0;
+#ifdef SAMPLECONVERTER_SSE2
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    __m128i lanes = _mm_load_si128(reinterpret_cast<const __m128i*>(dither.m_state));
+    for (; i + 8 <= samples; i += 8) {
+        const __m128 d0 = tpdf4(lanes);
+        const __m128 d1 = tpdf4(lanes);
+        __m128i lo = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(clampUnit4(_mm_loadu_ps(src + i)), scale), d0));
+        __m128i hi = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(clampUnit4(_mm_loadu_ps(src + i + 4)), scale), d1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_packs_epi32(lo, hi));
+    }
+    _mm_store_si128(reinterpret_cast<__m128i*>(dither.m_state), lanes);
+#endif
+    for (; i < samples; ++i) {
+        int16_t v = quantize16Dithered(src[i], tpdf(dither.m_state[i & 3]));
+        std::memcpy(out + 2 * i, &v, sizeof(v));
+    }
+}
+
+void SampleConverter::floatToInt24(const float* src, void* dst, size_t samples, Dither& dither) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    size_t i = 0;
+#ifdef SAMPLECONVERTER_SSE2
+    __m128i lanes = _mm_load_si128(reinterpret_cast<const __m128i*>(dither.m_state));
+    for (; i + 4 <= samples; i += 4) {
+        alignas(16) int32_t v[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(v), quantize24Dithered4(_mm_loadu_ps(src + i), tpdf4(lanes)));
+        for (int k = 0; k < 4; ++k) {
+            store24(out + 3 * (i + k), v[k]);
+        }
+    }
+    _mm_store_si128(reinterpret_cast<__m128i*>(dither.m_state), lanes);
+#endif
+    for (; i < samples; ++i) {
+        store24(out + 3 * i, quantize24Dithered(src[i], tpdf(dither.m_state[i & 3])));
+    }
+}
+
+void SampleConverter::toFloat(const void* src, int bits, bool isFloat, float* dst, size_t samples) {
+    if (isFloat) {
+        std::memcpy(dst, src, samples * sizeof(float));
+    } else if (bits == 16) {
+        int16ToFloat(src, dst, samples);
+    } else if (bits == 24) {
+        int24ToFloat(src, dst, samples);
+    } else if (bits == 32) {
+        int32ToFloat(src, dst, samples);
+    } else if (bits == 8) {
+        const uint8_t* in = static_cast<const uint8_t*>(src);
+        for (size_t i = 0; i < samples; ++i) {
+            dst[i] = static_cast<float>(static_cast<int>(in[i]) - 128) * (1.0f / 128.0f);
+        }
+    }
+}
+
+void SampleConverter::fromFloat(const float* src, void* dst, int bits, bool isFloat, size_t samples) {
+    if (isFloat) {
+        std::memcpy(dst, src, samples * sizeof(float));
+    } else if (bits == 16) {
+        floatToInt16(src, dst, samples);
+    } else if (bits == 24) {
+        floatToInt24(src, dst, samples);
+    } else if (bits == 32) {
+        floatToInt32(src, dst, samples);
+    }
+}
+
+int SampleConverter::bytesPerSample(Format format) {
+    switch (format) {
+    case Format::Int16: return 2;
+    case Format::Int24: return 3;
+    case Format::Int32: return 4;
+    case Format::Float32:
+    default: return 4;
+    }
+}
+
+void SampleConverter::toFloat(const void* src, Format format, float* dst, size_t samples) {
+    switch (format) {
+    case Format::Int16: int16ToFloat(src, dst, samples); break;
+    case Format::Int24: int24ToFloat(src, dst, samples); break;
+    case Format::Int32: int32ToFloat(src, dst, samples); break;
+    case Format::Float32: std::memcpy(dst, src, samples * sizeof(float)); break;
+    }
+}
+
+void SampleConverter::fromFloat(const float* src, void* dst, Format format, size_t samples, Dither* dither) {
+    switch (format) {
+    case Format::Int16:
+        dither ? floatToInt16(src, dst, samples, *dither) : floatToInt16(src, dst, samples);
+        break;
+    case Format::Int24:
+        dither ? floatToInt24(src, dst, samples, *dither) : floatToInt24(src, dst, samples);
+        break;
+    case Format::Int32:
+        floatToInt32(src, dst, samples);
+        break;
+    case Format::Float32:
+        std::memcpy(dst, src, samples * sizeof(float));
+        break;
+    }
+}
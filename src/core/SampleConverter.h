@@ -0,0 +1,66 @@
+#ifndef SAMPLECONVERTER_H
+#define SAMPLECONVERTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * SampleConverter - PCM <-> float32 conversion kernels
+ *
+ * Packed little-endian integer samples (as stored in WAV files and native
+ * device buffers) to and from float in [-1, 1). SSE2 is used where
+ * available, with SSSE3 shuffles for 24-bit; results match the scalar
+ * fallback exactly. Float to integer rounds to nearest and saturates.
+ * Source and destination may be unaligned but must not overlap.
+ *
+ * The dithered 16/24-bit variants add TPDF dither of +-1 LSB before
+ * rounding. At 32 bits the LSB is below float resolution, so no dither.
+ */
+class SampleConverter {
+public:
+    // Device/stream sample formats; integers are packed little-endian
+    enum class Format {
+        Float32,
+        Int16,
+        Int24,
+        Int32
+    };
+
+    /**
+     * Dither - TPDF noise source, four xorshift32 lanes
+     *
+     * Keep one per output stream; it is not thread-safe. Within one call the
+     * SSE and scalar paths draw the same values.
+     */
+    class Dither {
+    public:
+        explicit Dither(uint32_t seed = 0x9E3779B9u) { reset(seed); }
+        void reset(uint32_t seed);
+
+    private:
+        friend class SampleConverter;
+        alignas(16) uint32_t m_state[4];
+    };
+
+    static void int16ToFloat(const void* src, float* dst, size_t samples);
+    static void int24ToFloat(const void* src, float* dst, size_t samples);
+    static void int32ToFloat(const void* src, float* dst, size_t samples);
+
+    static void floatToInt16(const float* src, void* dst, size_t samples);
+    static void floatToInt24(const float* src, void* dst, size_t samples);
+    static void floatToInt32(const float* src, void* dst, size_t samples);
+
+    static void floatToInt16(const float* src, void* dst, size_t samples, Dither& dither);
+    static void floatToInt24(const float* src, void* dst, size_t samples, Dither& dither);
+
+    // Dispatch on container width; bits == 32 with isFloat is a plain copy
+    static void toFloat(const void* src, int bits, bool isFloat, float* dst, size_t samples);
+    static void fromFloat(const float* src, void* dst, int bits, bool isFloat, size_t samples);
+
+    // Dispatch on stream format; a null dither rounds without it
+    static int bytesPerSample(Format format);
+    static void toFloat(const void* src, Format format, float* dst, size_t samples);
+    static void fromFloat(const float* src, void* dst, Format format, size_t samples, Dither* dither = nullptr);
+};
+
+#endif // SAMPLECONVERTER_H
@@ -0,0 +1,186 @@
+#include "SessionManager.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+namespace {
+constexpr double kLoadSmoothing = 0.05;
+constexpr size_t kRingBlocks = 8;
+} // namespace
+
+EngineSession::EngineSession(int id, int channels, int sampleRate, int blockFrames)
+    : m_id(id)
+    , m_channels(std::clamp(channels, 1, 2))
+    , m_blockFrames(blockFrames)
+    , m_input(std::clamp(channels, 1, 2), static_cast<size_t>(blockFrames) * kRingBlocks)
+    , m_output(std::clamp(channels, 1, 2), static_cast<size_t>(blockFrames) * kRingBlocks)
+{
+    m_processor.setSampleRate(sampleRate);
+}
+
+bool EngineSession::pushInput(const float* data, size_t frames) {
+    return m_input.writeInterleaved(data, frames);
+}
+
+bool EngineSession::pullOutput(float* data, size_t frames) {
+    return m_output.readInterleaved(data, frames);
+}
+
+SessionStats EngineSession::getStats() const {
+    SessionStats stats;
+    stats.averageLoad = m_averageLoad.load(std::memory_order_relaxed);
+    stats.peakLoad = m_peakLoad.load(std::memory_order_relaxed);
+    stats.processedBlocks = m_processedBlocks.load(std::memory_order_relaxed);
+    stats.starvedBlocks = m_starvedBlocks.load(std::memory_order_relaxed);
+    stats.overruns = m_overruns.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void EngineSession::processBlock(double blockSeconds) {
+    const AudioFrameBuffer::Region block = m_input.acquireRead(m_blockFrames);
+    if (block.frames() < static_cast<size_t>(m_blockFrames)) {
+        m_starvedBlocks.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // The block is ours until commitRead, so process it in place (one or two runs if it wraps)
+    float* runs[2][2];
+    auto begin = std::chrono::steady_clock::now();
+    for (int run = 0; run < 2; ++run) {
+        const int frames = static_cast<int>(run == 0 ? block.firstFrames : block.secondFrames);
+        for (int ch = 0; ch < m_channels; ++ch) {
+            runs[run][ch] = block.channel(ch, run);
+        }
+        if (frames > 0) {
+            m_processor.processPlanar(runs[run], frames, m_channels);
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    // This worker is the only producer, so free space can only grow between the check and the writes
+    if (m_output.availableWrite() >= static_cast<size_t>(m_blockFrames)) {
+        m_output.writePlanar(runs[0], block.firstFrames);
+        m_output.writePlanar(runs[1], block.secondFrames);
+    } else {
+        m_overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_input.commitRead(m_blockFrames);
+
+    // Each session is processed by one worker per tick, so plain read-modify-write is safe
+    double load = elapsed / blockSeconds;
+    double average = m_averageLoad.load(std::memory_order_relaxed);
+    m_averageLoad.store(average + kLoadSmoothing * (load - average), std::memory_order_relaxed);
+    if (load > m_peakLoad.load(std::memory_order_relaxed)) {
+        m_peakLoad.store(load, std::memory_order_relaxed);
+    }
+    m_processedBlocks.fetch_add(1, std::memory_order_relaxed);
+}
+
+SessionManager::SessionManager(int sampleRate, int blockFrames, int workerCount)
+    : m_sampleRate(sampleRate)
+    , m_blockFrames(blockFrames)
+    , m_blockSeconds(static_cast<double>(blockFrames) / sampleRate)
+    , m_pool(workerCount, true)
+{
+    LOG_INFO("SessionManager: " + std::to_string(sampleRate) + " Hz, " + std::to_string(blockFrames)
+             + " frames per block, " + std::to_string(m_pool.getThreadCount()) + " workers");
+}
+
+SessionManager::~SessionManager() {
+    stop();
+}
+
+int SessionManager::createSession(int channels) {
+    std::lock_guard<std::mutex> lock(m_sessionsMutex);
+    int id = m_nextSessionId++;
+    m_sessions.push_back(std::make_unique<EngineSession>(id, channels, m_sampleRate, m_blockFrames));
+    LOG_INFO("Session " + std::to_string(id) + " created (" + std::to_string(channels) + " channels)");
+    return id;
+}
+
+bool SessionManager::destroySession(int id) {
+    // Holding the lock waits out any tick in flight, which may still be using the session
+    std::lock_guard<std::mutex> lock(m_sessionsMutex);
+    auto it = std::find_if(m_sessions.begin(), m_sessions.end(),
+                           [id](const auto& session) { return session->getId() == id; });
+    if (it == m_sessions.end()) {
+        return false;
+    }
+    m_sessions.erase(it);
+    LOG_INFO("Session " + std::to_string(id) + " destroyed");
+    return true;
+}
+
+EngineSession* SessionManager::getSession(int id) {
+    std::lock_guard<std::mutex> lock(m_sessionsMutex);
+    for (const auto& session : m_sessions) {
+        if (session->getId() == id) {
+            return session.get();
+        }
+    }
+    return nullptr;
+}
+
+int SessionManager::getSessionCount() const {
+    std::lock_guard<std::mutex> lock(m_sessionsMutex);
+    return static_cast<int>(m_sessions.size());
+}
+
+void SessionManager::start() {
+    if (m_running.exchange(true)) {
+        return;
+    }
+    m_clockThread = std::thread(&SessionManager::clockLoop, this);
+    LOG_INFO("SessionManager clock started");
+}
+
+void SessionManager::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    m_clockThread.join();
+    LOG_INFO("SessionManager clock stopped");
+}
+
+bool SessionManager::tick() {
+    if (m_running.load()) {
+        return false;
+    }
+    runTick();
+    return true;
+}
+
+void SessionManager::runTick() {
+    std::lock_guard<std::mutex> lock(m_sessionsMutex);
+    auto begin = std::chrono::steady_clock::now();
+
+    const double blockSeconds = m_blockSeconds;
+    for (const auto& session : m_sessions) {
+        EngineSession* target = session.get();
+        m_pool.submit([target, blockSeconds]() { target->processBlock(blockSeconds); });
+    }
+    m_pool.waitIdle();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    m_tickLoad.store(elapsed / m_blockSeconds, std::memory_order_relaxed);
+}
+
+void SessionManager::clockLoop() {
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(m_blockSeconds));
+
+    auto next = Clock::now() + period;
+    while (m_running.load()) {
+        runTick();
+
+        // Fell behind by more than a block: resync instead of bursting to catch up
+        auto now = Clock::now();
+        if (now > next + period) {
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+        next += period;
+    }
+}
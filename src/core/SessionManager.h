@@ -0,0 +1,124 @@
+#ifndef SESSIONMANAGER_H
+#define SESSIONMANAGER_H
+
+#include "AudioFrameBuffer.h"
+#include "WorkStealingPool.h"
+#include "../dsp/DSPProcessor.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Per-session processing statistics (load = DSP time / block period)
+struct SessionStats {
+    double averageLoad = 0.0;
+    double peakLoad = 0.0;
+    uint64_t processedBlocks = 0;
+    uint64_t starvedBlocks = 0;   // ticks without a full input block
+    uint64_t overruns = 0;        // output ring full, block dropped
+};
+
+/**
+ * EngineSession - One independent 300B stream hosted by SessionManager
+ *
+ * Producers push interleaved input into the session, consumers pull the
+ * processed output. The rings store planar frames, so the DSP runs in
+ * place on the input ring. Each session owns its DSPProcessor and rings,
+ * so sessions share nothing but the worker pool.
+ */
+class EngineSession {
+public:
+    EngineSession(int id, int channels, int sampleRate, int blockFrames);
+
+    int getId() const { return m_id; }
+    int getChannels() const { return m_channels; }
+    DSPProcessor& getProcessor() { return m_processor; }
+
+    // Called by the owner of the stream (capture callback, file reader, ...)
+    bool pushInput(const float* data, size_t frames);
+    bool pullOutput(float* data, size_t frames);
+
+    SessionStats getStats() const;
+
+private:
+    friend class SessionManager;
+
+    // One clock tick worth of DSP (runs on a pool worker)
+    void processBlock(double blockSeconds);
+
+    int m_id;
+    int m_channels;
+    int m_blockFrames;
+    DSPProcessor m_processor;
+    AudioFrameBuffer m_input;
+    AudioFrameBuffer m_output;
+
+    // Written by the worker that ran the block, read by any thread
+    std::atomic<double> m_averageLoad{0.0};
+    std::atomic<double> m_peakLoad{0.0};
+    std::atomic<uint64_t> m_processedBlocks{0};
+    std::atomic<uint64_t> m_starvedBlocks{0};
+    std::atomic<uint64_t> m_overruns{0};
+};
+
+/**
+ * SessionManager - Hosts many EngineSessions on a fixed worker pool
+ *
+ * An internal clock thread advances every session by one block per
+ * period. Session blocks are scheduled as independent tasks on a
+ * WorkStealingPool, so load spreads over the workers regardless of how
+ * sessions were created. A tick locks the session list, allocates tasks
+ * and waits for the pool, so it is never driven from an audio callback;
+ * callbacks only push and pull through the session rings. With the clock
+ * stopped, tick() advances the sessions one block at a time instead.
+ */
+class SessionManager {
+public:
+    SessionManager(int sampleRate = 48000, int blockFrames = 256, int workerCount = 0);
+    ~SessionManager();
+
+    int createSession(int channels = 2);
+    bool destroySession(int id);
+    // Returned pointer stays valid until destroySession(id)
+    EngineSession* getSession(int id);
+    int getSessionCount() const;
+
+    // Internal clock: one tick per block period
+    void start();
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+    // One block for every session, returns when done. For offline drivers and
+    // tests while the clock is stopped: false, and nothing processed, while it
+    // runs. Never call it from an audio callback
+    bool tick();
+
+    int getSampleRate() const { return m_sampleRate; }
+    int getBlockFrames() const { return m_blockFrames; }
+    int getWorkerCount() const { return m_pool.getThreadCount(); }
+
+    // Share of the block period spent on the last tick across all sessions
+    double getTickLoad() const { return m_tickLoad.load(std::memory_order_relaxed); }
+
+private:
+    void runTick();
+    void clockLoop();
+
+    int m_sampleRate;
+    int m_blockFrames;
+    double m_blockSeconds;
+
+    WorkStealingPool m_pool;
+
+    mutable std::mutex m_sessionsMutex;
+    std::vector<std::unique_ptr<EngineSession>> m_sessions;
+    int m_nextSessionId = 1;
+
+    std::thread m_clockThread;
+    std::atomic<bool> m_running{false};
+    std::atomic<double> m_tickLoad{0.0};
+};
+
+#endif // SESSIONMANAGER_H
@@ -0,0 +1,225 @@
+#include "SpectrumAnalyzer.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace {
+constexpr double kTwoPi = 6.283185307179586476925286766559;
+constexpr double kAttackSeconds = 0.01;
+constexpr double kReleaseSeconds = 0.3;
+} // namespace
+
+SpectrumAnalyzer::SpectrumAnalyzer() {
+    prepare(48000);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+    stop();
+}
+
+void SpectrumAnalyzer::prepare(int sampleRate) {
+    stop();
+
+    // ~10 Hz resolution at any rate; 75% overlap
+    m_fftSize = sampleRate <= 48000 ? 4096 : (sampleRate <= 96000 ? 8192 : 16384);
+    m_hop = m_fftSize / 4;
+    m_sleepMs = std::max(5, m_hop * 1000 / sampleRate / 2);
+    m_fft.setSize(m_fftSize);
+    m_tap.configure(2, static_cast<size_t>(m_fftSize) * 8, AudioFrameBuffer::Layout::Planar);
+    m_pending = AudioFrameBuffer::Region();
+
+    // 4-term Blackman-Harris: -92 dB sidelobes keep high-order harmonics visible
+    m_window.resize(m_fftSize);
+    double windowSum = 0.0;
+    for (int n = 0; n < m_fftSize; ++n) {
+        const double x = kTwoPi * n / m_fftSize;
+        m_window[n] = static_cast<float>(0.35875 - 0.48829 * std::cos(x) + 0.14128 * std::cos(2.0 * x)
+                                         - 0.01168 * std::cos(3.0 * x));
+        windowSum += m_window[n];
+    }
+    m_powerScale = static_cast<float>((2.0 / windowSum) * (2.0 / windowSum));
+
+    for (auto& history : m_history) {
+        history.assign(m_fftSize, 0.0f);
+    }
+    m_fill = 0;
+    m_windowed.assign(m_fftSize, 0.0f);
+    m_power.assign(m_fft.getBinCount(), 0.0f);
+
+    const double maxFrequency = std::min<double>(kMaxFrequency, 0.45 * sampleRate);
+    const double ratio = std::pow(maxFrequency / kMinFrequency, 1.0 / (kBands - 1));
+    const double binWidth = static_cast<double>(sampleRate) / m_fftSize;
+    const int lastBin = m_fft.getBinCount() - 1;
+
+    std::vector<float> frequencies(kBands);
+    m_bands.resize(kBands);
+    for (int b = 0; b < kBands; ++b) {
+        const double centre = kMinFrequency * std::pow(ratio, b);
+        const double edge = std::sqrt(ratio);
+        frequencies[b] = static_cast<float>(centre);
+        m_bands[b].first = static_cast<int>(std::ceil(centre / edge / binWidth));
+        m_bands[b].last = std::min(lastBin, static_cast<int>(std::floor(centre * edge / binWidth)));
+        m_bands[b].position = static_cast<float>(centre / binWidth);
+    }
+
+    for (auto& smoothed : m_smoothed) {
+        smoothed.assign(kBands, kFloorDb);
+    }
+    const double hopSeconds = static_cast<double>(m_hop) / sampleRate;
+    m_attack = static_cast<float>(1.0 - std::exp(-hopSeconds / kAttackSeconds));
+    m_release = static_cast<float>(1.0 - std::exp(-hopSeconds / kReleaseSeconds));
+
+    std::lock_guard<std::mutex> lock(m_frameMutex);
+    m_frame.frequencies = frequencies;
+    m_frame.dry.assign(kBands, kFloorDb);
+    m_frame.wet.assign(kBands, kFloorDb);
+    m_frame.sequence = 0;
+}
+
+void SpectrumAnalyzer::start() {
+    if (m_thread.joinable()) {
+        return;
+    }
+    m_droppedBlocks.store(0, std::memory_order_relaxed);
+    m_stopRequested.store(false, std::memory_order_relaxed);
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&SpectrumAnalyzer::run, this);
+    LOG_DEBUG("Spectrum analyzer: " + std::to_string(m_fftSize) + "-point FFT, hop " + std::to_string(m_hop));
+}
+
+void SpectrumAnalyzer::stop() {
+    m_running.store(false, std::memory_order_release);
+    m_stopRequested.store(true, std::memory_order_relaxed);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void SpectrumAnalyzer::mixInto(const AudioFrameBuffer::Region& region, int channel,
+                               const float* left, const float* right, size_t stride) {
+    size_t offset = 0;
+    for (int run = 0; run < 2; ++run) {
+        const size_t frames = run == 0 ? region.firstFrames : region.secondFrames;
+        float* dst = region.channel(channel, run);
+        if (left == right) {
+            for (size_t i = 0; i < frames; ++i) {
+                dst[i] = left[(offset + i) * stride];
+            }
+        } else {
+            for (size_t i = 0; i < frames; ++i) {
+                dst[i] = (left[(offset + i) * stride] + right[(offset + i) * stride]) * 0.5f;
+            }
+        }
+        offset += frames;
+    }
+}
+
+void SpectrumAnalyzer::captureDry(const float* left, const float* right, size_t stride, size_t frames) {
+    m_pending = AudioFrameBuffer::Region();
+    if (!m_running.load(std::memory_order_relaxed) || frames == 0) {
+        return;
+    }
+
+    const AudioFrameBuffer::Region region = m_tap.acquireWrite(frames);
+    if (region.frames() < frames) {
+        m_droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+        return;  // worker is behind; the display just skips this block
+    }
+    mixInto(region, 0, left, right, stride);
+    m_pending = region;
+}
+
+void SpectrumAnalyzer::captureWet(const float* left, const float* right, size_t stride, size_t frames) {
+    if (m_pending.frames() != frames || frames == 0) {
+        return;
+    }
+    mixInto(m_pending, 1, left, right, stride);
+    m_tap.commitWrite(frames);
+    m_pending = AudioFrameBuffer::Region();
+}
+
+bool SpectrumAnalyzer::latest(SpectrumFrame& frame) const {
+    std::lock_guard<std::mutex> lock(m_frameMutex);
+    if (m_frame.sequence == frame.sequence) {
+        return false;
+    }
+    frame.frequencies = m_frame.frequencies;
+    frame.dry = m_frame.dry;
+    frame.wet = m_frame.wet;
+    frame.sequence = m_frame.sequence;
+    return true;
+}
+
+void SpectrumAnalyzer::run() {
+    const size_t tail = static_cast<size_t>(m_fftSize - m_hop);
+
+    // Anything left from before a stop is stale
+    m_tap.commitRead(m_tap.availableRead());
+    m_fill = 0;
+
+    while (!m_stopRequested.load(std::memory_order_relaxed)) {
+        for (;;) {
+            const AudioFrameBuffer::Region region = m_tap.acquireRead(static_cast<size_t>(m_hop - m_fill));
+            if (region.frames() == 0) {
+                break;
+            }
+
+            // New frames fill the last hop of the history
+            size_t offset = tail + m_fill;
+            for (int run = 0; run < 2; ++run) {
+                const size_t frames = run == 0 ? region.firstFrames : region.secondFrames;
+                for (int ch = 0; ch < 2; ++ch) {
+                    std::memcpy(m_history[ch].data() + offset, region.channel(ch, run), frames * sizeof(float));
+                }
+                offset += frames;
+            }
+            m_tap.commitRead(region.frames());
+            m_fill += static_cast<int>(region.frames());
+
+            if (m_fill == m_hop) {
+                analyze();
+                for (auto& history : m_history) {
+                    std::memmove(history.data(), history.data() + m_hop, tail * sizeof(float));
+                }
+                m_fill = 0;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(m_sleepMs));
+    }
+}
+
+void SpectrumAnalyzer::analyze() {
+    const int lastBin = m_fft.getBinCount() - 1;
+
+    for (int ch = 0; ch < 2; ++ch) {
+        const float* history = m_history[ch].data();
+        for (int n = 0; n < m_fftSize; ++n) {
+            m_windowed[n] = history[n] * m_window[n];
+        }
+        m_fft.powerSpectrum(m_windowed.data(), m_power.data());
+
+        float* smoothed = m_smoothed[ch].data();
+        for (int b = 0; b < kBands; ++b) {
+            const Band& band = m_bands[b];
+            float power;
+            if (band.last >= band.first) {
+                power = *std::max_element(m_power.begin() + band.first, m_power.begin() + band.last + 1);
+            } else {
+                const int bin = std::min(static_cast<int>(band.position), lastBin - 1);
+                const float frac = band.position - static_cast<float>(bin);
+                power = m_power[bin] + (m_power[bin + 1] - m_power[bin]) * frac;
+            }
+
+            const float db = std::max(kFloorDb, 10.0f * std::log10(power * m_powerScale + 1e-30f));
+            smoothed[b] += (db - smoothed[b]) * (db > smoothed[b] ? m_attack : m_release);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_frameMutex);
+    std::copy(m_smoothed[0].begin(), m_smoothed[0].end(), m_frame.dry.begin());
+    std::copy(m_smoothed[1].begin(), m_smoothed[1].end(), m_frame.wet.begin());
+    ++m_frame.sequence;
+}
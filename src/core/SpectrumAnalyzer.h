@@ -0,0 +1,103 @@
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include "AudioFrameBuffer.h"
+#include "../dsp/RealFFT.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// One analyzer output: dry and wet level per log-spaced band, dBFS for a full-scale sine
+struct SpectrumFrame {
+    std::vector<float> frequencies;  // band centres, Hz
+    std::vector<float> dry;
+    std::vector<float> wet;
+    uint64_t sequence = 0;           // 0 = nothing analyzed yet
+};
+
+/**
+ * SpectrumAnalyzer - Dry vs. wet spectrum computed off the audio and GUI threads
+ *
+ * The audio thread writes a mono mix of the signal before (captureDry) and
+ * after (captureWet) the DSP straight into one slot of a two-channel SPSC
+ * ring; if the ring is full the block is dropped, never waited on. A worker
+ * thread drains the ring and, every quarter FFT (75% overlap), applies a
+ * Blackman-Harris window, runs a RealFFT, folds the power bins into
+ * kBands log-spaced bands (peak of the bins inside a band, interpolated
+ * where a band is narrower than a bin) and applies attack/release
+ * ballistics in dB. The GUI only copies the finished curves via latest().
+ */
+class SpectrumAnalyzer {
+public:
+    static constexpr int kBands = 240;
+    static constexpr float kMinFrequency = 20.0f;
+    static constexpr float kMaxFrequency = 20000.0f;
+    static constexpr float kFloorDb = -120.0f;
+
+    SpectrumAnalyzer();
+    ~SpectrumAnalyzer();
+
+    // Control thread, while no audio callback runs; stops the worker and allocates
+    void prepare(int sampleRate);
+
+    // Control thread; safe while audio runs. Capture is skipped while stopped
+    void start();
+    void stop();
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    // Audio thread: the same frames before and after the DSP. Channels are
+    // strided by `stride`; left == right means mono
+    void captureDry(const float* left, const float* right, size_t stride, size_t frames);
+    void captureWet(const float* left, const float* right, size_t stride, size_t frames);
+
+    // Any thread: copies the newest curves if they are newer than frame.sequence
+    bool latest(SpectrumFrame& frame) const;
+
+    uint64_t getDroppedBlocks() const { return m_droppedBlocks.load(std::memory_order_relaxed); }
+
+private:
+    // FFT bins [first, last] feed the band; last < first means interpolate at `position`
+    struct Band {
+        int first;
+        int last;
+        float position;
+    };
+
+    void run();
+    void analyze();
+
+    static void mixInto(const AudioFrameBuffer::Region& region, int channel,
+                        const float* left, const float* right, size_t stride);
+
+    // Audio thread
+    AudioFrameBuffer m_tap{2, 1, AudioFrameBuffer::Layout::Planar};  // channel 0 dry, 1 wet
+    AudioFrameBuffer::Region m_pending;
+    std::atomic<uint64_t> m_droppedBlocks{0};
+
+    // Worker
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stopRequested{false};
+    int m_fftSize = 4096;
+    int m_hop = 1024;
+    int m_sleepMs = 10;
+    RealFFT m_fft;
+    std::vector<float> m_window;
+    float m_powerScale = 1.0f;
+    std::vector<float> m_history[2];  // newest m_fftSize samples, oldest first
+    int m_fill = 0;                   // frames of the current hop received so far
+    std::vector<float> m_windowed;
+    std::vector<float> m_power;
+    std::vector<Band> m_bands;
+    std::vector<float> m_smoothed[2];
+    float m_attack = 1.0f;
+    float m_release = 1.0f;
+
+    mutable std::mutex m_frameMutex;
+    SpectrumFrame m_frame;
+};
+
+#endif // SPECTRUMANALYZER_H
@@ -0,0 +1,145 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+thread_local int t_workerIndex = -1;
+thread_local const WorkStealingPool* t_pool = nullptr;
+
+void raiseThreadPriority() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#else
+    // Best effort: SCHED_FIFO needs privileges, fall back silently
+    sched_param param{};
+    param.sched_priority = std::max(1, sched_get_priority_max(SCHED_FIFO) - 10);
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+}
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int threadCount, bool realtimePriority)
+    : m_realtimePriority(realtimePriority)
+{
+    if (threadCount <= 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_queues.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    m_workers.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    waitIdle();
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping.store(true);
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+int WorkStealingPool::currentWorkerIndex() {
+    return t_workerIndex;
+}
+
+void WorkStealingPool::submit(Task task) {
+    m_pendingTasks.fetch_add(1, std::memory_order_relaxed);
+
+    // Workers submitting follow-up work keep it local; others spread round-robin
+    size_t index = (t_pool == this)
+        ? static_cast<size_t>(t_workerIndex)
+        : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+    // Count the task before it becomes visible so a worker never decrements first
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_queuedTasks.fetch_add(1, std::memory_order_release);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+    m_wakeCondition.notify_one();
+}
+
+void WorkStealingPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_idleCondition.wait(lock, [this]() {
+        return m_pendingTasks.load(std::memory_order_acquire) == 0;
+    });
+}
+
+bool WorkStealingPool::popLocal(int index, Task& task) {
+    WorkerQueue& queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(int thief, Task& task) {
+    const int count = static_cast<int>(m_queues.size());
+    for (int offset = 1; offset < count; ++offset) {
+        WorkerQueue& victim = *m_queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(int index) {
+    t_workerIndex = index;
+    t_pool = this;
+    if (m_realtimePriority) {
+        raiseThreadPriority();
+    }
+
+    Task task;
+    while (true) {
+        if (popLocal(index, task) || steal(index, task)) {
+            m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            task = nullptr;
+
+            if (m_pendingTasks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+                m_idleCondition.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wakeCondition.wait(lock, [this]() {
+            return m_stopping.load() || m_queuedTasks.load(std::memory_order_acquire) > 0;
+        });
+        if (m_stopping.load() && m_queuedTasks.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
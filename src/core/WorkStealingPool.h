@@ -0,0 +1,66 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * WorkStealingPool - Fixed set of worker threads with per-worker queues
+ *
+ * Tasks are distributed round-robin over the worker queues. A worker pops
+ * its own queue from the back (most recent, cache-warm task first) and,
+ * when empty, steals from the front of the other queues. Idle workers
+ * sleep until new work is submitted.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threadCount <= 0 uses one worker per hardware thread
+    explicit WorkStealingPool(int threadCount = 0, bool realtimePriority = false);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task);
+
+    // Block until every submitted task has finished (not from a worker thread)
+    void waitIdle();
+
+    int getThreadCount() const { return static_cast<int>(m_workers.size()); }
+
+    // Index of the calling worker thread, -1 if called from outside the pool
+    static int currentWorkerIndex();
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(int index);
+    bool popLocal(int index, Task& task);
+    bool steal(int thief, Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_idleCondition;
+
+    std::atomic<size_t> m_nextQueue{0};
+    std::atomic<size_t> m_queuedTasks{0};
+    std::atomic<size_t> m_pendingTasks{0};
+    std::atomic<bool> m_stopping{false};
+    bool m_realtimePriority = false;
+};
+
+#endif // WORKSTEALINGPOOL_H
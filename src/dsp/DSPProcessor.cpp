@@ -1,5 +1,6 @@
 #include "DSPProcessor.h"
 #include "../utils/Logger.h"
+#include <string>
 
 DSPProcessor::DSPProcessor() {
     LOG_INFO("DSPProcessor initialized - Audiophile mode");
@@ -13,7 +14,7 @@ void DSPProcessor::setSampleRate(int rate) {
         m_sampleRate = rate;
         m_tubeEmulator.setSampleRate(rate);
         reset();
-        LOG_INFO(QString("DSPProcessor sample rate: %1 Hz").arg(rate));
+        LOG_INFO("DSPProcessor sample rate: " + std::to_string(rate) + " Hz");
     }
 }
 
@@ -29,6 +30,19 @@ void DSPProcessor::process(float* buffer, int numFrames, int numChannels) {
     }
 }
 
+void DSPProcessor::processPlanar(float* const* channels, int numFrames, int numChannels) {
+    if (m_bypass.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // Already split per channel, so no de-interleave is needed
+    if (numChannels == 2) {
+        m_tubeEmulator.process(channels[0], channels[1], numFrames);
+    } else if (numChannels == 1) {
+        m_tubeEmulator.processMono(channels[0], numFrames);
+    }
+}
+
 void DSPProcessor::processInterleaved(float* buffer, int numFrames) {
     // Process interleaved stereo efficiently
     // De-interleave to separate channels for processing
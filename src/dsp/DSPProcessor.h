@@ -22,6 +22,9 @@ public:
     // Real-time processing (called from audio thread)
     void process(float* buffer, int numFrames, int numChannels);
 
+    // Non-interleaved buffers, one per channel, processed in place
+    void processPlanar(float* const* channels, int numFrames, int numChannels);
+
     // Bypass control
     void setBypass(bool bypass);
     bool isBypassed() const { return m_bypass.load(); }
@@ -4,7 +4,7 @@
 FilterBank::FilterBank() {
 }
 
-void FilterBank::setCoefficients(const QVector<Parameters::FilterCoeffs>& coeffs) {
+void FilterBank::setCoefficients(const std::vector<Parameters::FilterCoeffs>& coeffs) {
     m_stages.clear();
     m_stages.reserve(coeffs.size());
 
@@ -16,12 +16,12 @@ void FilterBank::setCoefficients(const QVector<Parameters::FilterCoeffs>& coeffs
         state.a1 = fc.a1;
         state.a2 = fc.a2;
         state.reset();
-        m_stages.append(state);
+        m_stages.push_back(state);
     }
 }
 
 void FilterBank::process(float* left, float* right, int numSamples) {
-    if (m_stages.isEmpty()) return;
+    if (m_stages.empty()) return;
 
     for (int i = 0; i < numSamples; ++i) {
         double sampleL = static_cast<double>(left[i]);
@@ -39,7 +39,7 @@ void FilterBank::process(float* left, float* right, int numSamples) {
 }
 
 void FilterBank::processMono(float* buffer, int numSamples) {
-    if (m_stages.isEmpty()) return;
+    if (m_stages.empty()) return;
 
     for (int i = 0; i < numSamples; ++i) {
         double sample = static_cast<double>(buffer[i]);
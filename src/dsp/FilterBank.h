@@ -2,18 +2,18 @@
 #define FILTERBANK_H
 
 #include "Parameters.h"
-#include <QVector>
+#include <vector>
 
 class FilterBank {
 public:
     FilterBank();
 
-    void setCoefficients(const QVector<Parameters::FilterCoeffs>& coeffs);
+    void setCoefficients(const std::vector<Parameters::FilterCoeffs>& coeffs);
     void process(float* left, float* right, int numSamples);
     void processMono(float* buffer, int numSamples);
     void reset();
 
-    int getStageCount() const { return m_stages.size(); }
+    int getStageCount() const { return static_cast<int>(m_stages.size()); }
 
 private:
     struct BiquadState {
@@ -38,7 +38,7 @@ private:
         return output;
     }
 
-    QVector<BiquadState> m_stages;
+    std::vector<BiquadState> m_stages;
 };
 
 #endif // FILTERBANK_H
@@ -1,29 +1,54 @@
 #include "Parameters.h"
 #include "../utils/Logger.h"
-#include <QFile>
-#include <QTextStream>
-#include <QRegularExpression>
+#include <cctype>
+#include <cstdlib>
 #include <cstring>
 #include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace {
+std::string trimmed(const std::string& text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) --end;
+    return text.substr(begin, end - begin);
+}
+
+// Whole-string unsigned parse, like QString::toUInt
+bool parseUnsigned(const std::string& text, int base, unsigned long& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = std::strtoul(text.c_str(), &end, base);
+    return end == text.c_str() + text.size();
+}
+} // namespace
 
 Parameters::Parameters() {
     loadDefaultCoefficients();
 }
 
-bool Parameters::loadFromFile(const QString& path) {
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        LOG_ERROR(QString("Failed to open parameters file: %1").arg(path));
+bool Parameters::loadFromFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOG_ERROR("Failed to open parameters file: " + path);
         return false;
     }
 
-    QTextStream stream(&file);
-    QString content = stream.readAll();
-    file.close();
+    std::stringstream stream;
+    stream << file.rdbuf();
+
+    if (loadFromString(stream.str())) {
+        LOG_INFO("Loaded " + std::to_string(m_rawCoeffs.size()) + " coefficients from " + path);
+        return true;
+    }
+    return false;
+}
 
+bool Parameters::loadFromString(const std::string& content) {
     if (parseIDAFormat(content)) {
         m_loaded = true;
-        LOG_INFO(QString("Loaded %1 coefficients from %2").arg(m_rawCoeffs.size()).arg(path));
         return true;
     }
 
@@ -31,49 +56,44 @@ bool Parameters::loadFromFile(const QString& path) {
     return false;
 }
 
-bool Parameters::loadFromResource() {
-    return loadFromFile(":/resources/parameters.txt");
-}
-
-bool Parameters::parseIDAFormat(const QString& content) {
+bool Parameters::parseIDAFormat(const std::string& content) {
     m_rawCoeffs.clear();
-    QVector<uint8_t> allBytes;
-
-    // Parse DCB lines to extract bytes
-    QStringList lines = content.split('\n');
-    QRegularExpression dcbRegex(R"(DCB\s+(.+))");
-
-    for (const QString& line : lines) {
-        QRegularExpressionMatch match = dcbRegex.match(line);
-        if (match.hasMatch()) {
-            QString bytesStr = match.captured(1);
-            QVector<uint8_t> bytes = parseHexLine(bytesStr);
-            allBytes.append(bytes);
+    std::vector<uint8_t> allBytes;
+
+    // Parse "DCB <bytes>" lines to extract bytes
+    std::istringstream lines(content);
+    std::string line;
+    while (std::getline(lines, line)) {
+        const size_t dcb = line.find("DCB");
+        if (dcb == std::string::npos || dcb + 3 >= line.size()
+            || !std::isspace(static_cast<unsigned char>(line[dcb + 3]))) {
+            continue;
         }
+        const std::string bytesStr = trimmed(line.substr(dcb + 3));
+        if (bytesStr.empty()) continue;
+
+        const std::vector<uint8_t> bytes = parseHexLine(bytesStr);
+        allBytes.insert(allBytes.end(), bytes.begin(), bytes.end());
     }
 
-    if (allBytes.isEmpty()) {
+    if (allBytes.empty()) {
         LOG_WARNING("No DCB data found in parameter file");
         return false;
     }
 
-    LOG_DEBUG(QString("Parsed %1 bytes from parameter file").arg(allBytes.size()));
+    LOG_DEBUG("Parsed " + std::to_string(allBytes.size()) + " bytes from parameter file");
 
     // Convert bytes to doubles (8 bytes per double, little-endian)
-    for (int i = 0; i + 7 < allBytes.size(); i += 8) {
-        QVector<uint8_t> doubleBytes;
-        for (int j = 0; j < 8; ++j) {
-            doubleBytes.append(allBytes[i + j]);
-        }
-        double value = bytesToDouble(doubleBytes);
+    for (size_t i = 0; i + 7 < allBytes.size(); i += 8) {
+        double value = bytesToDouble(&allBytes[i]);
 
         // Filter out invalid values (NaN, Inf, or extremely large values)
         if (std::isfinite(value) && std::abs(value) < 1e10) {
-            m_rawCoeffs.append(value);
+            m_rawCoeffs.push_back(value);
         }
     }
 
-    LOG_DEBUG(QString("Extracted %1 valid coefficients").arg(m_rawCoeffs.size()));
+    LOG_DEBUG("Extracted " + std::to_string(m_rawCoeffs.size()) + " valid coefficients");
 
     // Organize coefficients into filter stages
     // Based on the data structure, we have sets of biquad coefficients
@@ -82,13 +102,14 @@ bool Parameters::parseIDAFormat(const QString& content) {
     // The data appears to contain multiple filter stages for different sample rates
     // For now, organize as a general filter bank
 
-    if (m_rawCoeffs.size() >= 30) {
+    const size_t rawCount = m_rawCoeffs.size();
+    if (rawCount >= 30) {
         // Create filter coefficients from raw data
         // Assuming pairs of doubles form filter parameters
 
         // Pre-filter: first set of coefficients
-        QVector<FilterCoeffs> preCoeffs;
-        for (int i = 0; i + 4 < m_rawCoeffs.size() / 2; i += 5) {
+        std::vector<FilterCoeffs> preCoeffs;
+        for (size_t i = 0; i + 4 < rawCount / 2; i += 5) {
             FilterCoeffs fc;
             fc.b0 = m_rawCoeffs[i];
             fc.b1 = m_rawCoeffs[i + 1];
@@ -98,14 +119,14 @@ bool Parameters::parseIDAFormat(const QString& content) {
 
             // Validate coefficient ranges for IIR stability
             if (std::abs(fc.a1) < 2.0 && std::abs(fc.a2) < 1.0) {
-                preCoeffs.append(fc);
+                preCoeffs.push_back(fc);
             }
         }
 
         // Post-filter: second half of coefficients
-        QVector<FilterCoeffs> postCoeffs;
-        int offset = m_rawCoeffs.size() / 2;
-        for (int i = offset; i + 4 < m_rawCoeffs.size(); i += 5) {
+        std::vector<FilterCoeffs> postCoeffs;
+        const size_t offset = rawCount / 2;
+        for (size_t i = offset; i + 4 < rawCount; i += 5) {
             FilterCoeffs fc;
             fc.b0 = m_rawCoeffs[i];
             fc.b1 = m_rawCoeffs[i + 1];
@@ -114,25 +135,24 @@ bool Parameters::parseIDAFormat(const QString& content) {
             fc.a2 = m_rawCoeffs[i + 4];
 
             if (std::abs(fc.a1) < 2.0 && std::abs(fc.a2) < 1.0) {
-                postCoeffs.append(fc);
+                postCoeffs.push_back(fc);
             }
         }
 
         // Only use parsed coefficients if we got valid filter stages
-        if (!preCoeffs.isEmpty() || !postCoeffs.isEmpty()) {
+        if (!preCoeffs.empty() || !postCoeffs.empty()) {
             // Store for common sample rates
-            QVector<int> rates = {44100, 48000, 88200, 96000, 176400, 192000};
-            for (int rate : rates) {
-                if (!preCoeffs.isEmpty()) {
+            for (int rate : getSupportedSampleRates()) {
+                if (!preCoeffs.empty()) {
                     m_preFilterCoeffs[rate] = preCoeffs;
                 }
-                if (!postCoeffs.isEmpty()) {
+                if (!postCoeffs.empty()) {
                     m_postFilterCoeffs[rate] = postCoeffs;
                 }
             }
 
-            LOG_INFO(QString("Loaded %1 pre-filter stages and %2 post-filter stages")
-                     .arg(preCoeffs.size()).arg(postCoeffs.size()));
+            LOG_INFO("Loaded " + std::to_string(preCoeffs.size()) + " pre-filter stages and "
+                     + std::to_string(postCoeffs.size()) + " post-filter stages");
         } else {
             LOG_WARNING("Parsed data but no valid filter coefficients found, keeping defaults");
         }
@@ -140,48 +160,47 @@ bool Parameters::parseIDAFormat(const QString& content) {
         LOG_WARNING("Not enough coefficients in file, keeping defaults");
     }
 
-    return !m_rawCoeffs.isEmpty();
+    return !m_rawCoeffs.empty();
 }
 
-QVector<uint8_t> Parameters::parseHexLine(const QString& line) const {
-    QVector<uint8_t> bytes;
-    QStringList parts = line.split(',');
+std::vector<uint8_t> Parameters::parseHexLine(const std::string& line) const {
+    std::vector<uint8_t> bytes;
+    std::istringstream parts(line);
+    std::string part;
 
-    for (const QString& part : parts) {
-        QString trimmed = part.trimmed();
+    while (std::getline(parts, part, ',')) {
+        std::string value = trimmed(part);
 
         // Remove trailing comments (like "; j" or "; #")
-        int semicolonPos = trimmed.indexOf(';');
-        if (semicolonPos >= 0) {
-            trimmed = trimmed.left(semicolonPos).trimmed();
+        const size_t semicolonPos = value.find(';');
+        if (semicolonPos != std::string::npos) {
+            value = trimmed(value.substr(0, semicolonPos));
         }
 
-        if (trimmed.isEmpty()) continue;
+        if (value.empty()) continue;
 
         // Handle hex values (0x?? or 0??h)
         bool ok = false;
-        uint8_t byte = 0;
+        unsigned long byte = 0;
 
-        if (trimmed.startsWith("0x", Qt::CaseInsensitive)) {
-            byte = trimmed.mid(2).toUInt(&ok, 16);
-        } else if (trimmed.endsWith("h", Qt::CaseInsensitive)) {
-            byte = trimmed.chopped(1).toUInt(&ok, 16);
+        if (value.size() > 2 && value[0] == '0' && (value[1] == 'x' || value[1] == 'X')) {
+            ok = parseUnsigned(value.substr(2), 16, byte);
+        } else if (value.back() == 'h' || value.back() == 'H') {
+            ok = parseUnsigned(value.substr(0, value.size() - 1), 16, byte);
         } else {
             // Try decimal
-            byte = trimmed.toUInt(&ok, 10);
+            ok = parseUnsigned(value, 10, byte);
         }
 
         if (ok) {
-            bytes.append(byte);
+            bytes.push_back(static_cast<uint8_t>(byte));
         }
     }
 
     return bytes;
 }
 
-double Parameters::bytesToDouble(const QVector<uint8_t>& bytes) const {
-    if (bytes.size() != 8) return 0.0;
-
+double Parameters::bytesToDouble(const uint8_t* bytes) const {
     // Little-endian byte order
     uint64_t value = 0;
     for (int i = 0; i < 8; ++i) {
@@ -193,32 +212,36 @@ double Parameters::bytesToDouble(const QVector<uint8_t>& bytes) const {
     return result;
 }
 
-QVector<Parameters::FilterCoeffs> Parameters::getPreFilterCoeffs(int sampleRate) const {
-    if (m_preFilterCoeffs.contains(sampleRate)) {
-        return m_preFilterCoeffs[sampleRate];
+std::vector<Parameters::FilterCoeffs> Parameters::getPreFilterCoeffs(int sampleRate) const {
+    auto it = m_preFilterCoeffs.find(sampleRate);
+    if (it != m_preFilterCoeffs.end()) {
+        return it->second;
     }
 
     // Return closest match or 48000 as default
-    if (m_preFilterCoeffs.contains(48000)) {
-        return m_preFilterCoeffs[48000];
+    it = m_preFilterCoeffs.find(48000);
+    if (it != m_preFilterCoeffs.end()) {
+        return it->second;
     }
 
-    return m_preFilterCoeffs.isEmpty() ? QVector<FilterCoeffs>() : m_preFilterCoeffs.first();
+    return m_preFilterCoeffs.empty() ? std::vector<FilterCoeffs>() : m_preFilterCoeffs.begin()->second;
 }
 
-QVector<Parameters::FilterCoeffs> Parameters::getPostFilterCoeffs(int sampleRate) const {
-    if (m_postFilterCoeffs.contains(sampleRate)) {
-        return m_postFilterCoeffs[sampleRate];
+std::vector<Parameters::FilterCoeffs> Parameters::getPostFilterCoeffs(int sampleRate) const {
+    auto it = m_postFilterCoeffs.find(sampleRate);
+    if (it != m_postFilterCoeffs.end()) {
+        return it->second;
     }
 
-    if (m_postFilterCoeffs.contains(48000)) {
-        return m_postFilterCoeffs[48000];
+    it = m_postFilterCoeffs.find(48000);
+    if (it != m_postFilterCoeffs.end()) {
+        return it->second;
     }
 
-    return m_postFilterCoeffs.isEmpty() ? QVector<FilterCoeffs>() : m_postFilterCoeffs.first();
+    return m_postFilterCoeffs.empty() ? std::vector<FilterCoeffs>() : m_postFilterCoeffs.begin()->second;
 }
 
-QVector<int> Parameters::getSupportedSampleRates() const {
+std::vector<int> Parameters::getSupportedSampleRates() const {
     return {44100, 48000, 88200, 96000, 176400, 192000};
 }
 
@@ -226,11 +249,9 @@ void Parameters::loadDefaultCoefficients() {
     // Default high-quality biquad coefficients for tube amp emulation
     // These provide a warm, musical frequency response
 
-    QVector<int> rates = {44100, 48000, 88200, 96000, 176400, 192000};
-
-    for (int rate : rates) {
-        QVector<FilterCoeffs> preCoeffs;
-        QVector<FilterCoeffs> postCoeffs;
+    for (int rate : getSupportedSampleRates()) {
+        std::vector<FilterCoeffs> preCoeffs;
+        std::vector<FilterCoeffs> postCoeffs;
 
         // Pre-filter: Gentle high-shelf boost (presence)
         FilterCoeffs pre1;
@@ -239,7 +260,7 @@ void Parameters::loadDefaultCoefficients() {
         pre1.b2 = 0.9398;
         pre1.a1 = -1.9692;
         pre1.a2 = 0.9704;
-        preCoeffs.append(pre1);
+        preCoeffs.push_back(pre1);
 
         // Pre-filter: Low-shelf warmth
         FilterCoeffs pre2;
@@ -248,7 +269,7 @@ void Parameters::loadDefaultCoefficients() {
         pre2.b2 = 0.9685;
         pre2.a1 = -1.9839;
         pre2.a2 = 0.9843;
-        preCoeffs.append(pre2);
+        preCoeffs.push_back(pre2);
 
         // Post-filter: Speaker cabinet simulation (low-pass)
         FilterCoeffs post1;
@@ -257,7 +278,7 @@ void Parameters::loadDefaultCoefficients() {
         post1.b2 = 0.0675;
         post1.a1 = -1.1430;
         post1.a2 = 0.4128;
-        postCoeffs.append(post1);
+        postCoeffs.push_back(post1);
 
         // Post-filter: Resonance peak
         FilterCoeffs post2;
@@ -266,7 +287,7 @@ void Parameters::loadDefaultCoefficients() {
         post2.b2 = 0.9507;
         post2.a1 = -1.9321;
         post2.a2 = 0.9333;
-        postCoeffs.append(post2);
+        postCoeffs.push_back(post2);
 
         m_preFilterCoeffs[rate] = preCoeffs;
         m_postFilterCoeffs[rate] = postCoeffs;
@@ -1,10 +1,11 @@
 #ifndef PARAMETERS_H
 #define PARAMETERS_H
 
-#include <QString>
-#include <QVector>
-#include <QMap>
 #include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
 
 class Parameters {
 public:
@@ -14,17 +15,19 @@ public:
     };
 
     struct FilterStage {
-        QVector<FilterCoeffs> coeffs;
+        std::vector<FilterCoeffs> coeffs;
     };
 
     Parameters();
 
-    bool loadFromFile(const QString& path);
-    bool loadFromResource();
+    bool loadFromFile(const std::string& path);
+
+    // Parses IDA-format text already in memory (e.g. read from a Qt resource)
+    bool loadFromString(const std::string& content);
 
     // Get filter coefficients for a specific sample rate
-    QVector<FilterCoeffs> getPreFilterCoeffs(int sampleRate) const;
-    QVector<FilterCoeffs> getPostFilterCoeffs(int sampleRate) const;
+    std::vector<FilterCoeffs> getPreFilterCoeffs(int sampleRate) const;
+    std::vector<FilterCoeffs> getPostFilterCoeffs(int sampleRate) const;
 
     // Tube emulation parameters
     double getTubeBias() const { return m_tubeBias; }
@@ -32,21 +35,21 @@ public:
     double getTubeAsymmetry() const { return m_tubeAsymmetry; }
 
     // Supported sample rates
-    QVector<int> getSupportedSampleRates() const;
+    std::vector<int> getSupportedSampleRates() const;
 
     bool isLoaded() const { return m_loaded; }
 
 private:
-    bool parseIDAFormat(const QString& content);
-    double bytesToDouble(const QVector<uint8_t>& bytes) const;
-    QVector<uint8_t> parseHexLine(const QString& line) const;
+    bool parseIDAFormat(const std::string& content);
+    double bytesToDouble(const uint8_t* bytes) const;
+    std::vector<uint8_t> parseHexLine(const std::string& line) const;
 
     // Filter coefficients organized by sample rate
-    QMap<int, QVector<FilterCoeffs>> m_preFilterCoeffs;
-    QMap<int, QVector<FilterCoeffs>> m_postFilterCoeffs;
+    std::map<int, std::vector<FilterCoeffs>> m_preFilterCoeffs;
+    std::map<int, std::vector<FilterCoeffs>> m_postFilterCoeffs;
 
     // Raw coefficient data extracted from IDA format
-    QVector<double> m_rawCoeffs;
+    std::vector<double> m_rawCoeffs;
 
     // Tube parameters
     double m_tubeBias = 0.0;
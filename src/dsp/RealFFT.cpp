@@ -0,0 +1,240 @@
+#include "RealFFT.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REALFFT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+constexpr double kTwoPi = 6.283185307179586476925286766559;
+
+#ifdef REALFFT_SSE2
+inline __m128 reverse(__m128 v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+#endif
+} // namespace
+
+RealFFT::RealFFT(int size) {
+    setSize(size);
+}
+
+void RealFFT::setSize(int size) {
+    int rounded = 16;
+    while (rounded < size) {
+        rounded <<= 1;
+    }
+    m_size = rounded;
+    m_half = rounded / 2;
+
+    int bits = 0;
+    while ((1 << bits) < m_half) {
+        ++bits;
+    }
+    m_bitReverse.resize(m_half);
+    for (int n = 0; n < m_half; ++n) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            reversed |= ((n >> b) & 1) << (bits - 1 - b);
+        }
+        m_bitReverse[n] = reversed;
+    }
+
+    // Twiddles of stages 8, 16, .. m_half, k-contiguous so four load at once
+    m_stageCos.clear();
+    m_stageSin.clear();
+    for (int len = 8; len <= m_half; len <<= 1) {
+        for (int k = 0; k < len / 2; ++k) {
+            m_stageCos.push_back(static_cast<float>(std::cos(kTwoPi * k / len)));
+            m_stageSin.push_back(static_cast<float>(-std::sin(kTwoPi * k / len)));
+        }
+    }
+
+    m_unpackCos.resize(m_half);
+    m_unpackSin.resize(m_half);
+    for (int k = 0; k < m_half; ++k) {
+        m_unpackCos[k] = static_cast<float>(std::cos(kTwoPi * k / m_size));
+        m_unpackSin[k] = static_cast<float>(-std::sin(kTwoPi * k / m_size));
+    }
+
+    m_re.assign(m_half, 0.0f);
+    m_im.assign(m_half, 0.0f);
+    m_outRe.assign(m_half + 1, 0.0f);
+    m_outIm.assign(m_half + 1, 0.0f);
+}
+
+void RealFFT::transform(const float* input) {
+    float* re = m_re.data();
+    float* im = m_im.data();
+    const int n = m_half;
+
+    for (int i = 0; i < n; ++i) {
+        const int p = m_bitReverse[i];
+        re[p] = input[2 * i];
+        im[p] = input[2 * i + 1];
+    }
+    butterflies();
+}
+
+void RealFFT::butterflies() {
+    float* re = m_re.data();
+    float* im = m_im.data();
+    const int n = m_half;
+
+    // Stages 2 and 4 have trivial twiddles (1 and -i)
+    for (int j = 0; j < n; j += 4) {
+        const float r0 = re[j] + re[j + 1], i0 = im[j] + im[j + 1];
+        const float r1 = re[j] - re[j + 1], i1 = im[j] - im[j + 1];
+        const float r2 = re[j + 2] + re[j + 3], i2 = im[j + 2] + im[j + 3];
+        const float r3 = re[j + 2] - re[j + 3], i3 = im[j + 2] - im[j + 3];
+
+        re[j] = r0 + r2;      im[j] = i0 + i2;
+        re[j + 2] = r0 - r2;  im[j + 2] = i0 - i2;
+        re[j + 1] = r1 + i3;  im[j + 1] = i1 - r3;
+        re[j + 3] = r1 - i3;  im[j + 3] = i1 + r3;
+    }
+
+    const float* stageCos = m_stageCos.data();
+    const float* stageSin = m_stageSin.data();
+    for (int len = 8; len <= n; len <<= 1) {
+        const int half = len / 2;
+        for (int j = 0; j < n; j += len) {
+            float* aRe = re + j;
+            float* aIm = im + j;
+            float* bRe = aRe + half;
+            float* bIm = aIm + half;
+            int k = 0;
+#ifdef REALFFT_SSE2
+            for (; k < half; k += 4) {
+                const __m128 c = _mm_loadu_ps(stageCos + k);
+                const __m128 s = _mm_loadu_ps(stageSin + k);
+                const __m128 br = _mm_loadu_ps(bRe + k);
+                const __m128 bi = _mm_loadu_ps(bIm + k);
+                const __m128 tr = _mm_sub_ps(_mm_mul_ps(c, br), _mm_mul_ps(s, bi));
+                const __m128 ti = _mm_add_ps(_mm_mul_ps(c, bi), _mm_mul_ps(s, br));
+                const __m128 ar = _mm_loadu_ps(aRe + k);
+                const __m128 ai = _mm_loadu_ps(aIm + k);
+                _mm_storeu_ps(aRe + k, _mm_add_ps(ar, tr));
+                _mm_storeu_ps(aIm + k, _mm_add_ps(ai, ti));
+                _mm_storeu_ps(bRe + k, _mm_sub_ps(ar, tr));
+                _mm_storeu_ps(bIm + k, _mm_sub_ps(ai, ti));
+            }
+#endif
+            for (; k < half; ++k) {
+                const float tr = stageCos[k] * bRe[k] - stageSin[k] * bIm[k];
+                const float ti = stageCos[k] * bIm[k] + stageSin[k] * bRe[k];
+                const float ar = aRe[k];
+                const float ai = aIm[k];
+                aRe[k] = ar + tr;
+                aIm[k] = ai + ti;
+                bRe[k] = ar - tr;
+                bIm[k] = ai - ti;
+            }
+        }
+        stageCos += half;
+        stageSin += half;
+    }
+}
+
+void RealFFT::forward(const float* input, float* outRe, float* outIm) {
+    transform(input);
+
+    const float* re = m_re.data();
+    const float* im = m_im.data();
+    const int n = m_half;
+
+    outRe[0] = re[0] + im[0];
+    outIm[0] = 0.0f;
+    outRe[n] = re[0] - im[0];
+    outIm[n] = 0.0f;
+
+    // X[k] = E + W^k * O with E, O the spectra of the even and odd samples:
+    // E = (Z[k] + conj(Z[n-k])) / 2, O = -i (Z[k] - conj(Z[n-k])) / 2
+    int k = 1;
+#ifdef REALFFT_SSE2
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (; k + 4 <= n; k += 4) {
+        const __m128 ar = _mm_loadu_ps(re + k);
+        const __m128 ai = _mm_loadu_ps(im + k);
+        const __m128 br = reverse(_mm_loadu_ps(re + n - k - 3));
+        const __m128 bi = reverse(_mm_loadu_ps(im + n - k - 3));  // conj: used negated below
+
+        const __m128 er = _mm_mul_ps(_mm_add_ps(ar, br), half);
+        const __m128 ei = _mm_mul_ps(_mm_sub_ps(ai, bi), half);
+        const __m128 orr = _mm_mul_ps(_mm_add_ps(ai, bi), half);
+        const __m128 oi = _mm_mul_ps(_mm_sub_ps(br, ar), half);
+
+        const __m128 c = _mm_loadu_ps(m_unpackCos.data() + k);
+        const __m128 s = _mm_loadu_ps(m_unpackSin.data() + k);
+        _mm_storeu_ps(outRe + k, _mm_add_ps(er, _mm_sub_ps(_mm_mul_ps(c, orr), _mm_mul_ps(s, oi))));
+        _mm_storeu_ps(outIm + k, _mm_add_ps(ei, _mm_add_ps(_mm_mul_ps(c, oi), _mm_mul_ps(s, orr))));
+    }
+#endif
+    for (; k < n; ++k) {
+        const float ar = re[k], ai = im[k];
+        const float br = re[n - k], bi = im[n - k];
+
+        const float er = (ar + br) * 0.5f;
+        const float ei = (ai - bi) * 0.5f;
+        const float orr = (ai + bi) * 0.5f;
+        const float oi = (br - ar) * 0.5f;
+
+        const float c = m_unpackCos[k], s = m_unpackSin[k];
+        outRe[k] = er + c * orr - s * oi;
+        outIm[k] = ei + c * oi + s * orr;
+    }
+}
+
+void RealFFT::inverse(const float* inRe, const float* inIm, float* output) {
+    float* re = m_re.data();
+    float* im = m_im.data();
+    const int n = m_half;
+
+    // Rebuild Z[k] = E + i O, the spectrum of the packed samples, from X[k] and
+    // X[n-k]: E = (X[k] + conj(X[n-k])) / 2, O = (X[k] - conj(X[n-k])) / (2 W^k).
+    // It goes in conjugated, so the forward butterflies compute the inverse
+    for (int k = 0; k < n; ++k) {
+        const float ar = inRe[k], ai = inIm[k];
+        const float br = inRe[n - k], bi = inIm[n - k];
+
+        const float er = (ar + br) * 0.5f;
+        const float ei = (ai - bi) * 0.5f;
+        const float dr = (ar - br) * 0.5f;
+        const float di = (ai + bi) * 0.5f;
+
+        const float c = m_unpackCos[k], s = m_unpackSin[k];
+        const float orr = dr * c + di * s;
+        const float oi = di * c - dr * s;
+
+        const int p = m_bitReverse[k];
+        re[p] = er - oi;
+        im[p] = -(ei + orr);
+    }
+    butterflies();
+
+    const float scale = 1.0f / n;
+    for (int i = 0; i < n; ++i) {
+        output[2 * i] = re[i] * scale;
+        output[2 * i + 1] = -im[i] * scale;
+    }
+}
+
+void RealFFT::powerSpectrum(const float* input, float* power) {
+    forward(input, m_outRe.data(), m_outIm.data());
+
+    const float* re = m_outRe.data();
+    const float* im = m_outIm.data();
+    const int bins = getBinCount();
+    int k = 0;
+#ifdef REALFFT_SSE2
+    for (; k + 4 <= bins; k += 4) {
+        const __m128 r = _mm_loadu_ps(re + k);
+        const __m128 i = _mm_loadu_ps(im + k);
+        _mm_storeu_ps(power + k, _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(i, i)));
+    }
+#endif
+    for (; k < bins; ++k) {
+        power[k] = re[k] * re[k] + im[k] * im[k];
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef REALFFT_H
+#define REALFFT_H
+
+#include <vector>
+
+/**
+ * RealFFT - Forward FFT of a real power-of-two block
+ *
+ * The N real samples are packed as N/2 complex values (even samples real,
+ * odd samples imaginary) in split re/im arrays, transformed with an
+ * iterative radix-2 FFT and unpacked into the N/2 + 1 bins of the real
+ * spectrum. Bit reversal happens while packing. From the third stage on,
+ * butterflies and the unpacking run four at a time with SSE; other
+ * targets use the same loops in scalar form. inverse() repacks a real
+ * spectrum and runs the same butterflies on its conjugate.
+ */
+class RealFFT {
+public:
+    explicit RealFFT(int size = 4096);
+
+    // Power of two, at least 16; allocates
+    void setSize(int size);
+    int getSize() const { return m_size; }
+    int getBinCount() const { return m_size / 2 + 1; }
+
+    // re/im receive getBinCount() values; bin k is k * sampleRate / size Hz
+    void forward(const float* input, float* re, float* im);
+
+    // getBinCount() bins back to 'size' samples; inverse(forward(x)) == x
+    void inverse(const float* re, const float* im, float* output);
+
+    // |X[k]|^2 for k = 0 .. size/2
+    void powerSpectrum(const float* input, float* power);
+
+private:
+    void transform(const float* input);
+    void butterflies();  // in place on m_re/m_im, input in bit-reversed order
+
+    int m_size = 0;
+    int m_half = 0;
+    std::vector<int> m_bitReverse;     // m_half entries
+    std::vector<float> m_stageCos;     // per stage with >= 4 butterflies, concatenated
+    std::vector<float> m_stageSin;
+    std::vector<float> m_unpackCos;    // exp(-2 pi i k / size), k < m_half
+    std::vector<float> m_unpackSin;
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+    std::vector<float> m_outRe;        // scratch for powerSpectrum
+    std::vector<float> m_outIm;
+};
+
+#endif // REALFFT_H
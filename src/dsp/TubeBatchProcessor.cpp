@@ -0,0 +1,205 @@
+#include "TubeBatchProcessor.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TUBEBATCH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+constexpr int W = TubeBatchProcessor::kLaneWidth;
+
+#ifdef TUBEBATCH_SSE2
+inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// logf for 4 lanes (Cephes polynomial, ~1 ulp); non-positive input gives NaN
+inline __m128 log4(__m128 x) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 invalid = _mm_cmple_ps(x, _mm_setzero_ps());
+
+    __m128i exponent = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(x), 23), _mm_set1_epi32(126));
+    __m128 e = _mm_cvtepi32_ps(exponent);
+    __m128 m = _mm_or_ps(_mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x007fffff))),
+                         _mm_set1_ps(0.5f));  // mantissa in [0.5, 1)
+
+    // Re-center the mantissa around 1 for the polynomial
+    __m128 small = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+    e = _mm_sub_ps(e, _mm_and_ps(one, small));
+    m = _mm_add_ps(_mm_sub_ps(m, one), _mm_and_ps(m, small));
+
+    __m128 z = _mm_mul_ps(m, m);
+    __m128 y = _mm_set1_ps(7.0376836292e-2f);
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.1514610310e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174e-1f));
+    y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+    y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+
+    __m128 result = _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+    return _mm_or_ps(result, invalid);  // all-ones is a NaN
+}
+
+// expf for 4 lanes (Cephes polynomial, ~1 ulp)
+inline __m128 exp4(__m128 x) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.3f)), _mm_set1_ps(88.3f));
+
+    // n = round(x / ln2) using a truncating conversion
+    __m128 v = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+    __m128 fn = _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, v), one));
+
+    x = _mm_sub_ps(x, _mm_mul_ps(fn, _mm_set1_ps(0.693359375f)));
+    x = _mm_sub_ps(x, _mm_mul_ps(fn, _mm_set1_ps(-2.12194440e-4f)));
+
+    __m128 z = _mm_mul_ps(x, x);
+    __m128 y = _mm_set1_ps(1.9875691500e-4f);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+    y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), one);
+
+    __m128i pow2n = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fn), _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(y, _mm_castsi128_ps(pow2n));
+}
+
+// TubeEmulator::shapeSample for 4 lanes. Both saturation branches are
+// folded into selects so every lane runs the same straight-line code.
+inline __m128 shape4(__m128 in) {
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    __m128 scaled = _mm_mul_ps(in, _mm_set1_ps(0.75f));
+    __m128 shaped = _mm_sub_ps(_mm_mul_ps(scaled, _mm_set1_ps(0.85f)),
+                               _mm_mul_ps(log4(_mm_sub_ps(one, scaled)), _mm_set1_ps(0.15f)));
+
+    __m128 absComp = _mm_andnot_ps(signMask, _mm_mul_ps(scaled, _mm_set1_ps(0.9f)));
+    __m128 negComp = _mm_xor_ps(absComp, signMask);
+    __m128 upper = _mm_cmplt_ps(absComp, shaped);
+    __m128 lower = _mm_cmpgt_ps(negComp, shaped);
+
+    __m128 base = select(upper, absComp, negComp);
+    __m128 diff = _mm_sub_ps(shaped, base);
+    __m128 soft = _mm_add_ps(base, _mm_div_ps(diff, _mm_add_ps(exp4(_mm_xor_ps(diff, signMask)), one)));
+
+    return select(_mm_or_ps(upper, lower), soft, shaped);
+}
+#endif
+
+// Shaper over one lane group, widened to double for the IIR
+inline void shapeLanes(const float* in, double* out) {
+#ifdef TUBEBATCH_SSE2
+    for (int l = 0; l < W; l += 4) {
+        __m128 shaped = shape4(_mm_load_ps(in + l));
+        _mm_store_pd(out + l, _mm_cvtps_pd(shaped));
+        _mm_store_pd(out + l + 2, _mm_cvtps_pd(_mm_movehl_ps(shaped, shaped)));
+    }
+#else
+    for (int l = 0; l < W; ++l) {
+        out[l] = static_cast<double>(TubeEmulator::shapeSample(in[l]));
+    }
+#endif
+}
+} // namespace
+
+TubeBatchProcessor::TubeBatchProcessor(int laneCount) {
+    m_coeffs = TubeEmulator::coefficientsForRate(m_sampleRate);
+    setLaneCount(laneCount);
+}
+
+void TubeBatchProcessor::setLaneCount(int laneCount) {
+    m_laneCount = std::max(1, laneCount);
+    m_groups.assign((m_laneCount + W - 1) / W, GroupState{});
+    m_stereoLanes.assign(m_laneCount + 1, nullptr);
+}
+
+void TubeBatchProcessor::setSampleRate(int sampleRate) {
+    if (sampleRate != m_sampleRate) {
+        m_sampleRate = sampleRate;
+        m_coeffs = TubeEmulator::coefficientsForRate(sampleRate);
+        reset();
+    }
+}
+
+void TubeBatchProcessor::reset() {
+    std::fill(m_groups.begin(), m_groups.end(), GroupState{});
+}
+
+void TubeBatchProcessor::process(float* const* lanes, int numSamples) {
+    for (size_t g = 0; g < m_groups.size(); ++g) {
+        int first = static_cast<int>(g) * W;
+        int count = std::min(W, m_laneCount - first);
+        processGroup(m_groups[g], lanes + first, count, numSamples);
+    }
+}
+
+void TubeBatchProcessor::processStereo(float* const* left, float* const* right, int numSamples) {
+    const int streams = m_laneCount / 2;
+    for (int k = 0; k < streams; ++k) {
+        m_stereoLanes[2 * k] = left[k];
+        m_stereoLanes[2 * k + 1] = right[k];
+    }
+    process(m_stereoLanes.data(), numSamples);
+}
+
+void TubeBatchProcessor::processGroup(GroupState& state, float* const* lanes, int laneCount, int numSamples) {
+    const TubeEmulator::Coefficients& c = m_coeffs;
+    const double scale = TubeEmulator::kOutputScale;
+
+    // Frame-major tile: tile[t][lane], so each time step is one contiguous vector
+    alignas(64) float tile[kTileFrames][W];
+    alignas(64) double x[W];
+
+    for (int offset = 0; offset < numSamples; offset += kTileFrames) {
+        const int frames = std::min(kTileFrames, numSamples - offset);
+
+        // Gather (unused lanes run on silence and are never written back)
+        for (int l = 0; l < W; ++l) {
+            if (l < laneCount) {
+                const float* src = lanes[l] + offset;
+                for (int t = 0; t < frames; ++t) {
+                    tile[t][l] = src[t];
+                }
+            } else {
+                for (int t = 0; t < frames; ++t) {
+                    tile[t][l] = 0.0f;
+                }
+            }
+        }
+
+        for (int t = 0; t < frames; ++t) {
+            shapeLanes(tile[t], x);
+
+            // Transposed direct form, identical tap order to TubeEmulator::processFilter
+            for (int l = 0; l < W; ++l) {
+                double y = c.b[0] * x[l] + state.z[0][l];
+                state.z[0][l] = c.b[1] * x[l] - c.a[0] * y + state.z[1][l];
+                state.z[1][l] = c.b[2] * x[l] - c.a[1] * y + state.z[2][l];
+                state.z[2][l] = c.b[3] * x[l] - c.a[2] * y + state.z[3][l];
+                state.z[3][l] = c.b[4] * x[l] - c.a[3] * y + state.z[4][l];
+                state.z[4][l] = c.b[5] * x[l] - c.a[4] * y + state.z[5][l];
+                state.z[5][l] = c.b[6] * x[l] - c.a[5] * y;
+                tile[t][l] = static_cast<float>(y * scale);
+            }
+        }
+
+        // Scatter
+        for (int l = 0; l < laneCount; ++l) {
+            float* dst = lanes[l] + offset;
+            for (int t = 0; t < frames; ++t) {
+                dst[t] = tile[t][l];
+            }
+        }
+    }
+}
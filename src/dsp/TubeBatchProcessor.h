@@ -0,0 +1,57 @@
+#ifndef TUBEBATCHPROCESSOR_H
+#define TUBEBATCHPROCESSOR_H
+
+#include "TubeEmulator.h"
+#include <vector>
+
+/**
+ * TubeBatchProcessor - 300B model for many independent streams at once
+ *
+ * Structure-of-arrays counterpart of TubeEmulator for offline/server use.
+ * Every channel buffer handed to process() is one lane; a stereo stream
+ * simply contributes two lanes. Lanes are advanced in groups of kLaneWidth,
+ * with the shaper and the 6th-order IIR state stored lane-contiguous so the
+ * per-sample recursion runs across lanes in vector registers instead of
+ * serially per stream.
+ *
+ * On SSE2 targets the shaper runs 4 lanes per instruction with polynomial
+ * log/exp, so output tracks TubeEmulator::process/processMono to within a
+ * few float ulps per lane; other targets fall back to the scalar shaper.
+ */
+class TubeBatchProcessor {
+public:
+    static constexpr int kLaneWidth = 8;
+    static constexpr int kTileFrames = 64;
+
+    explicit TubeBatchProcessor(int laneCount = kLaneWidth);
+
+    void setLaneCount(int laneCount);
+    int getLaneCount() const { return m_laneCount; }
+
+    void setSampleRate(int sampleRate);
+    int getSampleRate() const { return m_sampleRate; }
+
+    void reset();
+
+    // lanes[k] points to numSamples contiguous samples of lane k, processed in place
+    void process(float* const* lanes, int numSamples);
+
+    // Convenience for K stereo streams: left[k]/right[k] map to lanes 2k/2k+1
+    void processStereo(float* const* left, float* const* right, int numSamples);
+
+private:
+    // Filter state of one lane group, lane index innermost
+    struct alignas(64) GroupState {
+        double z[6][kLaneWidth] = {};
+    };
+
+    void processGroup(GroupState& state, float* const* lanes, int laneCount, int numSamples);
+
+    TubeEmulator::Coefficients m_coeffs;
+    std::vector<GroupState> m_groups;
+    std::vector<float*> m_stereoLanes;
+    int m_laneCount = 0;
+    int m_sampleRate = 48000;
+};
+
+#endif // TUBEBATCHPROCESSOR_H
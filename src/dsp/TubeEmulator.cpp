@@ -76,19 +76,28 @@ void TubeEmulator::reset() {
 }
 
 void TubeEmulator::loadCoefficients(int sampleRate) {
+    m_coeffs = coefficientsForRate(sampleRate);
+}
+
+TubeEmulator::Coefficients TubeEmulator::coefficientsForRate(int sampleRate) {
     const auto& entry = pickRate(sampleRate);
-    m_coeffs = {};
+    Coefficients coeffs;
     // Feedforward b0..b6
     for (int i = 0; i < 7; ++i) {
-        m_coeffs.b[i] = entry.coeffs[i];
+        coeffs.b[i] = entry.coeffs[i];
     }
     // Feedback a1..a6 (a0 is 1.0)
     for (int i = 0; i < 6; ++i) {
-        m_coeffs.a[i] = entry.coeffs[8 + i]; // skip the a0=1.0 at index 7
+        coeffs.a[i] = entry.coeffs[8 + i]; // skip the a0=1.0 at index 7
     }
+    return coeffs;
+}
+
+bool TubeEmulator::isRateSupported(int sampleRate) {
+    return pickRate(sampleRate).rate == sampleRate;
 }
 
-float TubeEmulator::shapeSample(float x) const {
+float TubeEmulator::shapeSample(float x) {
     // Recreate the log/exp soft saturation from resources/原始代码.txt
     float scaled = x * 0.75f;
     float shaped = scaled * 0.85f - std::log(1.0f - scaled) * 0.15f;
@@ -11,17 +11,22 @@ public:
     void reset();
     void setSampleRate(int sampleRate);
 
-private:
+    // Shared with the batch/offline kernels so they stay in lockstep with this one
     struct Coefficients {
         double b[7] = {0};
         double a[6] = {0}; // a0 assumed to be 1
     };
 
+    static Coefficients coefficientsForRate(int sampleRate);
+    static bool isRateSupported(int sampleRate);  // false means nearest-rate fallback
+    static float shapeSample(float x);
+    static constexpr float kOutputScale = 1.33f;
+
+private:
     struct FilterState {
         double z[6] = {0};
     };
 
-    float shapeSample(float x) const;
     double processFilter(double x, FilterState& state) const;
 
     void loadCoefficients(int sampleRate);
@@ -31,7 +36,6 @@ private:
     FilterState m_stateR;
 
     float m_outputGainDb = 0.0f;
-    static constexpr float kOutputScale = 1.33f;
 
     int m_sampleRate = 48000;
 };
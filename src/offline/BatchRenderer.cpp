@@ -0,0 +1,147 @@
+#include "BatchRenderer.h"
+#include "../core/WorkStealingPool.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <system_error>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace {
+std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+bool isWavFile(const fs::path& path) {
+    return toLower(path.extension().string()) == ".wav";
+}
+
+// Give every item its own output file. Case-insensitive, since the output
+// may live on a filesystem that folds case even when the inputs did not
+void makeOutputsUnique(std::vector<BatchItem>& items) {
+    std::unordered_set<std::string> taken;
+    for (auto& item : items) {
+        const fs::path original(item.outputPath);
+        fs::path candidate = original;
+        for (int suffix = 2; !taken.insert(toLower(candidate.lexically_normal().string())).second; ++suffix) {
+            candidate = original.parent_path()
+                / (original.stem().string() + "-" + std::to_string(suffix) + original.extension().string());
+        }
+        if (candidate != original) {
+            LOG_WARNING("Batch: " + item.inputPath + " shares its output name, writing " + candidate.string());
+            item.outputPath = candidate.string();
+        }
+    }
+}
+} // namespace
+
+size_t BatchSummary::getFailedCount() const {
+    return std::count_if(items.begin(), items.end(), [](const BatchItem& item) { return !item.result.ok; });
+}
+
+double BatchSummary::getAudioSeconds() const {
+    double total = 0.0;
+    for (const auto& item : items) {
+        total += item.result.getAudioSeconds();
+    }
+    return total;
+}
+
+BatchRenderer::BatchRenderer(const RenderOptions& options, int workerCount)
+    : m_options(options)
+    , m_workerCount(workerCount)
+{
+    // Parallelism comes from the pool; each task renders on its worker thread
+    m_options.pipelined = false;
+}
+
+std::vector<BatchItem> BatchRenderer::plan(const std::string& source, const std::string& outputDir,
+                                           std::string* error) {
+    std::vector<BatchItem> items;
+    std::error_code ec;
+    const fs::path root(source);
+    const fs::path outRoot(outputDir);
+
+    if (fs::is_directory(root, ec)) {
+        for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file(ec) && isWavFile(it->path())) {
+                BatchItem item;
+                item.inputPath = it->path().string();
+                item.outputPath = (outRoot / fs::relative(it->path(), root, ec)).string();
+                items.push_back(std::move(item));
+            }
+        }
+    } else {
+        std::ifstream list(source);
+        if (!list) {
+            ec = std::make_error_code(std::errc::no_such_file_or_directory);
+        }
+        std::string line;
+        while (std::getline(list, line)) {
+            while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) {
+                line.pop_back();
+            }
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            BatchItem item;
+            item.inputPath = line;
+            item.outputPath = (outRoot / fs::path(line).filename()).string();
+            items.push_back(std::move(item));
+        }
+    }
+
+    if (ec && error) {
+        *error = "Cannot read " + source + ": " + ec.message();
+    }
+    makeOutputsUnique(items);
+    return items;
+}
+
+BatchSummary BatchRenderer::render(std::vector<BatchItem> items) const {
+    BatchSummary summary;
+    const auto begin = std::chrono::steady_clock::now();
+
+    // Longest files first: the pool then finishes with short tasks that balance out
+    std::vector<uintmax_t> sizes(items.size(), 0);
+    for (size_t i = 0; i < items.size(); ++i) {
+        std::error_code ec;
+        sizes[i] = fs::file_size(items[i].inputPath, ec);
+    }
+    std::vector<size_t> order(items.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    {
+        WorkStealingPool pool(m_workerCount);
+        summary.workerCount = pool.getThreadCount();
+        LOG_INFO("Batch render: " + std::to_string(items.size()) + " files on "
+                 + std::to_string(summary.workerCount) + " workers");
+
+        const OfflineRenderer renderer(m_options);
+        for (size_t index : order) {
+            BatchItem* item = &items[index];
+            pool.submit([item, &renderer]() {
+                std::error_code ec;
+                fs::create_directories(fs::path(item->outputPath).parent_path(), ec);
+                item->result = renderer.render(item->inputPath, item->outputPath);
+                if (!item->result.ok) {
+                    LOG_WARNING("Batch: " + item->inputPath + " failed: " + item->result.error);
+                }
+            });
+        }
+        pool.waitIdle();
+    }
+
+    summary.items = std::move(items);
+    summary.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return summary;
+}
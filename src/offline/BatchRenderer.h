@@ -0,0 +1,51 @@
+#ifndef BATCHRENDERER_H
+#define BATCHRENDERER_H
+
+#include "OfflineRenderer.h"
+#include <string>
+#include <vector>
+
+struct BatchItem {
+    std::string inputPath;
+    std::string outputPath;
+    RenderResult result;
+};
+
+struct BatchSummary {
+    std::vector<BatchItem> items;
+    double wallSeconds = 0.0;
+    int workerCount = 0;
+
+    size_t getFailedCount() const;
+    double getAudioSeconds() const;
+    double getRealtimeFactor() const { return wallSeconds > 0.0 ? getAudioSeconds() / wallSeconds : 0.0; }
+};
+
+/**
+ * BatchRenderer - Renders many files in parallel on a WorkStealingPool
+ *
+ * Every file is one task with its own DSP chain, rendered serially inside
+ * the task, so a worker never holds more than one block of audio. Files are
+ * queued largest first so long tracks do not end up as a straggler tail.
+ */
+class BatchRenderer {
+public:
+    // workerCount <= 0 uses one worker per hardware thread
+    explicit BatchRenderer(const RenderOptions& options = RenderOptions(), int workerCount = 0);
+
+    // source is a directory (searched recursively for .wav files) or a text
+    // file with one input path per line. Directory inputs keep their relative
+    // layout under outputDir; listed files are written flat. Output paths are
+    // unique (compared case-insensitively): a name already taken gets a
+    // "-2", "-3", ... suffix, so no two tasks ever write the same file.
+    static std::vector<BatchItem> plan(const std::string& source, const std::string& outputDir,
+                                       std::string* error = nullptr);
+
+    BatchSummary render(std::vector<BatchItem> items) const;
+
+private:
+    RenderOptions m_options;
+    int m_workerCount;
+};
+
+#endif // BATCHRENDERER_H
@@ -0,0 +1,55 @@
+#include "ChannelGroupProcessor.h"
+#include <algorithm>
+
+ChannelGroupProcessor::ChannelGroupProcessor(int channels, int sampleRate)
+    : m_channels(std::max(1, channels))
+{
+    const int groups = (m_channels + 1) / 2;
+    for (int g = 0; g < groups; ++g) {
+        auto processor = std::make_unique<DSPProcessor>();
+        processor->setSampleRate(sampleRate);
+        m_groups.push_back(std::move(processor));
+    }
+}
+
+void ChannelGroupProcessor::setBypass(bool bypass) {
+    for (const auto& processor : m_groups) {
+        processor->setBypass(bypass);
+    }
+}
+
+void ChannelGroupProcessor::reset() {
+    for (const auto& processor : m_groups) {
+        processor->reset();
+    }
+}
+
+void ChannelGroupProcessor::process(float* buffer, int numFrames) {
+    if (m_channels <= 2) {
+        m_groups[0]->process(buffer, numFrames, m_channels);
+        return;
+    }
+
+    if (m_scratch.size() < static_cast<size_t>(numFrames) * 2) {
+        m_scratch.resize(static_cast<size_t>(numFrames) * 2);
+    }
+
+    for (size_t g = 0; g < m_groups.size(); ++g) {
+        const int first = static_cast<int>(g) * 2;
+        const int width = std::min(2, m_channels - first);
+
+        for (int i = 0; i < numFrames; ++i) {
+            for (int c = 0; c < width; ++c) {
+                m_scratch[i * width + c] = buffer[i * m_channels + first + c];
+            }
+        }
+
+        m_groups[g]->process(m_scratch.data(), numFrames, width);
+
+        for (int i = 0; i < numFrames; ++i) {
+            for (int c = 0; c < width; ++c) {
+                buffer[i * m_channels + first + c] = m_scratch[i * width + c];
+            }
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef CHANNELGROUPPROCESSOR_H
+#define CHANNELGROUPPROCESSOR_H
+
+#include "../dsp/DSPProcessor.h"
+#include <memory>
+#include <vector>
+
+/**
+ * ChannelGroupProcessor - DSPProcessor chain for any channel count
+ *
+ * DSPProcessor handles mono and stereo. Wider files are split into stereo
+ * pairs (plus a trailing mono channel for odd counts), each with its own
+ * DSPProcessor, so every pair sees exactly what the real-time path would.
+ */
+class ChannelGroupProcessor {
+public:
+    ChannelGroupProcessor(int channels, int sampleRate);
+
+    int getChannels() const { return m_channels; }
+
+    void setBypass(bool bypass);
+    void reset();
+
+    // Interleaved, in place
+    void process(float* buffer, int numFrames);
+
+private:
+    int m_channels;
+    std::vector<std::unique_ptr<DSPProcessor>> m_groups;
+    std::vector<float> m_scratch;
+};
+
+#endif // CHANNELGROUPPROCESSOR_H
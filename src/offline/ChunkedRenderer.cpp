@@ -0,0 +1,378 @@
+#include "ChunkedRenderer.h"
+#include "ChannelGroupProcessor.h"
+#include "MappedWavFile.h"
+#include "../core/WorkStealingPool.h"
+#include "../dsp/TubeEmulator.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr int kDecayBlock = 256;
+constexpr double kPi = 3.14159265358979323846;
+
+struct Segment {
+    std::vector<float> samples;
+    size_t frames = 0;
+    bool done = false;
+    std::string error;
+};
+} // namespace
+
+ChunkedRenderer::ChunkedRenderer(const RenderOptions& options, const ChunkOptions& chunkOptions)
+    : m_options(options)
+    , m_chunkOptions(chunkOptions)
+{
+    m_options.blockFrames = std::max(64, m_options.blockFrames);
+}
+
+int ChunkedRenderer::warmupFrames(int sampleRate, double tolerance) {
+    // The shaper is memoryless and bounded by 1 for full-scale input, so a
+    // wrong initial state at n0 changes y[n] by at most
+    // kOutputScale * sum_{k >= n - n0} |h[k]|. Find where that tail drops
+    // below the tolerance, at block granularity.
+    const TubeEmulator::Coefficients c = TubeEmulator::coefficientsForRate(sampleRate);
+    const double limit = tolerance / TubeEmulator::kOutputScale;
+    const int maxBlocks = sampleRate * 60 / kDecayBlock;
+
+    std::vector<double> blockSums;
+    double z[6] = {0};
+    for (int block = 0; block < maxBlocks; ++block) {
+        double sum = 0.0;
+        for (int i = 0; i < kDecayBlock; ++i) {
+            const double x = (block == 0 && i == 0) ? 1.0 : 0.0;
+            const double y = c.b[0] * x + z[0];
+            z[0] = c.b[1] * x - c.a[0] * y + z[1];
+            z[1] = c.b[2] * x - c.a[1] * y + z[2];
+            z[2] = c.b[3] * x - c.a[2] * y + z[3];
+            z[3] = c.b[4] * x - c.a[3] * y + z[4];
+            z[4] = c.b[5] * x - c.a[4] * y + z[5];
+            z[5] = c.b[6] * x - c.a[5] * y;
+            sum += std::fabs(y);
+        }
+        blockSums.push_back(sum);
+        if (block > 0 && sum < limit * 1.0e-4) {
+            break;  // the rest of the tail is negligible
+        }
+    }
+
+    double tail = 0.0;
+    size_t block = blockSums.size();
+    while (block > 0 && tail + blockSums[block - 1] < limit) {
+        tail += blockSums[--block];
+    }
+    return static_cast<int>(block) * kDecayBlock;
+}
+
+double ChunkedRenderer::roundoffFloor(int sampleRate) {
+    const size_t settle = static_cast<size_t>(warmupFrames(sampleRate, 1.0e-12));
+    const size_t measure = static_cast<size_t>(sampleRate / 2);
+
+    // Deterministic busy test signal peaking near full scale
+    std::vector<float> signal(2 * settle + measure);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < signal.size(); ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const float noise = static_cast<float>(seed >> 8) * (1.0f / 16777216.0f) - 0.5f;
+        signal[i] = 0.6f * static_cast<float>(std::sin(2.0 * kPi * 997.0 * i / sampleRate)) + 0.4f * noise;
+    }
+
+    std::vector<float> fromStart(signal);
+    std::vector<float> fromMiddle(signal.begin() + settle, signal.end());
+    TubeEmulator first;
+    TubeEmulator second;
+    first.setSampleRate(sampleRate);
+    second.setSampleRate(sampleRate);
+    first.processMono(fromStart.data(), static_cast<int>(fromStart.size()));
+    second.processMono(fromMiddle.data(), static_cast<int>(fromMiddle.size()));
+
+    double floor = 0.0;
+    for (size_t i = 2 * settle; i < signal.size(); ++i) {
+        floor = std::max(floor, std::fabs(static_cast<double>(fromStart[i]) - fromMiddle[i - settle]));
+    }
+    return floor;
+}
+
+double ChunkedRenderer::resolveTolerance(int sampleRate, const ChunkOptions& options, std::string* error) {
+    const double floor = roundoffFloor(sampleRate);
+    if (options.tolerance <= 0.0) {
+        return std::max(kDefaultTolerance, 2.0 * floor);
+    }
+    if (options.tolerance > floor) {
+        return options.tolerance;
+    }
+    if (options.relaxTolerance) {
+        return 2.0 * floor;
+    }
+
+    if (error) {
+        char text[160];
+        std::snprintf(text, sizeof(text),
+                      "Tolerance %g cannot be met at %d Hz: the filter roundoff floor alone is %g",
+                      options.tolerance, sampleRate, floor);
+        *error = text;
+    }
+    return -1.0;
+}
+
+ChunkedRenderer::SegmentPlan ChunkedRenderer::planSegments(const WavFormat& format, uint64_t totalFrames,
+                                                           std::string& error) const {
+    SegmentPlan plan;
+    if (!m_options.bypass) {
+        const double tolerance = resolveTolerance(format.sampleRate, m_chunkOptions, &error);
+        if (tolerance < 0.0) {
+            return plan;
+        }
+        // Roundoff between two start points takes its share of the tolerance first
+        plan.warmupFrames = warmupFrames(format.sampleRate, tolerance - roundoffFloor(format.sampleRate));
+    }
+    plan.segmentFrames = std::max<uint64_t>({static_cast<uint64_t>(m_chunkOptions.segmentSeconds * format.sampleRate),
+                                             4 * plan.warmupFrames, static_cast<uint64_t>(m_options.blockFrames)});
+    plan.segmentCount = static_cast<size_t>((totalFrames + plan.segmentFrames - 1) / plan.segmentFrames);
+    return plan;
+}
+
+RenderResult ChunkedRenderer::render(const std::string& inputPath, const std::string& outputPath) const {
+    RenderResult result;
+    const auto begin = std::chrono::steady_clock::now();
+
+    if (OfflineRenderer::isSameFile(inputPath, outputPath)) {
+        result.error = "Output " + outputPath + " is the input file";
+    } else if (m_options.memoryMapped) {
+        renderMapped(inputPath, outputPath, result);
+    } else {
+        renderStreaming(inputPath, outputPath, result);
+    }
+
+    result.ok = result.error.empty();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
+
+void ChunkedRenderer::renderMapped(const std::string& inputPath, const std::string& outputPath,
+                                   RenderResult& result) const {
+    MappedWavReader reader;
+    if (!reader.open(inputPath)) {
+        result.error = reader.getError();
+        return;
+    }
+    const WavFormat format = reader.getFormat();
+    const uint64_t totalFrames = reader.getTotalFrames();
+    result.format = format;
+
+    const SegmentPlan plan = planSegments(format, totalFrames, result.error);
+    if (!result.error.empty()) {
+        return;
+    }
+
+    MappedWavWriter writer;
+    if (!writer.create(outputPath, OfflineRenderer(m_options).outputFormatFor(format), totalFrames)) {
+        LOG_WARNING(writer.getError() + ", streaming the output instead");
+        reader.close();
+        renderStreaming(inputPath, outputPath, result);
+        return;
+    }
+
+    const size_t blockFrames = static_cast<size_t>(m_options.blockFrames);
+    const int channels = format.channels;
+    float* outputSpan = writer.getFloatSpan();
+
+    std::mutex errorMutex;
+    auto fail = [&](uint64_t frame) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (result.error.empty()) {
+            result.error = "Short read at frame " + std::to_string(frame) + " of " + inputPath;
+        }
+    };
+
+    // Every segment lands at its own offset in the mapped output, so tasks
+    // need no ordering and hold no more than one scratch block
+    auto renderSegment = [&](size_t index) {
+        const uint64_t start = index * plan.segmentFrames;
+        const uint64_t end = std::min(start + plan.segmentFrames, totalFrames);
+
+        ChannelGroupProcessor chain(channels, format.sampleRate);
+        chain.setBypass(m_options.bypass);
+        std::vector<float> scratch(blockFrames * channels);
+
+        for (uint64_t frame = start - std::min(start, plan.warmupFrames); frame < start; frame += blockFrames) {
+            const size_t wanted = static_cast<size_t>(std::min<uint64_t>(blockFrames, start - frame));
+            if (reader.read(frame, scratch.data(), wanted) != wanted) {
+                fail(frame);
+                return;
+            }
+            chain.process(scratch.data(), static_cast<int>(wanted));
+        }
+
+        for (uint64_t frame = start; frame < end; frame += blockFrames) {
+            float* block = outputSpan ? outputSpan + frame * channels : scratch.data();
+            const size_t wanted = static_cast<size_t>(std::min<uint64_t>(blockFrames, end - frame));
+            if (reader.read(frame, block, wanted) != wanted) {
+                fail(frame);
+                return;
+            }
+            chain.process(block, static_cast<int>(wanted));
+            if (!outputSpan) {
+                writer.write(frame, block, wanted);
+            }
+        }
+    };
+
+    {
+        WorkStealingPool pool(m_chunkOptions.workerCount);
+        LOG_INFO("Chunked render (mapped): " + std::to_string(plan.segmentCount) + " segments of "
+                 + std::to_string(plan.segmentFrames) + " frames, " + std::to_string(plan.warmupFrames)
+                 + " frames warm-up, " + std::to_string(pool.getThreadCount()) + " workers");
+
+        for (size_t i = 0; i < plan.segmentCount; ++i) {
+            pool.submit([&renderSegment, i]() { renderSegment(i); });
+        }
+        pool.waitIdle();
+    }
+
+    if (!result.error.empty()) {
+        writer.discard();
+    } else if (!writer.close()) {
+        result.error = writer.getError();
+    } else {
+        result.frames = totalFrames;
+    }
+}
+
+void ChunkedRenderer::renderStreaming(const std::string& inputPath, const std::string& outputPath,
+                                      RenderResult& result) const {
+    WavReader probe;
+    if (!probe.open(inputPath)) {
+        result.error = probe.getError();
+        return;
+    }
+    const WavFormat format = probe.getFormat();
+    const uint64_t totalFrames = probe.getTotalFrames();
+    probe.close();
+    result.format = format;
+
+    const SegmentPlan plan = planSegments(format, totalFrames, result.error);
+    if (!result.error.empty()) {
+        return;
+    }
+
+    WavWriter writer;
+    if (!writer.open(outputPath, OfflineRenderer(m_options).outputFormatFor(format))) {
+        result.error = writer.getError();
+        return;
+    }
+
+    const size_t blockFrames = static_cast<size_t>(m_options.blockFrames);
+    const uint64_t warmup = plan.warmupFrames;
+    const uint64_t segmentFrames = plan.segmentFrames;
+    const size_t segmentCount = plan.segmentCount;
+
+    std::vector<Segment> segments(segmentCount);
+    std::mutex mutex;
+    std::condition_variable segmentDone;
+
+    auto renderSegment = [&](size_t index) {
+        Segment& segment = segments[index];
+        const uint64_t start = index * segmentFrames;
+        const uint64_t end = std::min(start + segmentFrames, totalFrames);
+        uint64_t preroll = std::min(start, warmup);
+
+        std::string error;
+        WavReader reader;
+        if (!reader.open(inputPath) || !reader.seek(start - preroll)) {
+            error = reader.getError().empty() ? "Seek failed" : reader.getError();
+        } else {
+            ChannelGroupProcessor chain(format.channels, format.sampleRate);
+            chain.setBypass(m_options.bypass);
+
+            // Warm-up from zero state; output discarded
+            std::vector<float> scratch(blockFrames * format.channels);
+            while (preroll > 0) {
+                size_t frames = reader.read(scratch.data(), static_cast<size_t>(std::min<uint64_t>(preroll, blockFrames)));
+                if (frames == 0) {
+                    break;
+                }
+                chain.process(scratch.data(), static_cast<int>(frames));
+                preroll -= frames;
+            }
+
+            segment.samples.resize(static_cast<size_t>(end - start) * format.channels);
+            size_t offset = 0;
+            while (offset < end - start) {
+                float* block = segment.samples.data() + offset * format.channels;
+                size_t frames = reader.read(block, std::min<size_t>(blockFrames, static_cast<size_t>(end - start) - offset));
+                if (frames == 0) {
+                    break;
+                }
+                chain.process(block, static_cast<int>(frames));
+                offset += frames;
+            }
+            segment.frames = offset;
+
+            // A file shorter than its header claims must not pass as a shorter render
+            if (preroll > 0 || offset < end - start) {
+                error = reader.getError().empty()
+                    ? "Short read at frame " + std::to_string(start + offset) + " of " + inputPath
+                    : reader.getError() + ": " + inputPath;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        segment.error = error;
+        segment.done = true;
+        segmentDone.notify_all();
+    };
+
+    {
+        WorkStealingPool pool(m_chunkOptions.workerCount);
+        const size_t window = static_cast<size_t>(pool.getThreadCount()) * 2;
+
+        LOG_INFO("Chunked render: " + std::to_string(segmentCount) + " segments of "
+                 + std::to_string(segmentFrames) + " frames, " + std::to_string(warmup)
+                 + " frames warm-up, " + std::to_string(pool.getThreadCount()) + " workers");
+
+        for (size_t i = 0; i < std::min(window, segmentCount); ++i) {
+            pool.submit([&renderSegment, i]() { renderSegment(i); });
+        }
+
+        // Write back in order; each write frees a slot for the next segment
+        for (size_t i = 0; i < segmentCount; ++i) {
+            Segment& segment = segments[i];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                segmentDone.wait(lock, [&segment]() { return segment.done; });
+            }
+
+            if (!segment.error.empty()) {
+                result.error = segment.error;
+                break;
+            }
+            if (!writer.write(segment.samples.data(), segment.frames)) {
+                result.error = writer.getError();
+                break;
+            }
+            result.frames += segment.frames;
+            std::vector<float>().swap(segment.samples);
+
+            if (i + window < segmentCount) {
+                const size_t next = i + window;
+                pool.submit([&renderSegment, next]() { renderSegment(next); });
+            }
+        }
+
+        pool.waitIdle();
+    }
+
+    if (!writer.close() && result.error.empty()) {
+        result.error = writer.getError();
+    }
+    if (!result.error.empty()) {
+        std::remove(outputPath.c_str());
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef CHUNKEDRENDERER_H
+#define CHUNKEDRENDERER_H
+
+#include "OfflineRenderer.h"
+#include <string>
+
+struct ChunkOptions {
+    double segmentSeconds = 30.0;
+    // Max deviation from serial rendering, full-scale = 1.0. 0 picks
+    // ChunkedRenderer::kDefaultTolerance, or twice the roundoff floor where
+    // that is higher. A tolerance at or below the floor fails the render
+    // unless relaxTolerance raises it to twice the floor.
+    double tolerance = 0.0;
+    bool relaxTolerance = false;
+    int workerCount = 0;        // <= 0 uses one worker per hardware thread
+};
+
+/**
+ * ChunkedRenderer - Renders one long file on all cores
+ *
+ * The file is cut into segments that are rendered as independent pool
+ * tasks. The tube filter is recursive, so each task first runs a warm-up
+ * region ahead of its segment from zero state and discards it. The warm-up
+ * is the point where the tail of the filter's impulse response has summed
+ * below the tolerance, which bounds the seam error for full-scale input.
+ * With memory-mapped files each task writes its segment in place in the
+ * output; streaming output is written back in order with a bounded number
+ * of segments in flight.
+ *
+ * On top of the warm-up error sits the filter's own double-precision
+ * roundoff, which depends on history and grows with the rate (about 6e-8
+ * at 48 kHz, 1e-6 at 96 kHz, 5e-5 at 192 kHz). The warm-up is sized for
+ * what the roundoff floor leaves of the tolerance, so the total stays
+ * within it; a tolerance the floor alone exceeds is reported as an error.
+ */
+class ChunkedRenderer {
+public:
+    explicit ChunkedRenderer(const RenderOptions& options = RenderOptions(),
+                             const ChunkOptions& chunkOptions = ChunkOptions());
+
+    static constexpr double kDefaultTolerance = 1.0e-6;
+
+    RenderResult render(const std::string& inputPath, const std::string& outputPath) const;
+
+    // Seam error bound a render at this rate guarantees, or -1 with `error`
+    // set when an explicit tolerance is at or below the roundoff floor
+    static double resolveTolerance(int sampleRate, const ChunkOptions& options, std::string* error = nullptr);
+
+    // Frames needed for the IIR state to converge to within tolerance
+    static int warmupFrames(int sampleRate, double tolerance);
+
+    // Largest output difference between two renders that differ only in
+    // where the filter started, once start-up has fully decayed
+    static double roundoffFloor(int sampleRate);
+
+private:
+    struct SegmentPlan {
+        uint64_t warmupFrames = 0;
+        uint64_t segmentFrames = 0;
+        size_t segmentCount = 0;
+    };
+
+    // Empty segmentCount with `error` set when the tolerance cannot be met
+    SegmentPlan planSegments(const WavFormat& format, uint64_t totalFrames, std::string& error) const;
+    void renderMapped(const std::string& inputPath, const std::string& outputPath, RenderResult& result) const;
+    void renderStreaming(const std::string& inputPath, const std::string& outputPath, RenderResult& result) const;
+
+    RenderOptions m_options;
+    ChunkOptions m_chunkOptions;
+};
+
+#endif // CHUNKEDRENDERER_H
@@ -0,0 +1,239 @@
+#include "MappedFile.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::discard() {
+    const std::string path = m_createdPath;
+    m_createdPath.clear();  // nothing worth flushing
+    close();
+    if (!path.empty()) {
+        std::remove(path.c_str());
+    }
+}
+
+#ifdef _WIN32
+
+bool MappedFile::openRead(const std::string& path) {
+    close();
+    m_error.clear();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        m_error = "Cannot open " + path;
+        return false;
+    }
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        m_error = "Cannot stat " + path;
+        close();
+        return false;
+    }
+    m_size = static_cast<uint64_t>(size.QuadPart);
+    if (!map(false)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::create(const std::string& path, uint64_t size) {
+    close();
+    m_error.clear();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        m_error = "Cannot create " + path;
+        return false;
+    }
+    m_file = file;
+    m_createdPath = path;
+
+    // Extending the file allocates its clusters, so a full disk fails here
+    // instead of as an in-page error on a store into the view
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(file, end, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+        m_error = "Cannot reserve " + std::to_string(size) + " bytes for " + path;
+        discard();
+        return false;
+    }
+    m_size = size;
+    if (!map(true)) {
+        discard();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::map(bool writable) {
+    if (m_size == 0) {
+        m_error = "Empty file";
+        return false;
+    }
+
+    // The mapping extends a new file to m_size
+    m_mapping = CreateFileMappingA(static_cast<HANDLE>(m_file), nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                   static_cast<DWORD>(m_size >> 32), static_cast<DWORD>(m_size), nullptr);
+    if (m_mapping) {
+        m_data = static_cast<uint8_t*>(MapViewOfFile(static_cast<HANDLE>(m_mapping),
+                                                     writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!m_data) {
+        m_error = "Cannot map file";
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::close() {
+    bool ok = true;
+    if (m_data) {
+        // Write errors on the view only surface when it is flushed
+        if (!m_createdPath.empty() &&
+            (!FlushViewOfFile(m_data, 0) || !FlushFileBuffers(static_cast<HANDLE>(m_file)))) {
+            m_error = "Cannot write " + m_createdPath;
+            ok = false;
+        }
+        ok = (UnmapViewOfFile(m_data) != 0) && ok;
+        m_data = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+        m_mapping = nullptr;
+    }
+    if (m_file) {
+        CloseHandle(static_cast<HANDLE>(m_file));
+        m_file = nullptr;
+    }
+    if (!ok && !m_createdPath.empty()) {
+        if (m_error.empty()) {
+            m_error = "Cannot close " + m_createdPath;
+        }
+        DeleteFileA(m_createdPath.c_str());
+    }
+    m_createdPath.clear();
+    m_size = 0;
+    return ok;
+}
+
+#else
+
+bool MappedFile::openRead(const std::string& path) {
+    close();
+    m_error.clear();
+
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        m_error = "Cannot open " + path;
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(m_fd, &info) != 0) {
+        m_error = "Cannot stat " + path;
+        close();
+        return false;
+    }
+    m_size = static_cast<uint64_t>(info.st_size);
+    if (!map(false)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::create(const std::string& path, uint64_t size) {
+    close();
+    m_error.clear();
+
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) {
+        m_error = "Cannot create " + path;
+        return false;
+    }
+    m_createdPath = path;
+
+    // ftruncate alone leaves a sparse file, and a store into a hole the disk
+    // has no block for raises SIGBUS instead of returning an error
+    const int error = size > 0 ? ::posix_fallocate(m_fd, 0, static_cast<off_t>(size)) : 0;
+    if (error != 0) {
+        m_error = "Cannot reserve " + std::to_string(size) + " bytes for " + path + ": " + std::strerror(error);
+        discard();
+        return false;
+    }
+    m_size = size;
+    if (!map(true)) {
+        discard();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::map(bool writable) {
+    if (m_size == 0) {
+        m_error = "Empty file";
+        return false;
+    }
+
+    void* data = ::mmap(nullptr, static_cast<size_t>(m_size), writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                        MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED) {
+        m_error = "Cannot map file";
+        return false;
+    }
+    m_data = static_cast<uint8_t*>(data);
+
+    if (!writable) {
+        ::madvise(data, static_cast<size_t>(m_size), MADV_SEQUENTIAL);
+    }
+    return true;
+}
+
+bool MappedFile::close() {
+    bool ok = true;
+    if (m_data) {
+        // Write errors on a shared mapping only surface when it is synced
+        if (!m_createdPath.empty() && ::msync(m_data, static_cast<size_t>(m_size), MS_SYNC) != 0) {
+            m_error = "Cannot write " + m_createdPath + ": " + std::strerror(errno);
+            ok = false;
+        }
+        ok = (::munmap(m_data, static_cast<size_t>(m_size)) == 0) && ok;
+        m_data = nullptr;
+    }
+    if (m_fd >= 0) {
+        ok = (::close(m_fd) == 0) && ok;
+        m_fd = -1;
+    }
+    if (!ok && !m_createdPath.empty()) {
+        if (m_error.empty()) {
+            m_error = "Cannot close " + m_createdPath;
+        }
+        ::unlink(m_createdPath.c_str());
+    }
+    m_createdPath.clear();
+    m_size = 0;
+    return ok;
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * MappedFile - Whole-file memory mapping (Win32 file mapping / POSIX mmap)
+ *
+ * Files are mapped in one view, so sizes above 4 GB need a 64-bit build.
+ * Read-only maps are hinted for sequential access. A write fault on a
+ * mapping is a signal, not an error code, so created files reserve their
+ * blocks up front and are flushed before unmapping; a created file that
+ * fails either way is deleted rather than left half written.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool openRead(const std::string& path);
+    // Creates (or truncates) the file at the given size, mapped read-write.
+    // False when the disk space cannot be reserved
+    bool create(const std::string& path, uint64_t size);
+    // Flushes a created file to disk first; false if that failed
+    bool close();
+    // Closes and deletes a created file without flushing it
+    void discard();
+
+    bool isOpen() const { return m_data != nullptr; }
+    uint8_t* getData() const { return m_data; }
+    uint64_t getSize() const { return m_size; }
+    const std::string& getError() const { return m_error; }
+
+private:
+    bool map(bool writable);
+
+    uint8_t* m_data = nullptr;
+    uint64_t m_size = 0;
+    std::string m_createdPath;  // empty for read-only maps
+    std::string m_error;
+
+#ifdef _WIN32
+    void* m_file = nullptr;      // HANDLE
+    void* m_mapping = nullptr;   // HANDLE
+#else
+    int m_fd = -1;
+#endif
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,118 @@
+#include "MappedWavFile.h"
+#include "../core/SampleConverter.h"
+#include <algorithm>
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// MappedWavReader
+
+bool MappedWavReader::open(const std::string& path) {
+    m_error.clear();
+    if (!m_file.openRead(path)) {
+        m_error = m_file.getError();
+        return false;
+    }
+
+    const uint8_t* data = m_file.getData();
+    const uint64_t size = m_file.getSize();
+    auto readAt = [data, size](uint64_t offset, void* dst, size_t bytes) {
+        if (offset + bytes > size) {
+            return false;
+        }
+        std::memcpy(dst, data + offset, bytes);
+        return true;
+    };
+
+    std::string error;
+    if (!WavHeader::parse(readAt, size, m_layout, error)) {
+        m_error = error + ": " + path;
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+void MappedWavReader::close() {
+    m_file.close();
+    m_layout = WavLayout();
+}
+
+const float* MappedWavReader::getFloatSpan() const {
+    if (!m_file.isOpen() || !m_layout.format.isFloat) {
+        return nullptr;
+    }
+    const uint8_t* data = m_file.getData() + m_layout.dataOffset;
+    if (reinterpret_cast<uintptr_t>(data) % alignof(float) != 0) {
+        return nullptr;  // chunks are only word aligned
+    }
+    return reinterpret_cast<const float*>(data);
+}
+
+size_t MappedWavReader::read(uint64_t frame, float* output, size_t frames) const {
+    if (!m_file.isOpen() || frame >= m_layout.totalFrames) {
+        return 0;
+    }
+    frames = static_cast<size_t>(std::min<uint64_t>(frames, m_layout.totalFrames - frame));
+
+    const WavFormat& format = m_layout.format;
+    const uint8_t* src = m_file.getData() + m_layout.dataOffset + frame * format.bytesPerFrame();
+    SampleConverter::toFloat(src, format.bitsPerSample, format.isFloat, output, frames * format.channels);
+    return frames;
+}
+
+// ---------------------------------------------------------------------------
+// MappedWavWriter
+
+bool MappedWavWriter::create(const std::string& path, const WavFormat& format, uint64_t frames) {
+    m_error.clear();
+
+    const int bits = format.bitsPerSample;
+    bool supported = format.isFloat ? bits == 32 : (bits == 16 || bits == 24 || bits == 32);
+    if (!supported || format.channels < 1 || format.sampleRate <= 0) {
+        m_error = "Unsupported output encoding";
+        return false;
+    }
+
+    const std::vector<uint8_t> header = WavHeader::build(format, frames);
+    const uint64_t dataBytes = frames * format.bytesPerFrame();
+    const uint64_t size = header.size() + dataBytes + (dataBytes & 1);
+
+    if (!m_file.create(path, size)) {
+        m_error = m_file.getError();
+        return false;
+    }
+
+    // The file is created zero-filled, which also covers the pad byte
+    std::memcpy(m_file.getData(), header.data(), header.size());
+    m_format = format;
+    m_dataOffset = header.size();
+    m_totalFrames = frames;
+    return true;
+}
+
+bool MappedWavWriter::close() {
+    if (!m_file.isOpen()) {
+        return m_error.empty();
+    }
+    if (!m_file.close()) {
+        m_error = m_file.getError();
+        return false;
+    }
+    return true;
+}
+
+float* MappedWavWriter::getFloatSpan() const {
+    if (!m_file.isOpen() || !m_format.isFloat) {
+        return nullptr;
+    }
+    return reinterpret_cast<float*>(m_file.getData() + m_dataOffset);  // header size keeps this 8-byte aligned
+}
+
+void MappedWavWriter::write(uint64_t frame, const float* input, size_t frames) {
+    if (!m_file.isOpen() || frame >= m_totalFrames) {
+        return;
+    }
+    frames = static_cast<size_t>(std::min<uint64_t>(frames, m_totalFrames - frame));
+    uint8_t* dst = m_file.getData() + m_dataOffset + frame * m_format.bytesPerFrame();
+    SampleConverter::fromFloat(input, dst, m_format.bitsPerSample, m_format.isFloat, frames * m_format.channels);
+}
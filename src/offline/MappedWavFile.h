@@ -0,0 +1,69 @@
+#ifndef MAPPEDWAVFILE_H
+#define MAPPEDWAVFILE_H
+
+#include "MappedFile.h"
+#include "WavFile.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * MappedWavReader - WAV/RF64 input read straight from a file mapping
+ *
+ * read() converts from the mapped bytes with no intermediate copy and does
+ * not move any cursor, so several threads can read one file at once.
+ * getFloatSpan() exposes float32 data directly when the layout allows.
+ */
+class MappedWavReader {
+public:
+    bool open(const std::string& path);
+    void close();
+
+    const WavFormat& getFormat() const { return m_layout.format; }
+    uint64_t getTotalFrames() const { return m_layout.totalFrames; }
+    const std::string& getError() const { return m_error; }
+
+    // Interleaved float view of the data, nullptr unless float32 and aligned
+    const float* getFloatSpan() const;
+
+    // Returns the number of frames converted (short at end of data)
+    size_t read(uint64_t frame, float* output, size_t frames) const;
+
+private:
+    MappedFile m_file;
+    WavLayout m_layout;
+    std::string m_error;
+};
+
+/**
+ * MappedWavWriter - Preallocated WAV/RF64 output written through a mapping
+ *
+ * The total length is fixed at create() so the header (RF64 above 4 GB)
+ * is final up front. For float32 output getFloatSpan() is the file's data
+ * chunk itself, so DSP can run in place over it; write() converts into the
+ * mapping for integer formats. create() fails when the disk space cannot
+ * be reserved, so callers can fall back to WavWriter.
+ */
+class MappedWavWriter {
+public:
+    bool create(const std::string& path, const WavFormat& format, uint64_t frames);
+    // False if the data could not be flushed; the file is deleted then
+    bool close();
+    // Deletes the output of a failed render
+    void discard() { m_file.discard(); }
+
+    const WavFormat& getFormat() const { return m_format; }
+    uint64_t getTotalFrames() const { return m_totalFrames; }
+    const std::string& getError() const { return m_error; }
+
+    float* getFloatSpan() const;
+    void write(uint64_t frame, const float* input, size_t frames);
+
+private:
+    MappedFile m_file;
+    WavFormat m_format;
+    uint64_t m_dataOffset = 0;
+    uint64_t m_totalFrames = 0;
+    std::string m_error;
+};
+
+#endif // MAPPEDWAVFILE_H
@@ -0,0 +1,229 @@
+#include "OfflineRenderer.h"
+#include "ChannelGroupProcessor.h"
+#include "MappedWavFile.h"
+#include "../utils/BoundedQueue.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+struct Block {
+    std::vector<float> samples;
+    size_t frames = 0;
+};
+
+using BlockPtr = std::unique_ptr<Block>;
+} // namespace
+
+OfflineRenderer::OfflineRenderer(const RenderOptions& options)
+    : m_options(options)
+{
+    m_options.blockFrames = std::max(64, m_options.blockFrames);
+    m_options.queueDepth = std::max(1, m_options.queueDepth);
+}
+
+WavFormat OfflineRenderer::outputFormatFor(const WavFormat& input) const {
+    WavFormat format = input;
+    if (m_options.outputBits > 0) {
+        format.bitsPerSample = m_options.outputBits;
+        format.isFloat = m_options.outputFloat;
+    } else if (format.bitsPerSample == 8) {
+        format.bitsPerSample = 16;  // 8-bit output is not worth supporting
+    }
+    return format;
+}
+
+bool OfflineRenderer::isSameFile(const std::string& inputPath, const std::string& outputPath) {
+    // An output that does not exist yet is an error here, and cannot be the input
+    std::error_code error;
+    return std::filesystem::equivalent(inputPath, outputPath, error) && !error;
+}
+
+RenderResult OfflineRenderer::render(const std::string& inputPath, const std::string& outputPath) const {
+    RenderResult result;
+    const auto begin = std::chrono::steady_clock::now();
+
+    if (isSameFile(inputPath, outputPath)) {
+        result.error = "Output " + outputPath + " is the input file";
+    } else if (m_options.memoryMapped) {
+        renderMapped(inputPath, outputPath, result);
+    } else {
+        renderStreaming(inputPath, outputPath, result);
+    }
+
+    if (result.error.empty() && !TubeEmulator::isRateSupported(result.format.sampleRate)) {
+        LOG_WARNING(inputPath + ": " + std::to_string(result.format.sampleRate)
+                    + " Hz has no measured coefficients, used the nearest rate");
+    }
+
+    result.ok = result.error.empty();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
+
+void OfflineRenderer::renderMapped(const std::string& inputPath, const std::string& outputPath,
+                                   RenderResult& result) const {
+    MappedWavReader reader;
+    if (!reader.open(inputPath)) {
+        result.error = reader.getError();
+        return;
+    }
+    result.format = reader.getFormat();
+
+    const uint64_t totalFrames = reader.getTotalFrames();
+    MappedWavWriter writer;
+    if (!writer.create(outputPath, outputFormatFor(result.format), totalFrames)) {
+        // Typically no room to reserve the whole file; the streaming writer
+        // reports a disk that fills up as it goes as a plain write error
+        LOG_WARNING(writer.getError() + ", streaming the output instead");
+        reader.close();
+        renderStreaming(inputPath, outputPath, result);
+        return;
+    }
+
+    ChannelGroupProcessor chain(result.format.channels, result.format.sampleRate);
+    chain.setBypass(m_options.bypass);
+
+    // Float output: convert straight into the mapped file and process there
+    float* outputSpan = writer.getFloatSpan();
+    std::vector<float> scratch;
+    if (!outputSpan) {
+        scratch.resize(static_cast<size_t>(m_options.blockFrames) * result.format.channels);
+    }
+
+    const int channels = result.format.channels;
+    for (uint64_t frame = 0; frame < totalFrames; frame += m_options.blockFrames) {
+        float* block = outputSpan ? outputSpan + frame * channels : scratch.data();
+        const size_t frames = reader.read(frame, block, m_options.blockFrames);
+        chain.process(block, static_cast<int>(frames));
+        if (!outputSpan) {
+            writer.write(frame, block, frames);
+        }
+        result.frames += frames;
+    }
+
+    if (!writer.close()) {
+        result.error = writer.getError();
+        result.frames = 0;
+    }
+}
+
+void OfflineRenderer::renderStreaming(const std::string& inputPath, const std::string& outputPath,
+                                      RenderResult& result) const {
+    WavReader reader;
+    if (!reader.open(inputPath)) {
+        result.error = reader.getError();
+        return;
+    }
+    result.format = reader.getFormat();
+
+    WavWriter writer;
+    if (!writer.open(outputPath, outputFormatFor(result.format))) {
+        result.error = writer.getError();
+        return;
+    }
+
+    if (m_options.pipelined) {
+        renderPipelined(reader, writer, result);
+    } else {
+        renderSerial(reader, writer, result);
+    }
+
+    // A file shorter than its header claims must not pass as a shorter render
+    if (result.error.empty() && result.frames < reader.getTotalFrames()) {
+        result.error = reader.getError().empty()
+            ? "Short read at frame " + std::to_string(result.frames) + " of " + inputPath
+            : reader.getError() + ": " + inputPath;
+    }
+
+    if (!writer.close() && result.error.empty()) {
+        result.error = writer.getError();
+    }
+    if (!result.error.empty()) {
+        std::remove(outputPath.c_str());
+    }
+}
+
+void OfflineRenderer::renderSerial(WavReader& reader, WavWriter& writer, RenderResult& result) const {
+    const WavFormat& format = reader.getFormat();
+    ChannelGroupProcessor chain(format.channels, format.sampleRate);
+    chain.setBypass(m_options.bypass);
+
+    std::vector<float> block(static_cast<size_t>(m_options.blockFrames) * format.channels);
+    size_t frames;
+    while ((frames = reader.read(block.data(), m_options.blockFrames)) > 0) {
+        chain.process(block.data(), static_cast<int>(frames));
+        if (!writer.write(block.data(), frames)) {
+            result.error = writer.getError();
+            return;
+        }
+        result.frames += frames;
+    }
+}
+
+void OfflineRenderer::renderPipelined(WavReader& reader, WavWriter& writer, RenderResult& result) const {
+    const WavFormat format = reader.getFormat();
+    const size_t blockFrames = static_cast<size_t>(m_options.blockFrames);
+    const size_t depth = static_cast<size_t>(m_options.queueDepth);
+    const size_t blockCount = 2 * depth + 2;
+
+    // Blocks circulate reader -> DSP -> writer -> reader; nothing is allocated per block
+    BoundedQueue<BlockPtr> freeBlocks(blockCount);
+    BoundedQueue<BlockPtr> toProcess(depth);
+    BoundedQueue<BlockPtr> toWrite(depth);
+
+    for (size_t i = 0; i < blockCount; ++i) {
+        auto block = std::make_unique<Block>();
+        block->samples.resize(blockFrames * format.channels);
+        freeBlocks.push(std::move(block));
+    }
+
+    std::thread readerThread([&]() {
+        BlockPtr block;
+        while (freeBlocks.pop(block)) {
+            block->frames = reader.read(block->samples.data(), blockFrames);
+            if (block->frames == 0 || !toProcess.push(std::move(block))) {
+                break;
+            }
+        }
+        toProcess.close();
+    });
+
+    std::thread dspThread([&]() {
+        ChannelGroupProcessor chain(format.channels, format.sampleRate);
+        chain.setBypass(m_options.bypass);
+
+        BlockPtr block;
+        while (toProcess.pop(block)) {
+            chain.process(block->samples.data(), static_cast<int>(block->frames));
+            if (!toWrite.push(std::move(block))) {
+                break;
+            }
+        }
+        toWrite.close();
+    });
+
+    // The calling thread is the writer
+    BlockPtr block;
+    while (toWrite.pop(block)) {
+        if (!writer.write(block->samples.data(), block->frames)) {
+            result.error = writer.getError();
+            freeBlocks.close();
+            toProcess.close();
+            toWrite.close();
+            break;
+        }
+        result.frames += block->frames;
+        freeBlocks.push(std::move(block));
+    }
+
+    readerThread.join();
+    dspThread.join();
+}
@@ -0,0 +1,64 @@
+#ifndef OFFLINERENDERER_H
+#define OFFLINERENDERER_H
+
+#include "WavFile.h"
+#include <cstdint>
+#include <string>
+
+struct RenderOptions {
+    int blockFrames = 8192;
+    int queueDepth = 4;        // blocks in flight between two pipeline stages
+    int outputBits = 0;        // 0 keeps the input encoding
+    bool outputFloat = false;  // only used when outputBits is set
+    bool bypass = false;
+    bool pipelined = true;     // false runs all stages on the calling thread
+    bool memoryMapped = true;  // map input and output instead of streaming them
+};
+
+struct RenderResult {
+    bool ok = false;
+    std::string error;
+    WavFormat format;
+    uint64_t frames = 0;
+    double seconds = 0.0;      // wall clock
+
+    double getAudioSeconds() const { return format.sampleRate > 0 ? double(frames) / format.sampleRate : 0.0; }
+    double getRealtimeFactor() const { return seconds > 0.0 ? getAudioSeconds() / seconds : 0.0; }
+};
+
+/**
+ * OfflineRenderer - Renders WAV files through the 300B chain without a device
+ *
+ * By default both files are memory-mapped: input is converted straight from
+ * the mapping and, for float32 output, DSP runs in place over the mapped
+ * output, so audio never passes through stdio buffers. The streaming mode
+ * instead runs reader, DSP and writer on three threads joined by bounded
+ * queues, so disk I/O overlaps compute and memory stays at
+ * (2 * queueDepth + 2) blocks. Processing is sample-by-sample, so the result
+ * is bit-identical to the real-time path regardless of block size.
+ */
+class OfflineRenderer {
+public:
+    explicit OfflineRenderer(const RenderOptions& options = RenderOptions());
+
+    const RenderOptions& getOptions() const { return m_options; }
+
+    RenderResult render(const std::string& inputPath, const std::string& outputPath) const;
+
+    // Output encoding for a given input under the current options
+    WavFormat outputFormatFor(const WavFormat& input) const;
+
+    // True when both paths name the same existing file, through links or
+    // case folding too; rendering a file onto itself would truncate the input
+    static bool isSameFile(const std::string& inputPath, const std::string& outputPath);
+
+private:
+    void renderMapped(const std::string& inputPath, const std::string& outputPath, RenderResult& result) const;
+    void renderStreaming(const std::string& inputPath, const std::string& outputPath, RenderResult& result) const;
+    void renderSerial(WavReader& reader, WavWriter& writer, RenderResult& result) const;
+    void renderPipelined(WavReader& reader, WavWriter& writer, RenderResult& result) const;
+
+    RenderOptions m_options;
+};
+
+#endif // OFFLINERENDERER_H
@@ -0,0 +1,351 @@
+#include "WavFile.h"
+#include "../core/SampleConverter.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr uint16_t kFormatPcm = 0x0001;
+constexpr uint16_t kFormatFloat = 0x0003;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+constexpr uint32_t kSizeInDs64 = 0xFFFFFFFFu;  // RF64: the real size is in ds64
+constexpr uint32_t kDs64Size = 28;
+
+// Riff headers are little-endian; assemble them byte by byte
+uint16_t readLe16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t readLe32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t readLe64(const uint8_t* p) {
+    return static_cast<uint64_t>(readLe32(p)) | (static_cast<uint64_t>(readLe32(p + 4)) << 32);
+}
+
+void putLe16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void putLe32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+void putLe64(std::vector<uint8_t>& out, uint64_t v) {
+    putLe32(out, static_cast<uint32_t>(v));
+    putLe32(out, static_cast<uint32_t>(v >> 32));
+}
+
+bool seekFile(std::FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+uint64_t fileSize(std::FILE* file) {
+#ifdef _WIN32
+    _fseeki64(file, 0, SEEK_END);
+    return static_cast<uint64_t>(_ftelli64(file));
+#else
+    fseeko(file, 0, SEEK_END);
+    return static_cast<uint64_t>(ftello(file));
+#endif
+}
+} // namespace
+
+// ---------------------------------------------------------------------------
+// WavHeader
+
+bool WavHeader::parse(const ByteSource& readAt, uint64_t fileSize, WavLayout& layout, std::string& error) {
+    uint8_t riff[12];
+    if (!readAt(0, riff, sizeof(riff)) ||
+        (std::memcmp(riff, "RIFF", 4) != 0 && std::memcmp(riff, "RF64", 4) != 0) ||
+        std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        error = "Not a RIFF/WAVE file";
+        return false;
+    }
+    const bool rf64 = std::memcmp(riff, "RF64", 4) == 0;
+
+    bool haveFormat = false;
+    uint64_t ds64DataSize = 0;
+    uint64_t offset = sizeof(riff);
+    for (;;) {
+        uint8_t header[8];
+        if (!readAt(offset, header, sizeof(header))) {
+            error = "No data chunk";
+            return false;
+        }
+        const uint32_t chunkSize = readLe32(header + 4);
+        offset += sizeof(header);
+
+        if (std::memcmp(header, "ds64", 4) == 0) {
+            uint8_t ds64[16];
+            if (chunkSize < sizeof(ds64) || !readAt(offset, ds64, sizeof(ds64))) {
+                error = "Corrupt ds64 chunk";
+                return false;
+            }
+            ds64DataSize = readLe64(ds64 + 8);
+        } else if (std::memcmp(header, "fmt ", 4) == 0) {
+            uint8_t fmt[40] = {};
+            size_t toRead = std::min<size_t>(chunkSize, sizeof(fmt));
+            if (chunkSize < 16 || !readAt(offset, fmt, toRead)) {
+                error = "Corrupt fmt chunk";
+                return false;
+            }
+
+            uint16_t tag = readLe16(fmt);
+            if (tag == kFormatExtensible && chunkSize >= 40) {
+                tag = readLe16(fmt + 24);  // first two bytes of the sub-format GUID
+            }
+
+            WavFormat& format = layout.format;
+            format.channels = readLe16(fmt + 2);
+            format.sampleRate = static_cast<int>(readLe32(fmt + 4));
+            format.bitsPerSample = readLe16(fmt + 14);
+            format.isFloat = (tag == kFormatFloat);
+
+            const int bits = format.bitsPerSample;
+            bool supported = (tag == kFormatPcm && (bits == 8 || bits == 16 || bits == 24 || bits == 32)) ||
+                             (tag == kFormatFloat && bits == 32);
+            if (!supported || format.channels < 1 || format.sampleRate <= 0) {
+                error = "Unsupported WAV encoding";
+                return false;
+            }
+            haveFormat = true;
+        } else if (std::memcmp(header, "data", 4) == 0) {
+            if (!haveFormat) {
+                error = "data chunk before fmt chunk";
+                return false;
+            }
+            uint64_t dataSize = (rf64 && chunkSize == kSizeInDs64) ? ds64DataSize : chunkSize;
+            // Truncated files: only count what is really there
+            dataSize = std::min(dataSize, fileSize > offset ? fileSize - offset : 0);
+            layout.dataOffset = offset;
+            layout.totalFrames = dataSize / static_cast<uint64_t>(layout.format.bytesPerFrame());
+            return true;
+        }
+
+        offset += chunkSize + (chunkSize & 1);  // chunks are word aligned
+    }
+}
+
+std::vector<uint8_t> WavHeader::build(const WavFormat& format, uint64_t frames) {
+    // Multichannel files need WAVE_FORMAT_EXTENSIBLE to be read reliably
+    const bool extensible = format.channels > 2;
+    const uint16_t tag = format.isFloat ? kFormatFloat : kFormatPcm;
+    const uint32_t fmtSize = extensible ? 40 : 16;
+    const uint64_t dataBytes = frames * format.bytesPerFrame();
+    const uint64_t riffBytes = 4 + (8 + kDs64Size) + (8 + fmtSize) + 8 + dataBytes + (dataBytes & 1);
+    const bool rf64 = riffBytes > 0xFFFFFFFFu;
+
+    const char* magic = rf64 ? "RF64" : "RIFF";
+    std::vector<uint8_t> header(magic, magic + 4);
+    putLe32(header, rf64 ? kSizeInDs64 : static_cast<uint32_t>(riffBytes));
+    header.insert(header.end(), {'W', 'A', 'V', 'E'});
+
+    if (rf64) {
+        header.insert(header.end(), {'d', 's', '6', '4'});
+        putLe32(header, kDs64Size);
+        putLe64(header, riffBytes);
+        putLe64(header, dataBytes);
+        putLe64(header, frames);
+        putLe32(header, 0);  // no table entries
+    } else {
+        header.insert(header.end(), {'J', 'U', 'N', 'K'});
+        putLe32(header, kDs64Size);
+        header.insert(header.end(), kDs64Size, 0);
+    }
+
+    header.insert(header.end(), {'f', 'm', 't', ' '});
+    putLe32(header, fmtSize);
+    putLe16(header, extensible ? kFormatExtensible : tag);
+    putLe16(header, static_cast<uint16_t>(format.channels));
+    putLe32(header, static_cast<uint32_t>(format.sampleRate));
+    putLe32(header, static_cast<uint32_t>(format.sampleRate * format.bytesPerFrame()));
+    putLe16(header, static_cast<uint16_t>(format.bytesPerFrame()));
+    putLe16(header, static_cast<uint16_t>(format.bitsPerSample));
+    if (extensible) {
+        static const uint8_t kGuidTail[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80,
+                                              0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+        putLe16(header, 22);
+        putLe16(header, static_cast<uint16_t>(format.bitsPerSample));
+        putLe32(header, 0);  // no speaker mapping
+        putLe16(header, tag);
+        header.insert(header.end(), kGuidTail, kGuidTail + sizeof(kGuidTail));
+    }
+
+    header.insert(header.end(), {'d', 'a', 't', 'a'});
+    putLe32(header, rf64 ? kSizeInDs64 : static_cast<uint32_t>(dataBytes));
+    return header;
+}
+
+// ---------------------------------------------------------------------------
+// WavReader
+
+WavReader::~WavReader() {
+    close();
+}
+
+bool WavReader::fail(const std::string& message) {
+    m_error = message;
+    close();
+    return false;
+}
+
+bool WavReader::open(const std::string& path) {
+    close();
+    m_error.clear();
+
+    m_file = std::fopen(path.c_str(), "rb");
+    if (!m_file) {
+        m_error = "Cannot open " + path;
+        return false;
+    }
+
+    std::FILE* file = m_file;
+    auto readAt = [file](uint64_t offset, void* dst, size_t bytes) {
+        return seekFile(file, offset) && std::fread(dst, 1, bytes, file) == bytes;
+    };
+
+    WavLayout layout;
+    std::string error;
+    if (!WavHeader::parse(readAt, fileSize(m_file), layout, error)) {
+        return fail(error + ": " + path);
+    }
+
+    m_format = layout.format;
+    m_dataOffset = layout.dataOffset;
+    m_totalFrames = layout.totalFrames;
+    m_position = 0;
+    return seekFile(m_file, m_dataOffset) || fail("Seek failed in " + path);
+}
+
+void WavReader::close() {
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+    m_totalFrames = 0;
+    m_position = 0;
+}
+
+bool WavReader::seek(uint64_t frame) {
+    if (!m_file) {
+        return false;
+    }
+    frame = std::min(frame, m_totalFrames);
+    if (!seekFile(m_file, m_dataOffset + frame * m_format.bytesPerFrame())) {
+        return false;
+    }
+    m_position = frame;
+    return true;
+}
+
+size_t WavReader::read(float* output, size_t frames) {
+    if (!m_file) {
+        return 0;
+    }
+
+    frames = static_cast<size_t>(std::min<uint64_t>(frames, m_totalFrames - m_position));
+    const size_t bytes = frames * m_format.bytesPerFrame();
+    if (m_raw.size() < bytes) {
+        m_raw.resize(bytes);
+    }
+
+    const size_t got = std::fread(m_raw.data(), 1, bytes, m_file) / m_format.bytesPerFrame();
+    if (got < frames && std::ferror(m_file)) {
+        m_error = "Read error at frame " + std::to_string(m_position + got);
+    }
+    SampleConverter::toFloat(m_raw.data(), m_format.bitsPerSample, m_format.isFloat,
+                             output, got * m_format.channels);
+
+    m_position += got;
+    return got;
+}
+
+// ---------------------------------------------------------------------------
+// WavWriter
+
+WavWriter::~WavWriter() {
+    close();
+}
+
+bool WavWriter::fail(const std::string& message) {
+    m_error = message;
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+    return false;
+}
+
+bool WavWriter::open(const std::string& path, const WavFormat& format) {
+    close();
+    m_error.clear();
+
+    const int bits = format.bitsPerSample;
+    bool supported = format.isFloat ? bits == 32 : (bits == 16 || bits == 24 || bits == 32);
+    if (!supported || format.channels < 1 || format.sampleRate <= 0) {
+        m_error = "Unsupported output encoding";
+        return false;
+    }
+
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) {
+        m_error = "Cannot create " + path;
+        return false;
+    }
+
+    m_format = format;
+    m_framesWritten = 0;
+    return writeHeader() || fail("Cannot write header to " + path);
+}
+
+bool WavWriter::writeHeader() {
+    const std::vector<uint8_t> header = WavHeader::build(m_format, m_framesWritten);
+    return seekFile(m_file, 0) && std::fwrite(header.data(), 1, header.size(), m_file) == header.size();
+}
+
+bool WavWriter::write(const float* input, size_t frames) {
+    if (!m_file) {
+        return false;
+    }
+
+    const size_t bytes = frames * m_format.bytesPerFrame();
+    if (m_raw.size() < bytes) {
+        m_raw.resize(bytes);
+    }
+    SampleConverter::fromFloat(input, m_raw.data(), m_format.bitsPerSample, m_format.isFloat,
+                               frames * m_format.channels);
+
+    if (std::fwrite(m_raw.data(), 1, bytes, m_file) != bytes) {
+        return fail("Write failed (disk full?)");
+    }
+    m_framesWritten += frames;
+    return true;
+}
+
+bool WavWriter::close() {
+    if (!m_file) {
+        return m_error.empty();
+    }
+
+    // Odd-sized data chunks get a pad byte
+    bool ok = true;
+    if ((m_framesWritten * m_format.bytesPerFrame()) & 1) {
+        ok = std::fputc(0, m_file) != EOF;
+    }
+    ok = ok && writeHeader();
+    ok = (std::fclose(m_file) == 0) && ok;
+    m_file = nullptr;
+    if (!ok) {
+        m_error = "Failed to finalize WAV file";
+    }
+    return ok;
+}
@@ -0,0 +1,121 @@
+#ifndef WAVFILE_H
+#define WAVFILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Sample layout of a WAV data chunk
+struct WavFormat {
+    int sampleRate = 48000;
+    int channels = 2;
+    int bitsPerSample = 24;
+    bool isFloat = false;   // IEEE float (32 bit) instead of integer PCM
+
+    int bytesPerFrame() const { return channels * (bitsPerSample / 8); }
+};
+
+// Where the samples of a WAV file live
+struct WavLayout {
+    WavFormat format;
+    uint64_t dataOffset = 0;
+    uint64_t totalFrames = 0;
+};
+
+/**
+ * WavHeader - RIFF/RF64 header parsing and generation
+ *
+ * Shared by the streaming and memory-mapped file classes. Generated headers
+ * always reserve a 36-byte JUNK chunk that becomes the ds64 chunk when the
+ * data grows past 4 GB, so the header size (and the 8-byte aligned data
+ * offset) never changes between the RIFF and RF64 forms.
+ */
+class WavHeader {
+public:
+    // Copies `bytes` bytes at `offset` into dst, false past the end of file
+    using ByteSource = std::function<bool(uint64_t offset, void* dst, size_t bytes)>;
+
+    static bool parse(const ByteSource& readAt, uint64_t fileSize, WavLayout& layout, std::string& error);
+    static std::vector<uint8_t> build(const WavFormat& format, uint64_t frames);
+};
+
+/**
+ * WavReader - Streaming reader for PCM / IEEE-float WAV files
+ *
+ * Accepts 8/16/24/32-bit integer and 32-bit float data, including
+ * WAVE_FORMAT_EXTENSIBLE headers and RF64 files above 4 GB. read()
+ * converts to interleaved float in [-1, 1).
+ */
+class WavReader {
+public:
+    WavReader() = default;
+    ~WavReader();
+
+    WavReader(const WavReader&) = delete;
+    WavReader& operator=(const WavReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_file != nullptr; }
+
+    const WavFormat& getFormat() const { return m_format; }
+    uint64_t getTotalFrames() const { return m_totalFrames; }
+    uint64_t getPosition() const { return m_position; }
+    const std::string& getError() const { return m_error; }
+
+    bool seek(uint64_t frame);
+
+    // Returns the number of frames read, 0 at end of data or on error. A read
+    // error also sets getError(); a file cut short only returns fewer frames
+    size_t read(float* output, size_t frames);
+
+private:
+    bool fail(const std::string& message);
+
+    std::FILE* m_file = nullptr;
+    WavFormat m_format;
+    uint64_t m_dataOffset = 0;
+    uint64_t m_totalFrames = 0;
+    uint64_t m_position = 0;
+    std::vector<uint8_t> m_raw;
+    std::string m_error;
+};
+
+/**
+ * WavWriter - Streaming WAV writer
+ *
+ * Writes the header up front and patches the chunk sizes in close(),
+ * switching to RF64 if the data passed 4 GB. Float input is clipped to
+ * [-1, 1] when the target is integer PCM.
+ */
+class WavWriter {
+public:
+    WavWriter() = default;
+    ~WavWriter();
+
+    WavWriter(const WavWriter&) = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+
+    bool open(const std::string& path, const WavFormat& format);
+    bool write(const float* input, size_t frames);
+    bool close();
+    bool isOpen() const { return m_file != nullptr; }
+
+    const WavFormat& getFormat() const { return m_format; }
+    uint64_t getFramesWritten() const { return m_framesWritten; }
+    const std::string& getError() const { return m_error; }
+
+private:
+    bool fail(const std::string& message);
+    bool writeHeader();
+
+    std::FILE* m_file = nullptr;
+    WavFormat m_format;
+    uint64_t m_framesWritten = 0;
+    std::vector<uint8_t> m_raw;
+    std::string m_error;
+};
+
+#endif // WAVFILE_H
@@ -1,71 +1,106 @@
 #include "Logger.h"
-#include <QTextStream>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
 #include <iostream>
 
-QFile Logger::s_logFile;
-QMutex Logger::s_mutex;
+#ifdef QT_CORE_LIB
+#include <QDebug>
+#endif
+
+std::ofstream Logger::s_logFile;
+std::mutex Logger::s_mutex;
 Logger::Level Logger::s_minLevel = Logger::Debug;
 bool Logger::s_consoleOutput = true;
 
-void Logger::log(Level level, const QString& message) {
+void Logger::log(Level level, const std::string& message) {
     if (level < s_minLevel) {
         return;
     }
 
-    QMutexLocker locker(&s_mutex);
+    std::lock_guard<std::mutex> locker(s_mutex);
 
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
-    QString levelStr = levelToString(level);
-    QString formattedMessage = QString("[%1] [%2] %3").arg(timestamp, levelStr, message);
+    const std::string formattedMessage = "[" + timestamp() + "] [" + levelToString(level) + "] " + message;
 
     if (s_consoleOutput) {
+#ifdef QT_CORE_LIB
+        // Inside the Qt app, keep going through Qt's message handler
+        const QString text = QString::fromStdString(formattedMessage);
         switch (level) {
             case Debug:
-                qDebug().noquote() << formattedMessage;
+                qDebug().noquote() << text;
                 break;
             case Info:
-                qInfo().noquote() << formattedMessage;
+                qInfo().noquote() << text;
                 break;
             case Warning:
-                qWarning().noquote() << formattedMessage;
+                qWarning().noquote() << text;
                 break;
             case Error:
-                qCritical().noquote() << formattedMessage;
+                qCritical().noquote() << text;
                 break;
         }
+#else
+        std::cerr << formattedMessage << std::endl;
+#endif
     }
 
-    if (s_logFile.isOpen()) {
-        QTextStream stream(&s_logFile);
-        stream << formattedMessage << "\n";
-        stream.flush();
+    if (s_logFile.is_open()) {
+        s_logFile << formattedMessage << "\n";
+        s_logFile.flush();
     }
 }
 
-void Logger::setLogFile(const QString& path) {
-    QMutexLocker locker(&s_mutex);
+void Logger::log(Level level, const char* message) {
+    log(level, std::string(message ? message : ""));
+}
+
+void Logger::setLogFile(const std::string& path) {
+    std::lock_guard<std::mutex> locker(s_mutex);
 
-    if (s_logFile.isOpen()) {
+    if (s_logFile.is_open()) {
         s_logFile.close();
     }
 
-    s_logFile.setFileName(path);
-    if (!s_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
-        qWarning() << "Failed to open log file:" << path;
+    // Paths are UTF-8 (QString::toStdString), which Windows needs spelled out
+    s_logFile.open(std::filesystem::u8path(path), std::ios::out | std::ios::app);
+    if (!s_logFile.is_open()) {
+        std::cerr << "Failed to open log file: " << path << std::endl;
     }
 }
 
 void Logger::setLogLevel(Level minLevel) {
-    QMutexLocker locker(&s_mutex);
+    std::lock_guard<std::mutex> locker(s_mutex);
     s_minLevel = minLevel;
 }
 
 void Logger::enableConsoleOutput(bool enable) {
-    QMutexLocker locker(&s_mutex);
+    std::lock_guard<std::mutex> locker(s_mutex);
     s_consoleOutput = enable;
 }
 
-QString Logger::levelToString(Level level) {
+std::string Logger::timestamp() {
+    // yyyy-MM-dd hh:mm:ss.zzz, local time
+    const auto now = std::chrono::system_clock::now();
+    const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    const int millis = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()).count() % 1000);
+
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+
+    char buffer[32];
+    const size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+    std::snprintf(buffer + length, sizeof(buffer) - length, ".%03d", millis);
+    return buffer;
+}
+
+const char* Logger::levelToString(Level level) {
     switch (level) {
         case Debug:   return "DEBUG";
         case Info:    return "INFO";
@@ -1,12 +1,21 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#ifdef QT_CORE_LIB
 #include <QString>
-#include <QFile>
-#include <QMutex>
-#include <QDateTime>
-#include <QDebug>
+#endif
 
+/**
+ * Logger - Process-wide log sink
+ *
+ * Standard library only, so the DSP core can log without linking Qt.
+ * Qt builds also get QString overloads, which keeps the GUI layer's
+ * LOG_*(QString(...).arg(...)) calls unchanged.
+ */
 class Logger {
 public:
     enum Level {
@@ -16,15 +25,22 @@ public:
         Error
     };
 
-    static void log(Level level, const QString& message);
-    static void setLogFile(const QString& path);
+    static void log(Level level, const std::string& message);
+    static void log(Level level, const char* message);
+    static void setLogFile(const std::string& path);
     static void setLogLevel(Level minLevel);
     static void enableConsoleOutput(bool enable);
 
+#ifdef QT_CORE_LIB
+    static void log(Level level, const QString& message) { log(level, message.toStdString()); }
+    static void setLogFile(const QString& path) { setLogFile(path.toStdString()); }
+#endif
+
 private:
-    static QString levelToString(Level level);
-    static QFile s_logFile;
-    static QMutex s_mutex;
+    static const char* levelToString(Level level);
+    static std::string timestamp();
+    static std::ofstream s_logFile;
+    static std::mutex s_mutex;
     static Level s_minLevel;
     static bool s_consoleOutput;
 };
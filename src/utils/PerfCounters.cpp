@@ -0,0 +1,179 @@
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+PerfCounters::~PerfCounters() {
+    close();
+}
+
+const char* PerfCounters::eventName(Event event) {
+    switch (event) {
+    case Cycles: return "cycles";
+    case Instructions: return "instructions";
+    case L1DMisses: return "l1d_misses";
+    case LLCMisses: return "llc_misses";
+    case BranchMisses: return "branch_misses";
+    default: return "unknown";
+    }
+}
+
+bool PerfCounters::isOpen() const {
+    for (int fd : m_fds) {
+        if (fd >= 0) return true;
+    }
+    return false;
+}
+
+#ifdef __linux__
+
+namespace {
+int openEvent(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // This thread, any CPU, no group
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+constexpr uint64_t cacheConfig(uint64_t cache, uint64_t op, uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+} // namespace
+
+bool PerfCounters::open() {
+    close();
+    m_error.clear();
+
+    struct EventConfig { uint32_t type; uint64_t config; };
+    const EventConfig configs[EventCount] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                         PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+
+    int firstErrno = 0;
+    for (int i = 0; i < EventCount; ++i) {
+        m_fds[i] = openEvent(configs[i].type, configs[i].config);
+        if (m_fds[i] < 0 && firstErrno == 0) {
+            firstErrno = errno;
+        }
+    }
+
+    if (!isOpen()) {
+        m_error = std::string("perf_event_open failed: ") + std::strerror(firstErrno)
+                + " (check /proc/sys/kernel/perf_event_paranoid)";
+        return false;
+    }
+    return true;
+}
+
+void PerfCounters::close() {
+    for (int& fd : m_fds) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+}
+
+void PerfCounters::start() {
+    reset();
+    resume();
+}
+
+void PerfCounters::reset() {
+    for (int i = 0; i < EventCount; ++i) {
+        m_baseEnabled[i] = 0;
+        m_baseRunning[i] = 0;
+        if (m_fds[i] < 0) continue;
+
+        // The kernel keeps the enabled/running times across a reset; scale from here on
+        ioctl(m_fds[i], PERF_EVENT_IOC_RESET, 0);
+        uint64_t data[3] = {0, 0, 0};
+        if (::read(m_fds[i], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data))) {
+            m_baseEnabled[i] = data[1];
+            m_baseRunning[i] = data[2];
+        }
+    }
+}
+
+void PerfCounters::resume() {
+    for (int fd : m_fds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void PerfCounters::stop() {
+    for (int fd : m_fds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+}
+
+PerfCounters::Reading PerfCounters::read() const {
+    Reading reading;
+    for (int i = 0; i < EventCount; ++i) {
+        if (m_fds[i] < 0) continue;
+
+        uint64_t data[3] = {0, 0, 0};  // value, time enabled, time running
+        if (::read(m_fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+            continue;
+        }
+        const uint64_t enabled = data[1] - m_baseEnabled[i];
+        const uint64_t running = data[2] - m_baseRunning[i];
+        if (running == 0) {
+            continue;  // never scheduled on the PMU
+        }
+        reading.values[i] = double(data[0]) * double(enabled) / double(running);
+        reading.valid[i] = true;
+    }
+    return reading;
+}
+
+#else
+
+bool PerfCounters::open() {
+    m_error = "Hardware counters are only supported on Linux";
+    return false;
+}
+
+void PerfCounters::close() {
+}
+
+void PerfCounters::start() {
+}
+
+void PerfCounters::reset() {
+}
+
+void PerfCounters::resume() {
+}
+
+void PerfCounters::stop() {
+}
+
+PerfCounters::Reading PerfCounters::read() const {
+    return Reading();
+}
+
+#endif
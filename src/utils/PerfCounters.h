@@ -0,0 +1,73 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * PerfCounters - Hardware performance counters for the calling thread
+ *
+ * Linux only, through perf_event_open(2). Each event is opened on its own
+ * and scaled by its enabled/running time, so a PMU with fewer counters
+ * than events still gives estimates rather than failing. User-space only,
+ * which works with the default perf_event_paranoid of 2. Events the CPU
+ * or VM does not expose are reported as unavailable; on other platforms
+ * open() fails.
+ */
+class PerfCounters {
+public:
+    enum Event {
+        Cycles,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        BranchMisses,
+        EventCount
+    };
+
+    struct Reading {
+        std::array<double, EventCount> values{};
+        std::array<bool, EventCount> valid{};
+
+        double getIpc() const {
+            return valid[Cycles] && valid[Instructions] && values[Cycles] > 0.0
+                ? values[Instructions] / values[Cycles] : 0.0;
+        }
+    };
+
+    PerfCounters() = default;
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // True if at least one event could be opened
+    bool open();
+    void close();
+    bool isOpen() const;
+
+    // Reset and count from now / stop counting
+    void start();
+    void stop();
+
+    // Zero the counts without counting / count again after stop(), keeping
+    // what was counted so far. Together they bracket several windows
+    void reset();
+    void resume();
+
+    // Counts since start() or reset(), scaled for multiplexing
+    Reading read() const;
+
+    const std::string& getError() const { return m_error; }
+
+    static const char* eventName(Event event);
+
+private:
+    std::array<int, EventCount> m_fds{-1, -1, -1, -1, -1};
+    std::array<uint64_t, EventCount> m_baseEnabled{};  // times at the last reset
+    std::array<uint64_t, EventCount> m_baseRunning{};
+    std::string m_error;
+};
+
+#endif // PERFCOUNTERS_H
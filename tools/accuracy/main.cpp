@@ -0,0 +1,593 @@
+// amptube300b-accuracy - golden-reference check for every DSP kernel
+//
+//   amptube300b-accuracy [options]
+//
+// Runs a double-precision scalar model of the 300B chain (log/exp shaper
+// and 6th-order IIR, no float rounding anywhere) next to each production
+// kernel on sweeps, single tones, two-tone IMD signals and program
+// material at every measured rate. Reports max abs error, SNR against the
+// reference and the THD/IMD deltas the kernel introduces. Exits with 1
+// when any case breaks a threshold, so a build can gate on it.
+//
+// At high rates the IIR's poles sit close to the unit circle and it
+// amplifies any rounding of its input, so even a perfect float kernel
+// drifts from the double model. The error limits therefore never go below
+// what rounding the shaper output to float costs at that rate (the
+// "floor", measured per signal), with a fixed margin on top.
+
+#include "../../src/dsp/DSPProcessor.h"
+#include "../../src/dsp/TubeBatchProcessor.h"
+#include "../../src/dsp/TubeEmulator.h"
+#include "../../src/offline/MappedWavFile.h"
+#include "../../src/utils/Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+const int kRates[] = {44100, 48000, 88200, 96000, 176400, 192000};
+constexpr double kTwoPi = 6.283185307179586;
+constexpr int kBlockFrames = 256;  // candidates run in real-time sized blocks
+
+// ---------------------------------------------------------------------------
+// Reference model
+
+double shapeReference(double x) {
+    double scaled = x * 0.75;
+    double shaped = scaled * 0.85 - std::log(1.0 - scaled) * 0.15;
+
+    double absComp = std::fabs(scaled * 0.9);
+    if (absComp < shaped) {
+        double diff = shaped - absComp;
+        shaped = absComp + diff / (std::exp(-diff) + 1.0);
+    } else if (-absComp > shaped) {
+        double sum = absComp + shaped;
+        shaped = (sum / (std::exp(-sum) + 1.0)) - absComp;
+    }
+    return shaped;
+}
+
+// floatShaper rounds the shaper output to float, the least any float kernel loses
+std::vector<double> runReference(const std::vector<float>& input, int rate, bool floatShaper = false) {
+    const TubeEmulator::Coefficients c = TubeEmulator::coefficientsForRate(rate);
+    double z[6] = {0};
+    std::vector<double> output(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        const double shaped = shapeReference(input[i]);
+        const double x = floatShaper ? double(static_cast<float>(shaped)) : shaped;
+        const double y = c.b[0] * x + z[0];
+        for (int k = 0; k < 5; ++k) {
+            z[k] = c.b[k + 1] * x - c.a[k] * y + z[k + 1];
+        }
+        z[5] = c.b[6] * x - c.a[5] * y;
+        output[i] = y * TubeEmulator::kOutputScale;
+    }
+    return output;
+}
+
+// ---------------------------------------------------------------------------
+// Kernels under test. Each gets the same mono signal on every channel it
+// has and returns every channel's output for comparison.
+
+class Candidate {
+public:
+    virtual ~Candidate() = default;
+    virtual const char* name() const = 0;
+    virtual std::vector<std::vector<float>> run(const std::vector<float>& input, int rate) = 0;
+};
+
+class TubeStereoCandidate : public Candidate {
+public:
+    const char* name() const override { return "tube.process"; }
+    std::vector<std::vector<float>> run(const std::vector<float>& input, int rate) override {
+        TubeEmulator tube;
+        tube.setSampleRate(rate);
+        std::vector<float> left = input;
+        std::vector<float> right = input;
+        for (size_t i = 0; i < input.size(); i += kBlockFrames) {
+            int n = static_cast<int>(std::min<size_t>(kBlockFrames, input.size() - i));
+            tube.process(left.data() + i, right.data() + i, n);
+        }
+        return {left, right};
+    }
+};
+
+class TubeMonoCandidate : public Candidate {
+public:
+    const char* name() const override { return "tube.processMono"; }
+    std::vector<std::vector<float>> run(const std::vector<float>& input, int rate) override {
+        TubeEmulator tube;
+        tube.setSampleRate(rate);
+        std::vector<float> mono = input;
+        for (size_t i = 0; i < input.size(); i += kBlockFrames) {
+            tube.processMono(mono.data() + i, static_cast<int>(std::min<size_t>(kBlockFrames, input.size() - i)));
+        }
+        return {mono};
+    }
+};
+
+class DSPInterleavedCandidate : public Candidate {
+public:
+    const char* name() const override { return "dsp.process"; }
+    std::vector<std::vector<float>> run(const std::vector<float>& input, int rate) override {
+        DSPProcessor dsp;
+        dsp.setSampleRate(rate);
+        std::vector<float> interleaved(input.size() * 2);
+        for (size_t i = 0; i < input.size(); ++i) {
+            interleaved[i * 2] = interleaved[i * 2 + 1] = input[i];
+        }
+        for (size_t i = 0; i < input.size(); i += kBlockFrames) {
+            int n = static_cast<int>(std::min<size_t>(kBlockFrames, input.size() - i));
+            dsp.process(interleaved.data() + i * 2, n, 2);
+        }
+        std::vector<std::vector<float>> outputs(2, std::vector<float>(input.size()));
+        for (size_t i = 0; i < input.size(); ++i) {
+            outputs[0][i] = interleaved[i * 2];
+            outputs[1][i] = interleaved[i * 2 + 1];
+        }
+        return outputs;
+    }
+};
+
+class DSPPlanarCandidate : public Candidate {
+public:
+    const char* name() const override { return "dsp.processPlanar"; }
+    std::vector<std::vector<float>> run(const std::vector<float>& input, int rate) override {
+        DSPProcessor dsp;
+        dsp.setSampleRate(rate);
+        std::vector<std::vector<float>> outputs = {input, input};
+        for (size_t i = 0; i < input.size(); i += kBlockFrames) {
+            float* channels[2] = {outputs[0].data() + i, outputs[1].data() + i};
+            dsp.processPlanar(channels, static_cast<int>(std::min<size_t>(kBlockFrames, input.size() - i)), 2);
+        }
+        return outputs;
+    }
+};
+
+class BatchCandidate : public Candidate {
+public:
+    const char* name() const override { return "batch.process"; }
+    std::vector<std::vector<float>> run(const std::vector<float>& input, int rate) override {
+        // A full lane group, so the vector path is what gets measured
+        const int lanes = TubeBatchProcessor::kLaneWidth;
+        TubeBatchProcessor batch(lanes);
+        batch.setSampleRate(rate);
+        std::vector<std::vector<float>> outputs(lanes, input);
+        std::vector<float*> pointers(lanes);
+        for (size_t i = 0; i < input.size(); i += kBlockFrames) {
+            for (int k = 0; k < lanes; ++k) {
+                pointers[k] = outputs[k].data() + i;
+            }
+            batch.process(pointers.data(), static_cast<int>(std::min<size_t>(kBlockFrames, input.size() - i)));
+        }
+        return outputs;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Test signals
+
+struct Signal {
+    enum class Kind { Sweep, Tone, Smpte, Ccif, Program };
+    std::string name;
+    Kind kind;
+    double f1 = 0.0;
+    double f2 = 0.0;
+    std::vector<float> samples;
+};
+
+// Steady-state analysis window: the last second, so integer-Hz tones fall on exact bins
+constexpr double kToneSeconds = 1.5;
+
+Signal makeTone(int rate, double frequency, double dbfs) {
+    Signal s;
+    char name[32];
+    std::snprintf(name, sizeof(name), "tone %.0f Hz %.0f dBFS", frequency, dbfs);
+    s.name = name;
+    s.kind = Signal::Kind::Tone;
+    s.f1 = frequency;
+    const double amplitude = std::pow(10.0, dbfs / 20.0);
+    s.samples.resize(static_cast<size_t>(kToneSeconds * rate));
+    for (size_t i = 0; i < s.samples.size(); ++i) {
+        s.samples[i] = static_cast<float>(amplitude * std::sin(kTwoPi * frequency * i / rate));
+    }
+    return s;
+}
+
+Signal makeTwoTone(int rate, Signal::Kind kind, double f1, double a1, double f2, double a2, const char* name) {
+    Signal s;
+    s.name = name;
+    s.kind = kind;
+    s.f1 = f1;
+    s.f2 = f2;
+    s.samples.resize(static_cast<size_t>(kToneSeconds * rate));
+    for (size_t i = 0; i < s.samples.size(); ++i) {
+        const double t = double(i) / rate;
+        s.samples[i] = static_cast<float>(a1 * std::sin(kTwoPi * f1 * t) + a2 * std::sin(kTwoPi * f2 * t));
+    }
+    return s;
+}
+
+Signal makeSweep(int rate) {
+    Signal s;
+    s.name = "log sweep -6 dBFS";
+    s.kind = Signal::Kind::Sweep;
+    const double seconds = 2.0;
+    const double f0 = 20.0;
+    const double f1 = std::min(20000.0, 0.45 * rate);
+    const double k = std::log(f1 / f0);
+    s.samples.resize(static_cast<size_t>(seconds * rate));
+    for (size_t i = 0; i < s.samples.size(); ++i) {
+        const double t = double(i) / rate;
+        const double phase = kTwoPi * f0 * seconds / k * (std::exp(t / seconds * k) - 1.0);
+        s.samples[i] = static_cast<float>(0.5 * std::sin(phase));
+    }
+    return s;
+}
+
+// Plucked partials with decaying envelopes over a noise bed; -3 dBFS peak
+Signal makeProgram(int rate) {
+    Signal s;
+    s.name = "synthetic program";
+    s.kind = Signal::Kind::Program;
+    std::vector<double> mix(static_cast<size_t>(3.0 * rate), 0.0);
+
+    uint32_t state = 2024;
+    auto random = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return double(state >> 8) / double(1u << 24);
+    };
+
+    for (int note = 0; note < 24; ++note) {
+        const size_t start = static_cast<size_t>(random() * (mix.size() - rate / 2));
+        const double frequency = 55.0 * std::pow(2.0, std::floor(random() * 48.0) / 12.0);
+        const double decay = 2.0 + random() * 6.0;
+        for (size_t i = start; i < mix.size(); ++i) {
+            const double t = double(i - start) / rate;
+            const double envelope = std::exp(-decay * t);
+            if (envelope < 1e-4) break;
+            for (int h = 1; h <= 6 && h * frequency < 0.45 * rate; ++h) {
+                mix[i] += envelope / h * std::sin(kTwoPi * h * frequency * t);
+            }
+        }
+    }
+    double lowpass = 0.0;
+    for (double& x : mix) {
+        lowpass += 0.05 * ((random() - 0.5) - lowpass);
+        x += 2.0 * lowpass;
+    }
+
+    double peak = 0.0;
+    for (double x : mix) peak = std::max(peak, std::fabs(x));
+    const double gain = peak > 0.0 ? 0.708 / peak : 0.0;
+    s.samples.resize(mix.size());
+    for (size_t i = 0; i < mix.size(); ++i) {
+        s.samples[i] = static_cast<float>(mix[i] * gain);
+    }
+    return s;
+}
+
+bool loadProgram(const std::string& path, Signal& s) {
+    MappedWavReader reader;
+    if (!reader.open(path)) {
+        std::fprintf(stderr, "%s\n", reader.getError().c_str());
+        return false;
+    }
+    const WavFormat& format = reader.getFormat();
+    std::vector<float> interleaved(static_cast<size_t>(reader.getTotalFrames()) * format.channels);
+    const size_t frames = reader.read(0, interleaved.data(), static_cast<size_t>(reader.getTotalFrames()));
+
+    s.name = "program " + path.substr(path.find_last_of("/\\") + 1);
+    s.kind = Signal::Kind::Program;
+    s.samples.resize(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        s.samples[i] = interleaved[i * format.channels];  // first channel
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Analysis
+
+// Amplitude of an exact-bin sinusoid over [start, start + length)
+template <typename T>
+double toneAmplitude(const std::vector<T>& x, size_t start, size_t length, double frequency, int rate) {
+    double re = 0.0;
+    double im = 0.0;
+    const double w = kTwoPi * frequency / rate;
+    for (size_t i = 0; i < length; ++i) {
+        const double phase = w * double(start + i);
+        re += double(x[start + i]) * std::cos(phase);
+        im += double(x[start + i]) * std::sin(phase);
+    }
+    return 2.0 * std::sqrt(re * re + im * im) / double(length);
+}
+
+double toDb(double ratio) {
+    return 20.0 * std::log10(std::max(ratio, 1e-300));
+}
+
+// Distortion relative to the carrier(s), in dB, or NaN when the signal has none
+template <typename T>
+double distortionDb(const std::vector<T>& x, const Signal& s, int rate) {
+    const size_t length = static_cast<size_t>(rate);
+    const size_t start = x.size() - length;
+    const double nyquist = 0.5 * rate;
+    auto amp = [&](double f) { return toneAmplitude(x, start, length, f, rate); };
+
+    double products = 0.0;
+    double carrier = 0.0;
+    switch (s.kind) {
+    case Signal::Kind::Tone:
+        carrier = amp(s.f1);
+        for (int h = 2; h <= 10 && h * s.f1 < nyquist; ++h) {
+            products += std::pow(amp(h * s.f1), 2);
+        }
+        break;
+    case Signal::Kind::Smpte:
+        // Sidebands of the high tone at multiples of the low one
+        carrier = amp(s.f2);
+        for (int n = 1; n <= 3; ++n) {
+            products += std::pow(amp(s.f2 - n * s.f1), 2) + std::pow(amp(s.f2 + n * s.f1), 2);
+        }
+        break;
+    case Signal::Kind::Ccif:
+        carrier = amp(s.f1) + amp(s.f2);
+        products += std::pow(amp(s.f2 - s.f1), 2) + std::pow(amp(2 * s.f1 - s.f2), 2);
+        if (2 * s.f2 - s.f1 < nyquist) {
+            products += std::pow(amp(2 * s.f2 - s.f1), 2);
+        }
+        break;
+    default:
+        return std::nan("");
+    }
+    return toDb(std::sqrt(products) / carrier);
+}
+
+struct Thresholds {
+    double maxError = 1e-5;
+    double minSnrDb = 100.0;
+    double maxDistortionDeltaDb = 0.05;
+    double distortionFloorDb = -120.0;  // deltas below this reference level are not gated
+    double floorErrorMargin = 4.0;      // allowed max error as a multiple of the float floor
+    double floorSnrMarginDb = 12.0;     // allowed SNR loss below the float floor (float log/exp adds ~9 dB)
+};
+
+struct ErrorStats {
+    double maxError = 0.0;
+    double snrDb = 300.0;
+};
+
+template <typename T>
+ErrorStats measureError(const std::vector<T>& output, const std::vector<double>& reference) {
+    ErrorStats stats;
+    double signalEnergy = 0.0;
+    double errorEnergy = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        const double e = double(output[i]) - reference[i];
+        signalEnergy += reference[i] * reference[i];
+        errorEnergy += e * e;
+        stats.maxError = std::max(stats.maxError, std::fabs(e));
+    }
+    if (errorEnergy > 0.0) {
+        stats.snrDb = 10.0 * std::log10(signalEnergy / errorEnergy);
+    }
+    return stats;
+}
+
+struct CaseResult {
+    std::string kernel;
+    int rate;
+    std::string signal;
+    double maxError = 0.0;
+    double snrDb = 0.0;
+    double allowedError = 0.0;
+    double requiredSnrDb = 0.0;
+    double referenceDistortionDb = std::nan("");
+    double distortionDeltaDb = std::nan("");
+    bool pass = true;
+};
+
+CaseResult compare(const Candidate& candidate, const std::vector<std::vector<float>>& outputs,
+                   const std::vector<double>& reference, const Signal& signal, int rate,
+                   const Thresholds& limits) {
+    CaseResult result;
+    result.kernel = candidate.name();
+    result.rate = rate;
+    result.signal = signal.name;
+
+    double worstSnr = 1e300;
+    double worstDelta = 0.0;
+    const double referenceDistortion = distortionDb(reference, signal, rate);
+    for (const auto& output : outputs) {
+        const ErrorStats stats = measureError(output, reference);
+        result.maxError = std::max(result.maxError, stats.maxError);
+        worstSnr = std::min(worstSnr, stats.snrDb);
+
+        if (!std::isnan(referenceDistortion)) {
+            const double delta = distortionDb(output, signal, rate) - referenceDistortion;
+            if (std::fabs(delta) >= std::fabs(worstDelta)) {
+                worstDelta = delta;
+            }
+        }
+    }
+    result.snrDb = worstSnr;
+    result.referenceDistortionDb = referenceDistortion;
+    if (!std::isnan(referenceDistortion)) {
+        result.distortionDeltaDb = worstDelta;
+    }
+
+    result.allowedError = limits.maxError;
+    result.requiredSnrDb = limits.minSnrDb;
+    result.pass = result.maxError <= limits.maxError && result.snrDb >= limits.minSnrDb;
+    if (!std::isnan(referenceDistortion) && referenceDistortion > limits.distortionFloorDb
+        && std::fabs(worstDelta) > limits.maxDistortionDeltaDb) {
+        result.pass = false;
+    }
+    return result;
+}
+
+void writeJson(std::FILE* out, const std::vector<CaseResult>& results, const Thresholds& limits) {
+    auto number = [](double v) {
+        static char buffer[32];
+        if (std::isnan(v)) return "null";
+        std::snprintf(buffer, sizeof(buffer), "%.6g", v);
+        return static_cast<const char*>(buffer);
+    };
+
+    std::fprintf(out, "{\n  \"tool\": \"amptube300b-accuracy\",\n  \"schema\": 1,\n");
+    std::fprintf(out, "  \"thresholds\": {\"max_abs_error\": %g, \"min_snr_db\": %g, \"max_distortion_delta_db\": %g, "
+                      "\"floor_error_margin\": %g, \"floor_snr_margin_db\": %g},\n",
+                 limits.maxError, limits.minSnrDb, limits.maxDistortionDeltaDb,
+                 limits.floorErrorMargin, limits.floorSnrMarginDb);
+    std::fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const CaseResult& r = results[i];
+        std::fprintf(out, "    {\"kernel\": \"%s\", \"rate\": %d, \"signal\": \"%s\", \"max_abs_error\": %s, ",
+                     r.kernel.c_str(), r.rate, r.signal.c_str(), number(r.maxError));
+        std::fprintf(out, "\"allowed_error\": %s, ", number(r.allowedError));
+        std::fprintf(out, "\"snr_db\": %s, ", number(r.snrDb));
+        std::fprintf(out, "\"required_snr_db\": %s, ", number(r.requiredSnrDb));
+        std::fprintf(out, "\"reference_distortion_db\": %s, ", number(r.referenceDistortionDb));
+        std::fprintf(out, "\"distortion_delta_db\": %s, \"pass\": %s}%s\n", number(r.distortionDeltaDb),
+                     r.pass ? "true" : "false", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+void printUsage() {
+    std::printf(
+        "Usage: amptube300b-accuracy [options]\n"
+        "\n"
+        "Options:\n"
+        "  --filter <text>       only kernels whose name contains <text>\n"
+        "  --rate <hz>           only this rate (default: all measured rates)\n"
+        "  --program <file.wav>  add program material (first channel, played at every rate)\n"
+        "  --max-error <x>       max abs error vs reference (default: 1e-5, or 4x the float floor)\n"
+        "  --min-snr <db>        min SNR vs reference (default: 100, or the float floor - 12 dB)\n"
+        "  --max-delta <db>      max THD/IMD change vs reference (default: 0.05)\n"
+        "  --output <file>       also write JSON results\n"
+        "\n"
+        "Exit status is 1 if any case fails a threshold.\n");
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Thresholds limits;
+    std::string filter;
+    std::string outputPath;
+    std::vector<std::string> programPaths;
+    int onlyRate = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(arg, "--filter") == 0 && hasValue) {
+            filter = argv[++i];
+        } else if (std::strcmp(arg, "--rate") == 0 && hasValue) {
+            onlyRate = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--program") == 0 && hasValue) {
+            programPaths.push_back(argv[++i]);
+        } else if (std::strcmp(arg, "--max-error") == 0 && hasValue) {
+            limits.maxError = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--min-snr") == 0 && hasValue) {
+            limits.minSnrDb = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--max-delta") == 0 && hasValue) {
+            limits.maxDistortionDeltaDb = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--output") == 0 && hasValue) {
+            outputPath = argv[++i];
+        } else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage();
+            return 0;
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n\n", arg);
+            printUsage();
+            return 2;
+        }
+    }
+
+    Logger::setLogLevel(Logger::Warning);
+
+    std::vector<std::unique_ptr<Candidate>> candidates;
+    candidates.push_back(std::make_unique<TubeStereoCandidate>());
+    candidates.push_back(std::make_unique<TubeMonoCandidate>());
+    candidates.push_back(std::make_unique<DSPInterleavedCandidate>());
+    candidates.push_back(std::make_unique<DSPPlanarCandidate>());
+    candidates.push_back(std::make_unique<BatchCandidate>());
+
+    std::vector<Signal> programs;
+    for (const std::string& path : programPaths) {
+        Signal s;
+        if (!loadProgram(path, s)) {
+            return 2;
+        }
+        programs.push_back(std::move(s));
+    }
+
+    std::vector<CaseResult> results;
+    int failures = 0;
+
+    std::printf("%-20s %7s  %-26s %10s %10s %8s %8s %10s %9s\n",
+                "kernel", "rate", "signal", "max error", "allowed", "SNR dB", "needed", "ref dist", "delta dB");
+
+    for (int rate : kRates) {
+        if (onlyRate > 0 && rate != onlyRate) {
+            continue;
+        }
+
+        std::vector<Signal> testSignals;
+        testSignals.push_back(makeSweep(rate));
+        testSignals.push_back(makeTone(rate, 1000.0, -20.0));
+        testSignals.push_back(makeTone(rate, 1000.0, -6.0));
+        testSignals.push_back(makeTone(rate, 1000.0, -1.0));
+        testSignals.push_back(makeTwoTone(rate, Signal::Kind::Smpte, 60.0, 0.4, 7000.0, 0.1, "SMPTE IMD 60+7k"));
+        testSignals.push_back(makeTwoTone(rate, Signal::Kind::Ccif, 19000.0, 0.25, 20000.0, 0.25, "CCIF IMD 19k+20k"));
+        testSignals.push_back(makeProgram(rate));
+        testSignals.insert(testSignals.end(), programs.begin(), programs.end());
+
+        for (const Signal& signal : testSignals) {
+            const std::vector<double> reference = runReference(signal.samples, rate);
+
+            // Never demand more than a float kernel can deliver at this rate
+            const ErrorStats floor = measureError(runReference(signal.samples, rate, true), reference);
+            Thresholds caseLimits = limits;
+            caseLimits.maxError = std::max(limits.maxError, limits.floorErrorMargin * floor.maxError);
+            caseLimits.minSnrDb = std::min(limits.minSnrDb, floor.snrDb - limits.floorSnrMarginDb);
+
+            for (const auto& candidate : candidates) {
+                if (!filter.empty() && std::string(candidate->name()).find(filter) == std::string::npos) {
+                    continue;
+                }
+                CaseResult r = compare(*candidate, candidate->run(signal.samples, rate), reference,
+                                       signal, rate, caseLimits);
+                std::printf("%-20s %7d  %-26s %10.3g %10.3g %8.1f %8.1f %10.1f %9.4f  %s\n",
+                            r.kernel.c_str(), r.rate, r.signal.c_str(), r.maxError, r.allowedError,
+                            r.snrDb, r.requiredSnrDb, r.referenceDistortionDb, r.distortionDeltaDb,
+                            r.pass ? "ok" : "FAIL");
+                if (!r.pass) {
+                    ++failures;
+                }
+                results.push_back(r);
+            }
+        }
+    }
+
+    if (!outputPath.empty()) {
+        std::FILE* out = std::fopen(outputPath.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "Cannot write %s\n", outputPath.c_str());
+            return 2;
+        }
+        writeJson(out, results, limits);
+        std::fclose(out);
+    }
+
+    std::printf("\n%zu cases, %d failed\n", results.size(), failures);
+    return failures > 0 ? 1 : 0;
+}
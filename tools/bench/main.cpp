@@ -0,0 +1,692 @@
+// amptube300b-bench - microbenchmarks for the DSP and buffering primitives
+//
+//   amptube300b-bench [options]
+//
+// Every kernel is timed over each block size (and each supported sample
+// rate where the kernel depends on it). Every call gets a fresh block of
+// a precomputed signal so recursive state never runs into denormals or
+// silence: the blocks are laid out in an arena ahead of time and only the
+// pass over the arena is timed, not the copy that refills it. Results are
+// written as JSON. With --counters the same timed passes are also counted
+// with hardware performance counters (Linux). Kernels with an accuracy
+// check run it once before they are timed; a failed check exits with 1.
+
+#include "../../src/core/AudioBuffer.h"
+#include "../../src/core/ChannelMatrix.h"
+#include "../../src/core/LevelMeter.h"
+#include "../../src/core/LoudnessMeter.h"
+#include "../../src/core/SampleConverter.h"
+#include "../../src/dsp/DSPProcessor.h"
+#include "../../src/dsp/FilterBank.h"
+#include "../../src/dsp/Parameters.h"
+#include "../../src/dsp/RealFFT.h"
+#include "../../src/dsp/TubeBatchProcessor.h"
+#include "../../src/dsp/TubeEmulator.h"
+#include "../../src/utils/Logger.h"
+#include "../../src/utils/PerfCounters.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+const int kRates[] = {44100, 48000, 88200, 96000, 176400, 192000};
+const int kBlocks[] = {32, 64, 128, 256, 512, 1024, 2048, 4096};
+const int kQuickBlocks[] = {32, 256, 4096};
+constexpr int kSignalSeconds = 1;
+constexpr size_t kArenaSamples = 64 * 1024;  // 256 KB of blocks, stays in L2
+
+volatile float g_sink = 0.0f;  // keeps results observable
+
+/**
+ * Kernel - One benchmarked primitive
+ *
+ * prepare() runs untimed before each (rate, block) case; run() processes one
+ * block in place. The buffer holds 'channels' interleaved channels unless
+ * the kernel is planar, in which case channel k starts at k * frames.
+ */
+class Kernel {
+public:
+    virtual ~Kernel() = default;
+    virtual const char* name() const = 0;
+    virtual int channels() const { return 2; }
+    virtual bool planar() const { return false; }
+    virtual bool rateDependent() const { return true; }
+    virtual void prepare(int rate, int frames) { (void)rate; (void)frames; }
+    virtual void run(float* buffer, int frames) = 0;
+    // Untimed; false (with a reason) when the kernel computes the wrong result
+    virtual bool verify(std::string& error) { (void)error; return true; }
+};
+
+class TubeStereoKernel : public Kernel {
+public:
+    const char* name() const override { return "tube.process"; }
+    bool planar() const override { return true; }
+    void prepare(int rate, int) override { m_tube.setSampleRate(rate); m_tube.reset(); }
+    void run(float* buffer, int frames) override { m_tube.process(buffer, buffer + frames, frames); }
+private:
+    TubeEmulator m_tube;
+};
+
+class TubeMonoKernel : public Kernel {
+public:
+    const char* name() const override { return "tube.processMono"; }
+    int channels() const override { return 1; }
+    void prepare(int rate, int) override { m_tube.setSampleRate(rate); m_tube.reset(); }
+    void run(float* buffer, int frames) override { m_tube.processMono(buffer, frames); }
+private:
+    TubeEmulator m_tube;
+};
+
+class ShapeSampleKernel : public Kernel {
+public:
+    const char* name() const override { return "tube.shapeSample"; }
+    int channels() const override { return 1; }
+    bool rateDependent() const override { return false; }
+    void run(float* buffer, int frames) override {
+        for (int i = 0; i < frames; ++i) {
+            buffer[i] = TubeEmulator::shapeSample(buffer[i]);
+        }
+    }
+};
+
+class FilterBankKernel : public Kernel {
+public:
+    const char* name() const override { return "filterbank.process"; }
+    bool planar() const override { return true; }
+    void prepare(int rate, int) override {
+        m_bank.setCoefficients(m_parameters.getPreFilterCoeffs(rate));
+        m_bank.reset();
+    }
+    void run(float* buffer, int frames) override { m_bank.process(buffer, buffer + frames, frames); }
+private:
+    Parameters m_parameters;
+    FilterBank m_bank;
+};
+
+class DSPInterleavedKernel : public Kernel {
+public:
+    const char* name() const override { return "dsp.process"; }
+    void prepare(int rate, int) override { m_dsp.setSampleRate(rate); m_dsp.reset(); }
+    void run(float* buffer, int frames) override { m_dsp.process(buffer, frames, 2); }
+private:
+    DSPProcessor m_dsp;
+};
+
+class DSPPlanarKernel : public Kernel {
+public:
+    const char* name() const override { return "dsp.processPlanar"; }
+    bool planar() const override { return true; }
+    void prepare(int rate, int) override { m_dsp.setSampleRate(rate); m_dsp.reset(); }
+    void run(float* buffer, int frames) override {
+        float* channels[2] = {buffer, buffer + frames};
+        m_dsp.processPlanar(channels, frames, 2);
+    }
+private:
+    DSPProcessor m_dsp;
+};
+
+class BatchKernel : public Kernel {
+public:
+    const char* name() const override { return "batch.process"; }
+    int channels() const override { return TubeBatchProcessor::kLaneWidth; }
+    bool planar() const override { return true; }
+    void prepare(int rate, int frames) override {
+        m_batch.setSampleRate(rate);
+        m_batch.reset();
+        m_lanes.assign(channels(), nullptr);
+        (void)frames;
+    }
+    void run(float* buffer, int frames) override {
+        for (int k = 0; k < channels(); ++k) {
+            m_lanes[k] = buffer + k * frames;
+        }
+        m_batch.process(m_lanes.data(), frames);
+    }
+private:
+    TubeBatchProcessor m_batch;
+    std::vector<float*> m_lanes;
+};
+
+class AudioBufferKernel : public Kernel {
+public:
+    const char* name() const override { return "audiobuffer.writeRead"; }
+    bool rateDependent() const override { return false; }
+    void prepare(int, int) override { m_ring.clear(); }
+    void run(float* buffer, int frames) override {
+        m_ring.write(buffer, frames, 2);
+        m_ring.read(buffer, frames, 2);
+    }
+private:
+    AudioBuffer m_ring;
+};
+
+// Same round trip through the zero-copy regions, as an in-place producer/consumer would
+class AudioBufferRegionKernel : public Kernel {
+public:
+    const char* name() const override { return "audiobuffer.acquireCommit"; }
+    bool rateDependent() const override { return false; }
+    void prepare(int, int) override { m_ring.clear(); }
+    void run(float* buffer, int frames) override {
+        const size_t samples = static_cast<size_t>(frames) * 2;
+        AudioBuffer::WriteRegion out = m_ring.acquireWrite(samples);
+        std::memcpy(out.first, buffer, out.firstSize * sizeof(float));
+        std::memcpy(out.second, buffer + out.firstSize, out.secondSize * sizeof(float));
+        m_ring.commitWrite(out.size());
+
+        AudioBuffer::ReadRegion in = m_ring.acquireRead(samples);
+        std::memcpy(buffer, in.first, in.firstSize * sizeof(float));
+        std::memcpy(buffer + in.firstSize, in.second, in.secondSize * sizeof(float));
+        m_ring.commitRead(in.size());
+    }
+private:
+    AudioBuffer m_ring;
+};
+
+// Device-format round trip as an integer stream callback does it: in, then dithered out
+class NativeFormatKernel : public Kernel {
+public:
+    NativeFormatKernel(const char* name, SampleConverter::Format format) : m_name(name), m_format(format) {}
+    const char* name() const override { return m_name; }
+    bool rateDependent() const override { return false; }
+    void prepare(int, int frames) override {
+        m_native.assign(static_cast<size_t>(frames) * 2 * SampleConverter::bytesPerSample(m_format), 0);
+        m_dither.reset(1);
+    }
+    void run(float* buffer, int frames) override {
+        SampleConverter::fromFloat(buffer, m_native.data(), m_format, static_cast<size_t>(frames) * 2, &m_dither);
+        SampleConverter::toFloat(m_native.data(), m_format, buffer, static_cast<size_t>(frames) * 2);
+    }
+private:
+    const char* m_name;
+    SampleConverter::Format m_format;
+    SampleConverter::Dither m_dither;
+    std::vector<unsigned char> m_native;
+};
+
+class StereoToMonoKernel : public Kernel {
+public:
+    const char* name() const override { return "matrix.stereoToMono"; }
+    bool rateDependent() const override { return false; }
+    void prepare(int, int frames) override { m_mono.assign(frames, 0.0f); }
+    void run(float* buffer, int frames) override {
+        ChannelMatrix::mixDefault(buffer, 2, m_mono.data(), 1, frames);
+        ChannelMatrix::mixDefault(m_mono.data(), 1, buffer, 2, frames);
+    }
+private:
+    std::vector<float> m_mono;
+};
+
+// Non-default matrices take the general path: stereo is spread over three
+// channels (the padded-vector case) and folded back
+class GeneralMatrixKernel : public Kernel {
+public:
+    GeneralMatrixKernel() : m_up(2, 3), m_down(3, 2) {
+        m_up.setGain(0, 0, 0.9f);
+        m_up.setGain(0, 1, 0.1f);
+        m_up.setGain(1, 0, 0.1f);
+        m_up.setGain(1, 1, 0.9f);
+        m_up.setGain(2, 0, 0.5f);
+        m_up.setGain(2, 1, 0.5f);
+        m_down.setGain(0, 0, 1.0f);
+        m_down.setGain(0, 2, 0.7071f);
+        m_down.setGain(1, 1, 1.0f);
+        m_down.setGain(1, 2, 0.7071f);
+    }
+    const char* name() const override { return "matrix.general"; }
+    bool rateDependent() const override { return false; }
+    void prepare(int, int frames) override { m_wide.assign(static_cast<size_t>(frames) * 3, 0.0f); }
+    void run(float* buffer, int frames) override {
+        m_up.process(buffer, m_wide.data(), frames);
+        m_down.process(m_wide.data(), buffer, frames);
+    }
+    bool verify(std::string& error) override {
+        ChannelMatrix pan(1, 6);  // one vector plus a partial one
+        ChannelMatrix fold(6, 2);
+        for (int ch = 0; ch < 6; ++ch) {
+            pan.setGain(ch, 0, 0.25f + 0.125f * ch);
+            fold.setGain(ch % 2, ch, 1.0f / (ch + 1));
+            fold.setGain((ch + 1) % 2, ch, -0.5f / (ch + 1));
+        }
+        for (const ChannelMatrix* matrix : {&m_up, &m_down, &pan, &fold}) {
+            if (!check(*matrix, error)) {
+                return false;
+            }
+        }
+        return true;
+    }
+private:
+    // Every length up to a few vectors, so the last-frame store is covered
+    static bool check(const ChannelMatrix& matrix, std::string& error) {
+        const int inputs = matrix.getInputChannels();
+        const int outputs = matrix.getOutputChannels();
+        uint32_t state = 777;
+        for (size_t frames = 1; frames <= 19; ++frames) {
+            std::vector<float> input(frames * inputs);
+            for (float& sample : input) {
+                state = state * 1664525u + 1013904223u;
+                sample = static_cast<float>(double(state >> 8) / double(1u << 23) - 1.0);
+            }
+            // Guard samples past the end must survive
+            std::vector<float> output(frames * outputs + 4, 123.0f);
+            matrix.process(input.data(), output.data(), frames);
+
+            for (size_t i = 0; i < frames; ++i) {
+                for (int o = 0; o < outputs; ++o) {
+                    double expected = 0.0;
+                    for (int c = 0; c < inputs; ++c) {
+                        expected += double(matrix.getGain(o, c)) * input[i * inputs + c];
+                    }
+                    if (std::fabs(output[i * outputs + o] - expected) > 1e-6) {
+                        error = std::to_string(inputs) + "x" + std::to_string(outputs) + " matrix: output "
+                              + std::to_string(o) + " of frame " + std::to_string(i) + " is "
+                              + std::to_string(output[i * outputs + o]) + ", expected " + std::to_string(expected);
+                        return false;
+                    }
+                }
+            }
+            for (size_t i = frames * outputs; i < output.size(); ++i) {
+                if (output[i] != 123.0f) {
+                    error = std::to_string(inputs) + "x" + std::to_string(outputs) + " matrix wrote past "
+                          + std::to_string(frames) + " frames";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    ChannelMatrix m_up;
+    ChannelMatrix m_down;
+    std::vector<float> m_wide;
+};
+
+class LevelMeterKernel : public Kernel {
+public:
+    const char* name() const override { return "meter.process"; }
+    void prepare(int rate, int) override { m_meter.prepare(rate); }
+    void run(float* buffer, int frames) override {
+        const float* channels[2] = {buffer, buffer + 1};
+        m_meter.process(channels, 2, frames, 2);
+    }
+private:
+    LevelMeter m_meter;
+};
+
+// One real FFT per block, the block size being the transform size
+class RealFFTKernel : public Kernel {
+public:
+    const char* name() const override { return "fft.powerSpectrum"; }
+    int channels() const override { return 1; }
+    bool rateDependent() const override { return false; }
+    void prepare(int, int frames) override {
+        m_fft.setSize(frames);
+        m_power.assign(m_fft.getBinCount(), 0.0f);
+    }
+    void run(float* buffer, int frames) override {
+        if (frames < 16) return;
+        m_fft.powerSpectrum(buffer, m_power.data());
+        g_sink = m_power[1];
+    }
+private:
+    RealFFT m_fft;
+    std::vector<float> m_power;
+};
+
+class LoudnessMeterKernel : public Kernel {
+public:
+    const char* name() const override { return "meter.loudness"; }
+    void prepare(int rate, int) override { m_meter.prepare(rate); }
+    void run(float* buffer, int frames) override {
+        const float* channels[2] = {buffer, buffer + 1};
+        m_meter.process(channels, 2, frames, 2);
+    }
+private:
+    LoudnessMeter m_meter;
+};
+
+struct Result {
+    const Kernel* kernel;
+    int rate;
+    int frames;
+    double nsPerFrame;     // median of the repetitions, kernel calls only
+    double nsPerFrameMin;
+    PerfCounters::Reading counts;  // over the kernel calls of all repetitions
+    double countedFrames = 0.0;
+};
+
+// Band-limited test signal: two partials plus low-level noise, -6 dBFS peak
+std::vector<float> makeSignal(int rate, int channels) {
+    const size_t frames = static_cast<size_t>(rate) * kSignalSeconds;
+    std::vector<float> signal(frames * channels);
+    uint32_t state = 12345;
+    for (size_t i = 0; i < frames; ++i) {
+        const double t = double(i) / rate;
+        for (int ch = 0; ch < channels; ++ch) {
+            state = state * 1664525u + 1013904223u;
+            const double noise = (double(state >> 8) / double(1u << 24) - 0.5) * 0.02;
+            const double tone = 0.3 * std::sin(6.283185307179586 * 997.0 * t + ch)
+                              + 0.19 * std::sin(6.283185307179586 * 3203.0 * t);
+            signal[i * channels + ch] = static_cast<float>(tone + noise);
+        }
+    }
+    return signal;
+}
+
+Result measure(Kernel& kernel, int rate, int frames, double minSeconds, int repetitions,
+               PerfCounters* counters) {
+    using Clock = std::chrono::steady_clock;
+
+    const int channels = kernel.channels();
+    const std::vector<float> signal = makeSignal(rate, channels);
+    const size_t signalFrames = signal.size() / channels;
+    const size_t blockSamples = static_cast<size_t>(frames) * channels;
+    const size_t arenaBlocks = std::max<size_t>(1, kArenaSamples / blockSamples);
+    std::vector<float> arena(arenaBlocks * blockSamples);
+    size_t position = 0;
+
+    kernel.prepare(rate, frames);
+
+    // Refill every arena block from the signal; planar kernels get the channels one after another
+    auto refill = [&]() {
+        for (size_t b = 0; b < arenaBlocks; ++b) {
+            if (position + frames > signalFrames) {
+                position = 0;
+            }
+            const float* src = signal.data() + position * channels;
+            float* block = arena.data() + b * blockSamples;
+            if (kernel.planar() && channels > 1) {
+                for (int i = 0; i < frames; ++i) {
+                    for (int ch = 0; ch < channels; ++ch) {
+                        block[ch * frames + i] = src[i * channels + ch];
+                    }
+                }
+            } else {
+                std::memcpy(block, src, blockSamples * sizeof(float));
+            }
+            position += frames;
+        }
+    };
+
+    // One call per arena block; only the calls are timed and counted, the refill behind them is not
+    auto runPass = [&](PerfCounters* passCounters) {
+        if (passCounters) {
+            passCounters->resume();
+        }
+        const Clock::time_point start = Clock::now();
+        for (size_t b = 0; b < arenaBlocks; ++b) {
+            kernel.run(arena.data() + b * blockSamples, frames);
+        }
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (passCounters) {
+            passCounters->stop();
+        }
+        g_sink = g_sink + arena[0];
+        refill();
+        return elapsed;
+    };
+
+    // Warm up for about a millisecond
+    refill();
+    for (double warmup = 0.0; warmup < 1e-3;) {
+        warmup += runPass(nullptr);
+    }
+
+    std::vector<double> samples;
+    const double perRepetition = minSeconds / repetitions;
+    long totalCalls = 0;
+    if (counters) {
+        counters->reset();
+    }
+    for (int r = 0; r < repetitions; ++r) {
+        long calls = 0;
+        double elapsed = 0.0;
+        while (elapsed < perRepetition) {
+            elapsed += runPass(counters);
+            calls += static_cast<long>(arenaBlocks);
+        }
+        samples.push_back(elapsed * 1e9 / (double(calls) * frames));
+        totalCalls += calls;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result result;
+    result.kernel = &kernel;
+    result.rate = rate;
+    result.frames = frames;
+    result.nsPerFrame = samples[samples.size() / 2];
+    result.nsPerFrameMin = samples.front();
+    if (counters) {
+        result.counts = counters->read();
+        result.countedFrames = double(totalCalls) * frames;
+    }
+    return result;
+}
+
+const char* simdLevel() {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSSE3__)
+    return "ssse3";
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    return "sse2";
+#elif defined(__ARM_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+const char* compilerName() {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc";
+#else
+    return "unknown";
+#endif
+}
+
+// Appended to a result object: per-frame counts, misses per 1000 frames
+void writeCounters(std::FILE* out, const Result& r) {
+    const PerfCounters::Reading& c = r.counts;
+    const double frames = r.countedFrames;
+    std::fprintf(out, "     \"counters\": {");
+    bool first = true;
+    auto field = [&](const char* name, double value) {
+        std::fprintf(out, "%s\"%s\": %.4f", first ? "" : ", ", name, value);
+        first = false;
+    };
+    if (c.valid[PerfCounters::Cycles]) {
+        field("cycles_per_frame", c.values[PerfCounters::Cycles] / frames);
+        field("cycles_per_sample", c.values[PerfCounters::Cycles] / (frames * r.kernel->channels()));
+    }
+    if (c.valid[PerfCounters::Instructions]) {
+        field("instructions_per_frame", c.values[PerfCounters::Instructions] / frames);
+    }
+    if (c.valid[PerfCounters::Cycles] && c.valid[PerfCounters::Instructions]) {
+        field("ipc", c.getIpc());
+    }
+    for (PerfCounters::Event event : {PerfCounters::L1DMisses, PerfCounters::LLCMisses, PerfCounters::BranchMisses}) {
+        if (c.valid[event]) {
+            field((std::string(PerfCounters::eventName(event)) + "_per_kframe").c_str(),
+                  c.values[event] * 1000.0 / frames);
+        }
+    }
+    std::fprintf(out, "}}");
+}
+
+void writeJson(std::FILE* out, const std::vector<Result>& results, double minSeconds) {
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"tool\": \"amptube300b-bench\",\n");
+    std::fprintf(out, "  \"schema\": 1,\n");
+    std::fprintf(out, "  \"compiler\": \"%s\",\n", compilerName());
+    std::fprintf(out, "  \"simd\": \"%s\",\n", simdLevel());
+    std::fprintf(out, "  \"min_time_ms\": %.0f,\n", minSeconds * 1000.0);
+    std::fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        const int channels = r.kernel->channels();
+        // Real-time factor is per core at the case's rate (48 kHz for rate-independent kernels)
+        const double realtime = 1e9 / (r.nsPerFrame * r.rate);
+        std::fprintf(out, "    {\"kernel\": \"%s\", ", r.kernel->name());
+        if (r.kernel->rateDependent()) {
+            std::fprintf(out, "\"rate\": %d, ", r.rate);
+        }
+        std::fprintf(out, "\"block\": %d, \"channels\": %d, \"ns_per_frame\": %.4f, \"ns_per_sample\": %.4f, "
+                          "\"ns_per_frame_min\": %.4f, \"realtime_factor\": %.1f%s%s\n",
+                     r.frames, channels, r.nsPerFrame, r.nsPerFrame / channels, r.nsPerFrameMin, realtime,
+                     r.countedFrames > 0.0 ? "," : "}",
+                     r.countedFrames > 0.0 ? "" : (i + 1 < results.size() ? "," : ""));
+        if (r.countedFrames > 0.0) {
+            writeCounters(out, r);
+            std::fprintf(out, "%s\n", i + 1 < results.size() ? "," : "");
+        }
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+void printUsage() {
+    std::printf(
+        "Usage: amptube300b-bench [options]\n"
+        "\n"
+        "Options:\n"
+        "  --filter <text>     only kernels whose name contains <text>\n"
+        "  --min-time <ms>     measuring time per case (default: 200)\n"
+        "  --repeat <n>        repetitions per case, median reported (default: 5)\n"
+        "  --quick             blocks 32/256/4096 and 20 ms per case\n"
+        "  --output <file>     write JSON to <file> instead of stdout\n"
+        "  --counters          also read hardware performance counters (Linux)\n"
+        "  --list              list kernel names\n");
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    std::string outputPath;
+    double minSeconds = 0.2;
+    int repetitions = 5;
+    bool quick = false;
+    bool list = false;
+    bool useCounters = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(arg, "--filter") == 0 && hasValue) {
+            filter = argv[++i];
+        } else if (std::strcmp(arg, "--min-time") == 0 && hasValue) {
+            minSeconds = std::max(1.0, std::atof(argv[++i])) / 1000.0;
+        } else if (std::strcmp(arg, "--repeat") == 0 && hasValue) {
+            repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--quick") == 0) {
+            quick = true;
+            minSeconds = 0.02;
+        } else if (std::strcmp(arg, "--output") == 0 && hasValue) {
+            outputPath = argv[++i];
+        } else if (std::strcmp(arg, "--counters") == 0) {
+            useCounters = true;
+        } else if (std::strcmp(arg, "--list") == 0) {
+            list = true;
+        } else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage();
+            return 0;
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n\n", arg);
+            printUsage();
+            return 2;
+        }
+    }
+
+    Logger::setLogLevel(Logger::Warning);
+
+    std::vector<std::unique_ptr<Kernel>> kernels;
+    kernels.push_back(std::make_unique<TubeStereoKernel>());
+    kernels.push_back(std::make_unique<TubeMonoKernel>());
+    kernels.push_back(std::make_unique<ShapeSampleKernel>());
+    kernels.push_back(std::make_unique<FilterBankKernel>());
+    kernels.push_back(std::make_unique<DSPInterleavedKernel>());
+    kernels.push_back(std::make_unique<DSPPlanarKernel>());
+    kernels.push_back(std::make_unique<BatchKernel>());
+    kernels.push_back(std::make_unique<AudioBufferKernel>());
+    kernels.push_back(std::make_unique<AudioBufferRegionKernel>());
+    kernels.push_back(std::make_unique<NativeFormatKernel>("convert.int16Dithered", SampleConverter::Format::Int16));
+    kernels.push_back(std::make_unique<NativeFormatKernel>("convert.int24Dithered", SampleConverter::Format::Int24));
+    kernels.push_back(std::make_unique<NativeFormatKernel>("convert.int32", SampleConverter::Format::Int32));
+    kernels.push_back(std::make_unique<StereoToMonoKernel>());
+    kernels.push_back(std::make_unique<GeneralMatrixKernel>());
+    kernels.push_back(std::make_unique<LevelMeterKernel>());
+    kernels.push_back(std::make_unique<LoudnessMeterKernel>());
+    kernels.push_back(std::make_unique<RealFFTKernel>());
+
+    if (list) {
+        for (const auto& kernel : kernels) {
+            std::printf("%s\n", kernel->name());
+        }
+        return 0;
+    }
+
+    PerfCounters counters;
+    if (useCounters && !counters.open()) {
+        std::fprintf(stderr, "%s; continuing without counters\n", counters.getError().c_str());
+    }
+    PerfCounters* activeCounters = counters.isOpen() ? &counters : nullptr;
+
+    std::vector<int> blocks = quick
+        ? std::vector<int>(std::begin(kQuickBlocks), std::end(kQuickBlocks))
+        : std::vector<int>(std::begin(kBlocks), std::end(kBlocks));
+
+    std::vector<Result> results;
+    for (const auto& kernel : kernels) {
+        if (!filter.empty() && std::string(kernel->name()).find(filter) == std::string::npos) {
+            continue;
+        }
+        std::string error;
+        if (!kernel->verify(error)) {
+            std::fprintf(stderr, "%s: accuracy check failed: %s\n", kernel->name(), error.c_str());
+            return 1;
+        }
+
+        std::vector<int> rates = kernel->rateDependent()
+            ? std::vector<int>(std::begin(kRates), std::end(kRates))
+            : std::vector<int>{48000};
+
+        for (int rate : rates) {
+            for (int frames : blocks) {
+                Result result = measure(*kernel, rate, frames, minSeconds, repetitions, activeCounters);
+                std::fprintf(stderr, "%-24s %6d Hz %5d frames  %8.3f ns/frame  %8.1fx real time",
+                             kernel->name(), rate, frames, result.nsPerFrame, 1e9 / (result.nsPerFrame * rate));
+                if (result.countedFrames > 0.0 && result.counts.valid[PerfCounters::Cycles]) {
+                    std::fprintf(stderr, "  %7.2f cyc/sample  IPC %.2f",
+                                 result.counts.values[PerfCounters::Cycles]
+                                     / (result.countedFrames * kernel->channels()),
+                                 result.counts.getIpc());
+                }
+                std::fprintf(stderr, "\n");
+                results.push_back(result);
+            }
+        }
+    }
+
+    std::FILE* out = stdout;
+    if (!outputPath.empty()) {
+        out = std::fopen(outputPath.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "Cannot write %s\n", outputPath.c_str());
+            return 1;
+        }
+    }
+    writeJson(out, results, minSeconds);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,352 @@
+// amptube300b-claphost - headless CLAP host for testing the 300B plugin
+//
+//   amptube300b-claphost [options] <plugin.clap> [<input.wav> <output.wav>]
+//
+// Loads the plugin, checks its ports and latency, streams audio through it
+// in fixed blocks (in place by default, as a zero-copy host would) and
+// compares the result sample for sample with DSPProcessor run directly.
+// Without a WAV input a two-tone test signal is used. Exits with 1 when
+// the plugin misbehaves or its output differs.
+
+#include <clap/clap.h>
+#include "../../src/dsp/DSPProcessor.h"
+#include "../../src/offline/MappedWavFile.h"
+#include "../../src/utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace {
+constexpr int kChannels = 2;
+
+void printUsage() {
+    std::printf(
+        "Usage: amptube300b-claphost [options] <plugin.clap> [<input.wav> <output.wav>]\n"
+        "\n"
+        "Options:\n"
+        "  --block <frames>       host block size (default: 256)\n"
+        "  --copy                 separate input/output buffers instead of in-place\n"
+        "  --rate <hz>            sample rate of the test signal (default: 48000)\n"
+        "  --seconds <s>          length of the test signal (default: 5)\n"
+        "  --bypass-at <s>        send a bypass-on parameter event at this time\n");
+}
+
+void* loadLibrary(const std::string& path) {
+#ifdef _WIN32
+    return reinterpret_cast<void*>(LoadLibraryA(path.c_str()));
+#else
+    return dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+}
+
+void* findSymbol(void* library, const char* name) {
+#ifdef _WIN32
+    return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(library), name));
+#else
+    return dlsym(library, name);
+#endif
+}
+
+// Parameter events for one block, time-ordered
+struct EventList {
+    std::vector<clap_event_param_value_t> events;
+
+    clap_input_events_t list() {
+        clap_input_events_t in;
+        in.ctx = this;
+        in.size = [](const clap_input_events_t* self) {
+            return static_cast<uint32_t>(static_cast<EventList*>(self->ctx)->events.size());
+        };
+        in.get = [](const clap_input_events_t* self, uint32_t index) -> const clap_event_header_t* {
+            return &static_cast<EventList*>(self->ctx)->events[index].header;
+        };
+        return in;
+    }
+};
+
+clap_event_param_value_t paramEvent(clap_id id, double value, uint32_t time) {
+    clap_event_param_value_t event;
+    std::memset(&event, 0, sizeof(event));
+    event.header.size = sizeof(event);
+    event.header.time = time;
+    event.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+    event.header.type = CLAP_EVENT_PARAM_VALUE;
+    event.param_id = id;
+    event.note_id = -1;
+    event.port_index = -1;
+    event.channel = -1;
+    event.key = -1;
+    event.value = value;
+    return event;
+}
+
+bool findBypassParam(const clap_plugin_t* plugin, clap_id& id) {
+    const auto* params = static_cast<const clap_plugin_params_t*>(plugin->get_extension(plugin, CLAP_EXT_PARAMS));
+    if (!params) return false;
+    for (uint32_t i = 0; i < params->count(plugin); ++i) {
+        clap_param_info_t info;
+        if (params->get_info(plugin, i, &info) && (info.flags & CLAP_PARAM_IS_BYPASS)) {
+            id = info.id;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<float> makeTestSignal(int rate, double seconds) {
+    const size_t frames = static_cast<size_t>(seconds * rate);
+    std::vector<float> samples(frames * kChannels);
+    for (size_t i = 0; i < frames; ++i) {
+        const double t = double(i) / rate;
+        samples[i * 2] = static_cast<float>(0.4 * std::sin(6.283185307179586 * 220.0 * t)
+                                            + 0.2 * std::sin(6.283185307179586 * 3000.0 * t));
+        samples[i * 2 + 1] = static_cast<float>(0.5 * std::sin(6.283185307179586 * 440.0 * t));
+    }
+    return samples;
+}
+
+bool fail(const char* message) {
+    std::fprintf(stderr, "FAIL: %s\n", message);
+    return false;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int blockFrames = 256;
+    bool inPlace = true;
+    int testRate = 48000;
+    double testSeconds = 5.0;
+    double bypassAt = -1.0;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--block") == 0 && hasValue) {
+            blockFrames = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--copy") == 0) {
+            inPlace = false;
+        } else if (std::strcmp(arg, "--rate") == 0 && hasValue) {
+            testRate = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--seconds") == 0 && hasValue) {
+            testSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--bypass-at") == 0 && hasValue) {
+            bypassAt = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage();
+            return 0;
+        } else if (arg[0] == '-') {
+            std::fprintf(stderr, "Unknown argument: %s\n\n", arg);
+            printUsage();
+            return 2;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.size() != 1 && paths.size() != 3) {
+        printUsage();
+        return 2;
+    }
+
+    Logger::setLogLevel(Logger::Warning);
+
+    // Input audio, always stereo
+    WavFormat format;
+    std::vector<float> input;
+    if (paths.size() == 3) {
+        MappedWavReader reader;
+        if (!reader.open(paths[1])) {
+            std::fprintf(stderr, "%s\n", reader.getError().c_str());
+            return 1;
+        }
+        format = reader.getFormat();
+        const size_t frames = static_cast<size_t>(reader.getTotalFrames());
+        std::vector<float> samples(frames * format.channels);
+        reader.read(0, samples.data(), frames);
+        input.resize(frames * kChannels);
+        for (size_t i = 0; i < frames; ++i) {
+            for (int ch = 0; ch < kChannels; ++ch) {
+                input[i * kChannels + ch] = samples[i * format.channels + std::min(ch, format.channels - 1)];
+            }
+        }
+        format.channels = kChannels;
+    } else {
+        format.sampleRate = testRate;
+        input = makeTestSignal(testRate, testSeconds);
+    }
+    const size_t totalFrames = input.size() / kChannels;
+    const size_t bypassFrame = bypassAt >= 0.0 ? static_cast<size_t>(bypassAt * format.sampleRate) : totalFrames;
+
+    // Load and instantiate
+    void* library = loadLibrary(paths[0]);
+    if (!library) {
+        std::fprintf(stderr, "Cannot load %s\n", paths[0].c_str());
+        return 1;
+    }
+    const auto* entry = static_cast<const clap_plugin_entry_t*>(findSymbol(library, "clap_entry"));
+    if (!entry || !clap_version_is_compatible(entry->clap_version) || !entry->init(paths[0].c_str())) {
+        std::fprintf(stderr, "%s is not a usable CLAP plugin\n", paths[0].c_str());
+        return 1;
+    }
+
+    const auto* factory = static_cast<const clap_plugin_factory_t*>(entry->get_factory(CLAP_PLUGIN_FACTORY_ID));
+    if (!factory || factory->get_plugin_count(factory) == 0) {
+        std::fprintf(stderr, "No plugins in %s\n", paths[0].c_str());
+        return 1;
+    }
+    const clap_plugin_descriptor_t* descriptor = factory->get_plugin_descriptor(factory, 0);
+
+    clap_host_t host;
+    std::memset(&host, 0, sizeof(host));
+    host.clap_version = CLAP_VERSION_INIT;
+    host.name = "amptube300b-claphost";
+    host.vendor = "AmpTube300B";
+    host.url = "";
+    host.version = "1.0";
+    host.get_extension = [](const clap_host_t*, const char*) -> const void* { return nullptr; };
+    host.request_restart = [](const clap_host_t*) {};
+    host.request_process = [](const clap_host_t*) {};
+    host.request_callback = [](const clap_host_t*) {};
+
+    const clap_plugin_t* plugin = factory->create_plugin(factory, &host, descriptor->id);
+    if (!plugin || !plugin->init(plugin)) {
+        std::fprintf(stderr, "Cannot create %s\n", descriptor->id);
+        return 1;
+    }
+
+    bool ok = true;
+
+    // Ports: one stereo pair that may be processed in place
+    const auto* ports = static_cast<const clap_plugin_audio_ports_t*>(plugin->get_extension(plugin, CLAP_EXT_AUDIO_PORTS));
+    clap_audio_port_info_t inPort, outPort;
+    if (!ports || ports->count(plugin, true) < 1 || ports->count(plugin, false) < 1
+        || !ports->get(plugin, 0, true, &inPort) || !ports->get(plugin, 0, false, &outPort)) {
+        ok = fail("no audio ports");
+    } else if (inPort.channel_count != kChannels || outPort.channel_count != kChannels) {
+        ok = fail("main ports are not stereo");
+    } else if (inPlace && outPort.in_place_pair != inPort.id) {
+        ok = fail("output port is not an in-place pair of the input");
+    }
+
+    const auto* latency = static_cast<const clap_plugin_latency_t*>(plugin->get_extension(plugin, CLAP_EXT_LATENCY));
+    const uint32_t latencyFrames = latency ? latency->get(plugin) : 0;
+    if (!latency) {
+        ok = fail("no latency extension");
+    }
+
+    clap_id bypassId = CLAP_INVALID_ID;
+    if (bypassFrame < totalFrames && !findBypassParam(plugin, bypassId)) {
+        ok = fail("no bypass parameter");
+    }
+
+    if (ok && !plugin->activate(plugin, format.sampleRate, 1, static_cast<uint32_t>(blockFrames))) {
+        ok = fail("activate failed");
+    }
+    if (ok && !plugin->start_processing(plugin)) {
+        ok = fail("start_processing failed");
+    }
+
+    // Stream in host-sized blocks through planar buffers
+    std::vector<float> output(input.size());
+    double processSeconds = 0.0;
+    if (ok) {
+        std::vector<float> inL(blockFrames), inR(blockFrames), outL(blockFrames), outR(blockFrames);
+        float* inChannels[kChannels] = {inL.data(), inR.data()};
+        float* outChannels[kChannels] = {inPlace ? inL.data() : outL.data(), inPlace ? inR.data() : outR.data()};
+
+        clap_audio_buffer_t inBuffer = {inChannels, nullptr, kChannels, 0, 0};
+        clap_audio_buffer_t outBuffer = {outChannels, nullptr, kChannels, 0, 0};
+
+        EventList events;
+        clap_input_events_t inEvents = events.list();
+        clap_output_events_t outEvents = {nullptr, [](const clap_output_events_t*, const clap_event_header_t*) { return true; }};
+
+        for (size_t start = 0; start < totalFrames && ok; start += blockFrames) {
+            const uint32_t frames = static_cast<uint32_t>(std::min<size_t>(blockFrames, totalFrames - start));
+            for (uint32_t i = 0; i < frames; ++i) {
+                inL[i] = input[(start + i) * 2];
+                inR[i] = input[(start + i) * 2 + 1];
+            }
+
+            events.events.clear();
+            if (bypassFrame >= start && bypassFrame < start + frames) {
+                events.events.push_back(paramEvent(bypassId, 1.0, static_cast<uint32_t>(bypassFrame - start)));
+            }
+
+            clap_process_t process;
+            std::memset(&process, 0, sizeof(process));
+            process.steady_time = static_cast<int64_t>(start);
+            process.frames_count = frames;
+            process.audio_inputs = &inBuffer;
+            process.audio_outputs = &outBuffer;
+            process.audio_inputs_count = 1;
+            process.audio_outputs_count = 1;
+            process.in_events = &inEvents;
+            process.out_events = &outEvents;
+
+            const auto begin = std::chrono::steady_clock::now();
+            const clap_process_status status = plugin->process(plugin, &process);
+            processSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            if (status == CLAP_PROCESS_ERROR) {
+                ok = fail("process returned an error");
+            }
+
+            for (uint32_t i = 0; i < frames; ++i) {
+                output[(start + i) * 2] = outChannels[0][i];
+                output[(start + i) * 2 + 1] = outChannels[1][i];
+            }
+        }
+        plugin->stop_processing(plugin);
+        plugin->deactivate(plugin);
+    }
+    plugin->destroy(plugin);
+    entry->deinit();
+
+    // Reference: the same core called directly, bypassed from the same frame
+    double maxDiff = 0.0;
+    if (ok) {
+        DSPProcessor reference;
+        reference.setSampleRate(format.sampleRate);
+        reference.reset();
+        std::vector<float> expected(input);
+        reference.process(expected.data(), static_cast<int>(std::min(bypassFrame, totalFrames)), kChannels);
+        for (size_t i = 0; i < expected.size(); ++i) {
+            maxDiff = std::max(maxDiff, std::fabs(double(expected[i]) - double(output[i])));
+        }
+        if (maxDiff != 0.0) {
+            ok = fail("plugin output differs from DSPProcessor");
+        }
+    }
+
+    if (ok && paths.size() == 3) {
+        MappedWavWriter writer;
+        if (!writer.create(paths[2], format, totalFrames)) {
+            std::fprintf(stderr, "%s\n", writer.getError().c_str());
+            return 1;
+        }
+        writer.write(0, output.data(), totalFrames);
+        if (!writer.close()) {
+            std::fprintf(stderr, "%s\n", writer.getError().c_str());
+            return 1;
+        }
+    }
+
+    const double audioSeconds = double(totalFrames) / format.sampleRate;
+    std::printf("%s %s: %d Hz, %zu frames in %d-frame blocks, %s, latency %u frames\n",
+                descriptor->name, descriptor->version, format.sampleRate, totalFrames, blockFrames,
+                inPlace ? "in place" : "separate buffers", latencyFrames);
+    std::printf("max difference vs DSPProcessor: %g, %.1fx real time  %s\n",
+                maxDiff, processSeconds > 0.0 ? audioSeconds / processSeconds : 0.0, ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
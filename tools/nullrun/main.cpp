@@ -0,0 +1,242 @@
+// amptube300b-nullrun - drive the full AudioEngine on the null backend
+//
+//   amptube300b-nullrun [options]
+//
+// Runs the engine exactly as the app does (callback, DSP, metering,
+// latency probe) on the virtual device, so benchmarks and smoke tests
+// need no sound hardware. Prints the device's timing statistics, the
+// callback timing and the output levels when the run ends. Exits with 1
+// when the engine fails to start, a latency measurement fails, or more
+// paced deadlines were missed than --max-missed allows.
+
+#include "../../src/core/AudioEngine.h"
+#include "../../src/dsp/DSPProcessor.h"
+#include "../../src/utils/Logger.h"
+#include <QCoreApplication>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+void printUsage() {
+    std::printf(
+        "Usage: amptube300b-nullrun [options]\n"
+        "\n"
+        "Options:\n"
+        "  --source <kind>          silence, sine, noise, file or loopback (default: sine)\n"
+        "  --file <input.wav>       source file, looped (implies --source file)\n"
+        "  --frequency <hz>         sine frequency (default: 1000)\n"
+        "  --amplitude <x>          sine/noise amplitude (default: 0.5)\n"
+        "  --rate <hz>              sample rate (default: 48000)\n"
+        "  --block <frames>         frames per callback (default: 256)\n"
+        "  --variation <frames>     random +/- frames per callback (default: 0)\n"
+        "  --channels <1|2>         channel count (default: 2)\n"
+        "  --duration <seconds>     stream length (default: 10)\n"
+        "  --paced                  real-time schedule instead of as fast as possible\n"
+        "  --jitter <ms>            paced only: random late wake-up (default: 0)\n"
+        "  --xrun <probability>     per block: drop it and flag the next callback\n"
+        "  --seed <n>               generator seed (default: 1)\n"
+        "  --loopback <frames>      loopback delay (default: 480)\n"
+        "  --measure-latency        with --source loopback: run a latency measurement\n"
+        "  --max-missed <n>         fail if more paced deadlines are missed (default: no limit)\n"
+        "  --bypass                 run without the 300B DSP\n"
+        "  --verbose                log engine messages\n");
+}
+
+bool parseSource(const char* value, NullDeviceOptions::Source& source) {
+    const struct {
+        const char* name;
+        NullDeviceOptions::Source source;
+    } sources[] = {
+        {"silence", NullDeviceOptions::Source::Silence},
+        {"sine", NullDeviceOptions::Source::Sine},
+        {"noise", NullDeviceOptions::Source::Noise},
+        {"file", NullDeviceOptions::Source::File},
+        {"loopback", NullDeviceOptions::Source::Loopback},
+    };
+    for (const auto& entry : sources) {
+        if (std::strcmp(value, entry.name) == 0) {
+            source = entry.source;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string formatDb(float level) {
+    const float db = LevelReading::toDecibels(level);
+    char text[16];
+    if (std::isfinite(db)) {
+        std::snprintf(text, sizeof(text), "%.1f", db);
+    } else {
+        std::snprintf(text, sizeof(text), "-inf");
+    }
+    return text;
+}
+
+void printReport(const AudioEngine& engine) {
+    const NullDeviceStats stats = engine.getNullDeviceStats();
+    std::printf("%.2f s of audio in %llu callbacks, %.2f s wall, %.3f s in callbacks (%.1fx real time)\n",
+                stats.getAudioSeconds(), static_cast<unsigned long long>(stats.callbacks),
+                stats.wallSeconds, stats.callbackSeconds, stats.getRealtimeFactor());
+    std::printf("max callback %.3f ms, %llu missed deadlines, %llu injected xruns\n",
+                stats.maxCallbackMs, static_cast<unsigned long long>(stats.missedDeadlines),
+                static_cast<unsigned long long>(stats.xruns));
+
+    const CallbackTiming timing = engine.getCallbackTiming();
+    if (timing.callbacks > 1 && timing.timestampsAvailable) {
+        std::printf("callback interval %.3f ms mean, %.3f ms jitter, %.3f ms worst deviation\n",
+                    timing.meanIntervalMs, timing.intervalJitterMs, timing.maxIntervalDeviationMs);
+    }
+
+    const LevelReading levels = engine.getLevels();
+    for (int ch = 0; ch < levels.channels; ++ch) {
+        std::printf("channel %d: RMS %s dB, peak %s dB, true peak max %s dBTP\n", ch + 1,
+                    formatDb(levels.rms[ch]).c_str(), formatDb(levels.peak[ch]).c_str(),
+                    formatDb(levels.maxTruePeak[ch]).c_str());
+    }
+
+    const LoudnessReading loudness = engine.getLoudness();
+    if (loudness.blocks > 0 && std::isfinite(loudness.integrated)) {
+        std::printf("loudness %.1f LUFS integrated, LRA %.1f LU\n", loudness.integrated, loudness.range);
+    }
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    NullDeviceOptions options;
+    options.durationSeconds = 10.0;
+    options.loopbackFrames = 480;
+    int sampleRate = 48000;
+    int blockFrames = 256;
+    int channels = 2;
+    bool measureLatency = false;
+    long long maxMissed = -1;
+    bool bypass = false;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(arg, "--source") == 0 && hasValue) {
+            if (!parseSource(argv[++i], options.source)) {
+                std::fprintf(stderr, "Invalid --source value: %s\n", argv[i]);
+                return 2;
+            }
+        } else if (std::strcmp(arg, "--file") == 0 && hasValue) {
+            options.filePath = argv[++i];
+            options.source = NullDeviceOptions::Source::File;
+        } else if (std::strcmp(arg, "--frequency") == 0 && hasValue) {
+            options.sineFrequency = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--amplitude") == 0 && hasValue) {
+            options.amplitude = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--rate") == 0 && hasValue) {
+            sampleRate = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--block") == 0 && hasValue) {
+            blockFrames = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--variation") == 0 && hasValue) {
+            options.blockVariation = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--channels") == 0 && hasValue) {
+            channels = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--duration") == 0 && hasValue) {
+            options.durationSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--paced") == 0) {
+            options.paced = true;
+        } else if (std::strcmp(arg, "--jitter") == 0 && hasValue) {
+            options.jitterMs = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--xrun") == 0 && hasValue) {
+            options.xrunProbability = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--loopback") == 0 && hasValue) {
+            options.loopbackFrames = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--measure-latency") == 0) {
+            measureLatency = true;
+        } else if (std::strcmp(arg, "--max-missed") == 0 && hasValue) {
+            maxMissed = std::atoll(argv[++i]);
+        } else if (std::strcmp(arg, "--bypass") == 0) {
+            bypass = true;
+        } else if (std::strcmp(arg, "--verbose") == 0) {
+            verbose = true;
+        } else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage();
+            return 0;
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n\n", arg);
+            printUsage();
+            return 2;
+        }
+    }
+
+    // The run must end on its own for the report to print
+    if (options.durationSeconds <= 0.0 || sampleRate <= 0 || blockFrames <= 0) {
+        std::fprintf(stderr, "--duration, --rate and --block must be positive\n");
+        return 2;
+    }
+    if (measureLatency && options.source != NullDeviceOptions::Source::Loopback) {
+        std::fprintf(stderr, "--measure-latency needs --source loopback\n");
+        return 2;
+    }
+
+    Logger::enableConsoleOutput(true);
+    Logger::setLogLevel(verbose ? Logger::Info : Logger::Warning);
+
+    DSPProcessor dsp;
+    dsp.setBypass(bypass);
+
+    AudioEngine engine;
+    engine.setBackend(AudioEngine::Backend::Null);
+    engine.setSampleRate(sampleRate);
+    engine.setBufferSize(blockFrames);
+    engine.setChannels(channels);
+    engine.setDSPProcessor(&dsp);
+    engine.setVisualizationEnabled(false);  // nothing displays it
+    engine.setNullDeviceOptions(options);
+
+    int exitCode = 0;
+    QObject::connect(&engine, &AudioEngine::errorOccurred, &app, [&app, &exitCode](const QString& error) {
+        std::fprintf(stderr, "Engine error: %s\n", error.toLocal8Bit().constData());
+        exitCode = 1;
+        app.quit();
+    });
+    QObject::connect(&engine, &AudioEngine::streamFinished, &app, &QCoreApplication::quit);
+    QObject::connect(&engine, &AudioEngine::latencyMeasured, &app,
+                     [&engine, &exitCode](const LatencyMeasurement& result) {
+        if (!result.valid) {
+            std::fprintf(stderr, "Latency measurement failed: %s\n", result.error.c_str());
+            exitCode = 1;
+        } else {
+            std::printf("round trip %.3f ms (%.3f-%.3f ms), DSP %.3f ms, peak-to-noise %.1f dB\n",
+                        result.roundTripMs, result.minRoundTripMs, result.maxRoundTripMs,
+                        result.dspLatencyMs, result.peakToNoiseDb);
+        }
+        engine.stop();
+        QCoreApplication::quit();
+    });
+
+    if (!engine.start()) {
+        std::fprintf(stderr, "Failed to start the null device\n");
+        return 1;
+    }
+    if (measureLatency && !engine.startLatencyMeasurement()) {
+        std::fprintf(stderr, "Failed to start the latency measurement\n");
+        return 1;
+    }
+
+    app.exec();
+    engine.stop();
+    printReport(engine);
+
+    const NullDeviceStats stats = engine.getNullDeviceStats();
+    if (maxMissed >= 0 && stats.missedDeadlines > static_cast<unsigned long long>(maxMissed)) {
+        std::fprintf(stderr, "%llu missed deadlines, at most %lld allowed\n",
+                     static_cast<unsigned long long>(stats.missedDeadlines), maxMissed);
+        exitCode = 1;
+    }
+    return exitCode;
+}
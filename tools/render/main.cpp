@@ -0,0 +1,345 @@
+// amptube300b-render - offline 300B rendering of WAV files
+//
+//   amptube300b-render [options] <input.wav> <output.wav>
+//   amptube300b-render [options] --batch <dir|list.txt> <output dir>
+//   amptube300b-render [options] --split <input.wav> <output.wav>
+//   amptube300b-render [options] --self-test
+
+#include "../../src/offline/BatchRenderer.h"
+#include "../../src/offline/ChunkedRenderer.h"
+#include "../../src/offline/OfflineRenderer.h"
+#include "../../src/utils/Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+
+void printUsage() {
+    std::printf(
+        "Usage: amptube300b-render [options] <input.wav> <output.wav>\n"
+        "       amptube300b-render [options] --batch <dir|list.txt> <output dir>\n"
+        "       amptube300b-render [options] --self-test\n"
+        "\n"
+        "Options:\n"
+        "  --batch                  render a directory tree or a file list in parallel\n"
+        "  --split                  render one long file in parallel segments\n"
+        "  --segment <seconds>      split segment length (default: 30)\n"
+        "  --tolerance <x>          split seam error bound (default: 1e-6, or twice the\n"
+        "                           filter roundoff floor where that is higher)\n"
+        "  --relax-tolerance        raise a tolerance below the roundoff floor instead of failing\n"
+        "  --verify                 with --split: compare against a serial render\n"
+        "  --self-test              check split against serial renders at every supported rate\n"
+        "  --jobs <n>               worker threads (default: one per core)\n"
+        "  --bits <16|24|32|float>  output encoding (default: same as input)\n"
+        "  --block <frames>         processing block size (default: 8192)\n"
+        "  --queue <blocks>         blocks in flight per pipeline stage (default: 4)\n"
+        "  --no-mmap                stream files instead of memory-mapping them\n"
+        "  --serial                 with --no-mmap: read/process/write on one thread\n"
+        "  --bypass                 copy audio through unprocessed\n"
+        "  --verbose                log engine messages\n");
+}
+
+bool parseBits(const char* value, RenderOptions& options) {
+    if (std::strcmp(value, "float") == 0) {
+        options.outputBits = 32;
+        options.outputFloat = true;
+        return true;
+    }
+    int bits = std::atoi(value);
+    if (bits != 16 && bits != 24 && bits != 32) {
+        return false;
+    }
+    options.outputBits = bits;
+    options.outputFloat = false;
+    return true;
+}
+
+int runBatch(const RenderOptions& options, int jobs, const std::string& source, const std::string& outputDir) {
+    std::string error;
+    std::vector<BatchItem> items = BatchRenderer::plan(source, outputDir, &error);
+    if (!error.empty()) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (items.empty()) {
+        std::fprintf(stderr, "No .wav files found in %s\n", source.c_str());
+        return 1;
+    }
+
+    BatchRenderer batch(options, jobs);
+    BatchSummary summary = batch.render(std::move(items));
+
+    for (const auto& item : summary.items) {
+        if (item.result.ok) {
+            std::printf("%8.2f s  %7.1fx  %s\n", item.result.seconds,
+                        item.result.getRealtimeFactor(), item.inputPath.c_str());
+        } else {
+            std::printf("  FAILED            %s: %s\n", item.inputPath.c_str(), item.result.error.c_str());
+        }
+    }
+
+    std::printf("\n%zu files (%zu failed), %.1f s of audio in %.2f s on %d workers: %.1fx real time\n",
+                summary.items.size(), summary.getFailedCount(), summary.getAudioSeconds(),
+                summary.wallSeconds, summary.workerCount, summary.getRealtimeFactor());
+    return summary.getFailedCount() == 0 ? 0 : 1;
+}
+// Largest sample difference between two WAV files, -1 if they differ in shape
+double maxDifference(const std::string& a, const std::string& b) {
+    WavReader readerA;
+    WavReader readerB;
+    if (!readerA.open(a) || !readerB.open(b) ||
+        readerA.getTotalFrames() != readerB.getTotalFrames() ||
+        readerA.getFormat().channels != readerB.getFormat().channels) {
+        return -1.0;
+    }
+
+    const size_t block = 8192;
+    std::vector<float> bufferA(block * readerA.getFormat().channels);
+    std::vector<float> bufferB(bufferA.size());
+    double maxDiff = 0.0;
+    size_t frames;
+    while ((frames = readerA.read(bufferA.data(), block)) > 0) {
+        if (readerB.read(bufferB.data(), frames) != frames) {
+            return -1.0;
+        }
+        for (size_t i = 0; i < frames * readerA.getFormat().channels; ++i) {
+            maxDiff = std::max(maxDiff, std::fabs(static_cast<double>(bufferA[i]) - bufferB[i]));
+        }
+    }
+    return maxDiff;
+}
+
+// Render both ways in float and check the seams stay within tolerance
+int runVerify(RenderOptions options, const ChunkOptions& chunkOptions, const std::string& input,
+              const std::string& output) {
+    options.outputBits = 32;
+    options.outputFloat = true;
+    const std::string serialPath = output + ".serial.wav";
+
+    RenderResult chunked = ChunkedRenderer(options, chunkOptions).render(input, output);
+    RenderResult serial = OfflineRenderer(options).render(input, serialPath);
+    if (!chunked.ok || !serial.ok) {
+        std::fprintf(stderr, "Render failed: %s\n", (chunked.ok ? serial : chunked).error.c_str());
+        return 1;
+    }
+
+    double diff = maxDifference(output, serialPath);
+    std::remove(serialPath.c_str());
+
+    // The render already refused a tolerance it could not meet; this is the one it promised
+    const double bound = ChunkedRenderer::resolveTolerance(chunked.format.sampleRate, chunkOptions);
+    const double floor = ChunkedRenderer::roundoffFloor(chunked.format.sampleRate);
+
+    std::printf("split %.2f s, serial %.2f s (%.1fx speedup), max difference %.3g "
+                "(tolerance %.3g, roundoff floor %.3g)\n",
+                chunked.seconds, serial.seconds, serial.seconds / std::max(chunked.seconds, 1e-9),
+                diff, bound, floor);
+    if (diff < 0.0 || diff > bound) {
+        std::fprintf(stderr, "VERIFY FAILED\n");
+        return 1;
+    }
+    std::printf("VERIFY OK\n");
+    return 0;
+}
+// Busy float32 test file near full scale, long enough for several seams
+bool writeTestSignal(const std::string& path, int rate, uint64_t frames) {
+    WavFormat format;
+    format.sampleRate = rate;
+    format.channels = 2;
+    format.bitsPerSample = 32;
+    format.isFloat = true;
+
+    WavWriter writer;
+    if (!writer.open(path, format)) {
+        return false;
+    }
+    std::vector<float> block(8192 * 2);
+    uint32_t seed = 12345;
+    for (uint64_t frame = 0; frame < frames;) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(8192, frames - frame));
+        for (size_t i = 0; i < count; ++i, ++frame) {
+            seed = seed * 1664525u + 1013904223u;
+            const float noise = static_cast<float>(seed >> 8) * (1.0f / 16777216.0f) - 0.5f;
+            const double t = static_cast<double>(frame) / rate;
+            block[2 * i] = static_cast<float>(0.7 * std::sin(2.0 * kPi * 220.0 * t)) + 0.25f * noise;
+            block[2 * i + 1] = static_cast<float>(0.5 * std::sin(2.0 * kPi * 3150.0 * t)) - 0.4f * noise;
+        }
+        if (!writer.write(block.data(), count)) {
+            return false;
+        }
+    }
+    return writer.close();
+}
+
+// Split renders must match a serial render within the tolerance they resolve
+// to, on both I/O paths and at every rate the filter is designed for, and a
+// tolerance below the roundoff floor must be refused rather than loosened
+int runSelfTest(int jobs) {
+    const int rates[] = {44100, 48000, 88200, 96000, 176400, 192000};
+    std::error_code ec;
+    const fs::path dir = fs::temp_directory_path(ec) / "amptube300b-render-selftest";
+    fs::create_directories(dir, ec);
+    if (ec) {
+        std::fprintf(stderr, "Cannot create %s: %s\n", dir.string().c_str(), ec.message().c_str());
+        return 1;
+    }
+
+    RenderOptions options;
+    options.outputBits = 32;
+    options.outputFloat = true;
+    int failures = 0;
+
+    for (int rate : rates) {
+        const double floor = ChunkedRenderer::roundoffFloor(rate);
+        const std::string input = (dir / ("input-" + std::to_string(rate) + ".wav")).string();
+        const std::string serialPath = (dir / "serial.wav").string();
+        const std::string splitPath = (dir / "split.wav").string();
+
+        ChunkOptions chunkOptions;
+        chunkOptions.workerCount = jobs;
+        chunkOptions.segmentSeconds = 0.25;
+        const double tolerance = ChunkedRenderer::resolveTolerance(rate, chunkOptions);
+        const uint64_t warmup = static_cast<uint64_t>(ChunkedRenderer::warmupFrames(rate, tolerance - floor));
+        const uint64_t segment = std::max<uint64_t>(static_cast<uint64_t>(0.25 * rate), 4 * warmup);
+        const uint64_t frames = 5 * segment + 1234;  // ragged last segment
+
+        if (!writeTestSignal(input, rate, frames) || !OfflineRenderer(options).render(input, serialPath).ok) {
+            std::fprintf(stderr, "%6d Hz  cannot prepare test files in %s\n", rate, dir.string().c_str());
+            ++failures;
+            continue;
+        }
+
+        for (bool mapped : {true, false}) {
+            RenderOptions splitOptions = options;
+            splitOptions.memoryMapped = mapped;
+            const RenderResult result = ChunkedRenderer(splitOptions, chunkOptions).render(input, splitPath);
+            const double diff = result.ok ? maxDifference(splitPath, serialPath) : -1.0;
+            const bool pass = result.ok && diff >= 0.0 && diff <= tolerance;
+            std::printf("%6d Hz  %-9s  max difference %9.3g  tolerance %9.3g  floor %9.3g  %s\n",
+                        rate, mapped ? "mapped" : "streaming", diff, tolerance, floor, pass ? "ok" : "FAILED");
+            failures += pass ? 0 : 1;
+        }
+
+        // An explicit tolerance is either met or refused, never widened silently
+        ChunkOptions strict = chunkOptions;
+        strict.tolerance = ChunkedRenderer::kDefaultTolerance;
+        const RenderResult result = ChunkedRenderer(options, strict).render(input, splitPath);
+        const bool meetable = strict.tolerance > floor;
+        const double diff = result.ok ? maxDifference(splitPath, serialPath) : -1.0;
+        const bool pass = meetable ? (result.ok && diff >= 0.0 && diff <= strict.tolerance) : !result.ok;
+        std::printf("%6d Hz  %-9s  %s  %s\n", rate, "tol 1e-6",
+                    meetable ? "met" : "refused (below roundoff floor)", pass ? "ok" : "FAILED");
+        failures += pass ? 0 : 1;
+
+        std::remove(input.c_str());
+        std::remove(serialPath.c_str());
+        std::remove(splitPath.c_str());
+    }
+
+    fs::remove(dir, ec);
+    std::printf("%s\n", failures == 0 ? "SELF-TEST OK" : "SELF-TEST FAILED");
+    return failures == 0 ? 0 : 1;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    RenderOptions options;
+    std::string paths[2];
+    int pathCount = 0;
+    bool verbose = false;
+    bool batch = false;
+    bool split = false;
+    bool verify = false;
+    bool selfTest = false;
+    int jobs = 0;
+    ChunkOptions chunkOptions;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(arg, "--bits") == 0 && hasValue) {
+            if (!parseBits(argv[++i], options)) {
+                std::fprintf(stderr, "Invalid --bits value: %s\n", argv[i]);
+                return 2;
+            }
+        } else if (std::strcmp(arg, "--block") == 0 && hasValue) {
+            options.blockFrames = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--queue") == 0 && hasValue) {
+            options.queueDepth = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--jobs") == 0 && hasValue) {
+            jobs = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--batch") == 0) {
+            batch = true;
+        } else if (std::strcmp(arg, "--split") == 0) {
+            split = true;
+        } else if (std::strcmp(arg, "--segment") == 0 && hasValue) {
+            chunkOptions.segmentSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--tolerance") == 0 && hasValue) {
+            chunkOptions.tolerance = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--relax-tolerance") == 0) {
+            chunkOptions.relaxTolerance = true;
+        } else if (std::strcmp(arg, "--verify") == 0) {
+            verify = true;
+        } else if (std::strcmp(arg, "--self-test") == 0) {
+            selfTest = true;
+        } else if (std::strcmp(arg, "--no-mmap") == 0) {
+            options.memoryMapped = false;
+        } else if (std::strcmp(arg, "--serial") == 0) {
+            options.pipelined = false;
+        } else if (std::strcmp(arg, "--bypass") == 0) {
+            options.bypass = true;
+        } else if (std::strcmp(arg, "--verbose") == 0) {
+            verbose = true;
+        } else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage();
+            return 0;
+        } else if (arg[0] != '-' && pathCount < 2) {
+            paths[pathCount++] = arg;
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n\n", arg);
+            printUsage();
+            return 2;
+        }
+    }
+
+    Logger::setLogLevel(verbose ? Logger::Info : Logger::Warning);
+    if (selfTest) {
+        return runSelfTest(jobs);
+    }
+
+    if (pathCount != 2) {
+        printUsage();
+        return 2;
+    }
+
+    if (batch) {
+        return runBatch(options, jobs, paths[0], paths[1]);
+    }
+
+    chunkOptions.workerCount = jobs;
+    if (split && verify) {
+        return runVerify(options, chunkOptions, paths[0], paths[1]);
+    }
+
+    RenderResult result = split ? ChunkedRenderer(options, chunkOptions).render(paths[0], paths[1])
+                                : OfflineRenderer(options).render(paths[0], paths[1]);
+    if (!result.ok) {
+        std::fprintf(stderr, "Render failed: %s\n", result.error.c_str());
+        return 1;
+    }
+
+    std::printf("%s: %d Hz, %d ch, %.1f s of audio in %.2f s (%.1fx real time)\n",
+                paths[1].c_str(), result.format.sampleRate, result.format.channels,
+                result.getAudioSeconds(), result.seconds, result.getRealtimeFactor());
+    return 0;
+}
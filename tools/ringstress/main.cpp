@@ -0,0 +1,450 @@
+// amptube300b-ringstress - cross-thread stress test and throughput benchmark
+// for AudioBuffer and AudioFrameBuffer
+//
+//   amptube300b-ringstress [options]
+//
+// A producer thread writes a counting sequence in randomly sized blocks
+// while a consumer thread reads randomly sized blocks and checks every
+// sample, once per transfer mode (write/read copies, acquire/commit
+// regions, and the two mixed). AudioFrameBuffer runs with both ring
+// layouts; its regions are filled and checked channel by channel through
+// Region::channel() and stride(), its copies convert between interleaved
+// and planar. Build it with -fsanitize=thread to have ThreadSanitizer
+// check the index handoff; an optimized build without it reports
+// cross-thread throughput. Exits with 1 on any lost, duplicated or
+// corrupted sample, or if a region mode never saw a wrapped region.
+
+#include "../../src/core/AudioBuffer.h"
+#include "../../src/core/AudioFrameBuffer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+// Sample values stay exact in a float up to 2^24
+constexpr uint32_t kSequenceMask = (1u << 24) - 1;
+
+struct Options {
+    double seconds = 2.0;
+    size_t capacity = 4096;
+    size_t maxBlock = 1024;
+    int channels = 2;
+    uint32_t seed = 1;
+};
+
+struct Mode {
+    const char* name;
+    bool regionWrite;
+    bool regionRead;
+};
+
+const Mode kModes[] = {
+    {"copy", false, false},
+    {"region", true, true},
+    {"region-write", true, false},
+    {"region-read", false, true},
+};
+
+// AudioFrameBuffer: ring layout and how each side moves frames
+enum class Transfer {
+    Interleaved,  // writeInterleaved / readInterleaved
+    Planar,       // writePlanar / readPlanar
+    Region        // acquire/commit, per channel through Region::channel()
+};
+
+struct FrameMode {
+    const char* name;
+    AudioFrameBuffer::Layout layout;
+    Transfer write;
+    Transfer read;
+};
+
+const FrameMode kFrameModes[] = {
+    {"frames-planar", AudioFrameBuffer::Layout::Planar, Transfer::Region, Transfer::Region},
+    {"frames-interleaved", AudioFrameBuffer::Layout::Interleaved, Transfer::Region, Transfer::Region},
+    {"frames-planar-copy", AudioFrameBuffer::Layout::Planar, Transfer::Interleaved, Transfer::Planar},
+    {"frames-inter-copy", AudioFrameBuffer::Layout::Interleaved, Transfer::Planar, Transfer::Interleaved},
+    {"frames-planar-mixed", AudioFrameBuffer::Layout::Planar, Transfer::Region, Transfer::Interleaved},
+    {"frames-inter-mixed", AudioFrameBuffer::Layout::Interleaved, Transfer::Planar, Transfer::Region},
+};
+
+bool usesRegions(const Mode& mode) {
+    return mode.regionWrite || mode.regionRead;
+}
+
+bool usesRegions(const FrameMode& mode) {
+    return mode.write == Transfer::Region || mode.read == Transfer::Region;
+}
+
+struct RunResult {
+    uint64_t samples = 0;
+    uint64_t errors = 0;
+    uint64_t firstErrorAt = 0;
+    uint64_t wrappedRegions = 0;  // either side
+    double seconds = 0.0;
+};
+
+void printUsage() {
+    std::printf(
+        "Usage: amptube300b-ringstress [options]\n"
+        "\n"
+        "Options:\n"
+        "  --seconds <s>          duration of each mode (default: 2)\n"
+        "  --capacity <samples>   ring capacity, rounded up to a power of two (default: 4096)\n"
+        "  --max-block <samples>  largest block either side transfers (default: 1024)\n"
+        "  --channels <n>         AudioFrameBuffer channel count; capacity and blocks\n"
+        "                         are divided among them (default: 2)\n"
+        "  --seed <n>             block size sequence seed (default: 1)\n");
+}
+
+void produce(AudioBuffer& ring, const Mode& mode, const Options& options,
+             const std::atomic<bool>& stop, std::atomic<bool>& done, uint64_t& produced,
+             uint64_t& wrapped) {
+    std::mt19937 random(options.seed);
+    std::uniform_int_distribution<size_t> blockSize(1, options.maxBlock);
+    std::vector<float> block(options.maxBlock);
+    uint32_t next = 0;
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        const size_t samples = blockSize(random);
+
+        if (mode.regionWrite) {
+            AudioBuffer::WriteRegion region = ring.acquireWrite(samples);
+            for (size_t i = 0; i < region.firstSize; ++i) {
+                region.first[i] = static_cast<float>(next++ & kSequenceMask);
+            }
+            for (size_t i = 0; i < region.secondSize; ++i) {
+                region.second[i] = static_cast<float>(next++ & kSequenceMask);
+            }
+            ring.commitWrite(region.size());
+            produced += region.size();
+            wrapped += region.secondSize > 0;
+            if (region.size() < samples) {
+                std::this_thread::yield();
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < samples; ++i) {
+            block[i] = static_cast<float>((next + i) & kSequenceMask);
+        }
+        if (ring.write(block.data(), samples, 1)) {
+            next += static_cast<uint32_t>(samples);
+            produced += samples;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    done.store(true, std::memory_order_release);
+}
+
+void consume(AudioBuffer& ring, const Mode& mode, const Options& options,
+             const std::atomic<bool>& done, RunResult& result) {
+    std::mt19937 random(options.seed * 7919u + 1u);
+    std::uniform_int_distribution<size_t> blockSize(1, options.maxBlock);
+    std::vector<float> block(options.maxBlock);
+    uint64_t expected = 0;
+
+    auto check = [&result, &expected](const float* data, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (data[i] != static_cast<float>(expected & kSequenceMask)) {
+                if (result.errors++ == 0) {
+                    result.firstErrorAt = expected;
+                }
+            }
+            ++expected;
+        }
+    };
+
+    // Keep reading after the producer stops until the ring is drained
+    for (;;) {
+        const bool stopping = done.load(std::memory_order_acquire);
+        const size_t samples = blockSize(random);
+        size_t got = 0;
+
+        if (mode.regionRead) {
+            AudioBuffer::ReadRegion region = ring.acquireRead(samples);
+            check(region.first, region.firstSize);
+            check(region.second, region.secondSize);
+            ring.commitRead(region.size());
+            got = region.size();
+            result.wrappedRegions += region.secondSize > 0;
+        } else {
+            const size_t available = std::min(samples, ring.availableRead());
+            if (available > 0 && ring.read(block.data(), available, 1)) {
+                check(block.data(), available);
+                got = available;
+            }
+        }
+
+        if (got == 0) {
+            if (stopping) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+    result.samples = expected;
+}
+
+// Sample `ch` of frame `frame`: the interleaved sample count, so every channel differs
+float frameValue(uint64_t frame, int channels, int ch) {
+    return static_cast<float>((frame * channels + ch) & kSequenceMask);
+}
+
+size_t frameCapacity(const Options& options) {
+    return std::max<size_t>(1, options.capacity / options.channels);
+}
+
+size_t maxBlockFrames(const Options& options) {
+    return std::max<size_t>(1, options.maxBlock / options.channels);
+}
+
+void produce(AudioFrameBuffer& ring, const FrameMode& mode, const Options& options,
+             const std::atomic<bool>& stop, std::atomic<bool>& done, uint64_t& produced,
+             uint64_t& wrapped) {
+    const int channels = options.channels;
+    const size_t maxFrames = maxBlockFrames(options);
+    std::mt19937 random(options.seed);
+    std::uniform_int_distribution<size_t> blockSize(1, maxFrames);
+    std::vector<float> interleaved(maxFrames * channels);
+    std::vector<std::vector<float>> planes(channels, std::vector<float>(maxFrames));
+    std::vector<float*> planePointers(channels);
+    for (int ch = 0; ch < channels; ++ch) {
+        planePointers[ch] = planes[ch].data();
+    }
+    uint64_t next = 0;
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        const size_t frames = blockSize(random);
+        size_t written = 0;
+
+        if (mode.write == Transfer::Region) {
+            const AudioFrameBuffer::Region region = ring.acquireWrite(frames);
+            const size_t stride = region.stride();
+            uint64_t frame = next;
+            for (int run = 0; run < 2; ++run) {
+                const size_t runFrames = run == 0 ? region.firstFrames : region.secondFrames;
+                for (int ch = 0; ch < channels; ++ch) {
+                    float* samples = region.channel(ch, run);
+                    for (size_t i = 0; i < runFrames; ++i) {
+                        samples[i * stride] = frameValue(frame + i, channels, ch);
+                    }
+                }
+                frame += runFrames;
+            }
+            ring.commitWrite(region.frames());
+            written = region.frames();
+            wrapped += region.secondFrames > 0;
+        } else if (mode.write == Transfer::Interleaved) {
+            for (size_t i = 0; i < frames; ++i) {
+                for (int ch = 0; ch < channels; ++ch) {
+                    interleaved[i * channels + ch] = frameValue(next + i, channels, ch);
+                }
+            }
+            written = ring.writeInterleaved(interleaved.data(), frames) ? frames : 0;
+        } else {
+            for (int ch = 0; ch < channels; ++ch) {
+                for (size_t i = 0; i < frames; ++i) {
+                    planes[ch][i] = frameValue(next + i, channels, ch);
+                }
+            }
+            written = ring.writePlanar(planePointers.data(), frames) ? frames : 0;
+        }
+
+        next += written;
+        produced += written * channels;
+        if (written < frames) {
+            std::this_thread::yield();
+        }
+    }
+    done.store(true, std::memory_order_release);
+}
+
+void consume(AudioFrameBuffer& ring, const FrameMode& mode, const Options& options,
+             const std::atomic<bool>& done, RunResult& result) {
+    const int channels = options.channels;
+    const size_t maxFrames = maxBlockFrames(options);
+    std::mt19937 random(options.seed * 7919u + 1u);
+    std::uniform_int_distribution<size_t> blockSize(1, maxFrames);
+    std::vector<float> interleaved(maxFrames * channels);
+    std::vector<std::vector<float>> planes(channels, std::vector<float>(maxFrames));
+    std::vector<float*> planePointers(channels);
+    for (int ch = 0; ch < channels; ++ch) {
+        planePointers[ch] = planes[ch].data();
+    }
+    uint64_t expected = 0;  // frames
+
+    auto check = [&result, channels](float value, uint64_t frame, int ch) {
+        if (value != frameValue(frame, channels, ch) && result.errors++ == 0) {
+            result.firstErrorAt = frame * channels + ch;
+        }
+    };
+
+    // Keep reading after the producer stops until the ring is drained
+    for (;;) {
+        const bool stopping = done.load(std::memory_order_acquire);
+        const size_t frames = blockSize(random);
+        size_t got = 0;
+
+        if (mode.read == Transfer::Region) {
+            const AudioFrameBuffer::Region region = ring.acquireRead(frames);
+            const size_t stride = region.stride();
+            uint64_t frame = expected;
+            for (int run = 0; run < 2; ++run) {
+                const size_t runFrames = run == 0 ? region.firstFrames : region.secondFrames;
+                for (int ch = 0; ch < channels; ++ch) {
+                    const float* samples = region.channel(ch, run);
+                    for (size_t i = 0; i < runFrames; ++i) {
+                        check(samples[i * stride], frame + i, ch);
+                    }
+                }
+                frame += runFrames;
+            }
+            ring.commitRead(region.frames());
+            got = region.frames();
+            result.wrappedRegions += region.secondFrames > 0;
+        } else {
+            const size_t available = std::min(frames, ring.availableRead());
+            if (available > 0 && mode.read == Transfer::Interleaved
+                && ring.readInterleaved(interleaved.data(), available)) {
+                for (size_t i = 0; i < available; ++i) {
+                    for (int ch = 0; ch < channels; ++ch) {
+                        check(interleaved[i * channels + ch], expected + i, ch);
+                    }
+                }
+                got = available;
+            } else if (available > 0 && mode.read == Transfer::Planar
+                       && ring.readPlanar(planePointers.data(), available)) {
+                for (int ch = 0; ch < channels; ++ch) {
+                    for (size_t i = 0; i < available; ++i) {
+                        check(planes[ch][i], expected + i, ch);
+                    }
+                }
+                got = available;
+            }
+        }
+        expected += got;
+
+        if (got == 0) {
+            if (stopping) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+    result.samples = expected * channels;
+}
+
+template <typename Ring, typename RingMode>
+RunResult run(Ring& ring, const RingMode& mode, const Options& options) {
+    std::atomic<bool> stop{false};
+    std::atomic<bool> done{false};
+    uint64_t produced = 0;
+    uint64_t wrappedWrites = 0;
+    RunResult result;
+
+    // Start both indices mid-ring. Threads that fall into lockstep (fill to full,
+    // drain to empty) would otherwise always meet the ring end on a block edge
+    const size_t offset = ring.capacity() / 3 + 1;
+    ring.acquireWrite(offset);
+    ring.commitWrite(offset);
+    ring.acquireRead(offset);
+    ring.commitRead(offset);
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::thread consumer([&]() { consume(ring, mode, options, done, result); });
+    std::thread producer([&]() { produce(ring, mode, options, stop, done, produced, wrappedWrites); });
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+    stop.store(true, std::memory_order_relaxed);
+    producer.join();
+    consumer.join();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    result.wrappedRegions += wrappedWrites;
+
+    if (produced != result.samples) {
+        std::fprintf(stderr, "%s: produced %llu samples but consumed %llu\n", mode.name,
+                     static_cast<unsigned long long>(produced),
+                     static_cast<unsigned long long>(result.samples));
+        ++result.errors;
+    }
+    if (usesRegions(mode) && result.wrappedRegions == 0) {
+        std::fprintf(stderr, "%s: no region wrapped around the ring end; run longer\n", mode.name);
+        ++result.errors;
+    }
+    return result;
+}
+
+// Prints one line per mode; false if it failed
+template <typename RingMode>
+bool report(const RingMode& mode, const RunResult& result) {
+    std::printf("%-19s %12llu samples  %8.1f Msamples/s  %8llu wraps  %s\n", mode.name,
+                static_cast<unsigned long long>(result.samples),
+                double(result.samples) / result.seconds / 1e6,
+                static_cast<unsigned long long>(result.wrappedRegions),
+                result.errors == 0 ? "ok" : "FAILED");
+    if (result.errors > 0) {
+        std::fprintf(stderr, "%s: %llu bad samples, first at sample %llu\n", mode.name,
+                     static_cast<unsigned long long>(result.errors),
+                     static_cast<unsigned long long>(result.firstErrorAt));
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--seconds") == 0 && hasValue) {
+            options.seconds = std::max(0.01, std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--capacity") == 0 && hasValue) {
+            options.capacity = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(arg, "--max-block") == 0 && hasValue) {
+            options.maxBlock = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(arg, "--channels") == 0 && hasValue) {
+            options.channels = std::clamp(std::atoi(argv[++i]), 1, 8);
+        } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage();
+            return 0;
+        } else {
+            std::fprintf(stderr, "Unknown or incomplete option: %s\n\n", arg);
+            printUsage();
+            return 2;
+        }
+    }
+
+    // A copy-mode write must fit the ring or the producer can never make progress
+    const size_t capacity = AudioBuffer(options.capacity).capacity();
+    options.maxBlock = std::min(options.maxBlock, capacity);
+
+    std::printf("capacity %zu samples, blocks 1..%zu samples, %.2f s per mode\n",
+                capacity, options.maxBlock, options.seconds);
+
+    bool failed = false;
+    for (const Mode& mode : kModes) {
+        AudioBuffer ring(options.capacity);
+        failed |= !report(mode, run(ring, mode, options));
+    }
+
+    std::printf("frame rings: %d channels, capacity %zu frames, blocks 1..%zu frames\n", options.channels,
+                AudioFrameBuffer(options.channels, frameCapacity(options)).capacity(), maxBlockFrames(options));
+    for (const FrameMode& mode : kFrameModes) {
+        AudioFrameBuffer ring(options.channels, frameCapacity(options), mode.layout);
+        failed |= !report(mode, run(ring, mode, options));
+    }
+    return failed ? 1 : 0;
+}
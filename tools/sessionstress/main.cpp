@@ -0,0 +1,401 @@
+// amptube300b-sessionstress - multi-session scheduling and statistics check for SessionManager
+//
+//   amptube300b-sessionstress [options]
+//
+// Runs N EngineSessions (alternating stereo and mono) and checks every
+// output sample bit for bit against a standalone DSPProcessor fed the
+// same blocks. Four phases:
+//
+//   exact      one block pushed, ticked and pulled per tick()
+//   starved    no input on every third tick: starvedBlocks must count them
+//   undrained  output never pulled: overruns must account for every block
+//              the output ring could not take, and what it did keep must
+//              be the first blocks processed
+//   clock      the real clock thread from start(), fed and drained by
+//              another thread, with the pool spreading sessions over workers
+//
+// The block size defaults to a non-power-of-two so session rings wrap
+// mid-block. Build it with -fsanitize=thread to check the handoff between
+// the clock, the workers and the feeding thread. Exits with 1 on any
+// mismatch or wrong statistic.
+
+#include "../../src/core/SessionManager.h"
+#include "../../src/dsp/DSPProcessor.h"
+#include "../../src/utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+struct Options {
+    int sessions = 8;
+    int ticks = 200;
+    double seconds = 2.0;
+    int blockFrames = 200;
+    int sampleRate = 48000;
+    int workers = 0;
+    uint32_t seed = 1;
+};
+
+/**
+ * SessionCheck - One session and the standalone reference it must match
+ *
+ * Every pushed block also goes through the reference DSPProcessor; its
+ * output waits in a queue until the session's output is pulled and
+ * compared against it.
+ */
+class SessionCheck {
+public:
+    SessionCheck(SessionManager& manager, int channels, const Options& options, uint32_t seed)
+        : m_channels(channels)
+        , m_blockFrames(options.blockFrames)
+        , m_random(seed)
+        , m_block(static_cast<size_t>(options.blockFrames) * channels)
+        , m_planes(channels, std::vector<float>(options.blockFrames))
+    {
+        m_id = manager.createSession(channels);
+        m_session = manager.getSession(m_id);
+        m_reference.setSampleRate(options.sampleRate);
+        m_frequency = 0.002 + 0.02 * (seed % 17) / 17.0;
+    }
+
+    int getId() const { return m_id; }
+    EngineSession& session() { return *m_session; }
+    uint64_t getPushedBlocks() const { return m_pushedBlocks; }
+    uint64_t getCheckedBlocks() const { return m_checkedBlocks; }
+    uint64_t getErrors() const { return m_errors; }
+
+    // Pushes the next block if the input ring takes it
+    bool pushBlock() {
+        for (int i = 0; i < m_blockFrames; ++i) {
+            const double t = double(m_frame + i);
+            for (int ch = 0; ch < m_channels; ++ch) {
+                m_random = m_random * 1664525u + 1013904223u;
+                const double noise = (double(m_random >> 8) / double(1u << 24) - 0.5) * 0.05;
+                m_block[i * m_channels + ch] = static_cast<float>(
+                    0.7 * std::sin(6.283185307179586 * m_frequency * t + ch) + noise);
+            }
+        }
+        if (!m_session->pushInput(m_block.data(), m_blockFrames)) {
+            return false;
+        }
+
+        float* planes[2];
+        for (int ch = 0; ch < m_channels; ++ch) {
+            planes[ch] = m_planes[ch].data();
+            for (int i = 0; i < m_blockFrames; ++i) {
+                m_planes[ch][i] = m_block[i * m_channels + ch];
+            }
+        }
+        m_reference.processPlanar(planes, m_blockFrames, m_channels);
+
+        std::vector<float> expected(m_block.size());
+        for (int i = 0; i < m_blockFrames; ++i) {
+            for (int ch = 0; ch < m_channels; ++ch) {
+                expected[i * m_channels + ch] = m_planes[ch][i];
+            }
+        }
+        m_expected.push_back(std::move(expected));
+        m_frame += m_blockFrames;
+        ++m_pushedBlocks;
+        return true;
+    }
+
+    // Pulls and compares every whole block the session has output; returns how many
+    uint64_t pullBlocks() {
+        std::vector<float> output(m_block.size());
+        uint64_t pulled = 0;
+        while (m_session->pullOutput(output.data(), m_blockFrames)) {
+            if (m_expected.empty()) {
+                reportError("output block with no input behind it");
+                break;
+            }
+            if (std::memcmp(output.data(), m_expected.front().data(), output.size() * sizeof(float)) != 0) {
+                reportError("output differs from the standalone DSPProcessor");
+            }
+            m_expected.pop_front();
+            ++m_checkedBlocks;
+            ++pulled;
+        }
+        return pulled;
+    }
+
+    // Expected output that will never arrive (dropped by an overrun)
+    void discardExpected() { m_expected.clear(); }
+
+    void reportError(const char* what) {
+        if (m_errors++ == 0) {
+            std::fprintf(stderr, "session %d: %s at block %llu\n", m_id, what,
+                         static_cast<unsigned long long>(m_checkedBlocks));
+        }
+    }
+
+private:
+    int m_id = 0;
+    EngineSession* m_session = nullptr;
+    int m_channels;
+    int m_blockFrames;
+    uint32_t m_random;
+    double m_frequency = 0.01;
+    uint64_t m_frame = 0;
+    DSPProcessor m_reference;
+    std::vector<float> m_block;
+    std::vector<std::vector<float>> m_planes;
+    std::deque<std::vector<float>> m_expected;
+    uint64_t m_pushedBlocks = 0;
+    uint64_t m_checkedBlocks = 0;
+    uint64_t m_errors = 0;
+};
+
+using Checks = std::vector<std::unique_ptr<SessionCheck>>;
+
+Checks createSessions(SessionManager& manager, const Options& options) {
+    Checks checks;
+    for (int i = 0; i < options.sessions; ++i) {
+        const int channels = i % 2 == 0 ? 2 : 1;
+        checks.push_back(std::make_unique<SessionCheck>(manager, channels, options, options.seed * 7919u + i));
+    }
+    return checks;
+}
+
+bool expectCount(SessionCheck& check, const char* name, uint64_t actual, uint64_t expected) {
+    if (actual == expected) {
+        return true;
+    }
+    std::fprintf(stderr, "session %d: %s is %llu, expected %llu\n", check.getId(), name,
+                 static_cast<unsigned long long>(actual), static_cast<unsigned long long>(expected));
+    check.reportError("wrong statistics");
+    return false;
+}
+
+// Load figures exist once a block was processed, and the peak bounds the average
+bool checkLoad(SessionCheck& check, const SessionStats& stats) {
+    if (stats.processedBlocks > 0 && (stats.averageLoad <= 0.0 || stats.peakLoad < stats.averageLoad)) {
+        std::fprintf(stderr, "session %d: load average %.4f, peak %.4f\n", check.getId(),
+                     stats.averageLoad, stats.peakLoad);
+        check.reportError("implausible load");
+        return false;
+    }
+    return true;
+}
+
+uint64_t totalErrors(const Checks& checks) {
+    uint64_t errors = 0;
+    for (const auto& check : checks) {
+        errors += check->getErrors();
+    }
+    return errors;
+}
+
+bool report(const char* phase, const Checks& checks, const SessionManager& manager) {
+    uint64_t blocks = 0;
+    double peak = 0.0;
+    for (const auto& check : checks) {
+        blocks += check->getCheckedBlocks();
+        peak = std::max(peak, check->session().getStats().peakLoad);
+    }
+    const uint64_t errors = totalErrors(checks);
+    std::printf("%-10s %3zu sessions  %8llu blocks compared  peak session load %6.2f%%  tick load %6.2f%%  %s\n",
+                phase, checks.size(), static_cast<unsigned long long>(blocks), peak * 100.0,
+                manager.getTickLoad() * 100.0, errors == 0 ? "ok" : "FAILED");
+    return errors == 0;
+}
+
+bool runExact(const Options& options) {
+    SessionManager manager(options.sampleRate, options.blockFrames, options.workers);
+    Checks checks = createSessions(manager, options);
+
+    for (int t = 0; t < options.ticks; ++t) {
+        for (auto& check : checks) {
+            check->pushBlock();
+        }
+        manager.tick();
+        for (auto& check : checks) {
+            if (check->pullBlocks() != 1) {
+                check->reportError("no output block after a fed tick");
+            }
+        }
+    }
+
+    for (auto& check : checks) {
+        const SessionStats stats = check->session().getStats();
+        expectCount(*check, "processedBlocks", stats.processedBlocks, options.ticks);
+        expectCount(*check, "starvedBlocks", stats.starvedBlocks, 0);
+        expectCount(*check, "overruns", stats.overruns, 0);
+        checkLoad(*check, stats);
+    }
+    return report("exact", checks, manager);
+}
+
+bool runStarved(const Options& options) {
+    SessionManager manager(options.sampleRate, options.blockFrames, options.workers);
+    Checks checks = createSessions(manager, options);
+
+    uint64_t fedTicks = 0;
+    for (int t = 0; t < options.ticks; ++t) {
+        const bool feed = t % 3 != 0;
+        if (feed) {
+            for (auto& check : checks) {
+                check->pushBlock();
+            }
+            ++fedTicks;
+        }
+        manager.tick();
+        for (auto& check : checks) {
+            if (check->pullBlocks() != (feed ? 1u : 0u)) {
+                check->reportError("output does not follow the fed ticks");
+            }
+        }
+    }
+
+    for (auto& check : checks) {
+        const SessionStats stats = check->session().getStats();
+        expectCount(*check, "processedBlocks", stats.processedBlocks, fedTicks);
+        expectCount(*check, "starvedBlocks", stats.starvedBlocks, options.ticks - fedTicks);
+        expectCount(*check, "overruns", stats.overruns, 0);
+        checkLoad(*check, stats);
+    }
+    return report("starved", checks, manager);
+}
+
+bool runUndrained(const Options& options) {
+    SessionManager manager(options.sampleRate, options.blockFrames, options.workers);
+    Checks checks = createSessions(manager, options);
+
+    for (int t = 0; t < options.ticks; ++t) {
+        for (auto& check : checks) {
+            check->pushBlock();
+        }
+        manager.tick();
+    }
+
+    // The output ring kept the first blocks; everything after it filled was dropped
+    for (auto& check : checks) {
+        const uint64_t kept = check->pullBlocks();
+        check->discardExpected();
+
+        const SessionStats stats = check->session().getStats();
+        expectCount(*check, "processedBlocks", stats.processedBlocks, options.ticks);
+        expectCount(*check, "starvedBlocks", stats.starvedBlocks, 0);
+        expectCount(*check, "overruns", stats.overruns, options.ticks - kept);
+        if (kept == 0 || stats.overruns == 0) {
+            check->reportError("the output ring never filled; raise --ticks");
+        }
+        checkLoad(*check, stats);
+    }
+    return report("undrained", checks, manager);
+}
+
+bool runClock(const Options& options) {
+    SessionManager manager(options.sampleRate, options.blockFrames, options.workers);
+    Checks checks = createSessions(manager, options);
+
+    // Keep a few blocks queued ahead of the clock, well inside the input ring
+    constexpr uint64_t kBlocksAhead = 3;
+    const auto feedPeriod = std::chrono::duration<double>(0.25 * options.blockFrames / options.sampleRate);
+
+    manager.start();
+    if (manager.tick()) {
+        checks.front()->reportError("tick() ran while the clock was running");
+    }
+    const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(options.seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        for (auto& check : checks) {
+            check->pullBlocks();
+            const uint64_t processed = check->session().getStats().processedBlocks;
+            while (check->getPushedBlocks() < processed + kBlocksAhead && check->pushBlock()) {
+            }
+        }
+        std::this_thread::sleep_for(feedPeriod);
+    }
+    manager.stop();
+
+    uint64_t minProcessed = UINT64_MAX;
+    uint64_t maxProcessed = 0;
+    for (auto& check : checks) {
+        check->pullBlocks();
+        const SessionStats stats = check->session().getStats();
+        minProcessed = std::min(minProcessed, stats.processedBlocks);
+        maxProcessed = std::max(maxProcessed, stats.processedBlocks);
+
+        // The feeder kept up, so nothing was dropped and every processed block was compared
+        expectCount(*check, "overruns", stats.overruns, 0);
+        expectCount(*check, "compared blocks", check->getCheckedBlocks(), stats.processedBlocks);
+        if (stats.processedBlocks == 0) {
+            check->reportError("never processed");
+        }
+        checkLoad(*check, stats);
+    }
+
+    // Every tick reaches every session, so their counts can only differ by what was queued
+    if (maxProcessed - minProcessed > kBlocksAhead + 1) {
+        std::fprintf(stderr, "clock: processed blocks range from %llu to %llu across sessions\n",
+                     static_cast<unsigned long long>(minProcessed),
+                     static_cast<unsigned long long>(maxProcessed));
+        checks.front()->reportError("uneven scheduling");
+    }
+    return report("clock", checks, manager);
+}
+
+void printUsage() {
+    std::printf(
+        "Usage: amptube300b-sessionstress [options]\n"
+        "\n"
+        "Options:\n"
+        "  --sessions <n>      sessions, alternating stereo and mono (default: 8)\n"
+        "  --ticks <n>         ticks per tick()-driven phase (default: 200)\n"
+        "  --seconds <s>       duration of the clock phase (default: 2)\n"
+        "  --block <frames>    frames per block (default: 200)\n"
+        "  --rate <hz>         sample rate (default: 48000)\n"
+        "  --workers <n>       pool threads, 0 for one per hardware thread (default: 0)\n"
+        "  --seed <n>          input signal seed (default: 1)\n");
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--sessions") == 0 && hasValue) {
+            options.sessions = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--ticks") == 0 && hasValue) {
+            options.ticks = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--seconds") == 0 && hasValue) {
+            options.seconds = std::max(0.05, std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--block") == 0 && hasValue) {
+            options.blockFrames = std::max(16, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--rate") == 0 && hasValue) {
+            options.sampleRate = std::max(8000, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--workers") == 0 && hasValue) {
+            options.workers = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage();
+            return 0;
+        } else {
+            std::fprintf(stderr, "Unknown or incomplete option: %s\n\n", arg);
+            printUsage();
+            return 2;
+        }
+    }
+
+    Logger::setLogLevel(Logger::Warning);
+
+    bool ok = true;
+    ok &= runExact(options);
+    ok &= runStarved(options);
+    ok &= runUndrained(options);
+    ok &= runClock(options);
+    return ok ? 0 : 1;
+}
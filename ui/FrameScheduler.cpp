@@ -0,0 +1,182 @@
+#include "FrameScheduler.h"
+#include "../src/utils/Logger.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QScreen>
+#include <algorithm>
+
+namespace {
+constexpr int MIN_FRAME_MS = 4;       // 240 Hz displays
+constexpr int MAX_FRAME_MS = 33;      // never animate slower than ~30 FPS
+constexpr int FALLBACK_FRAME_MS = 16;
+} // namespace
+
+FrameScheduler* FrameScheduler::instance() {
+    static QPointer<FrameScheduler> s_instance;
+    if (!s_instance) {
+        s_instance = new FrameScheduler(QCoreApplication::instance());
+    }
+    return s_instance;
+}
+
+FrameScheduler::FrameScheduler(QObject* parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(FALLBACK_FRAME_MS);
+    connect(m_timer, &QTimer::timeout, this, &FrameScheduler::onFrame);
+    m_clock.start();
+}
+
+void FrameScheduler::addClient(QWidget* widget, int maxFps, std::function<void()> tick) {
+    if (!widget) {
+        return;
+    }
+    removeClient(widget);
+
+    Client client;
+    client.widget = widget;
+    client.intervalMs = maxFps > 0 ? 1000 / maxFps : 0;
+    client.tick = std::move(tick);
+    m_clients.push_back(std::move(client));
+
+    widget->installEventFilter(this);
+    watchWindow(widget);
+    connect(widget, &QObject::destroyed, this, [this]() { scheduleRefresh(); });
+    scheduleRefresh();
+}
+
+void FrameScheduler::removeClient(QWidget* widget) {
+    auto it = std::find_if(m_clients.begin(), m_clients.end(),
+                           [widget](const Client& client) { return client.widget == widget; });
+    if (it == m_clients.end()) {
+        return;
+    }
+    widget->removeEventFilter(this);
+    disconnect(widget, &QObject::destroyed, this, nullptr);
+    m_clients.erase(it);
+    scheduleRefresh();
+}
+
+bool FrameScheduler::isClientVisible(const QWidget* widget) const {
+    for (const Client& client : m_clients) {
+        if (client.widget == widget) {
+            return client.visible;
+        }
+    }
+    return false;
+}
+
+bool FrameScheduler::eventFilter(QObject* watched, QEvent* event) {
+    switch (event->type()) {
+    case QEvent::Show:
+    case QEvent::Hide:
+    case QEvent::WindowStateChange:
+        scheduleRefresh();
+        break;
+    case QEvent::ParentChange:
+        // Reparented into another window: watch that one too
+        if (auto* widget = qobject_cast<QWidget*>(watched)) {
+            watchWindow(widget);
+        }
+        scheduleRefresh();
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void FrameScheduler::watchWindow(QWidget* widget) {
+    QWidget* window = widget->window();
+    if (window == widget) {
+        return;
+    }
+    for (const QPointer<QWidget>& watched : m_windows) {
+        if (watched == window) {
+            return;
+        }
+    }
+    window->installEventFilter(this);
+    m_windows.push_back(window);
+}
+
+void FrameScheduler::scheduleRefresh() {
+    // Show/Hide arrive in bursts (one per child); settle them once the event loop is back
+    if (m_refreshPending) {
+        return;
+    }
+    m_refreshPending = true;
+    QMetaObject::invokeMethod(this, &FrameScheduler::refresh, Qt::QueuedConnection);
+}
+
+bool FrameScheduler::computeVisible(const QWidget* widget) {
+    return widget->isVisible() && !widget->window()->isMinimized();
+}
+
+void FrameScheduler::refresh() {
+    m_refreshPending = false;
+
+    m_clients.erase(std::remove_if(m_clients.begin(), m_clients.end(),
+                                   [](const Client& client) { return client.widget.isNull(); }),
+                    m_clients.end());
+    m_windows.erase(std::remove_if(m_windows.begin(), m_windows.end(),
+                                   [](const QPointer<QWidget>& window) { return window.isNull(); }),
+                    m_windows.end());
+
+    bool changed = false;
+    int visibleClients = 0;
+    qreal refreshRate = 0.0;
+    for (Client& client : m_clients) {
+        const bool visible = computeVisible(client.widget);
+        if (visible != client.visible) {
+            client.visible = visible;
+            client.lastTick = -1;  // catch up on the first frame after being shown
+            changed = true;
+        }
+        if (visible) {
+            ++visibleClients;
+            if (QScreen* screen = client.widget->screen()) {
+                refreshRate = std::max(refreshRate, screen->refreshRate());
+            }
+        }
+    }
+
+    if (visibleClients > 0) {
+        const int frameMs = refreshRate > 0.0
+            ? std::clamp(qRound(1000.0 / refreshRate), MIN_FRAME_MS, MAX_FRAME_MS)
+            : FALLBACK_FRAME_MS;
+        if (!m_timer->isActive() || m_timer->interval() != frameMs) {
+            m_timer->start(frameMs);
+            LOG_DEBUG(QString("FrameScheduler: %1 ms frames for %2 visible clients")
+                      .arg(frameMs).arg(visibleClients));
+        }
+    } else if (m_timer->isActive()) {
+        m_timer->stop();
+        LOG_DEBUG("FrameScheduler: no visible clients, idle");
+    }
+
+    if (changed) {
+        emit visibilityChanged();
+    }
+}
+
+void FrameScheduler::onFrame() {
+    const qint64 now = m_clock.elapsed();
+    const int halfFrame = m_timer->interval() / 2;
+
+    // Index loop and a copied callback: a tick may add or remove clients
+    for (size_t i = 0; i < m_clients.size(); ++i) {
+        Client& client = m_clients[i];
+        if (!client.visible || client.widget.isNull()) {
+            continue;
+        }
+        if (client.lastTick >= 0 && now - client.lastTick < client.intervalMs - halfFrame) {
+            continue;
+        }
+        client.lastTick = now;
+        const std::function<void()> tick = client.tick;
+        tick();
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QWidget>
+#include <functional>
+#include <vector>
+
+/**
+ * FrameScheduler - One display-paced timer for every animated widget
+ *
+ * Widgets register a tick callback instead of running their own QTimer.
+ * A client is ticked only while its widget is visible: shown, on the
+ * current page, and in a window that is neither hidden (e.g. minimized
+ * to the tray) nor minimized. The shared timer runs at the refresh rate
+ * of the screen showing the clients, and each client is throttled to its
+ * own maxFps on top of that. When no client is visible the timer stops,
+ * so a hidden UI causes no wakeups at all.
+ *
+ * Visibility is tracked through Show/Hide/WindowStateChange events on
+ * the clients and their windows, not by polling.
+ */
+class FrameScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    // Lives as long as the QApplication
+    static FrameScheduler* instance();
+
+    // maxFps 0 means every display frame. The client is dropped when the widget is destroyed
+    void addClient(QWidget* widget, int maxFps, std::function<void()> tick);
+    void removeClient(QWidget* widget);
+
+    bool isClientVisible(const QWidget* widget) const;
+    bool isRunning() const { return m_timer->isActive(); }
+    int getFrameInterval() const { return m_timer->interval(); }
+
+signals:
+    // Some client became visible or hidden
+    void visibilityChanged();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    explicit FrameScheduler(QObject* parent);
+
+    struct Client {
+        QPointer<QWidget> widget;
+        int intervalMs = 0;
+        qint64 lastTick = -1;
+        bool visible = false;
+        std::function<void()> tick;
+    };
+
+    void scheduleRefresh();
+    void refresh();
+    void onFrame();
+    void watchWindow(QWidget* widget);
+    static bool computeVisible(const QWidget* widget);
+
+    std::vector<Client> m_clients;
+    std::vector<QPointer<QWidget>> m_windows;
+    QTimer* m_timer;
+    QElapsedTimer m_clock;
+    bool m_refreshPending = false;
+};
+
+#endif // FRAMESCHEDULER_H
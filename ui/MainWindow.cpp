@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "FrameScheduler.h"
 #include "RainbowLine.h"
 #include "../src/core/AudioEngine.h"
 #include "../src/dsp/DSPProcessor.h"
@@ -12,8 +13,13 @@
 #include <QMouseEvent>
 #include <QCloseEvent>
 #include <QSettings>
+#include <QSignalBlocker>
 #include <QMessageBox>
 #include <QScreen>
+#include <QTime>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
 
 #ifdef Q_OS_WIN
 #include <dwmapi.h>
@@ -24,13 +30,14 @@
 // Optimized audio settings for low latency
 static constexpr int OPTIMAL_SAMPLE_RATE = 48000;
 static constexpr int OPTIMAL_BUFFER_SIZE = 128;  // ~2.7ms latency at 48kHz
+static constexpr int LEVEL_POLL_MS = 50;          // one meter window
+static constexpr int RUN_CLOCK_FPS = 4;           // run clock label lags a second change by < 250 ms
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
     , m_audioEngine(new AudioEngine(this))
     , m_dspProcessor(new DSPProcessor())
     , m_isRunning(false)
-    , m_runTimer(new QTimer(this))
     , m_trayIcon(nullptr)
     , m_trayMenu(nullptr)
 {
@@ -55,8 +62,25 @@ MainWindow::MainWindow(QWidget* parent)
     refreshOutputDevices();
     loadSettings();
 
-    // Timer setup
-    connect(m_runTimer, &QTimer::timeout, this, &MainWindow::updateTimer);
+    // Periodic UI work shares the frame scheduler and stops while its label is hidden
+    FrameScheduler* scheduler = FrameScheduler::instance();
+    scheduler->addClient(m_timerLabel, RUN_CLOCK_FPS, [this]() {
+        if (m_isRunning) {
+            updateTimer();
+        }
+    });
+    scheduler->addClient(m_levelLabel, 1000 / LEVEL_POLL_MS, [this]() {
+        if (m_isRunning) {
+            updateLevels();
+        }
+    });
+
+    // The engine only feeds the spectrum view while it is on screen
+    auto syncVisualization = [this, scheduler]() {
+        m_audioEngine->setVisualizationEnabled(scheduler->isClientVisible(m_spectrumWidget));
+    };
+    connect(scheduler, &FrameScheduler::visibilityChanged, this, syncVisualization);
+    syncVisualization();
 }
 
 MainWindow::~MainWindow() {
@@ -197,11 +221,22 @@ void MainWindow::setupMonitorPage() {
     statusLayout->addWidget(latLabel);
     statusLayout->addWidget(m_latencyLabel);
     statusLayout->addStretch();
+
+    // Output level: RMS and held true-peak, polled from the engine's meter
+    m_levelLabel = new QLabel("-- dB", this);
+    m_levelLabel->setObjectName("monitorLabel");
+    statusLayout->addWidget(m_levelLabel);
+
+    // EBU R128 loudness of the output
+    m_loudnessLabel = new QLabel("-- LUFS", this);
+    m_loudnessLabel->setObjectName("monitorLabel");
+    statusLayout->addWidget(m_loudnessLabel);
     layout->addLayout(statusLayout);
 
     // Spectrum visualization (dry vs wet comparison)
     m_spectrumWidget = new SpectrumWidget(this);
     m_spectrumWidget->setMinimumHeight(100);
+    m_spectrumWidget->setAnalyzer(&m_audioEngine->getSpectrumAnalyzer());
     layout->addWidget(m_spectrumWidget);
 
     // Bottom row
@@ -250,17 +285,51 @@ void MainWindow::setupConnections() {
     // Audio engine signals
     connect(m_audioEngine, &AudioEngine::audioDataReady, this, &MainWindow::onAudioDataReady);
     connect(m_audioEngine, &AudioEngine::spectrumDataReady, this, &MainWindow::onSpectrumDataReady);
-    connect(m_audioEngine, &AudioEngine::levelChanged, this, &MainWindow::onLevelChanged);
     connect(m_audioEngine, &AudioEngine::errorOccurred, this, &MainWindow::onAudioError);
     connect(m_audioEngine, &AudioEngine::latencyChanged, this, [this](double input, double output) {
         m_latencyLabel->setText(QString("%1 ms").arg(input + output, 0, 'f', 1));
     });
+    connect(m_audioEngine, &AudioEngine::latencyMeasured, this, [this](const LatencyMeasurement& result) {
+        if (!result.valid) {
+            m_latencyLabel->setToolTip(QString::fromStdString(result.error));
+            return;
+        }
+        // Measured loopback round trip replaces the driver's estimate
+        m_latencyLabel->setText(QString::fromUtf8("%1 ms (实测)").arg(result.roundTripMs, 0, 'f', 1));
+        m_latencyLabel->setToolTip(QString::fromUtf8("往返 %1-%2 ms, DSP %3 ms")
+            .arg(result.minRoundTripMs, 0, 'f', 2)
+            .arg(result.maxRoundTripMs, 0, 'f', 2)
+            .arg(result.dspLatencyMs, 0, 'f', 2));
+    });
 
     // Device selection
     connect(m_outputDeviceCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
-        if (index >= 0 && !m_isRunning) {
-            int deviceIdx = m_outputDeviceCombo->currentData().toInt();
-            m_audioEngine->setOutputDevice(deviceIdx);
+        // Also allowed while running: the engine switches outputs live
+        if (index < 0) {
+            return;
+        }
+        const bool wasRunning = m_isRunning;
+        const int previousDevice = m_audioEngine->getOutputDeviceIndex();
+        int deviceIdx = m_outputDeviceCombo->currentData().toInt();
+        if (m_audioEngine->setOutputDevice(deviceIdx) || !wasRunning) {
+            return;  // while stopped the engine logs the bad device and start() reports it
+        }
+
+        if (!m_audioEngine->isRunning()) {
+            // Full-duplex restart failed; errors the engine emitted have already stopped the UI
+            if (m_isRunning) {
+                onAudioError(QString::fromUtf8("无法在新输出设备上重新启动音频处理。"));
+            }
+            return;
+        }
+
+        // The previous output is still playing: say so and select it again
+        QMessageBox::warning(this, QString::fromUtf8("输出设备"),
+            QString::fromUtf8("无法切换到该输出设备，继续使用当前设备。"));
+        const QSignalBlocker blocker(m_outputDeviceCombo);
+        const int previousIndex = m_outputDeviceCombo->findData(previousDevice);
+        if (previousIndex >= 0) {
+            m_outputDeviceCombo->setCurrentIndex(previousIndex);
         }
     });
 }
@@ -276,11 +345,16 @@ void MainWindow::setupSystemTray() {
     QAction* showAction = m_trayMenu->addAction(QString::fromUtf8("显示/隐藏"));
     QAction* bypassAction = m_trayMenu->addAction(QString::fromUtf8("直通"));
     bypassAction->setCheckable(true);
+    // Needs an output looped back to the input; the input is muted while it runs
+    QAction* measureAction = m_trayMenu->addAction(QString::fromUtf8("测量延迟 (回环)"));
     m_trayMenu->addSeparator();
     QAction* exitAction = m_trayMenu->addAction(QString::fromUtf8("退出"));
 
     connect(showAction, &QAction::triggered, this, &MainWindow::toggleMainWindow);
     connect(bypassAction, &QAction::toggled, m_bypassButton, &QPushButton::setChecked);
+    connect(measureAction, &QAction::triggered, this, [this]() {
+        m_audioEngine->startLatencyMeasurement();
+    });
     connect(exitAction, &QAction::triggered, this, &MainWindow::onExitButtonClicked);
 
     m_trayIcon->setContextMenu(m_trayMenu);
@@ -319,6 +393,29 @@ void MainWindow::autoConfigureAudio() {
     m_audioEngine->setBufferSize(OPTIMAL_BUFFER_SIZE);
     m_dspProcessor->setSampleRate(OPTIMAL_SAMPLE_RATE);
 
+    // Separate streams let the output device be switched live with a crossfade and
+    // absorb the drift between VB-CABLE and the output device; installs that want
+    // the last few ms of latency can opt back into full duplex
+    QSettings settings("AmpTube300B", "AmpTube300B");
+    m_audioEngine->setStreamMode(settings.value("separateStreams", true).toBool()
+                                 ? AudioEngine::StreamMode::SeparateStreams
+                                 : AudioEngine::StreamMode::FullDuplex);
+
+    // Linux installs can run as a JACK/PipeWire client instead of through PortAudio
+    if (settings.value("backend").toString() == "jack") {
+        m_audioEngine->setBackend(AudioEngine::Backend::Jack);
+    }
+
+    // Devices with integer-native drivers (ASIO, ALSA hw) can skip PortAudio's float conversion
+    const QString streamFormat = settings.value("streamFormat").toString();
+    if (streamFormat == "int16") {
+        m_audioEngine->setStreamFormat(SampleConverter::Format::Int16);
+    } else if (streamFormat == "int24") {
+        m_audioEngine->setStreamFormat(SampleConverter::Format::Int24);
+    } else if (streamFormat == "int32") {
+        m_audioEngine->setStreamFormat(SampleConverter::Format::Int32);
+    }
+
     LOG_INFO(QString("Auto-configured: %1 Hz, %2 samples buffer (~%3 ms)")
              .arg(OPTIMAL_SAMPLE_RATE)
              .arg(OPTIMAL_BUFFER_SIZE)
@@ -368,8 +465,9 @@ void MainWindow::enableFrostedGlassEffect() {
 
 void MainWindow::onStartButtonClicked() {
     if (!m_isRunning) {
-        // Check if VB-CABLE is available
-        if (m_autoInputDeviceIndex < 0) {
+        // Check if VB-CABLE is available (JACK routes input in its own graph)
+        bool usesJack = m_audioEngine->getBackend() == AudioEngine::Backend::Jack;
+        if (m_autoInputDeviceIndex < 0 && !usesJack) {
             QMessageBox::warning(this, QString::fromUtf8("配置错误"),
                 QString::fromUtf8("未找到VB-CABLE！\n\n"
                 "请安装VB-Audio Virtual Cable，\n"
@@ -396,12 +494,11 @@ void MainWindow::onStartButtonClicked() {
 
             m_spectrumWidget->setSimulationMode(false);
 
-            // Start timer
-            m_elapsedTime = QTime(0, 0, 0);
-            m_runTimer->start(1000);
-
-            // Disable output selection while running
-            m_outputDeviceCombo->setEnabled(false);
+            // Run clock and meters are refreshed by the frame scheduler
+            m_runClock.start();
+            m_timerLabel->setText("00:00:00");
+            m_lastLevelWindow = 0;
+            m_lastLoudnessBlock = 0;
 
             // Auto switch to Monitor page
             m_stackedWidget->setCurrentIndex(1);
@@ -427,10 +524,8 @@ void MainWindow::onStartButtonClicked() {
         m_processingStatusLabel->style()->polish(m_processingStatusLabel);
 
         m_spectrumWidget->setSimulationMode(true);
-        m_runTimer->stop();
-
-        // Re-enable output selection
-        m_outputDeviceCombo->setEnabled(true);
+        m_levelLabel->setText("-- dB");
+        m_loudnessLabel->setText("-- LUFS");
 
         LOG_INFO("Audio processing stopped");
     }
@@ -449,8 +544,11 @@ void MainWindow::onTabButtonClicked(int id) {
 }
 
 void MainWindow::updateTimer() {
-    m_elapsedTime = m_elapsedTime.addSecs(1);
-    m_timerLabel->setText(m_elapsedTime.toString("hh:mm:ss"));
+    // Derived from the clock, so time spent hidden (no ticks) is still counted
+    const QString elapsed = QTime(0, 0).addMSecs(m_runClock.elapsed()).toString("hh:mm:ss");
+    if (elapsed != m_timerLabel->text()) {
+        m_timerLabel->setText(elapsed);
+    }
 }
 
 void MainWindow::onAudioDataReady(const QVector<float>& data) {
@@ -462,9 +560,44 @@ void MainWindow::onSpectrumDataReady(const QVector<float>& dryData, const QVecto
     m_spectrumWidget->updateSpectrum(dryData, wetData);
 }
 
-void MainWindow::onLevelChanged(float left, float right) {
-    Q_UNUSED(left);
-    Q_UNUSED(right);
+void MainWindow::updateLevels() {
+    const LoudnessReading loudness = m_audioEngine->getLoudness();
+    if (loudness.blocks != m_lastLoudnessBlock) {
+        m_lastLoudnessBlock = loudness.blocks;
+
+        auto lufs = [](float value) {
+            return std::isfinite(value) ? QString::number(value, 'f', 1) : QString("--");
+        };
+        m_loudnessLabel->setText(QString("I %1 LUFS | LRA %2 LU")
+            .arg(lufs(loudness.integrated)).arg(loudness.range, 0, 'f', 1));
+        m_loudnessLabel->setToolTip(QString::fromUtf8("瞬时 (M): %1 LUFS, 最大 %2\n短期 (S): %3 LUFS, 最大 %4\n综合 (I): %5 LUFS\n响度范围 (LRA): %6 LU")
+            .arg(lufs(loudness.momentary)).arg(lufs(loudness.maxMomentary))
+            .arg(lufs(loudness.shortTerm)).arg(lufs(loudness.maxShortTerm))
+            .arg(lufs(loudness.integrated)).arg(loudness.range, 0, 'f', 1));
+    }
+
+    const LevelReading levels = m_audioEngine->getLevels();
+    if (levels.windows == m_lastLevelWindow || levels.channels == 0) {
+        return;  // no new metering window since the last poll
+    }
+    m_lastLevelWindow = levels.windows;
+
+    auto format = [](float level) {
+        return level > 1e-5f ? QString::number(LevelReading::toDecibels(level), 'f', 1) : QString("--");
+    };
+
+    float rms = 0.0f;
+    float hold = 0.0f;
+    QStringList details;
+    for (int ch = 0; ch < levels.channels; ++ch) {
+        rms = std::max(rms, levels.rms[ch]);
+        hold = std::max(hold, levels.maxTruePeak[ch]);
+        details << QString::fromUtf8("声道 %1: RMS %2 dB, 峰值 %3 dB, 真峰值 %4 dBTP")
+            .arg(ch + 1).arg(format(levels.rms[ch])).arg(format(levels.peak[ch])).arg(format(levels.truePeak[ch]));
+    }
+
+    m_levelLabel->setText(QString("%1 dB | %2 dBTP").arg(format(rms)).arg(format(hold)));
+    m_levelLabel->setToolTip(details.join('\n'));
 }
 
 void MainWindow::onAudioError(const QString& error) {
@@ -9,8 +9,7 @@
 #include <QPushButton>
 #include <QStackedWidget>
 #include <QSystemTrayIcon>
-#include <QTimer>
-#include <QTime>
+#include <QElapsedTimer>
 
 #include "SpectrumWidget.h"
 
@@ -40,7 +39,7 @@ private slots:
     void updateTimer();
     void onAudioDataReady(const QVector<float>& data);
     void onSpectrumDataReady(const QVector<float>& dryData, const QVector<float>& wetData);
-    void onLevelChanged(float left, float right);
+    void updateLevels();
     void onAudioError(const QString& error);
     void onBypassToggled(bool checked);
     void toggleMainWindow();
@@ -86,6 +85,8 @@ private:
     QWidget* m_pageMonitor;
     QLabel* m_processingStatusLabel;
     QLabel* m_latencyLabel;
+    QLabel* m_levelLabel;
+    QLabel* m_loudnessLabel;
     SpectrumWidget* m_spectrumWidget;
     QPushButton* m_bypassButton;
     QPushButton* m_minimizeButton;
@@ -94,8 +95,9 @@ private:
 
     // State
     bool m_isRunning;
-    QTimer* m_runTimer;
-    QTime m_elapsedTime;
+    QElapsedTimer m_runClock;
+    quint64 m_lastLevelWindow = 0;
+    quint64 m_lastLoudnessBlock = 0;
     QPoint m_dragPosition;
 
     // System tray
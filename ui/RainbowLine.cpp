@@ -1,24 +1,19 @@
 #include "RainbowLine.h"
+#include "FrameScheduler.h"
 #include <QLinearGradient>
 #include <QPainter>
 
 RainbowLine::RainbowLine(QWidget* parent)
     : QWidget(parent)
-    , m_timer(new QTimer(this))
     , m_offset(0.0f)
 {
     setFixedHeight(2);
 
-    // Update at ~60 FPS
-    connect(m_timer, &QTimer::timeout, this, &RainbowLine::updateAnimation);
-    m_timer->start(16);
+    // Update at ~60 FPS while visible
+    FrameScheduler::instance()->addClient(this, ANIMATION_FPS, [this]() { updateAnimation(); });
 }
 
-RainbowLine::~RainbowLine() {
-    if (m_timer->isActive()) {
-        m_timer->stop();
-    }
-}
+RainbowLine::~RainbowLine() = default;
 
 void RainbowLine::updateAnimation() {
     m_offset += 0.005f;
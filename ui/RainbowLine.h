@@ -1,7 +1,6 @@
 #ifndef RAINBOWLINE_H
 #define RAINBOWLINE_H
 
-#include <QTimer>
 #include <QWidget>
 
 class RainbowLine : public QWidget {
@@ -18,7 +17,8 @@ private slots:
     void updateAnimation();
 
 private:
-    QTimer* m_timer;
+    static constexpr int ANIMATION_FPS = 60;
+
     float m_offset;  // 0.0 to 1.0 for animation
 };
 
@@ -1,6 +1,10 @@
 #include "SpectrumWidget.h"
+#include "FrameScheduler.h"
+#include "../src/utils/Logger.h"
+#include <QElapsedTimer>
+#include <QMouseEvent>
 #include <QPainter>
-#include <QPainterPath>
+#include <QPolygonF>
 #include <cmath>
 #include <algorithm>
 
@@ -9,19 +13,28 @@ SpectrumWidget::SpectrumWidget(QWidget* parent)
 {
     setMinimumHeight(100);
     setAttribute(Qt::WA_OpaquePaintEvent, false);
+    setCursor(Qt::PointingHandCursor);
+    setToolTip(QString::fromUtf8("点击切换 频谱/波形"));
 
-    // Initialize waveform history buffers
+    // Initialize waveform history buffers; the display starts with a full history of silence
     m_dryHistory.resize(HISTORY_SIZE, 0.0f);
     m_wetHistory.resize(HISTORY_SIZE, 0.0f);
+    m_sampleCount = HISTORY_SIZE;
 
-    // Start animation timer for smooth scrolling
-    m_animationTimer = new QTimer(this);
-    connect(m_animationTimer, &QTimer::timeout, this, [this]() {
-        if (!m_simulationMode) {
+    // Smooth scrolling at up to ANIMATION_FPS, only while the widget is on screen
+    FrameScheduler::instance()->addClient(this, ANIMATION_FPS, [this]() {
+        if (m_simulationMode) {
+            return;
+        }
+        // Repaint only when there is something new to show
+        if (m_displayMode == DisplayMode::Waveform) {
+            if (m_sampleCount != m_paintedSamples) {
+                update();
+            }
+        } else if (m_analyzer && m_analyzer->latest(m_frame)) {
             update();
         }
     });
-    m_animationTimer->start(16);  // ~60 FPS
 }
 
 void SpectrumWidget::updateSpectrum(const QVector<float>& dryData, const QVector<float>& wetData) {
@@ -80,23 +93,29 @@ void SpectrumWidget::setSimulationMode(bool enabled) {
         std::fill(m_wetHistory.begin(), m_wetHistory.end(), 0.0f);
         m_lastDry = 0.0f;
         m_lastWet = 0.0f;
+        m_cacheValid = false;
+        m_frame.dry.clear();
+        m_frame.wet.clear();
+        m_frame.sequence = 0;
         update();  // Repaint to show flat line
     }
 }
 
-void SpectrumWidget::pushSample(float drySample, float wetSample) {
-    // Shift history left and add new sample at the end
-    for (int i = 0; i < HISTORY_SIZE - 1; ++i) {
-        m_dryHistory[i] = m_dryHistory[i + 1];
-        m_wetHistory[i] = m_wetHistory[i + 1];
-    }
+void SpectrumWidget::setDisplayMode(DisplayMode mode) {
+    m_displayMode = mode;
+    update();
+}
 
+void SpectrumWidget::pushSample(float drySample, float wetSample) {
     // Smooth the input
     float smoothedDry = m_lastDry * 0.7f + drySample * 0.3f;
     float smoothedWet = m_lastWet * 0.7f + wetSample * 0.3f;
 
-    m_dryHistory[HISTORY_SIZE - 1] = smoothedDry;
-    m_wetHistory[HISTORY_SIZE - 1] = smoothedWet;
+    // Overwrite the oldest slot of the ring
+    const int index = static_cast<int>(m_sampleCount % HISTORY_SIZE);
+    m_dryHistory[index] = smoothedDry;
+    m_wetHistory[index] = smoothedWet;
+    ++m_sampleCount;
 
     m_lastDry = smoothedDry;
     m_lastWet = smoothedWet;
@@ -104,14 +123,119 @@ void SpectrumWidget::pushSample(float drySample, float wetSample) {
 
 void SpectrumWidget::resizeEvent(QResizeEvent* event) {
     QWidget::resizeEvent(event);
+    m_cacheValid = false;
+}
+
+void SpectrumWidget::mousePressEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton) {
+        setDisplayMode(m_displayMode == DisplayMode::Spectrum ? DisplayMode::Waveform : DisplayMode::Spectrum);
+        event->accept();
+        return;
+    }
+    QWidget::mousePressEvent(event);
 }
 
 void SpectrumWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
 
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
 
+    if (m_displayMode == DisplayMode::Spectrum) {
+        paintSpectrum(painter);
+        paintLegend(painter, QString::fromUtf8("频率 →"));
+    } else {
+        paintWaveform(painter);
+        paintLegend(painter, QString::fromUtf8("时间 →"));
+    }
+
+    m_paintNanos += paintTimer.nsecsElapsed();
+    if (++m_paintCount == PAINT_STATS_FRAMES) {
+        LOG_DEBUG(QString("SpectrumWidget: %1 us per %2 paint (%3 frames)")
+                  .arg(m_paintNanos / 1000.0 / m_paintCount, 0, 'f', 1)
+                  .arg(m_displayMode == DisplayMode::Spectrum ? "spectrum" : "waveform")
+                  .arg(m_paintCount));
+        m_paintNanos = 0;
+        m_paintCount = 0;
+    }
+}
+
+void SpectrumWidget::paintSpectrum(QPainter& painter) {
+    const int w = width();
+    const int h = height();
+    const int marginLeft = 5;
+    const int marginRight = 5;
+    const int marginTop = 18;
+    const int marginBottom = 5;
+    const float graphW = static_cast<float>(w - marginLeft - marginRight);
+    const float graphH = static_cast<float>(h - marginTop - marginBottom);
+
+    const float logMin = std::log10(SpectrumAnalyzer::kMinFrequency);
+    const float logSpan = std::log10(SpectrumAnalyzer::kMaxFrequency) - logMin;
+    auto xFor = [&](float frequency) {
+        return marginLeft + (std::log10(frequency) - logMin) / logSpan * graphW;
+    };
+    auto yFor = [&](float db) {
+        const float clamped = std::clamp(db, SPECTRUM_BOTTOM_DB, SPECTRUM_TOP_DB);
+        return marginTop + (SPECTRUM_TOP_DB - clamped) / (SPECTRUM_TOP_DB - SPECTRUM_BOTTOM_DB) * graphH;
+    };
+
+    painter.fillRect(rect(), m_bgColor);
+
+    // Grid: 1-2-5 frequency steps and 20 dB lines
+    QFont font = painter.font();
+    font.setPointSize(7);
+    painter.setFont(font);
+    painter.setPen(QPen(m_gridColor, 1, Qt::DotLine));
+    for (float frequency : {50.0f, 100.0f, 200.0f, 500.0f, 1000.0f, 2000.0f, 5000.0f, 10000.0f}) {
+        const float x = xFor(frequency);
+        painter.drawLine(QPointF(x, marginTop), QPointF(x, h - marginBottom));
+    }
+    for (float db = SPECTRUM_TOP_DB - 20.0f; db > SPECTRUM_BOTTOM_DB; db -= 20.0f) {
+        const float y = yFor(db);
+        painter.drawLine(QPointF(marginLeft, y), QPointF(w - marginRight, y));
+    }
+    painter.setPen(QColor(80, 80, 80));
+    painter.drawText(QPointF(xFor(100.0f) + 2, h - marginBottom - 2), "100");
+    painter.drawText(QPointF(xFor(1000.0f) + 2, h - marginBottom - 2), "1k");
+    painter.drawText(QPointF(xFor(10000.0f) + 2, h - marginBottom - 2), "10k");
+    for (float db = SPECTRUM_TOP_DB - 20.0f; db > SPECTRUM_BOTTOM_DB; db -= 20.0f) {
+        painter.drawText(QPointF(marginLeft + 2, yFor(db) - 2), QString::number(static_cast<int>(db)));
+    }
+
+    const int bands = static_cast<int>(std::min({m_frame.frequencies.size(), m_frame.dry.size(), m_frame.wet.size()}));
+    if (m_simulationMode || bands < 2) {
+        return;
+    }
+
+    QPolygonF dry(bands);
+    QPolygonF wet(bands);
+    for (int b = 0; b < bands; ++b) {
+        const float x = xFor(m_frame.frequencies[b]);
+        dry[b] = QPointF(x, yFor(m_frame.dry[b]));
+        wet[b] = QPointF(x, yFor(m_frame.wet[b]));
+    }
+
+    // Wet area first so the dry trace stays readable on top of it
+    QPolygonF wetArea = wet;
+    wetArea << QPointF(wet.last().x(), h - marginBottom) << QPointF(wet.first().x(), h - marginBottom);
+    QColor fillColor = m_wetColor;
+    fillColor.setAlpha(40);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(fillColor);
+    painter.drawPolygon(wetArea);
+    painter.setBrush(Qt::NoBrush);
+
+    painter.setPen(QPen(m_wetColor, 1.5));
+    painter.drawPolyline(wet);
+    painter.setPen(QPen(m_dryColor, 1.2));
+    painter.drawPolyline(dry);
+}
+
+void SpectrumWidget::paintWaveform(QPainter& painter) {
     const int w = width();
     const int h = height();
     const int marginLeft = 5;
@@ -142,45 +266,129 @@ void SpectrumWidget::paintEvent(QPaintEvent* event) {
         painter.drawLine(x, marginTop, x, h - marginBottom);
     }
 
-    // Helper lambda to draw waveform
-    auto drawWaveform = [&](const QVector<float>& history, const QColor& color, float offsetY = 0.0f) {
-        if (history.isEmpty()) return;
+    // Traces: bring the cache up to date and blit it
+    updateWaveformCache();
+    if (m_cacheValid) {
+        painter.drawPixmap(waveformRect().topLeft(), m_waveformCache);
+    }
+    m_paintedSamples = m_sampleCount;
+}
 
-        QPainterPath path;
-        bool started = false;
-        int histSize = static_cast<int>(history.size());
+QRect SpectrumWidget::waveformRect() const {
+    const int marginLeft = 5;
+    const int marginRight = 5;
+    const int marginTop = 18;
+    const int marginBottom = 5;
+    return QRect(marginLeft, marginTop, width() - marginLeft - marginRight, height() - marginTop - marginBottom);
+}
 
-        for (int i = 0; i < histSize; ++i) {
-            float x = marginLeft + (static_cast<float>(i) / (histSize - 1)) * graphW;
+qint64 SpectrumWidget::cacheOriginFor(qint64 newestSample) const {
+    // The newest sample lands on the right edge, to within a device pixel
+    const double step = static_cast<double>(m_waveformCache.width()) / (HISTORY_SIZE - 1);
+    return static_cast<qint64>(std::floor(newestSample * step)) - m_waveformCache.width();
+}
 
-            // Clamp and scale amplitude
-            float amp = std::clamp(history[i], -1.0f, 1.0f);
-            float y = centerY - (amp * (graphH / 2 - 2)) + offsetY;
+void SpectrumWidget::strokeWaveform(QPainter& painter, const QVector<float>& history, const QColor& color,
+                                    float offsetY, qint64 first, qint64 last, qint64 origin) const {
+    const double dpr = m_waveformCache.devicePixelRatio();
+    const double step = static_cast<double>(m_waveformCache.width()) / (HISTORY_SIZE - 1);
+    const float halfHeight = static_cast<float>(static_cast<int>(m_waveformCache.height() / dpr) / 2);
+
+    QPolygonF points;
+    points.reserve(static_cast<int>(last - first + 1));
+    for (qint64 sample = first; sample <= last; ++sample) {
+        // Clamp and scale amplitude
+        const float amp = std::clamp(history[static_cast<int>(sample % HISTORY_SIZE)], -1.0f, 1.0f);
+        points << QPointF((sample * step - origin) / dpr, halfHeight - amp * (halfHeight - 2) + offsetY);
+    }
 
-            if (!started) {
-                path.moveTo(x, y);
-                started = true;
-            } else {
-                path.lineTo(x, y);
-            }
-        }
+    // Draw glow effect
+    QColor glowColor = color;
+    glowColor.setAlpha(30);
+    painter.setPen(QPen(glowColor, 4.0));
+    painter.drawPolyline(points);
 
-        // Draw glow effect
-        QColor glowColor = color;
-        glowColor.setAlpha(30);
-        painter.setPen(QPen(glowColor, 4.0));
-        painter.drawPath(path);
+    // Draw main line
+    painter.setPen(QPen(color, 1.5));
+    painter.drawPolyline(points);
+}
 
-        // Draw main line
-        painter.setPen(QPen(color, 1.5));
-        painter.drawPath(path);
-    };
+void SpectrumWidget::rebuildWaveformCache() {
+    const QRect area = waveformRect();
+    if (area.width() < 2 || area.height() < 2) {
+        m_cacheValid = false;
+        return;
+    }
+
+    const qreal dpr = devicePixelRatioF();
+    const QSize deviceSize = area.size() * dpr;
+    if (m_waveformCache.size() != deviceSize || m_waveformCache.devicePixelRatio() != dpr) {
+        m_waveformCache = QPixmap(deviceSize);
+        m_waveformCache.setDevicePixelRatio(dpr);
+    }
+    m_waveformCache.fill(Qt::transparent);
+
+    const qint64 newest = m_sampleCount - 1;
+    m_cacheOrigin = cacheOriginFor(newest);
+
+    QPainter painter(&m_waveformCache);
+    painter.setRenderHint(QPainter::Antialiasing);
+    // Dry slightly offset up, wet slightly offset down
+    strokeWaveform(painter, m_dryHistory, m_dryColor, -1.0f, newest - (HISTORY_SIZE - 1), newest, m_cacheOrigin);
+    strokeWaveform(painter, m_wetHistory, m_wetColor, 1.0f, newest - (HISTORY_SIZE - 1), newest, m_cacheOrigin);
+
+    m_cachedSamples = m_sampleCount;
+    m_cacheValid = true;
+}
+
+void SpectrumWidget::updateWaveformCache() {
+    const qreal dpr = devicePixelRatioF();
+    // Incremental strokes restart two samples back, which must still be in the ring
+    if (!m_cacheValid || m_waveformCache.size() != waveformRect().size() * dpr
+        || m_waveformCache.devicePixelRatio() != dpr
+        || m_sampleCount - m_cachedSamples > HISTORY_SIZE - 3) {
+        rebuildWaveformCache();
+        return;
+    }
+    if (m_sampleCount == m_cachedSamples) {
+        return;
+    }
+
+    const qint64 previousNewest = m_cachedSamples - 1;
+    const qint64 newest = m_sampleCount - 1;
+    const qint64 origin = cacheOriginFor(newest);
+
+    // Whole device pixels, so the retained columns are copied exactly
+    const qint64 shift = origin - m_cacheOrigin;
+    if (shift > 0) {
+        m_waveformCache.scroll(-static_cast<int>(shift), 0, m_waveformCache.rect());
+    }
 
-    // Draw dry waveform (blue) - slightly offset up
-    drawWaveform(m_dryHistory, m_dryColor, -1.0f);
+    // Everything right of the previous newest sample is cleared and redrawn. The
+    // strokes restart two samples earlier, clipped to that seam, so line joins and
+    // caps come out as in a full redraw
+    const double step = static_cast<double>(m_waveformCache.width()) / (HISTORY_SIZE - 1);
+    const qreal seam = (previousNewest * step - origin) / dpr;
+    const QRectF fresh(seam, 0.0, m_waveformCache.width() / dpr - seam + 1.0, m_waveformCache.height() / dpr);
+
+    QPainter painter(&m_waveformCache);
+    painter.setCompositionMode(QPainter::CompositionMode_Clear);
+    painter.fillRect(fresh, Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    painter.setClipRect(fresh);
+    painter.setRenderHint(QPainter::Antialiasing);
+    strokeWaveform(painter, m_dryHistory, m_dryColor, -1.0f, previousNewest - 2, newest, origin);
+    strokeWaveform(painter, m_wetHistory, m_wetColor, 1.0f, previousNewest - 2, newest, origin);
 
-    // Draw wet waveform (green) - slightly offset down
-    drawWaveform(m_wetHistory, m_wetColor, 1.0f);
+    m_cacheOrigin = origin;
+    m_cachedSamples = m_sampleCount;
+}
+
+void SpectrumWidget::paintLegend(QPainter& painter, const QString& axisLabel) {
+    const int w = width();
+    const int h = height();
+    const int marginLeft = 5;
+    const int marginRight = 5;
 
     // Legend
     QFont font = painter.font();
@@ -202,36 +410,7 @@ void SpectrumWidget::paintEvent(QPaintEvent* event) {
     painter.setPen(m_wetColor);
     painter.drawText(marginLeft + 90, legendY + 4, QString::fromUtf8("处理后"));
 
-    // Time indicator
+    // Axis indicator
     painter.setPen(QColor(80, 80, 80));
-    painter.drawText(w - marginRight - 45, h - 2, QString::fromUtf8("时间 →"));
-}
-
-// Keep these methods for API compatibility (they're declared in header)
-void SpectrumWidget::computeFFT(const QVector<float>& input, QVector<float>& magnitudes) {
-    Q_UNUSED(input);
-    Q_UNUSED(magnitudes);
-    // Not used in waveform mode
-}
-
-void SpectrumWidget::fft(std::vector<std::complex<float>>& data) {
-    Q_UNUSED(data);
-    // Not used in waveform mode
-}
-
-void SpectrumWidget::applyWindow(QVector<float>& data) {
-    Q_UNUSED(data);
-    // Not used in waveform mode
-}
-
-void SpectrumWidget::smoothSpectrum(QVector<float>& current, const QVector<float>& target) {
-    Q_UNUSED(current);
-    Q_UNUSED(target);
-    // Not used in waveform mode
-}
-
-float SpectrumWidget::toDecibels(float magnitude) const {
-    Q_UNUSED(magnitude);
-    return 0.0f;
-    // Not used in waveform mode
+    painter.drawText(w - marginRight - 45, h - 2, axisLabel);
 }
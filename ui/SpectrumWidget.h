@@ -2,28 +2,44 @@
 #define SPECTRUMWIDGET_H
 
 #include <QWidget>
+#include <QPixmap>
 #include <QVector>
-#include <QTimer>
-#include <complex>
+#include "../src/core/SpectrumAnalyzer.h"
 
 /**
- * SpectrumWidget - ECG-style scrolling waveform display
+ * SpectrumWidget - Dry vs. wet spectrum, or an ECG-style scrolling waveform
  *
- * Displays scrolling waveforms comparing dry/wet signals:
+ * Spectrum mode (the default) paints the log-frequency curves that
+ * SpectrumAnalyzer computes on its worker thread, so the tube's harmonic
+ * signature shows up as green peaks above the blue dry trace. The widget
+ * only copies and draws; no analysis runs on the GUI thread.
+ *
+ * Waveform mode scrolls the dry/wet signals from right to left like a
+ * heart monitor. The history is a ring, and the traces live in a cached
+ * pixmap that is scrolled by whole pixels each frame; only the columns of
+ * the newly pushed samples are stroked, so a frame costs the same however
+ * long the history is. Clicking the widget switches modes.
  * - Blue: Original (dry) signal
  * - Green: Processed (wet) signal
- *
- * The waveforms scroll from right to left like a heart monitor,
- * allowing audiophiles to see the real-time difference between
- * the original and tube-processed audio.
  */
 class SpectrumWidget : public QWidget {
     Q_OBJECT
 
 public:
+    enum class DisplayMode {
+        Spectrum,
+        Waveform
+    };
+
     explicit SpectrumWidget(QWidget* parent = nullptr);
 
-    // Update with both dry and wet audio data
+    // Source of the spectrum curves; polled on each animation frame
+    void setAnalyzer(const SpectrumAnalyzer* analyzer) { m_analyzer = analyzer; }
+
+    void setDisplayMode(DisplayMode mode);
+    DisplayMode getDisplayMode() const { return m_displayMode; }
+
+    // Update the waveform with both dry and wet audio data
     void updateSpectrum(const QVector<float>& dryData, const QVector<float>& wetData);
 
     // For backwards compatibility - updates wet only
@@ -35,31 +51,58 @@ public:
 protected:
     void paintEvent(QPaintEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
 
 private:
-    // Push a new sample to the history (scrolls left)
+    // Append a sample to the history ring
     void pushSample(float drySample, float wetSample);
 
-    // Legacy FFT methods (kept for API compatibility, not used)
-    void computeFFT(const QVector<float>& input, QVector<float>& magnitudes);
-    void fft(std::vector<std::complex<float>>& data);
-    void applyWindow(QVector<float>& data);
-    void smoothSpectrum(QVector<float>& current, const QVector<float>& target);
-    float toDecibels(float magnitude) const;
-
-    // Waveform history buffers
+    void paintSpectrum(QPainter& painter);
+    void paintWaveform(QPainter& painter);
+    void paintLegend(QPainter& painter, const QString& axisLabel);
+
+    // Waveform cache: sample s sits at s * step device pixels from the
+    // cache origin, so scrolling is a whole-pixel blit plus new columns
+    QRect waveformRect() const;
+    void updateWaveformCache();
+    void rebuildWaveformCache();
+    void strokeWaveform(QPainter& painter, const QVector<float>& history, const QColor& color,
+                        float offsetY, qint64 first, qint64 last, qint64 origin) const;
+    qint64 cacheOriginFor(qint64 newestSample) const;
+
+    // Spectrum display
+    DisplayMode m_displayMode = DisplayMode::Spectrum;
+    const SpectrumAnalyzer* m_analyzer = nullptr;
+    SpectrumFrame m_frame;
+    static constexpr float SPECTRUM_TOP_DB = 0.0f;
+    static constexpr float SPECTRUM_BOTTOM_DB = -100.0f;
+
+    // Waveform history rings; sample s lives at index s % HISTORY_SIZE
     QVector<float> m_dryHistory;
     QVector<float> m_wetHistory;
+    qint64 m_sampleCount = 0;  // samples pushed, counting the initial silent history
 
     // Display parameters
     static constexpr int HISTORY_SIZE = 300;  // Number of samples to display
 
+    // Rendered waveform traces (transparent outside the strokes)
+    QPixmap m_waveformCache;
+    qint64 m_cachedSamples = 0;   // m_sampleCount when the cache was last brought up to date
+    qint64 m_cacheOrigin = 0;     // device pixel at the cache's left edge
+    bool m_cacheValid = false;
+    qint64 m_paintedSamples = -1;
+
+    // Paint cost, logged at debug level every PAINT_STATS_FRAMES paints
+    static constexpr int PAINT_STATS_FRAMES = 600;
+    qint64 m_paintNanos = 0;
+    int m_paintCount = 0;
+
     // Smoothing state
     float m_lastDry = 0.0f;
     float m_lastWet = 0.0f;
 
-    // Animation
-    QTimer* m_animationTimer = nullptr;
+    // Animation, driven by FrameScheduler
+    static constexpr int ANIMATION_FPS = 60;
 
     // Simulation mode
     bool m_simulationMode = true;
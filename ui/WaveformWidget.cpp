@@ -1,11 +1,11 @@
 #include "WaveformWidget.h"
+#include "FrameScheduler.h"
 #include <QPainter>
 #include <QRandomGenerator>
 #include <cmath>
 
 WaveformWidget::WaveformWidget(QWidget* parent)
     : QWidget(parent)
-    , m_animationTimer(new QTimer(this))
     , m_useRealData(false)
     , m_barCount(50)
     , m_topColor(0, 255, 255)      // Cyan
@@ -20,16 +20,11 @@ WaveformWidget::WaveformWidget(QWidget* parent)
         m_bars[i] = QRandomGenerator::global()->bounded(100);
     }
 
-    // Animation timer for simulation mode
-    connect(m_animationTimer, &QTimer::timeout, this, &WaveformWidget::onAnimationTick);
-    m_animationTimer->start(50);  // 20 FPS for simulation
+    // Simulation animation, paused by the scheduler while the widget is hidden
+    FrameScheduler::instance()->addClient(this, ANIMATION_FPS, [this]() { onAnimationTick(); });
 }
 
-WaveformWidget::~WaveformWidget() {
-    if (m_animationTimer->isActive()) {
-        m_animationTimer->stop();
-    }
-}
+WaveformWidget::~WaveformWidget() = default;
 
 void WaveformWidget::updateFromAudioData(const QVector<float>& audioSamples) {
     m_useRealData = true;
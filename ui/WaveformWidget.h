@@ -1,7 +1,6 @@
 #ifndef WAVEFORMWIDGET_H
 #define WAVEFORMWIDGET_H
 
-#include <QTimer>
 #include <QVector>
 #include <QWidget>
 
@@ -36,8 +35,9 @@ private slots:
 private:
     void convertAudioToLevels(const QVector<float>& samples);
 
+    static constexpr int ANIMATION_FPS = 20;
+
     QVector<int> m_bars;
-    QTimer* m_animationTimer;
     bool m_useRealData;
 
     // Visual settings